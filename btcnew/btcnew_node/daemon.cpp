@@ -45,6 +45,8 @@ void btcnew_daemon::daemon::run (boost::filesystem::path const & data_path, btcn
 	btcnew::set_use_memory_pools (config.node.use_memory_pools);
 	if (!error)
 	{
+		// Threads created from here on are pinned by their role
+		config.node.threading_config.apply_affinity ();
 		config.node.logging.init (data_path);
 		btcnew::logger_mt logger{ config.node.logging.min_time_between_log_output };
 		boost::asio::io_context io_ctx;
@@ -10,7 +10,9 @@
 
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <numeric>
 #include <sstream>
 
 #include <argon2.h>
@@ -64,6 +66,12 @@ int main (int argc, char * const * argv)
 		("debug_profile_sign", "Profile signature generation")
 		("debug_profile_process", "Profile active blocks processing (only for btcnew_test_network)")
 		("debug_profile_votes", "Profile votes processing (only for btcnew_test_network)")
+		("debug_profile_message_parser", "Profile parsing of inbound messages, in packets per second for each message type (only for btcnew_test_network)")
+		("debug_profile_tally", "Profile the cost of adding a vote to an election with an increasing number of voting representatives (only for btcnew_test_network)")
+		("debug_profile_flood", "Profile choosing fanout peers and flooding a vote to them with 1000 and 10000 peers (only for btcnew_test_network)")
+		("debug_profile_simulated", "Profile propagating and confirming a block among 100 nodes connected by an in-process network with 50ms latency and 1% loss (only for btcnew_test_network)")
+		("debug_profile_block_store", "Profile block store operations on a synthetic ledger for every available database backend, output as JSON")
+		("debug_profile_confirmation_height", "Profile cementing of long account chains with an increasing number of prefetch threads (only for btcnew_test_network)")
 		("debug_random_feed", "Generates output to RNG test suites")
 		("debug_rpc", "Read an RPC command from stdin and invoke it. Network operations will have no effect.")
 		("debug_validate_blocks", "Check all blocks for correct hash, signature, work value")
@@ -75,7 +83,9 @@ int main (int argc, char * const * argv)
 		("device", boost::program_options::value<std::string> (), "Defines <device> for OpenCL command")
 		("threads", boost::program_options::value<std::string> (), "Defines <threads> count for OpenCL command")
 		("difficulty", boost::program_options::value<std::string> (), "Defines <difficulty> for OpenCL command, HEX")
-		("pow_sleep_interval", boost::program_options::value<std::string> (), "Defines the amount to sleep inbetween each pow calculation attempt");
+		("pow_sleep_interval", boost::program_options::value<std::string> (), "Defines the amount to sleep inbetween each pow calculation attempt")
+		("accounts", boost::program_options::value<std::size_t> (), "Defines <accounts> count for debug_profile_block_store (default 10000) and debug_profile_confirmation_height (default 1000)")
+		("blocks_per_account", boost::program_options::value<std::size_t> (), "Defines <blocks_per_account> for debug_profile_block_store (default 10) and debug_profile_confirmation_height (default 100)");
 	// clang-format on
 	btcnew::add_node_options (description);
 	btcnew::add_node_flag_options (description);
@@ -708,6 +718,504 @@ int main (int argc, char * const * argv)
 			node->stop ();
 			std::cerr << boost::str (boost::format ("%|1$ 12d| us \n%2% votes per second\n") % time % (max_votes * 1000000 / time));
 		}
+		else if (vm.count ("debug_profile_message_parser"))
+		{
+			btcnew::network_constants::set_active_network (btcnew::btcnew_networks::btcnew_test_network);
+			btcnew::work_pool work (std::numeric_limits<unsigned>::max ());
+			size_t iterations (200000);
+			// Only counts the messages, so the measurement is limited to parsing
+			class counting_visitor final : public btcnew::message_visitor
+			{
+			public:
+				void keepalive (btcnew::keepalive const &) override
+				{
+					++count;
+				}
+				void publish (btcnew::publish const &) override
+				{
+					++count;
+				}
+				void confirm_req (btcnew::confirm_req const &) override
+				{
+					++count;
+				}
+				void confirm_ack (btcnew::confirm_ack const &) override
+				{
+					++count;
+				}
+				void bulk_pull (btcnew::bulk_pull const &) override
+				{
+					++count;
+				}
+				void bulk_pull_account (btcnew::bulk_pull_account const &) override
+				{
+					++count;
+				}
+				void bulk_push (btcnew::bulk_push const &) override
+				{
+					++count;
+				}
+				void frontier_req (btcnew::frontier_req const &) override
+				{
+					++count;
+				}
+				void node_id_handshake (btcnew::node_id_handshake const &) override
+				{
+					++count;
+				}
+				uint64_t count{ 0 };
+			};
+			btcnew::keypair key;
+			auto block (std::make_shared<btcnew::state_block> (key.pub, 0, key.pub, 1, 0, key.prv, key.pub, *work.generate (key.pub)));
+			auto insufficient_work (std::make_shared<btcnew::state_block> (*block));
+			uint64_t work_l (0);
+			while (!btcnew::work_validate (insufficient_work->root (), work_l))
+			{
+				++work_l;
+			}
+			insufficient_work->block_work_set (work_l);
+			std::vector<btcnew::block_hash> hashes;
+			for (auto i (0); i < 12; ++i)
+			{
+				hashes.push_back (btcnew::block_hash (i));
+			}
+			auto vote (std::make_shared<btcnew::vote> (key.pub, key.prv, 1, hashes));
+			std::vector<std::pair<std::string, std::shared_ptr<std::vector<uint8_t>>>> messages{
+				{ "keepalive", btcnew::keepalive ().to_bytes () },
+				{ "publish", btcnew::publish (block).to_bytes () },
+				{ "publish_insufficient_work", btcnew::publish (insufficient_work).to_bytes () },
+				{ "confirm_req", btcnew::confirm_req (block).to_bytes () },
+				{ "confirm_req_hashes", btcnew::confirm_req (block->hash (), block->root ()).to_bytes () },
+				{ "confirm_ack", btcnew::confirm_ack (vote).to_bytes () }
+			};
+			for (auto & message : messages)
+			{
+				btcnew::block_uniquer block_uniquer;
+				btcnew::vote_uniquer vote_uniquer (block_uniquer);
+				btcnew::network_filter filter (1);
+				counting_visitor visitor;
+				btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, work);
+				auto begin (std::chrono::steady_clock::now ());
+				for (size_t i (0); i < iterations; ++i)
+				{
+					// The same publish is parsed repeatedly, keep the duplicate filter out of the measurement
+					filter.clear ();
+					parser.deserialize_buffer (message.second->data (), message.second->size ());
+				}
+				auto time (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - begin).count ());
+				std::cerr << boost::str (boost::format ("%|1$ 26s| %|2$ 10d| packets per second, %3% accepted\n") % message.first % (iterations * 1000000 / std::max<decltype (time)> (time, 1)) % visitor.count);
+			}
+		}
+		else if (vm.count ("debug_profile_tally"))
+		{
+			btcnew::network_constants::set_active_network (btcnew::btcnew_networks::btcnew_test_network);
+			btcnew::network_params test_params;
+			size_t votes_per_sample (1000);
+			btcnew::system system (24000, 1);
+			btcnew::work_pool work (std::numeric_limits<unsigned>::max ());
+			btcnew::logging logging;
+			auto path (btcnew::unique_path ());
+			logging.init (path);
+			btcnew::node_config config (24001, logging);
+			// Votes should never reach quorum
+			config.online_weight_minimum = std::numeric_limits<btcnew::uint128_t>::max ();
+			config.frontiers_confirmation = btcnew::frontiers_confirmation_mode::disabled;
+			auto node (std::make_shared<btcnew::node> (system.io_ctx, path, system.alarm, config, work));
+			btcnew::block_builder builder;
+			btcnew::keypair destination;
+			auto genesis_latest (node->latest (test_params.ledger.test_genesis_key.pub));
+			std::shared_ptr<btcnew::block> send = builder.state ()
+			                                      .account (test_params.ledger.test_genesis_key.pub)
+			                                      .previous (genesis_latest)
+			                                      .representative (test_params.ledger.test_genesis_key.pub)
+			                                      .balance (std::numeric_limits<btcnew::uint128_t>::max () - 1)
+			                                      .link (destination.pub)
+			                                      .sign (test_params.ledger.test_genesis_key.prv, test_params.ledger.test_genesis_key.pub)
+			                                      .work (*work.generate (genesis_latest))
+			                                      .build ();
+			node->process_active (send);
+			node->block_processor.flush ();
+			btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
+			auto existing (node->active.find_root (send->qualified_root ()));
+			release_assert (existing != nullptr);
+			auto election (existing->election);
+			// Votes are applied directly to the election so the measurement excludes signature checking and vote processor queueing
+			btcnew::uint256_t next_rep (1);
+			for (size_t representatives : { 10, 100, 1000, 10000, 100000 })
+			{
+				while (election->last_votes.size () < representatives)
+				{
+					election->vote (btcnew::account (next_rep++), 1, send->hash ());
+				}
+				auto begin (std::chrono::steady_clock::now ());
+				for (size_t i (0); i != votes_per_sample; ++i)
+				{
+					election->vote (btcnew::account (next_rep++), 1, send->hash ());
+				}
+				auto time (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - begin).count ());
+				std::cerr << boost::str (boost::format ("%|1$ 8d| representatives %|2$ 10d| ns per vote\n") % representatives % (time / votes_per_sample));
+			}
+			node->stop ();
+		}
+		else if (vm.count ("debug_profile_flood"))
+		{
+			btcnew::network_constants::set_active_network (btcnew::btcnew_networks::btcnew_test_network);
+			btcnew::network_params test_params;
+			size_t iterations (1000);
+			btcnew::system system (24000, 1);
+			auto node (system.nodes[0]);
+			btcnew::keypair key;
+			btcnew::confirm_ack message (std::make_shared<btcnew::vote> (key.pub, key.prv, 0, std::vector<btcnew::block_hash>{ btcnew::genesis ().hash () }));
+			uint16_t next_port (10000);
+			for (size_t peers : { 1000, 10000 })
+			{
+				// Peers are never contacted before the measurement, sends to them are only queued
+				while (node->network.size () < peers)
+				{
+					node->network.udp_channels.insert (btcnew::endpoint (boost::asio::ip::address_v6::loopback (), next_port++), test_params.protocol.protocol_version);
+				}
+				auto begin (std::chrono::steady_clock::now ());
+				size_t fanout (0);
+				for (size_t i (0); i != iterations; ++i)
+				{
+					fanout += node->network.list_fanout ().size ();
+				}
+				auto fanout_time (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - begin).count ());
+				std::array<btcnew::endpoint, 8> endpoints;
+				begin = std::chrono::steady_clock::now ();
+				for (size_t i (0); i != iterations; ++i)
+				{
+					node->network.random_fill (endpoints);
+				}
+				auto fill_time (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - begin).count ());
+				begin = std::chrono::steady_clock::now ();
+				for (size_t i (0); i != iterations; ++i)
+				{
+					node->network.flood_message (message);
+				}
+				auto flood_time (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - begin).count ());
+				// Drain the queued sends outside of the measurement
+				system.io_ctx.poll ();
+				std::cerr << boost::str (boost::format ("%|1$ 6d| peers, fanout %2%: %3% ns list_fanout, %4% ns random_fill, %5% ns flood_message\n") % peers % (fanout / iterations) % (fanout_time / iterations) % (fill_time / iterations) % (flood_time / iterations));
+			}
+			node->stop ();
+		}
+		else if (vm.count ("debug_profile_simulated"))
+		{
+			btcnew::network_constants::set_active_network (btcnew::btcnew_networks::btcnew_test_network);
+			btcnew::network_params test_params;
+			btcnew::transport::simulation_config simulation;
+			simulation.latency = std::chrono::milliseconds (50);
+			simulation.jitter = std::chrono::milliseconds (10);
+			simulation.loss = 0.01;
+			simulation.bandwidth = 10 * 1024 * 1024;
+			size_t const count (100);
+			std::cerr << boost::str (boost::format ("Starting %1% nodes\n") % count);
+			// Nodes only wait for their first peer while being added, a lost handshake would stall them
+			btcnew::system system (24000, count, btcnew::transport::simulation_config ());
+			system.simulated->set_config (simulation);
+			system.wallet (0)->insert_adhoc (test_params.ledger.test_genesis_key.prv);
+			btcnew::keypair key;
+			auto begin (std::chrono::steady_clock::now ());
+			auto block (system.wallet (0)->send_action (test_params.ledger.test_genesis_key.pub, key.pub, btcnew::Gbtcnew_ratio));
+			auto all = [&system] (std::function<bool (btcnew::node &)> const & predicate_a) {
+				return std::all_of (system.nodes.begin (), system.nodes.end (), [&predicate_a] (std::shared_ptr<btcnew::node> const & node_a) { return predicate_a (*node_a); });
+			};
+			while (!all ([&block] (btcnew::node & node_a) { return node_a.block (block->hash ()) != nullptr; }))
+			{
+				system.poll ();
+			}
+			auto propagated (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - begin).count ());
+			while (!all ([&block] (btcnew::node & node_a) { return node_a.ledger.block_confirmed (node_a.store.tx_begin_read (), block->hash ()); }))
+			{
+				system.poll ();
+			}
+			auto confirmed (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - begin).count ());
+			std::cerr << boost::str (boost::format ("Block reached every node in %1% ms, confirmed by every node in %2% ms. %3% datagrams sent, %4% lost\n") % propagated % confirmed % system.simulated->sent % system.simulated->lost);
+		}
+		else if (vm.count ("debug_profile_block_store"))
+		{
+			size_t num_accounts (vm.count ("accounts") ? vm["accounts"].as<std::size_t> () : 10000);
+			size_t num_blocks_per_account (vm.count ("blocks_per_account") ? vm["blocks_per_account"].as<std::size_t> () : 10);
+			size_t const write_batch_size (1000);
+			size_t max_blocks (num_accounts * num_blocks_per_account);
+			std::cerr << boost::str (boost::format ("Starting pregenerating %1% blocks\n") % max_blocks);
+			// Generating a synthetic ledger once, so every backend stores identical data
+			btcnew::keypair representative;
+			std::vector<btcnew::account> accounts;
+			std::vector<btcnew::account_info> account_infos;
+			std::vector<std::pair<std::shared_ptr<btcnew::state_block>, btcnew::block_sideband>> blocks;
+			accounts.reserve (num_accounts);
+			account_infos.reserve (num_accounts);
+			blocks.reserve (max_blocks);
+			for (size_t i (0); i != num_accounts; ++i)
+			{
+				btcnew::keypair key;
+				btcnew::block_hash previous (0);
+				btcnew::amount balance (num_blocks_per_account);
+				for (uint64_t height (1); height <= num_blocks_per_account; ++height)
+				{
+					balance = balance.number () - 1;
+					auto block (std::make_shared<btcnew::state_block> (key.pub, previous, representative.pub, balance, key.pub, key.prv, key.pub, 0));
+					blocks.emplace_back (block, btcnew::block_sideband (btcnew::block_type::state, key.pub, 0, balance, height, btcnew::seconds_since_epoch (), btcnew::epoch::epoch_0));
+					previous = block->hash ();
+				}
+				accounts.push_back (key.pub);
+				account_infos.emplace_back (previous, representative.pub, blocks[blocks.size () - num_blocks_per_account].first->hash (), balance, btcnew::seconds_since_epoch (), num_blocks_per_account, btcnew::epoch::epoch_0);
+			}
+			// Sequential access follows key order, which is how both backends lay out their tables
+			std::vector<btcnew::block_hash> hashes_sequential;
+			hashes_sequential.reserve (max_blocks);
+			for (auto const & block : blocks)
+			{
+				hashes_sequential.push_back (block.first->hash ());
+			}
+			std::sort (hashes_sequential.begin (), hashes_sequential.end ());
+			auto hashes_random (hashes_sequential);
+			btcnew::random_pool::shuffle (hashes_random.begin (), hashes_random.end ());
+			auto accounts_sequential (accounts);
+			std::sort (accounts_sequential.begin (), accounts_sequential.end ());
+			auto accounts_random (accounts);
+			btcnew::random_pool::shuffle (accounts_random.begin (), accounts_random.end ());
+
+			auto measure = [](boost::property_tree::ptree & results_a, std::string const & name_a, size_t count_a, std::function<void ()> const & action_a) {
+				auto begin (std::chrono::steady_clock::now ());
+				action_a ();
+				auto time (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - begin).count ());
+				boost::property_tree::ptree entry;
+				entry.put ("count", count_a);
+				entry.put ("total_us", time / 1000);
+				entry.put ("average_ns", count_a > 0 ? time / count_a : 0);
+				entry.put ("per_second", time > 0 ? count_a * 1000000000 / time : 0);
+				results_a.add_child (name_a, entry);
+				std::cerr << boost::str (boost::format ("%|1$-30s| %|2$ 12d| us\n") % name_a % (time / 1000));
+			};
+
+			auto profile_store = [&](std::string const & backend_a, bool use_rocksdb_a) {
+				std::cerr << boost::str (boost::format ("Profiling %1% backend\n") % backend_a);
+				boost::property_tree::ptree results;
+				btcnew::logger_mt logger;
+				auto store (btcnew::make_store (logger, btcnew::unique_path (), false, false, btcnew::rocksdb_config{}, btcnew::txn_tracking_config{}, std::chrono::milliseconds (5000), 128, 512, false, use_rocksdb_a));
+				release_assert (store != nullptr && !store->init_error ());
+				std::vector<uint64_t> commit_latencies;
+				// Writes are split in batches to keep transactions at a size comparable to the block processor
+				auto write_batched = [&store, &commit_latencies, write_batch_size](size_t count_a, std::function<void (btcnew::write_transaction const &, size_t)> const & action_a) {
+					auto transaction (store->tx_begin_write ());
+					for (size_t i (0); i != count_a; ++i)
+					{
+						action_a (transaction, i);
+						if ((i + 1) % write_batch_size == 0 || i + 1 == count_a)
+						{
+							auto begin (std::chrono::steady_clock::now ());
+							transaction.commit ();
+							commit_latencies.push_back (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - begin).count ());
+							transaction.renew ();
+						}
+					}
+				};
+				measure (results, "block_put", blocks.size (), [&]() {
+					write_batched (blocks.size (), [&](btcnew::write_transaction const & transaction_a, size_t i) {
+						store->block_put (transaction_a, blocks[i].first->hash (), *blocks[i].first, blocks[i].second);
+					});
+				});
+				measure (results, "account_put", accounts.size (), [&]() {
+					write_batched (accounts.size (), [&](btcnew::write_transaction const & transaction_a, size_t i) {
+						store->account_put (transaction_a, accounts[i], account_infos[i]);
+					});
+				});
+				measure (results, "confirmation_height_put", accounts.size (), [&]() {
+					write_batched (accounts.size (), [&](btcnew::write_transaction const & transaction_a, size_t i) {
+						store->confirmation_height_put (transaction_a, accounts[i], account_infos[i].block_count / 2);
+					});
+				});
+				measure (results, "pending_put", blocks.size (), [&]() {
+					write_batched (blocks.size (), [&](btcnew::write_transaction const & transaction_a, size_t i) {
+						store->pending_put (transaction_a, btcnew::pending_key (blocks[i].first->account (), blocks[i].first->hash ()), btcnew::pending_info (representative.pub, 1, btcnew::epoch::epoch_0));
+					});
+				});
+				auto transaction (store->tx_begin_read ());
+				measure (results, "block_get_sequential", hashes_sequential.size (), [&]() {
+					for (auto const & hash : hashes_sequential)
+					{
+						release_assert (store->block_get (transaction, hash) != nullptr);
+					}
+				});
+				measure (results, "block_get_random", hashes_random.size (), [&]() {
+					for (auto const & hash : hashes_random)
+					{
+						release_assert (store->block_get (transaction, hash) != nullptr);
+					}
+				});
+				measure (results, "account_get_sequential", accounts_sequential.size (), [&]() {
+					btcnew::account_info info;
+					for (auto const & account : accounts_sequential)
+					{
+						release_assert (!store->account_get (transaction, account, info));
+					}
+				});
+				measure (results, "account_get_random", accounts_random.size (), [&]() {
+					btcnew::account_info info;
+					for (auto const & account : accounts_random)
+					{
+						release_assert (!store->account_get (transaction, account, info));
+					}
+				});
+				measure (results, "confirmation_height_get_random", accounts_random.size (), [&]() {
+					uint64_t confirmation_height;
+					for (auto const & account : accounts_random)
+					{
+						release_assert (!store->confirmation_height_get (transaction, account, confirmation_height));
+					}
+				});
+				measure (results, "pending_begin_full_scan", blocks.size (), [&]() {
+					size_t count (0);
+					for (auto i (store->pending_begin (transaction)), n (store->pending_end ()); i != n; ++i)
+					{
+						++count;
+					}
+					release_assert (count == blocks.size ());
+				});
+				measure (results, "pending_begin_per_account_random", blocks.size (), [&]() {
+					size_t count (0);
+					for (auto const & account : accounts_random)
+					{
+						for (auto i (store->pending_begin (transaction, btcnew::pending_key (account, 0))), n (store->pending_end ()); i != n && i->first.account == account; ++i)
+						{
+							++count;
+						}
+					}
+					release_assert (count == blocks.size ());
+				});
+				std::sort (commit_latencies.begin (), commit_latencies.end ());
+				boost::property_tree::ptree commit;
+				if (!commit_latencies.empty ())
+				{
+					commit.put ("count", commit_latencies.size ());
+					commit.put ("batch_size", write_batch_size);
+					commit.put ("average_us", std::accumulate (commit_latencies.begin (), commit_latencies.end (), uint64_t (0)) / commit_latencies.size ());
+					commit.put ("p50_us", commit_latencies[commit_latencies.size () / 2]);
+					commit.put ("p99_us", commit_latencies[commit_latencies.size () * 99 / 100]);
+					commit.put ("max_us", commit_latencies.back ());
+				}
+				results.add_child ("write_commit", commit);
+				return results;
+			};
+
+			boost::property_tree::ptree tree;
+			tree.put ("accounts", num_accounts);
+			tree.put ("blocks_per_account", num_blocks_per_account);
+			tree.put ("blocks", max_blocks);
+			boost::property_tree::ptree backends;
+			backends.add_child ("lmdb", profile_store ("lmdb", false));
+#if BTCNEW_ROCKSDB
+			backends.add_child ("rocksdb", profile_store ("rocksdb", true));
+#endif
+			tree.add_child ("backends", backends);
+			btcnew::remove_temporary_directories ();
+			boost::property_tree::write_json (std::cout, tree);
+		}
+		else if (vm.count ("debug_profile_confirmation_height"))
+		{
+			btcnew::network_constants::set_active_network (btcnew::btcnew_networks::btcnew_test_network);
+			btcnew::network_params test_params;
+			btcnew::block_builder builder;
+			size_t num_accounts (vm.count ("accounts") ? vm["accounts"].as<std::size_t> () : 1000);
+			size_t num_blocks_per_account (std::max<size_t> (1, vm.count ("blocks_per_account") ? vm["blocks_per_account"].as<std::size_t> () : 100));
+			size_t max_blocks (num_accounts * (num_blocks_per_account + 1)); // A send from genesis to every account, which opens it
+			std::cerr << boost::str (boost::format ("Starting pregenerating %1% blocks\n") % max_blocks);
+			btcnew::system system (24000, 1);
+			btcnew::work_pool work (std::numeric_limits<unsigned>::max ());
+			btcnew::logging logging;
+			btcnew::block_hash genesis_latest (system.nodes[0]->latest (test_params.ledger.test_genesis_key.pub));
+			btcnew::uint128_t genesis_balance (std::numeric_limits<btcnew::uint128_t>::max ());
+			std::vector<std::shared_ptr<btcnew::block>> blocks;
+			std::vector<btcnew::block_hash> frontiers;
+			blocks.reserve (max_blocks);
+			for (size_t i (0); i != num_accounts; ++i)
+			{
+				btcnew::keypair key;
+				genesis_balance = genesis_balance - 1;
+
+				auto send = builder.state ()
+				            .account (test_params.ledger.test_genesis_key.pub)
+				            .previous (genesis_latest)
+				            .representative (test_params.ledger.test_genesis_key.pub)
+				            .balance (genesis_balance)
+				            .link (key.pub)
+				            .sign (test_params.ledger.test_genesis_key.prv, test_params.ledger.test_genesis_key.pub)
+				            .work (*work.generate (genesis_latest))
+				            .build ();
+
+				genesis_latest = send->hash ();
+				blocks.push_back (std::move (send));
+
+				auto open = builder.state ()
+				            .account (key.pub)
+				            .previous (0)
+				            .representative (key.pub)
+				            .balance (1)
+				            .link (genesis_latest)
+				            .sign (key.prv, key.pub)
+				            .work (*work.generate (key.pub))
+				            .build ();
+
+				btcnew::block_hash latest (open->hash ());
+				blocks.push_back (std::move (open));
+				// Lengthening the account chain with representative changes
+				for (size_t j (1); j != num_blocks_per_account; ++j)
+				{
+					auto change = builder.state ()
+					              .account (key.pub)
+					              .previous (latest)
+					              .representative (j % 2 ? test_params.ledger.test_genesis_key.pub : key.pub)
+					              .balance (1)
+					              .link (0)
+					              .sign (key.prv, key.pub)
+					              .work (*work.generate (latest))
+					              .build ();
+
+					latest = change->hash ();
+					blocks.push_back (std::move (change));
+				}
+				frontiers.push_back (latest);
+			}
+			std::vector<unsigned> thread_counts{ 0 };
+			for (auto threads (1u); threads <= std::max (4u, std::thread::hardware_concurrency ()); threads *= 2)
+			{
+				thread_counts.push_back (threads);
+			}
+			for (size_t i (0); i != thread_counts.size (); ++i)
+			{
+				btcnew::node_config node_config (24001 + i, logging);
+				node_config.frontiers_confirmation = btcnew::frontiers_confirmation_mode::disabled;
+				btcnew::node_flags node_flags;
+				node_flags.confirmation_height_prefetch_threads = thread_counts[i];
+				auto path (btcnew::unique_path ());
+				logging.init (path);
+				auto node (std::make_shared<btcnew::node> (system.io_ctx, path, system.alarm, node_config, work, node_flags));
+				{
+					auto transaction (node->store.tx_begin_write ());
+					for (auto const & block : blocks)
+					{
+						release_assert (node->ledger.process (transaction, *block).code == btcnew::process_result::progress);
+					}
+				}
+				// Cementing every frontier
+				auto begin (std::chrono::high_resolution_clock::now ());
+				for (auto const & frontier : frontiers)
+				{
+					node->confirmation_height_processor.add (frontier);
+				}
+				while (node->ledger.cemented_count < max_blocks + 1)
+				{
+					std::this_thread::sleep_for (std::chrono::milliseconds (10));
+				}
+				auto end (std::chrono::high_resolution_clock::now ());
+				auto time (std::chrono::duration_cast<std::chrono::microseconds> (end - begin).count ());
+				node->stop ();
+				std::cerr << boost::str (boost::format ("%1% prefetch threads: %|2$ 12d| us, %3% blocks cemented per second\n") % thread_counts[i] % time % (max_blocks * 1000000 / std::max<uint64_t> (time, 1)));
+			}
+		}
 		else if (vm.count ("debug_random_feed"))
 		{
 			/*
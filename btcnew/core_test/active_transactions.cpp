@@ -4,6 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <unordered_set>
+
 using namespace std::chrono_literals;
 
 TEST (active_transactions, adjusted_difficulty_priority)
@@ -32,33 +35,27 @@ TEST (active_transactions, adjusted_difficulty_priority)
 
 	// Check adjusted difficulty
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node1.active.mutex);
-		ASSERT_EQ (node1.active.roots.get<1> ().begin ()->election->status.winner->hash (), send1->hash ());
-		ASSERT_LT (node1.active.roots.find (send2->qualified_root ())->adjusted_difficulty, node1.active.roots.find (send1->qualified_root ())->adjusted_difficulty);
-		ASSERT_LT (node1.active.roots.find (open1->qualified_root ())->adjusted_difficulty, node1.active.roots.find (send1->qualified_root ())->adjusted_difficulty);
-		ASSERT_LT (node1.active.roots.find (open2->qualified_root ())->adjusted_difficulty, node1.active.roots.find (send2->qualified_root ())->adjusted_difficulty);
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
+		ASSERT_EQ (node1.active.sorted_roots ().front ().election->status.winner->hash (), send1->hash ());
+		ASSERT_LT (node1.active.find_root (send2->qualified_root ())->adjusted_difficulty, node1.active.find_root (send1->qualified_root ())->adjusted_difficulty);
+		ASSERT_LT (node1.active.find_root (open1->qualified_root ())->adjusted_difficulty, node1.active.find_root (send1->qualified_root ())->adjusted_difficulty);
+		ASSERT_LT (node1.active.find_root (open2->qualified_root ())->adjusted_difficulty, node1.active.find_root (send2->qualified_root ())->adjusted_difficulty);
 	}
 
 	// Confirm elections
 	while (node1.active.size () != 0)
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node1.active.mutex);
-		auto it (node1.active.roots.begin ());
-		while (!node1.active.roots.empty () && it != node1.active.roots.end ())
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
+		for (auto const & info : node1.active.sorted_roots ())
 		{
-			auto election (it->election);
-			election->confirm_once ();
-			it = node1.active.roots.begin ();
+			info.election->confirm_once ();
 		}
 	}
 	{
 		system.deadline_set (10s);
-		btcnew::unique_lock<std::mutex> active_lock (node1.active.mutex);
-		while (node1.active.confirmed.size () != 4)
+		while (node1.active.list_confirmed ().size () != 4)
 		{
-			active_lock.unlock ();
 			ASSERT_NO_ERROR (system.poll ());
-			active_lock.lock ();
 		}
 	}
 
@@ -85,20 +82,20 @@ TEST (active_transactions, adjusted_difficulty_priority)
 	}
 
 	// Check adjusted difficulty
-	btcnew::lock_guard<std::mutex> lock (node1.active.mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> lock (node1.active.mutex);
 	uint64_t last_adjusted (0);
-	for (auto i (node1.active.roots.get<1> ().begin ()), n (node1.active.roots.get<1> ().end ()); i != n; ++i)
+	for (auto const & info : node1.active.sorted_roots ())
 	{
 		//first root has nothing to compare
 		if (last_adjusted != 0)
 		{
-			ASSERT_LT (i->adjusted_difficulty, last_adjusted);
+			ASSERT_LT (info.adjusted_difficulty, last_adjusted);
 		}
-		last_adjusted = i->adjusted_difficulty;
+		last_adjusted = info.adjusted_difficulty;
 	}
-	ASSERT_LT (node1.active.roots.find (send4->qualified_root ())->adjusted_difficulty, node1.active.roots.find (send3->qualified_root ())->adjusted_difficulty);
-	ASSERT_LT (node1.active.roots.find (send6->qualified_root ())->adjusted_difficulty, node1.active.roots.find (send5->qualified_root ())->adjusted_difficulty);
-	ASSERT_LT (node1.active.roots.find (send8->qualified_root ())->adjusted_difficulty, node1.active.roots.find (send7->qualified_root ())->adjusted_difficulty);
+	ASSERT_LT (node1.active.find_root (send4->qualified_root ())->adjusted_difficulty, node1.active.find_root (send3->qualified_root ())->adjusted_difficulty);
+	ASSERT_LT (node1.active.find_root (send6->qualified_root ())->adjusted_difficulty, node1.active.find_root (send5->qualified_root ())->adjusted_difficulty);
+	ASSERT_LT (node1.active.find_root (send8->qualified_root ())->adjusted_difficulty, node1.active.find_root (send7->qualified_root ())->adjusted_difficulty);
 }
 
 TEST (active_transactions, adjusted_difficulty_overflow_max)
@@ -126,15 +123,16 @@ TEST (active_transactions, adjusted_difficulty_overflow_max)
 	}
 
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node1.active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
 		// Update difficulty to maximum
-		auto send1_root (node1.active.roots.find (send1->qualified_root ()));
-		auto send2_root (node1.active.roots.find (send2->qualified_root ()));
-		auto open1_root (node1.active.roots.find (open1->qualified_root ()));
-		auto open2_root (node1.active.roots.find (open2->qualified_root ()));
+		auto send1_root (node1.active.find_root (send1->qualified_root ()));
+		auto send2_root (node1.active.find_root (send2->qualified_root ()));
+		auto open1_root (node1.active.find_root (open1->qualified_root ()));
+		auto open2_root (node1.active.find_root (open2->qualified_root ()));
 		// clang-format off
-		auto modify_difficulty = [& roots = node1.active.roots](auto & existing_root) {
-			roots.modify (existing_root, [](btcnew::conflict_info & info_a) {
+		auto modify_difficulty = [&node1](auto existing_root) {
+			auto & roots (node1.active.shard (existing_root->root).roots);
+			roots.modify (roots.find (existing_root->root), [](btcnew::conflict_info & info_a) {
 				info_a.difficulty = std::numeric_limits<std::uint64_t>::max ();
 			});
 		};
@@ -145,7 +143,7 @@ TEST (active_transactions, adjusted_difficulty_overflow_max)
 		modify_difficulty (open2_root);
 		node1.active.adjust_difficulty (send2->hash ());
 		// Test overflow
-		ASSERT_EQ (node1.active.roots.get<1> ().begin ()->election->status.winner->hash (), send1->hash ());
+		ASSERT_EQ (node1.active.sorted_roots ().front ().election->status.winner->hash (), send1->hash ());
 		ASSERT_EQ (send1_root->adjusted_difficulty, std::numeric_limits<std::uint64_t>::max ());
 		ASSERT_LT (send2_root->adjusted_difficulty, send1_root->adjusted_difficulty);
 		ASSERT_LT (open1_root->adjusted_difficulty, send1_root->adjusted_difficulty);
@@ -180,16 +178,17 @@ TEST (active_transactions, adjusted_difficulty_overflow_min)
 	}
 
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node1.active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
 		// Update difficulty to minimum
-		auto send1_root (node1.active.roots.find (send1->qualified_root ()));
-		auto send2_root (node1.active.roots.find (send2->qualified_root ()));
-		auto open1_root (node1.active.roots.find (open1->qualified_root ()));
-		auto open2_root (node1.active.roots.find (open2->qualified_root ()));
-		auto send3_root (node1.active.roots.find (send3->qualified_root ()));
+		auto send1_root (node1.active.find_root (send1->qualified_root ()));
+		auto send2_root (node1.active.find_root (send2->qualified_root ()));
+		auto open1_root (node1.active.find_root (open1->qualified_root ()));
+		auto open2_root (node1.active.find_root (open2->qualified_root ()));
+		auto send3_root (node1.active.find_root (send3->qualified_root ()));
 		// clang-format off
-		auto modify_difficulty = [& roots = node1.active.roots](auto & existing_root) {
-			roots.modify (existing_root, [](btcnew::conflict_info & info_a) {
+		auto modify_difficulty = [&node1](auto existing_root) {
+			auto & roots (node1.active.shard (existing_root->root).roots);
+			roots.modify (roots.find (existing_root->root), [](btcnew::conflict_info & info_a) {
 				info_a.difficulty = std::numeric_limits<std::uint64_t>::min () + 1;
 			});
 		};
@@ -201,7 +200,7 @@ TEST (active_transactions, adjusted_difficulty_overflow_min)
 		modify_difficulty (send3_root);
 		node1.active.adjust_difficulty (send1->hash ());
 		// Test overflow
-		ASSERT_EQ (node1.active.roots.get<1> ().begin ()->election->status.winner->hash (), send1->hash ());
+		ASSERT_EQ (node1.active.sorted_roots ().front ().election->status.winner->hash (), send1->hash ());
 		ASSERT_EQ (send1_root->adjusted_difficulty, std::numeric_limits<std::uint64_t>::min () + 3);
 		ASSERT_LT (send2_root->adjusted_difficulty, send1_root->adjusted_difficulty);
 		ASSERT_LT (open1_root->adjusted_difficulty, send1_root->adjusted_difficulty);
@@ -209,7 +208,10 @@ TEST (active_transactions, adjusted_difficulty_overflow_min)
 		ASSERT_LT (send3_root->adjusted_difficulty, open2_root->adjusted_difficulty);
 		ASSERT_EQ (send3_root->adjusted_difficulty, std::numeric_limits<std::uint64_t>::min ());
 		// Clear roots with too low difficulty to prevent issues
-		node1.active.roots.clear ();
+		for (auto & shard : node1.active.shards)
+		{
+			shard.roots.clear ();
+		}
 	}
 }
 
@@ -242,12 +244,10 @@ TEST (active_transactions, keep_local)
 	ASSERT_EQ (0, node.active.dropped_elections_cache_size ());
 	while (!node.active.empty ())
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node.active.mutex);
-		auto it (node.active.roots.begin ());
-		while (!node.active.roots.empty () && it != node.active.roots.end ())
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node.active.mutex);
+		for (auto const & info : node.active.sorted_roots ())
 		{
-			(it->election)->confirm_once ();
-			it = node.active.roots.begin ();
+			info.election->confirm_once ();
 		}
 	}
 	auto open1 (std::make_shared<btcnew::state_block> (key1.pub, 0, key1.pub, node.config.receive_minimum.number (), send1->hash (), key1.prv, key1.pub, *system.work.generate (key1.pub)));
@@ -304,13 +304,10 @@ TEST (active_transactions, prioritize_chains)
 	}
 	while (node1.active.size () != 0)
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node1.active.mutex);
-		auto it (node1.active.roots.get<1> ().begin ());
-		while (!node1.active.roots.empty () && it != node1.active.roots.get<1> ().end ())
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
+		for (auto const & info : node1.active.sorted_roots ())
 		{
-			auto election (it->election);
-			election->confirm_once ();
-			it = node1.active.roots.get<1> ().begin ();
+			info.election->confirm_once ();
 		}
 	}
 
@@ -334,14 +331,13 @@ TEST (active_transactions, prioritize_chains)
 	}
 	size_t seen (0);
 	{
-		auto it (node1.active.roots.get<1> ().begin ());
-		while (!node1.active.roots.empty () && it != node1.active.roots.get<1> ().end ())
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
+		for (auto const & info : node1.active.sorted_roots ())
 		{
-			if (it->difficulty == (difficulty1 || difficulty2))
+			if (info.difficulty == (difficulty1 || difficulty2))
 			{
 				seen++;
 			}
-			it++;
 		}
 	}
 	ASSERT_LT (seen, 2);
@@ -394,10 +390,10 @@ TEST (active_transactions, inactive_votes_cache_existing_vote)
 	}
 	std::shared_ptr<btcnew::election> election;
 	{
-		btcnew::lock_guard<std::mutex> active_guard (node->active.mutex);
-		auto it (node->active.roots.begin ());
-		ASSERT_NE (node->active.roots.end (), it);
-		election = it->election;
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node->active.mutex);
+		auto roots (node->active.sorted_roots ());
+		ASSERT_FALSE (roots.empty ());
+		election = roots.front ().election;
 	}
 	ASSERT_GT (node->weight (key.pub), node->minimum_principal_weight ());
 	// Insert vote
@@ -407,13 +403,13 @@ TEST (active_transactions, inactive_votes_cache_existing_vote)
 	bool done (false);
 	while (!done)
 	{
-		btcnew::unique_lock<std::mutex> active_lock (node->active.mutex);
+		std::unique_lock<btcnew::elections_mutex> active_lock (node->active.mutex);
 		done = (election->last_votes.size () == 2);
 		active_lock.unlock ();
 		ASSERT_NO_ERROR (system.poll ());
 	}
 	ASSERT_EQ (1, system.nodes[0]->stats.count (btcnew::stat::type::election, btcnew::stat::detail::vote_new));
-	btcnew::lock_guard<std::mutex> active_guard (node->active.mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> active_guard (node->active.mutex);
 	auto last_vote1 (election->last_votes[key.pub]);
 	ASSERT_EQ (send->hash (), last_vote1.hash);
 	ASSERT_EQ (1, last_vote1.sequence);
@@ -454,7 +450,7 @@ TEST (active_transactions, inactive_votes_cache_multiple_votes)
 	while (true)
 	{
 		{
-			btcnew::lock_guard<std::mutex> active_guard (system.nodes[0]->active.mutex);
+			btcnew::lock_guard<btcnew::elections_mutex> active_guard (system.nodes[0]->active.mutex);
 			if (system.nodes[0]->active.find_inactive_votes_cache (send1->hash ()).voters.size () == 2)
 			{
 				break;
@@ -466,10 +462,10 @@ TEST (active_transactions, inactive_votes_cache_multiple_votes)
 	// Start election
 	system.nodes[0]->active.start (send1);
 	{
-		btcnew::lock_guard<std::mutex> active_guard (system.nodes[0]->active.mutex);
-		auto it (system.nodes[0]->active.roots.begin ());
-		ASSERT_NE (system.nodes[0]->active.roots.end (), it);
-		ASSERT_EQ (3, it->election->last_votes.size ()); // 2 votes and 1 default not_an_acount
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (system.nodes[0]->active.mutex);
+		auto roots (system.nodes[0]->active.sorted_roots ());
+		ASSERT_FALSE (roots.empty ());
+		ASSERT_EQ (3, roots.front ().election->last_votes.size ()); // 2 votes and 1 default not_an_acount
 	}
 	ASSERT_EQ (2, system.nodes[0]->stats.count (btcnew::stat::type::election, btcnew::stat::detail::vote_cached));
 }
@@ -510,9 +506,9 @@ TEST (active_transactions, update_difficulty)
 	auto modify_election = [&node1] (auto block) {
 		auto root_l (block->root ());
 		auto hash (block->hash ());
-		btcnew::lock_guard<std::mutex> active_guard (node1.active.mutex);
-		auto existing (node1.active.roots.find (block->qualified_root ()));
-		ASSERT_NE (existing, node1.active.roots.end ());
+		btcnew::lock_guard<btcnew::elections_mutex> active_guard (node1.active.mutex);
+		auto existing (node1.active.find_root (block->qualified_root ()));
+		ASSERT_NE (existing, nullptr);
 		auto election (existing->election);
 		ASSERT_EQ (election->status.winner->hash (), hash);
 		election->status.winner = block;
@@ -532,17 +528,17 @@ TEST (active_transactions, update_difficulty)
 	{
 		{
 			// node1
-			btcnew::lock_guard<std::mutex> guard1 (node1.active.mutex);
-			auto const existing1 (node1.active.roots.find (send1->qualified_root ()));
-			ASSERT_NE (existing1, node1.active.roots.end ());
-			auto const existing2 (node1.active.roots.find (send2->qualified_root ()));
-			ASSERT_NE (existing2, node1.active.roots.end ());
+			btcnew::lock_guard<btcnew::elections_mutex> guard1 (node1.active.mutex);
+			auto const existing1 (node1.active.find_root (send1->qualified_root ()));
+			ASSERT_NE (existing1, nullptr);
+			auto const existing2 (node1.active.find_root (send2->qualified_root ()));
+			ASSERT_NE (existing2, nullptr);
 			// node2
-			btcnew::lock_guard<std::mutex> guard2 (node2.active.mutex);
-			auto const existing3 (node2.active.roots.find (send1->qualified_root ()));
-			ASSERT_NE (existing3, node2.active.roots.end ());
-			auto const existing4 (node2.active.roots.find (send2->qualified_root ()));
-			ASSERT_NE (existing4, node2.active.roots.end ());
+			btcnew::lock_guard<btcnew::elections_mutex> guard2 (node2.active.mutex);
+			auto const existing3 (node2.active.find_root (send1->qualified_root ()));
+			ASSERT_NE (existing3, nullptr);
+			auto const existing4 (node2.active.find_root (send2->qualified_root ()));
+			ASSERT_NE (existing4, nullptr);
 			done = (existing1->difficulty > difficulty1) && (existing2->difficulty > difficulty2) && (existing3->difficulty > difficulty1) && (existing4->difficulty > difficulty2);
 		}
 		ASSERT_NO_ERROR (system.poll ());
@@ -561,7 +557,7 @@ TEST (active_transactions, restart_dropped)
 	// Process only in ledger and emulate dropping the election
 	ASSERT_EQ (btcnew::process_result::progress, node.process (*send1).code);
 	{
-		btcnew::lock_guard<std::mutex> guard (node.active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node.active.mutex);
 		node.active.add_dropped_elections_cache (send1->qualified_root ());
 	}
 	uint64_t difficulty1 (0);
@@ -581,9 +577,9 @@ TEST (active_transactions, restart_dropped)
 	while (!done)
 	{
 		{
-			btcnew::lock_guard<std::mutex> guard (node.active.mutex);
-			auto existing (node.active.roots.find (send2->qualified_root ()));
-			done = existing != node.active.roots.end ();
+			btcnew::lock_guard<btcnew::elections_mutex> guard (node.active.mutex);
+			auto existing (node.active.find_root (send2->qualified_root ()));
+			done = existing != nullptr;
 			if (done)
 			{
 				ASSERT_EQ (difficulty2, existing->difficulty);
@@ -612,3 +608,140 @@ TEST (active_transactions, restart_dropped)
 		ASSERT_EQ (work2, block->block_work ());
 	}
 }
+
+TEST (active_transactions, schedule)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.enable_voting = false;
+	node_config.frontiers_confirmation = btcnew::frontiers_confirmation_mode::disabled;
+	auto & node = *system.add_node (node_config);
+	btcnew::genesis genesis;
+	auto send (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, genesis.hash (), btcnew::test_genesis_key.pub, btcnew::genesis_amount - btcnew::btcnew_ratio, btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	ASSERT_EQ (btcnew::process_result::progress, node.process (*send).code);
+	ASSERT_FALSE (node.active.start (send));
+	ASSERT_EQ (1, node.active.scheduled_size ());
+	// The election keeps being rescheduled while it is active
+	system.deadline_set (5s);
+	while (true)
+	{
+		{
+			btcnew::lock_guard<btcnew::elections_mutex> guard (node.active.mutex);
+			auto existing (node.active.find_root (send->qualified_root ()));
+			ASSERT_NE (nullptr, existing);
+			if (existing->election->confirmation_request_count > 2)
+			{
+				break;
+			}
+		}
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (1, node.active.scheduled_size ());
+	// Erasing an election removes its entry straight away
+	node.active.erase (*send);
+	ASSERT_EQ (0, node.active.scheduled_size ());
+	ASSERT_TRUE (node.active.empty ());
+}
+
+// Elections are spread over shards by root and waiting on a shard lock is counted
+TEST (active_transactions, shard_contention)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.enable_voting = false;
+	node_config.frontiers_confirmation = btcnew::frontiers_confirmation_mode::disabled;
+	auto & node = *system.add_node (node_config);
+	std::vector<std::shared_ptr<btcnew::block>> blocks;
+	btcnew::block_hash previous (btcnew::genesis ().hash ());
+	for (auto i (0); i < 16; ++i)
+	{
+		btcnew::keypair key;
+		auto send (std::make_shared<btcnew::send_block> (previous, key.pub, btcnew::genesis_amount - (i + 1) * btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (previous)));
+		previous = send->hash ();
+		ASSERT_FALSE (node.active.start (send));
+		blocks.push_back (send);
+	}
+	ASSERT_EQ (16, node.active.size ());
+	std::unordered_set<btcnew::active_shard const *> shards;
+	for (auto & block : blocks)
+	{
+		shards.insert (&node.active.shard (block->qualified_root ()));
+	}
+	ASSERT_GT (shards.size (), 1);
+	auto root (blocks.front ()->qualified_root ());
+	auto & shard (node.active.shard (root));
+	auto contended (shard.counters.contended.load ());
+	{
+		auto lock (shard.lock ());
+		std::thread thread ([&node, &root] () {
+			ASSERT_TRUE (node.active.active (root));
+		});
+		std::this_thread::sleep_for (100ms);
+		lock.unlock ();
+		thread.join ();
+	}
+	ASSERT_GT (shard.counters.contended, contended);
+	system.deadline_set (5s);
+	while (node.stats.count (btcnew::stat::type::election, btcnew::stat::detail::shard_lock_contended) == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+}
+
+TEST (active_transactions, inactive_votes_cache_bounds)
+{
+	btcnew::stat stats;
+	btcnew::inactive_votes_cache cache (stats, 64);
+	btcnew::keypair key1;
+	std::vector<btcnew::account> voters;
+	std::vector<btcnew::block_hash> hashes;
+	auto random_hash = [] () {
+		btcnew::block_hash hash;
+		btcnew::random_pool::generate_block (hash.bytes.data (), hash.bytes.size ());
+		return hash;
+	};
+	// Entries are only allocated once votes arrive
+	ASSERT_EQ (0, cache.size ());
+	for (auto i (0); i < 64; ++i)
+	{
+		hashes.push_back (random_hash ());
+		ASSERT_FALSE (cache.vote (hashes.back (), key1.pub, voters));
+	}
+	ASSERT_EQ (64, cache.size ());
+	ASSERT_EQ (0, stats.count (btcnew::stat::type::election, btcnew::stat::detail::vote_cache_evicted));
+	for (auto & hash : hashes)
+	{
+		ASSERT_EQ (1, cache.find (hash).voters.size ());
+	}
+	// Further entries replace the oldest ones without growing
+	for (auto i (0); i < 32; ++i)
+	{
+		hashes.push_back (random_hash ());
+		ASSERT_FALSE (cache.vote (hashes.back (), key1.pub, voters));
+	}
+	ASSERT_EQ (64, cache.size ());
+	ASSERT_EQ (32, stats.count (btcnew::stat::type::election, btcnew::stat::detail::vote_cache_evicted));
+	for (auto i (0); i < hashes.size (); ++i)
+	{
+		ASSERT_EQ (i < 32 ? 0 : 1, cache.find (hashes[i]).voters.size ());
+	}
+	// The voter list of an entry is bounded
+	auto hash (hashes.back ());
+	for (auto i (1); i < btcnew::inactive_votes_cache::max_voters; ++i)
+	{
+		ASSERT_TRUE (cache.vote (hash, btcnew::keypair ().pub, voters));
+		ASSERT_EQ (i + 1, voters.size ());
+	}
+	// Repeated votes are ignored
+	ASSERT_FALSE (cache.vote (hash, key1.pub, voters));
+	ASSERT_FALSE (cache.vote (hash, btcnew::keypair ().pub, voters));
+	ASSERT_EQ (1, stats.count (btcnew::stat::type::election, btcnew::stat::detail::vote_cache_voter_dropped));
+	ASSERT_EQ (btcnew::inactive_votes_cache::max_voters, cache.find (hash).voters.size ());
+	// Confirmed entries don't take further voters
+	auto hash2 (hashes[hashes.size () - 2]);
+	cache.confirm (hash2);
+	ASSERT_FALSE (cache.vote (hash2, btcnew::keypair ().pub, voters));
+	auto info (cache.find (hash2));
+	ASSERT_TRUE (info.confirmed);
+	ASSERT_EQ (1, info.voters.size ());
+}
@@ -1086,6 +1086,77 @@ TEST (block_store, sequence_flush_by_hash)
 	ASSERT_EQ (*seq3, *vote1);
 }
 
+TEST (block_store, sequence_reservation)
+{
+	auto path (btcnew::unique_path ());
+	btcnew::logger_mt logger;
+	btcnew::keypair key1;
+	auto send1 (std::make_shared<btcnew::send_block> (0, 0, 0, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
+	{
+		auto store = btcnew::make_store (logger, path);
+		ASSERT_FALSE (store->init_error ());
+		store->vote_reservation_set (8);
+		auto transaction (store->tx_begin_read ());
+		// The first reservation is written before a sequence from it is returned
+		auto vote1 (store->vote_generate (transaction, key1.pub, key1.prv, send1));
+		ASSERT_EQ (1, vote1->sequence);
+		ASSERT_FALSE (store->vote_flush_required ());
+		// The top of the reservation is written as a valid vote
+		transaction.refresh ();
+		auto stored1 (store->vote_get (transaction, key1.pub));
+		ASSERT_NE (nullptr, stored1);
+		ASSERT_EQ (9, stored1->sequence);
+		ASSERT_FALSE (stored1->validate ());
+		// Sequences from the reservation are used without writing until half of it is left
+		for (auto i (2); i < 5; ++i)
+		{
+			ASSERT_EQ (i, store->vote_generate (transaction, key1.pub, key1.prv, send1)->sequence);
+			ASSERT_FALSE (store->vote_flush_required ());
+		}
+		ASSERT_EQ (5, store->vote_generate (transaction, key1.pub, key1.prv, send1)->sequence);
+		ASSERT_TRUE (store->vote_flush_required ());
+		store->vote_flush ();
+		ASSERT_FALSE (store->vote_flush_required ());
+		transaction.refresh ();
+		ASSERT_EQ (13, store->vote_get (transaction, key1.pub)->sequence);
+		// Flushing a later vote never lowers the written sequence
+		ASSERT_EQ (6, store->vote_generate (transaction, key1.pub, key1.prv, send1)->sequence);
+		store->vote_flush ();
+		store->vote_flush ();
+		transaction.refresh ();
+		ASSERT_EQ (13, store->vote_get (transaction, key1.pub)->sequence);
+	}
+	// After a restart sequences continue above the reservation
+	auto store = btcnew::make_store (logger, path);
+	ASSERT_FALSE (store->init_error ());
+	auto transaction (store->tx_begin_read ());
+	ASSERT_EQ (14, store->vote_generate (transaction, key1.pub, key1.prv, send1)->sequence);
+}
+
+TEST (block_store, sequence_reservation_crash)
+{
+	auto path (btcnew::unique_path ());
+	btcnew::logger_mt logger;
+	btcnew::keypair key1;
+	auto send1 (std::make_shared<btcnew::send_block> (0, 0, 0, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
+	uint64_t last (0);
+	{
+		auto store = btcnew::make_store (logger, path);
+		ASSERT_FALSE (store->init_error ());
+		store->vote_reservation_set (8);
+		auto transaction (store->tx_begin_read ());
+		for (auto i (0); i < 20; ++i)
+		{
+			last = store->vote_generate (transaction, key1.pub, key1.prv, send1)->sequence;
+		}
+		// The store is closed without flushing, as in a crash
+	}
+	auto store = btcnew::make_store (logger, path);
+	ASSERT_FALSE (store->init_error ());
+	auto transaction (store->tx_begin_read ());
+	ASSERT_GT (store->vote_generate (transaction, key1.pub, key1.prv, send1)->sequence, last);
+}
+
 // Upgrading tracking block sequence numbers to whole vote.
 TEST (mdb_block_store, upgrade_v8_v9)
 {
@@ -1903,6 +1974,42 @@ TEST (block_store, reset_renew_existing_transaction)
 	ASSERT_NE (nullptr, block_existing);
 }
 
+TEST (block_store, pooled_read_transaction)
+{
+	btcnew::logger_mt logger;
+	auto store = btcnew::make_store (logger, btcnew::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+
+	btcnew::open_block block (0, 1, 1, btcnew::keypair ().prv, 0, 0);
+	auto hash1 (block.hash ());
+	{
+		auto transaction (store->tx_begin_read ());
+		ASSERT_EQ (nullptr, store->block_get (transaction, hash1));
+	}
+	{
+		auto write_transaction (store->tx_begin_write ());
+		btcnew::block_sideband sideband (btcnew::block_type::open, 0, 0, 0, 0, 0, btcnew::epoch::epoch_0);
+		store->block_put (write_transaction, hash1, block, sideband);
+	}
+	// A renewed pooled transaction must see the latest writes
+	{
+		auto transaction (store->tx_begin_read ());
+		ASSERT_NE (nullptr, store->block_get (transaction, hash1));
+	}
+	// Resetting before the transaction is returned to the pool must not release it twice
+	{
+		auto transaction (store->tx_begin_read ());
+		transaction.reset ();
+	}
+	{
+		auto transaction (store->tx_begin_read ());
+		ASSERT_NE (nullptr, store->block_get (transaction, hash1));
+	}
+	boost::property_tree::ptree totals;
+	store->serialize_txn_totals (totals);
+	ASSERT_GE (totals.get<uint64_t> ("read_pool_renewed"), 3);
+}
+
 TEST (block_store, rocksdb_force_test_env_variable)
 {
 	btcnew::logger_mt logger;
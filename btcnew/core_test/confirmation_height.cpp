@@ -620,9 +620,9 @@ TEST (confirmation_height, conflict_rollback_cemented)
 	node1.block_processor.flush ();
 	node2.network.process_message (publish1, channel2);
 	node2.block_processor.flush ();
-	btcnew::unique_lock<std::mutex> lock (node2.active.mutex);
-	auto conflict (node2.active.roots.find (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
-	ASSERT_NE (node2.active.roots.end (), conflict);
+	std::unique_lock<btcnew::elections_mutex> lock (node2.active.mutex);
+	auto conflict (node2.active.find_root (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
+	ASSERT_NE (nullptr, conflict);
 	auto votes1 (conflict->election);
 	ASSERT_NE (nullptr, votes1);
 	ASSERT_EQ (1, votes1->last_votes.size ());
@@ -704,11 +704,10 @@ TEST (confirmation_height, modified_chain)
 		ASSERT_EQ (btcnew::process_result::progress, node->ledger.process (transaction, *send).code);
 	}
 
-	node->confirmation_height_processor.add (send->hash ());
-
 	{
-		// The write guard prevents the confirmation height processor doing any writes
+		// The write guard prevents the confirmation height processor doing any writes, so it must be held before adding the block
 		auto write_guard = node->write_database_queue.wait (btcnew::writer::testing);
+		node->confirmation_height_processor.add (send->hash ());
 		while (!node->write_database_queue.contains (btcnew::writer::confirmation_height))
 			;
 
@@ -745,25 +744,16 @@ TEST (confirmation_height, pending_observer_callbacks)
 
 	add_callback_stats (*node);
 
+	// Queue both while paused so the dependency is still pending when its successor gets cemented
+	node->confirmation_height_processor.pause ();
 	node->confirmation_height_processor.add (send1->hash ());
-
-	while (true)
-	{
-		if (node->pending_confirmation_height.size () == 0)
-		{
-			break;
-		}
-	}
-	// Can have timing issues.
 	node->confirmation_height_processor.add (send.hash ());
+	node->confirmation_height_processor.unpause ();
+
+	system.deadline_set (10s);
+	while (node->ledger.cemented_count != 3 || node->pending_confirmation_height.size () != 0 || !node->pending_confirmation_height.current ().is_zero ())
 	{
-		btcnew::unique_lock<std::mutex> lk (node->pending_confirmation_height.mutex);
-		while (!node->pending_confirmation_height.current_hash.is_zero ())
-		{
-			lk.unlock ();
-			std::this_thread::yield ();
-			lk.lock ();
-		}
+		ASSERT_NO_ERROR (system.poll ());
 	}
 
 	// Confirm the callback is not called under this circumstance
@@ -905,9 +895,10 @@ TEST (confirmation_height, prioritize_frontiers)
 	}
 
 	std::array<btcnew::qualified_root, num_accounts> frontiers{ send17.qualified_root (), send6.qualified_root (), send7.qualified_root (), open2.qualified_root (), send11.qualified_root () };
+	btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
 	for (auto & frontier : frontiers)
 	{
-		ASSERT_NE (node->active.roots.find (frontier), node->active.roots.end ());
+		ASSERT_NE (node->active.find_root (frontier), nullptr);
 	}
 }
 }
@@ -1006,8 +997,8 @@ TEST (confirmation_height, callback_confirmed_history)
 
 		ASSERT_EQ (0, node->active.list_confirmed ().size ());
 		{
-			btcnew::lock_guard<std::mutex> guard (node->active.mutex);
-			ASSERT_EQ (0, node->active.blocks.size ());
+			btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
+			ASSERT_EQ (0, node->active.blocks_size ());
 		}
 
 		auto transaction = node->store.tx_begin_read ();
@@ -1033,7 +1024,6 @@ TEST (confirmation_height, callback_confirmed_history)
 	ASSERT_TRUE (node->ledger.block_confirmed (transaction, send->hash ()));
 
 	ASSERT_EQ (1, node->active.list_confirmed ().size ());
-	ASSERT_EQ (0, node->active.blocks.size ());
 
 	// Confirm the callback is not called under this circumstance
 	ASSERT_EQ (2, node->stats.count (btcnew::stat::type::confirmation_height, btcnew::stat::detail::blocks_confirmed, btcnew::stat::dir::in));
@@ -1041,7 +1031,8 @@ TEST (confirmation_height, callback_confirmed_history)
 	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::observer, btcnew::stat::detail::observer_confirmation_active_quorum, btcnew::stat::dir::out));
 	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::observer, btcnew::stat::detail::observer_confirmation_inactive, btcnew::stat::dir::out));
 
-	btcnew::lock_guard<std::mutex> guard (node->active.mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
+	ASSERT_EQ (0, node->active.blocks_size ());
 	ASSERT_EQ (0, node->active.pending_conf_height.size ());
 }
 
@@ -1107,7 +1098,7 @@ TEST (confirmation_height, dependent_election)
 	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::observer, btcnew::stat::detail::observer_confirmation_inactive, btcnew::stat::dir::out));
 	ASSERT_EQ (3, node->stats.count (btcnew::stat::type::confirmation_height, btcnew::stat::detail::blocks_confirmed, btcnew::stat::dir::in));
 
-	btcnew::lock_guard<std::mutex> guard (node->active.mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
 	ASSERT_EQ (0, node->active.pending_conf_height.size ());
 }
 
@@ -1145,8 +1136,8 @@ TEST (confirmation_height, dependent_election_after_already_cemented)
 
 		ASSERT_EQ (0, node->active.list_confirmed ().size ());
 		{
-			btcnew::lock_guard<std::mutex> guard (node->active.mutex);
-			ASSERT_EQ (0, node->active.blocks.size ());
+			btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
+			ASSERT_EQ (0, node->active.blocks_size ());
 		}
 
 		auto transaction = node->store.tx_begin_read ();
@@ -1173,7 +1164,7 @@ TEST (confirmation_height, dependent_election_after_already_cemented)
 	}
 
 	system.deadline_set (10s);
-	btcnew::unique_lock<std::mutex> lk (node->active.mutex);
+	std::unique_lock<btcnew::elections_mutex> lk (node->active.mutex);
 	while (node->active.pending_conf_height.size () > 0)
 	{
 		lk.unlock ();
@@ -1181,4 +1172,47 @@ TEST (confirmation_height, dependent_election_after_already_cemented)
 		lk.lock ();
 	}
 }
+
+TEST (confirmation_height, prefetch)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.frontiers_confirmation = btcnew::frontiers_confirmation_mode::disabled;
+	btcnew::node_flags node_flags;
+	node_flags.confirmation_height_prefetch_threads = 0;
+	auto node = system.add_node (node_config, node_flags);
+	btcnew::keypair key1;
+	btcnew::block_hash latest (node->latest (btcnew::test_genesis_key.pub));
+	btcnew::send_block send (latest, key1.pub, btcnew::genesis_amount - btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (latest));
+	btcnew::open_block open (send.hash (), btcnew::test_genesis_key.pub, key1.pub, key1.prv, key1.pub, *system.work.generate (key1.pub));
+	btcnew::change_block change (open.hash (), key1.pub, key1.prv, key1.pub, *system.work.generate (open.hash ()));
+	{
+		auto transaction (node->store.tx_begin_write ());
+		ASSERT_EQ (btcnew::process_result::progress, node->ledger.process (transaction, send).code);
+		ASSERT_EQ (btcnew::process_result::progress, node->ledger.process (transaction, open).code);
+		ASSERT_EQ (btcnew::process_result::progress, node->ledger.process (transaction, change).code);
+	}
+
+	// The account chain and the source of the open block are read, but not the already cemented genesis block
+	auto & processor (node->confirmation_height_processor);
+	processor.prefetch (change.hash ());
+	ASSERT_EQ (3, processor.prefetched_size);
+	ASSERT_EQ (1, processor.prefetched.count (change.hash ()));
+	ASSERT_EQ (1, processor.prefetched.count (open.hash ()));
+	ASSERT_EQ (1, processor.prefetched.count (send.hash ()));
+	ASSERT_EQ (0, processor.prefetched.count (latest));
+
+	// Prefetched blocks are handed out once
+	auto transaction (node->store.tx_begin_read ());
+	btcnew::block_sideband sideband;
+	auto block (processor.block_get (transaction, open.hash (), sideband));
+	ASSERT_NE (nullptr, block);
+	ASSERT_EQ (open.hash (), block->hash ());
+	ASSERT_EQ (1, sideband.height);
+	ASSERT_EQ (2, processor.prefetched_size);
+	ASSERT_EQ (0, processor.prefetched.count (open.hash ()));
+	block = processor.block_get (transaction, open.hash (), sideband);
+	ASSERT_NE (nullptr, block);
+	ASSERT_EQ (2, processor.prefetched_size);
+}
 }
@@ -18,9 +18,9 @@ TEST (conflicts, start_stop)
 	node1.active.start (send1);
 	ASSERT_EQ (1, node1.active.size ());
 	{
-		btcnew::lock_guard<std::mutex> guard (node1.active.mutex);
-		auto existing1 (node1.active.roots.find (send1->qualified_root ()));
-		ASSERT_NE (node1.active.roots.end (), existing1);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+		auto existing1 (node1.active.find_root (send1->qualified_root ()));
+		ASSERT_NE (nullptr, existing1);
 		auto votes1 (existing1->election);
 		ASSERT_NE (nullptr, votes1);
 		ASSERT_EQ (1, votes1->last_votes.size ());
@@ -45,8 +45,8 @@ TEST (conflicts, add_existing)
 	node1.active.vote (vote1);
 	ASSERT_EQ (1, node1.active.size ());
 	{
-		btcnew::lock_guard<std::mutex> guard (node1.active.mutex);
-		auto votes1 (node1.active.roots.find (send2->qualified_root ())->election);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+		auto votes1 (node1.active.find_root (send2->qualified_root ())->election);
 		ASSERT_NE (nullptr, votes1);
 		ASSERT_EQ (2, votes1->last_votes.size ());
 		ASSERT_NE (votes1->last_votes.end (), votes1->last_votes.find (key2.pub));
@@ -172,9 +172,9 @@ TEST (conflicts, reprioritize)
 	node1.process_active (send1);
 	node1.block_processor.flush ();
 	{
-		btcnew::lock_guard<std::mutex> guard (node1.active.mutex);
-		auto existing1 (node1.active.roots.find (send1->qualified_root ()));
-		ASSERT_NE (node1.active.roots.end (), existing1);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+		auto existing1 (node1.active.find_root (send1->qualified_root ()));
+		ASSERT_NE (nullptr, existing1);
 		ASSERT_EQ (difficulty1, existing1->difficulty);
 	}
 	node1.work_generate_blocking (send1_copy, difficulty1);
@@ -183,9 +183,9 @@ TEST (conflicts, reprioritize)
 	node1.process_active (std::make_shared<btcnew::send_block> (send1_copy));
 	node1.block_processor.flush ();
 	{
-		btcnew::lock_guard<std::mutex> guard (node1.active.mutex);
-		auto existing2 (node1.active.roots.find (send1->qualified_root ()));
-		ASSERT_NE (node1.active.roots.end (), existing2);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+		auto existing2 (node1.active.find_root (send1->qualified_root ()));
+		ASSERT_NE (nullptr, existing2);
 		ASSERT_EQ (difficulty2, existing2->difficulty);
 	}
 }
@@ -210,9 +210,9 @@ TEST (conflicts, dependency)
 	ASSERT_EQ (2, node1->active.size ());
 	// Check dependency for send block
 	{
-		btcnew::lock_guard<std::mutex> guard (node1->active.mutex);
-		auto existing1 (node1->active.roots.find (send1->qualified_root ()));
-		ASSERT_NE (node1->active.roots.end (), existing1);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1->active.mutex);
+		auto existing1 (node1->active.find_root (send1->qualified_root ()));
+		ASSERT_NE (nullptr, existing1);
 		auto election1 (existing1->election);
 		ASSERT_NE (nullptr, election1);
 		ASSERT_EQ (1, election1->dependent_blocks.size ());
@@ -258,11 +258,11 @@ TEST (conflicts, adjusted_difficulty)
 	}
 	std::unordered_map<btcnew::block_hash, uint64_t> adjusted_difficulties;
 	{
-		btcnew::lock_guard<std::mutex> guard (node1.active.mutex);
-		ASSERT_EQ (node1.active.roots.get<1> ().begin ()->election->status.winner->hash (), send1->hash ());
-		for (auto i (node1.active.roots.get<1> ().begin ()), n (node1.active.roots.get<1> ().end ()); i != n; ++i)
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+		ASSERT_EQ (node1.active.sorted_roots ().front ().election->status.winner->hash (), send1->hash ());
+		for (auto const & info : node1.active.sorted_roots ())
 		{
-			adjusted_difficulties.insert (std::make_pair (i->election->status.winner->hash (), i->adjusted_difficulty));
+			adjusted_difficulties.insert (std::make_pair (info.election->status.winner->hash (), info.adjusted_difficulty));
 		}
 	}
 	// genesis
@@ -292,7 +292,7 @@ TEST (conflicts, adjusted_difficulty)
 		ASSERT_NO_ERROR (system.poll ());
 	}
 	{
-		btcnew::lock_guard<std::mutex> guard (node1.active.mutex);
-		ASSERT_EQ (node1.active.roots.get<1> ().begin ()->election->status.winner->hash (), open_epoch2->hash ());
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+		ASSERT_EQ (node1.active.sorted_roots ().front ().election->status.winner->hash (), open_epoch2->hash ());
 	}
 }
@@ -0,0 +1,80 @@
+#include <btcnew/core_test/testutil.hpp>
+#include <btcnew/node/election_scheduler.hpp>
+#include <btcnew/secure/common.hpp>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+std::shared_ptr<btcnew::block> make_block (uint64_t previous_a)
+{
+	return std::make_shared<btcnew::send_block> (previous_a, 0, 0, btcnew::keypair ().prv, 0, 0);
+}
+}
+
+TEST (election_scheduler, bucket_index)
+{
+	ASSERT_EQ (0, btcnew::election_scheduler::bucket_index (0));
+	ASSERT_EQ (0, btcnew::election_scheduler::bucket_index (1));
+	ASSERT_EQ (0, btcnew::election_scheduler::bucket_index (std::numeric_limits<uint64_t>::max ()));
+	ASSERT_EQ (1, btcnew::election_scheduler::bucket_index (btcnew::uint128_t (1) << 64));
+	ASSERT_EQ (1, btcnew::election_scheduler::bucket_index ((btcnew::uint128_t (1) << 68) - 1));
+	ASSERT_EQ (2, btcnew::election_scheduler::bucket_index (btcnew::uint128_t (1) << 68));
+	ASSERT_EQ (btcnew::election_scheduler::bucket_count - 1, btcnew::election_scheduler::bucket_index (std::numeric_limits<btcnew::uint128_t>::max ()));
+}
+
+TEST (election_scheduler, round_robin)
+{
+	btcnew::election_scheduler scheduler (8);
+	auto low1 (make_block (1));
+	auto low2 (make_block (2));
+	auto high (make_block (3));
+	ASSERT_FALSE (scheduler.push (low1, 1, std::chrono::seconds (0)));
+	ASSERT_FALSE (scheduler.push (low2, 1, std::chrono::seconds (0)));
+	ASSERT_FALSE (scheduler.push (high, btcnew::genesis_amount, std::chrono::seconds (0)));
+	ASSERT_EQ (3, scheduler.size ());
+	ASSERT_EQ (2, scheduler.bucket_size (0));
+	// A later block in another bucket does not wait behind the first bucket
+	ASSERT_EQ (low1, scheduler.pop ());
+	ASSERT_EQ (high, scheduler.pop ());
+	ASSERT_EQ (low2, scheduler.pop ());
+	ASSERT_EQ (nullptr, scheduler.pop ());
+	ASSERT_TRUE (scheduler.empty ());
+}
+
+TEST (election_scheduler, idle_priority)
+{
+	btcnew::election_scheduler scheduler (8);
+	auto recent (make_block (1));
+	auto idle (make_block (2));
+	auto recent2 (make_block (3));
+	ASSERT_FALSE (scheduler.push (recent, 1, std::chrono::seconds (5)));
+	ASSERT_FALSE (scheduler.push (idle, 1, std::chrono::seconds (3600)));
+	ASSERT_FALSE (scheduler.push (recent2, 1, std::chrono::seconds (5)));
+	ASSERT_EQ (idle, scheduler.pop ());
+	ASSERT_EQ (recent, scheduler.pop ());
+	ASSERT_EQ (recent2, scheduler.pop ());
+}
+
+TEST (election_scheduler, full_bucket)
+{
+	btcnew::election_scheduler scheduler (2);
+	auto block1 (make_block (1));
+	auto block2 (make_block (2));
+	auto block3 (make_block (3));
+	auto block4 (make_block (4));
+	ASSERT_FALSE (scheduler.push (block1, 1, std::chrono::seconds (10)));
+	ASSERT_FALSE (scheduler.push (block2, 1, std::chrono::seconds (5)));
+	// Lower priority than everything queued
+	ASSERT_TRUE (scheduler.push (block3, 1, std::chrono::seconds (1)));
+	// Evicts block2
+	ASSERT_FALSE (scheduler.push (block4, 1, std::chrono::seconds (60)));
+	ASSERT_EQ (2, scheduler.size ());
+	// Other buckets are not affected
+	ASSERT_FALSE (scheduler.push (block3, btcnew::genesis_amount, std::chrono::seconds (0)));
+	ASSERT_EQ (3, scheduler.size ());
+	ASSERT_EQ (block4, scheduler.pop ());
+	ASSERT_EQ (block3, scheduler.pop ());
+	ASSERT_EQ (block1, scheduler.pop ());
+	ASSERT_TRUE (scheduler.empty ());
+}
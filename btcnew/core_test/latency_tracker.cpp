@@ -0,0 +1,74 @@
+#include <btcnew/core_test/testutil.hpp>
+#include <btcnew/node/testing.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST (latency_tracker, stages)
+{
+	btcnew::stat stats;
+	btcnew::latency_tracker latency (stats);
+	btcnew::block_hash hash1 (1);
+	btcnew::block_hash hash2 (2);
+	latency.arrival (hash1);
+	ASSERT_EQ (1, latency.size ());
+	// Blocks which did not arrive live are not followed
+	latency.stage (hash2, btcnew::latency_stage::enqueue);
+	ASSERT_EQ (0, latency.get_summary (btcnew::latency_stage::enqueue).count);
+	latency.stage (hash1, btcnew::latency_stage::enqueue);
+	latency.stage (hash1, btcnew::latency_stage::confirm_req);
+	latency.stage (hash1, btcnew::latency_stage::confirm_req);
+	ASSERT_EQ (1, latency.get_summary (btcnew::latency_stage::enqueue).count);
+	ASSERT_EQ (2, latency.get_summary (btcnew::latency_stage::confirm_req).count);
+	ASSERT_EQ (0, latency.get_summary (btcnew::latency_stage::total).count);
+	latency.stage (hash1, btcnew::latency_stage::observers);
+	ASSERT_EQ (1, latency.get_summary (btcnew::latency_stage::observers).count);
+	ASSERT_EQ (1, latency.get_summary (btcnew::latency_stage::total).count);
+	ASSERT_EQ (0, latency.size ());
+	// Completed blocks are forgotten
+	latency.stage (hash1, btcnew::latency_stage::observers);
+	ASSERT_EQ (1, latency.get_summary (btcnew::latency_stage::observers).count);
+}
+
+TEST (latency_tracker, percentiles)
+{
+	btcnew::stat stats;
+	btcnew::latency_tracker latency (stats);
+	for (auto i (0); i < 90; ++i)
+	{
+		stats.update_histogram (btcnew::stat::type::latency, btcnew::stat::detail::quorum, btcnew::stat::dir::in, 3);
+	}
+	for (auto i (0); i < 10; ++i)
+	{
+		stats.update_histogram (btcnew::stat::type::latency, btcnew::stat::detail::quorum, btcnew::stat::dir::in, 700);
+	}
+	auto summary (latency.get_summary (btcnew::latency_stage::quorum));
+	ASSERT_EQ (100, summary.count);
+	ASSERT_EQ (5, summary.p50);
+	ASSERT_EQ (5, summary.p90);
+	ASSERT_EQ (1000, summary.p99);
+	auto empty (latency.get_summary (btcnew::latency_stage::cemented));
+	ASSERT_EQ (0, empty.count);
+	ASSERT_EQ (0, empty.p99);
+}
+
+TEST (latency_tracker, live_block)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	system.wallet (0)->insert_adhoc (btcnew::test_genesis_key.prv);
+	btcnew::genesis genesis;
+	auto send (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, genesis.hash (), btcnew::test_genesis_key.pub, btcnew::genesis_amount - btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	node.process_active (send);
+	system.deadline_set (10s);
+	while (node.latency.get_summary (btcnew::latency_stage::total).count < 1)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	for (auto stage : { btcnew::latency_stage::enqueue, btcnew::latency_stage::dequeue, btcnew::latency_stage::ledger_process, btcnew::latency_stage::election_start, btcnew::latency_stage::quorum, btcnew::latency_stage::cemented, btcnew::latency_stage::observers })
+	{
+		ASSERT_EQ (1, node.latency.get_summary (stage).count) << btcnew::latency_tracker::stage_to_string (stage);
+	}
+	ASSERT_EQ (0, node.latency.size ());
+}
@@ -732,9 +732,10 @@ TEST (votes, check_signature)
 		ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send1).code);
 	}
 	node1.active.start (send1);
-	btcnew::lock_guard<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
 	ASSERT_EQ (1, votes1->last_votes.size ());
+	lock.unlock ();
 	auto vote1 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 1, send1));
 	vote1->signature.bytes[0] ^= 1;
 	auto transaction (node1.store.tx_begin_read ());
@@ -755,8 +756,8 @@ TEST (votes, add_one)
 	auto transaction (node1.store.tx_begin_write ());
 	ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send1).code);
 	node1.active.start (send1);
-	btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
 	ASSERT_EQ (1, votes1->last_votes.size ());
 	lock.unlock ();
 	auto vote1 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 1, send1));
@@ -784,8 +785,8 @@ TEST (votes, add_two)
 	auto transaction (node1.store.tx_begin_write ());
 	ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send1).code);
 	node1.active.start (send1);
-	btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
 	lock.unlock ();
 	btcnew::keypair key2;
 	auto send2 (std::make_shared<btcnew::send_block> (genesis.hash (), key2.pub, 0, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
@@ -824,8 +825,8 @@ TEST (votes, add_existing)
 	ASSERT_FALSE (node1.active.vote (vote1));
 	// Block is already processed from vote
 	ASSERT_TRUE (node1.active.publish (send1));
-	btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
 	ASSERT_EQ (1, votes1->last_votes[btcnew::test_genesis_key.pub].sequence);
 	btcnew::keypair key2;
 	auto send2 (std::make_shared<btcnew::send_block> (genesis.hash (), key2.pub, btcnew::genesis_amount - btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
@@ -867,16 +868,20 @@ TEST (votes, add_old)
 	ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send1).code);
 	node1.active.start (send1);
 	auto vote1 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 2, send1));
-	btcnew::lock_guard<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
+	lock.unlock ();
 	auto channel (std::make_shared<btcnew::transport::channel_udp> (node1.network.udp_channels, node1.network.endpoint (), node1.network_params.protocol.protocol_version));
 	node1.vote_processor.vote_blocking (transaction, vote1, channel);
 	btcnew::keypair key2;
 	auto send2 (std::make_shared<btcnew::send_block> (genesis.hash (), key2.pub, 0, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
 	node1.work_generate_blocking (*send2);
 	auto vote2 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 1, send2));
+	lock.lock ();
 	votes1->last_votes[btcnew::test_genesis_key.pub].time = std::chrono::steady_clock::now () - std::chrono::seconds (20);
+	lock.unlock ();
 	node1.vote_processor.vote_blocking (transaction, vote2, channel);
+	lock.lock ();
 	ASSERT_EQ (2, votes1->last_votes.size ());
 	ASSERT_NE (votes1->last_votes.end (), votes1->last_votes.find (btcnew::test_genesis_key.pub));
 	ASSERT_EQ (send1->hash (), votes1->last_votes[btcnew::test_genesis_key.pub].hash);
@@ -900,19 +905,23 @@ TEST (votes, add_old_different_account)
 	ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send2).code);
 	node1.active.start (send1);
 	node1.active.start (send2);
-	btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
-	auto votes2 (node1.active.roots.find (send2->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
+	auto votes2 (node1.active.find_root (send2->qualified_root ())->election);
 	ASSERT_EQ (1, votes1->last_votes.size ());
 	ASSERT_EQ (1, votes2->last_votes.size ());
 	auto vote1 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 2, send1));
 	auto channel (std::make_shared<btcnew::transport::channel_udp> (node1.network.udp_channels, node1.network.endpoint (), node1.network_params.protocol.protocol_version));
+	lock.unlock ();
 	auto vote_result1 (node1.vote_processor.vote_blocking (transaction, vote1, channel));
+	lock.lock ();
 	ASSERT_EQ (btcnew::vote_code::vote, vote_result1);
 	ASSERT_EQ (2, votes1->last_votes.size ());
 	ASSERT_EQ (1, votes2->last_votes.size ());
 	auto vote2 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 1, send2));
+	lock.unlock ();
 	auto vote_result2 (node1.vote_processor.vote_blocking (transaction, vote2, channel));
+	lock.lock ();
 	ASSERT_EQ (btcnew::vote_code::vote, vote_result2);
 	ASSERT_EQ (2, votes1->last_votes.size ());
 	ASSERT_EQ (2, votes2->last_votes.size ());
@@ -938,8 +947,9 @@ TEST (votes, add_cooldown)
 	auto transaction (node1.store.tx_begin_write ());
 	ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send1).code);
 	node1.active.start (send1);
-	btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
+	lock.unlock ();
 	auto vote1 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 1, send1));
 	auto channel (std::make_shared<btcnew::transport::channel_udp> (node1.network.udp_channels, node1.network.endpoint (), node1.network_params.protocol.protocol_version));
 	node1.vote_processor.vote_blocking (transaction, vote1, channel);
@@ -948,6 +958,7 @@ TEST (votes, add_cooldown)
 	node1.work_generate_blocking (*send2);
 	auto vote2 (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 2, send2));
 	node1.vote_processor.vote_blocking (transaction, vote2, channel);
+	lock.lock ();
 	ASSERT_EQ (2, votes1->last_votes.size ());
 	ASSERT_NE (votes1->last_votes.end (), votes1->last_votes.find (btcnew::test_genesis_key.pub));
 	ASSERT_EQ (send1->hash (), votes1->last_votes[btcnew::test_genesis_key.pub].hash);
@@ -955,6 +966,43 @@ TEST (votes, add_cooldown)
 	ASSERT_EQ (*send1, *winner.second);
 }
 
+// Replaced votes move their weight between blocks without recomputing the tally
+TEST (votes, tally_incremental)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.online_weight_minimum = std::numeric_limits<btcnew::uint128_t>::max ();
+	node_config.frontiers_confirmation = btcnew::frontiers_confirmation_mode::disabled;
+	auto & node1 = *system.add_node (node_config);
+	btcnew::genesis genesis;
+	btcnew::keypair key1;
+	auto send1 (std::make_shared<btcnew::send_block> (genesis.hash (), key1.pub, btcnew::genesis_amount - 100, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
+	node1.work_generate_blocking (*send1);
+	{
+		auto transaction (node1.store.tx_begin_write ());
+		ASSERT_EQ (btcnew::process_result::progress, node1.ledger.process (transaction, *send1).code);
+	}
+	node1.active.start (send1);
+	btcnew::lock_guard<btcnew::elections_mutex> lock (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
+	auto weight (node1.ledger.weight (btcnew::test_genesis_key.pub));
+	votes1->vote (btcnew::test_genesis_key.pub, 1, send1->hash ());
+	ASSERT_EQ (1, votes1->last_tally.size ());
+	ASSERT_EQ (weight, votes1->last_tally[send1->hash ()]);
+	btcnew::keypair key2;
+	auto send2 (std::make_shared<btcnew::send_block> (genesis.hash (), key2.pub, btcnew::genesis_amount - 100, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
+	votes1->last_votes[btcnew::test_genesis_key.pub].time = std::chrono::steady_clock::now () - std::chrono::seconds (20);
+	votes1->vote (btcnew::test_genesis_key.pub, 2, send2->hash ());
+	votes1->vote (key2.pub, 1, send2->hash ());
+	// send1 keeps the zero weight vote the election starts with
+	ASSERT_EQ (2, votes1->last_tally.size ());
+	ASSERT_EQ (0, votes1->last_tally[send1->hash ()]);
+	ASSERT_EQ (weight, votes1->last_tally[send2->hash ()]);
+	auto tally (votes1->last_tally);
+	votes1->reconcile_tally ();
+	ASSERT_EQ (tally, votes1->last_tally);
+}
+
 // Query for block successor
 TEST (ledger, successor)
 {
@@ -2568,10 +2616,11 @@ TEST (ledger, block_hash_account_conflict)
 	node1.active.start (receive1);
 	node1.active.start (send2);
 	node1.active.start (open_epoch1);
-	auto votes1 (node1.active.roots.find (send1->qualified_root ())->election);
-	auto votes2 (node1.active.roots.find (receive1->qualified_root ())->election);
-	auto votes3 (node1.active.roots.find (send2->qualified_root ())->election);
-	auto votes4 (node1.active.roots.find (open_epoch1->qualified_root ())->election);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (node1.active.mutex);
+	auto votes1 (node1.active.find_root (send1->qualified_root ())->election);
+	auto votes2 (node1.active.find_root (receive1->qualified_root ())->election);
+	auto votes3 (node1.active.find_root (send2->qualified_root ())->election);
+	auto votes4 (node1.active.find_root (open_epoch1->qualified_root ())->election);
 	auto winner1 (*votes1->tally ().begin ());
 	auto winner2 (*votes2->tally ().begin ());
 	auto winner3 (*votes3->tally ().begin ());
@@ -2866,3 +2915,44 @@ TEST (ledger, zero_rep)
 	ASSERT_EQ (btcnew::genesis_amount, system.nodes[0]->ledger.rep_weights.representation_get (btcnew::test_genesis_key.pub));
 	ASSERT_EQ (0, system.nodes[0]->ledger.rep_weights.representation_get (0));
 }
+
+TEST (ledger, confirmation_height_cache)
+{
+	btcnew::logger_mt logger;
+	auto store = btcnew::make_store (logger, btcnew::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	btcnew::stat stats;
+	btcnew::genesis genesis;
+	{
+		btcnew::ledger ledger (*store, stats);
+		auto transaction (store->tx_begin_write ());
+		store->initialize (transaction, genesis, ledger.rep_weights, ledger.cemented_count, ledger.block_count_cache);
+	}
+	// Confirmation heights are loaded on construction
+	btcnew::ledger ledger (*store, stats, true, true, true);
+	uint64_t confirmation_height;
+	ASSERT_FALSE (ledger.confirmation_height_cache.get (btcnew::genesis_account, confirmation_height));
+	ASSERT_EQ (1, confirmation_height);
+	btcnew::keypair key1;
+	btcnew::work_pool pool (std::numeric_limits<unsigned>::max ());
+	auto transaction (store->tx_begin_write ());
+	btcnew::send_block send (genesis.hash (), key1.pub, btcnew::genesis_amount - 100, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *pool.generate (genesis.hash ()));
+	ASSERT_EQ (btcnew::process_result::progress, ledger.process (transaction, send).code);
+	btcnew::open_block open (send.hash (), key1.pub, key1.pub, key1.prv, key1.pub, *pool.generate (key1.pub));
+	ASSERT_EQ (btcnew::process_result::progress, ledger.process (transaction, open).code);
+	// Opening an account is not cached before it is committed
+	ASSERT_TRUE (ledger.confirmation_height_cache.get (key1.pub, confirmation_height));
+	ASSERT_EQ (1, ledger.confirmation_height_cache.size ());
+	ASSERT_FALSE (ledger.block_confirmed (transaction, open.hash ()));
+	ASSERT_TRUE (ledger.block_confirmed (transaction, genesis.hash ()));
+	ASSERT_FALSE (ledger.block_confirmed (transaction, send.hash ()));
+	// Confirmation checks are answered from the cache rather than the store
+	ledger.confirmation_height_cache.put (btcnew::genesis_account, 2);
+	ASSERT_TRUE (ledger.block_confirmed (transaction, send.hash ()));
+	ASSERT_FALSE (store->confirmation_height_get (transaction, btcnew::genesis_account, confirmation_height));
+	ASSERT_EQ (1, confirmation_height);
+	// Rolling back the open block removes the account
+	ASSERT_FALSE (ledger.rollback (transaction, open.hash ()));
+	ASSERT_TRUE (ledger.confirmation_height_cache.get (key1.pub, confirmation_height));
+	ASSERT_EQ (1, ledger.confirmation_height_cache.size ());
+}
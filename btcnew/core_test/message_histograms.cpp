@@ -0,0 +1,85 @@
+#include <btcnew/core_test/testutil.hpp>
+#include <btcnew/node/testing.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST (message_histograms, percentiles)
+{
+	btcnew::message_histograms histograms;
+	for (auto i (0); i < 90; ++i)
+	{
+		histograms.add (btcnew::transport::transport_type::udp, btcnew::message_type::publish, btcnew::message_histograms::metric::size, 100);
+	}
+	for (auto i (0); i < 10; ++i)
+	{
+		histograms.add (btcnew::transport::transport_type::udp, btcnew::message_type::publish, btcnew::message_histograms::metric::size, 1000);
+	}
+	auto summary (histograms.get_summary (btcnew::transport::transport_type::udp, btcnew::message_type::publish, btcnew::message_histograms::metric::size));
+	ASSERT_EQ (100, summary.count);
+	// Upper bounds of the power of two bins
+	ASSERT_EQ (128, summary.p50);
+	ASSERT_EQ (128, summary.p90);
+	ASSERT_EQ (1024, summary.p99);
+	// Other metrics, message types and transports are kept apart
+	ASSERT_EQ (0, histograms.get_summary (btcnew::transport::transport_type::udp, btcnew::message_type::publish, btcnew::message_histograms::metric::parse).count);
+	ASSERT_EQ (0, histograms.get_summary (btcnew::transport::transport_type::udp, btcnew::message_type::confirm_ack, btcnew::message_histograms::metric::size).count);
+	ASSERT_EQ (0, histograms.get_summary (btcnew::transport::transport_type::tcp, btcnew::message_type::publish, btcnew::message_histograms::metric::size).count);
+	// Undefined transports are ignored
+	histograms.add (btcnew::transport::transport_type::undefined, btcnew::message_type::publish, btcnew::message_histograms::metric::size, 100);
+	ASSERT_EQ (100, histograms.get_summary (btcnew::transport::transport_type::udp, btcnew::message_type::publish, btcnew::message_histograms::metric::size).count);
+}
+
+TEST (message_histograms, threads)
+{
+	btcnew::message_histograms histograms;
+	std::vector<std::thread> threads;
+	for (auto i (0); i < 4; ++i)
+	{
+		threads.emplace_back ([&histograms] () {
+			for (auto j (0); j < 1000; ++j)
+			{
+				histograms.add (btcnew::transport::transport_type::tcp, btcnew::message_type::confirm_ack, btcnew::message_histograms::metric::handler, j);
+			}
+		});
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	// Every thread records to its own buffer, all of them are summed when read
+	ASSERT_EQ (4, histograms.buffers_size ());
+	ASSERT_EQ (4000, histograms.get_summary (btcnew::transport::transport_type::tcp, btcnew::message_type::confirm_ack, btcnew::message_histograms::metric::handler).count);
+	boost::property_tree::ptree tree;
+	histograms.serialize_json (tree);
+	ASSERT_EQ ("4000", tree.get<std::string> ("tcp.confirm_ack.handler_us.count"));
+	ASSERT_EQ ("1024", tree.get<std::string> ("tcp.confirm_ack.handler_us.p99"));
+	ASSERT_FALSE (tree.get_child_optional ("tcp.confirm_ack.size_bytes"));
+	ASSERT_FALSE (tree.get_child_optional ("udp.confirm_ack"));
+}
+
+TEST (message_histograms, network)
+{
+	btcnew::system system (24000, 2);
+	auto & node1 (*system.nodes[0]);
+	auto & node2 (*system.nodes[1]);
+	auto channel (node1.network.find_channel (node2.network.endpoint ()));
+	ASSERT_NE (nullptr, channel);
+	btcnew::genesis genesis;
+	btcnew::publish publish (genesis.open);
+	channel->send (publish);
+	system.deadline_set (10s);
+	while (node2.network.message_histograms.get_summary (channel->get_type (), btcnew::message_type::publish, btcnew::message_histograms::metric::handler).count == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	auto type (channel->get_type ());
+	ASSERT_EQ (1, node2.network.message_histograms.get_summary (type, btcnew::message_type::publish, btcnew::message_histograms::metric::size).count);
+	ASSERT_EQ (1, node2.network.message_histograms.get_summary (type, btcnew::message_type::publish, btcnew::message_histograms::metric::parse).count);
+	ASSERT_EQ (1, node2.network.message_histograms.get_summary (type, btcnew::message_type::publish, btcnew::message_histograms::metric::queue).count);
+}
@@ -61,7 +61,8 @@ TEST (message_parser, exact_confirm_ack_size)
 	test_visitor visitor;
 	btcnew::block_uniquer block_uniquer;
 	btcnew::vote_uniquer vote_uniquer (block_uniquer);
-	btcnew::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	btcnew::network_filter filter (1);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	auto block (std::make_shared<btcnew::send_block> (1, 1, 2, btcnew::keypair ().prv, 4, *system.work.generate (btcnew::root (1))));
 	auto vote (std::make_shared<btcnew::vote> (0, btcnew::keypair ().prv, 0, std::move (block)));
 	btcnew::confirm_ack message (vote);
@@ -94,7 +95,8 @@ TEST (message_parser, exact_confirm_req_size)
 	test_visitor visitor;
 	btcnew::block_uniquer block_uniquer;
 	btcnew::vote_uniquer vote_uniquer (block_uniquer);
-	btcnew::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	btcnew::network_filter filter (1);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	auto block (std::make_shared<btcnew::send_block> (1, 1, 2, btcnew::keypair ().prv, 4, *system.work.generate (btcnew::root (1))));
 	btcnew::confirm_req message (std::move (block));
 	std::vector<uint8_t> bytes;
@@ -126,7 +128,8 @@ TEST (message_parser, exact_confirm_req_hash_size)
 	test_visitor visitor;
 	btcnew::block_uniquer block_uniquer;
 	btcnew::vote_uniquer vote_uniquer (block_uniquer);
-	btcnew::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	btcnew::network_filter filter (1);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	btcnew::send_block block (1, 1, 2, btcnew::keypair ().prv, 4, *system.work.generate (btcnew::root (1)));
 	btcnew::confirm_req message (block.hash (), block.root ());
 	std::vector<uint8_t> bytes;
@@ -158,7 +161,8 @@ TEST (message_parser, exact_publish_size)
 	test_visitor visitor;
 	btcnew::block_uniquer block_uniquer;
 	btcnew::vote_uniquer vote_uniquer (block_uniquer);
-	btcnew::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	btcnew::network_filter filter (1);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	auto block (std::make_shared<btcnew::send_block> (1, 1, 2, btcnew::keypair ().prv, 4, *system.work.generate (btcnew::root (1))));
 	btcnew::publish message (std::move (block));
 	std::vector<uint8_t> bytes;
@@ -184,13 +188,68 @@ TEST (message_parser, exact_publish_size)
 	ASSERT_NE (parser.status, btcnew::message_parser::parse_status::success);
 }
 
+TEST (message_parser, duplicate_publish)
+{
+	btcnew::system system (24000, 1);
+	test_visitor visitor;
+	btcnew::block_uniquer block_uniquer;
+	btcnew::vote_uniquer vote_uniquer (block_uniquer);
+	btcnew::network_filter filter (1024);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
+	auto block (std::make_shared<btcnew::send_block> (1, 1, 2, btcnew::keypair ().prv, 4, *system.work.generate (btcnew::root (1))));
+	btcnew::publish message (block);
+	auto bytes (message.to_bytes ());
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (1, visitor.publish_count);
+	ASSERT_EQ (parser.status, btcnew::message_parser::parse_status::success);
+	// The same payload again is dropped before deserializing it
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (1, visitor.publish_count);
+	ASSERT_EQ (parser.status, btcnew::message_parser::parse_status::duplicate_publish_message);
+	// Clearing the block lets it through again
+	filter.clear (block);
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (2, visitor.publish_count);
+	ASSERT_EQ (parser.status, btcnew::message_parser::parse_status::success);
+}
+
+TEST (message_parser, insufficient_work_publish)
+{
+	btcnew::system system (24000, 1);
+	test_visitor visitor;
+	btcnew::block_uniquer block_uniquer;
+	btcnew::vote_uniquer vote_uniquer (block_uniquer);
+	btcnew::network_filter filter (1024);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
+	auto block (std::make_shared<btcnew::send_block> (1, 1, 2, btcnew::keypair ().prv, 4, 0));
+	uint64_t work (0);
+	while (!btcnew::work_validate (block->root (), work))
+	{
+		++work;
+	}
+	block->block_work_set (work);
+	auto bytes (btcnew::publish (block).to_bytes ());
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (parser.status, btcnew::message_parser::parse_status::insufficient_work);
+	ASSERT_EQ (0, visitor.publish_count);
+	// Rejected blocks never reach the uniquer
+	ASSERT_EQ (0, block_uniquer.size ());
+	block->block_work_set (*system.work.generate (block->root ()));
+	bytes = btcnew::publish (block).to_bytes ();
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (parser.status, btcnew::message_parser::parse_status::success);
+	ASSERT_EQ (1, visitor.publish_count);
+	ASSERT_EQ (1, block_uniquer.size ());
+}
+
 TEST (message_parser, exact_keepalive_size)
 {
 	btcnew::system system (24000, 1);
 	test_visitor visitor;
 	btcnew::block_uniquer block_uniquer;
 	btcnew::vote_uniquer vote_uniquer (block_uniquer);
-	btcnew::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	btcnew::network_filter filter (1);
+	btcnew::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	btcnew::keepalive message;
 	std::vector<uint8_t> bytes;
 	{
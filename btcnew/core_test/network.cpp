@@ -534,6 +534,36 @@ TEST (network, ipv6_bind_send_ipv4)
 	});
 }
 
+#ifdef __linux__
+TEST (network, udp_packets_per_syscall)
+{
+	btcnew::system system (24000, 2);
+	auto & node1 (*system.nodes[0]);
+	auto & node2 (*system.nodes[1]);
+	auto packets = [] (btcnew::node & node_a, btcnew::stat::dir dir_a) {
+		uint64_t result (0);
+		for (auto & bin : node_a.stats.get_histogram (btcnew::stat::type::udp, btcnew::stat::detail::packets_per_syscall, dir_a)->get_bins ())
+		{
+			result += bin.value * bin.start_inclusive;
+		}
+		return result;
+	};
+	auto sent (packets (node1, btcnew::stat::dir::out));
+	auto received (packets (node2, btcnew::stat::dir::in));
+	btcnew::transport::channel_udp channel (node1.network.udp_channels, node2.network.endpoint (), node1.network_params.protocol.protocol_version);
+	btcnew::keepalive keepalive;
+	for (auto i (0); i < 8; ++i)
+	{
+		channel.send (keepalive);
+	}
+	system.deadline_set (10s);
+	while (packets (node1, btcnew::stat::dir::out) < sent + 8 || packets (node2, btcnew::stat::dir::in) < received + 8)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+}
+#endif
+
 TEST (network, endpoint_bad_fd)
 {
 	btcnew::system system (24000, 1);
@@ -641,6 +671,29 @@ TEST (message_buffer_manager, two_overflow)
 	ASSERT_EQ (buffer2, buffer4);
 }
 
+TEST (message_buffer_manager, batch)
+{
+	btcnew::stat stats;
+	btcnew::message_buffer_manager buffer (stats, 512, 4);
+	std::vector<btcnew::message_buffer *> buffers1;
+	buffer.allocate (buffers1, 3);
+	ASSERT_EQ (3, buffers1.size ());
+	std::vector<btcnew::message_buffer *> buffers2;
+	buffer.allocate (buffers2, 3);
+	ASSERT_EQ (1, buffers2.size ());
+	for (auto data : buffers1)
+	{
+		buffer.enqueue (data);
+	}
+	buffer.enqueue (buffers2[0]);
+	// Without free buffers the oldest unserviced one is reused
+	std::vector<btcnew::message_buffer *> buffers3;
+	buffer.allocate (buffers3, 3);
+	ASSERT_EQ (1, buffers3.size ());
+	ASSERT_EQ (buffers1[0], buffers3[0]);
+	ASSERT_EQ (1, stats.count (btcnew::stat::type::udp, btcnew::stat::detail::overflow, btcnew::stat::dir::in));
+}
+
 TEST (message_buffer_manager, one_buffer_multithreaded)
 {
 	btcnew::stat stats;
@@ -919,3 +972,317 @@ TEST (bandwidth_limiter, validate)
 		ASSERT_EQ (limiter_1536.get_rate (), full_confirm_ack); //should be 0 since nothing is small enough to pass through is tracked
 	}
 }
+
+TEST (traffic_shaper, class_share)
+{
+	btcnew::stat stats;
+	btcnew::traffic_shaping_config config;
+	config.enable = true;
+	config.inbound_limit = 1000;
+	config.outbound_limit = 1000;
+	config.peer_inbound_limit = 0;
+	config.vote_weight = 6;
+	config.publish_weight = 2;
+	config.keepalive_weight = 1;
+	config.bootstrap_weight = 1;
+	btcnew::transport::traffic_shaper shaper (config, stats);
+	// Keepalives use their share of 100 bytes, then borrow the rest of the node wide budget
+	for (auto i (0); i < 10; ++i)
+	{
+		ASSERT_FALSE (shaper.should_drop_outbound (btcnew::message_type::keepalive, 100));
+	}
+	ASSERT_TRUE (shaper.should_drop_outbound (btcnew::message_type::keepalive, 100));
+	// Votes still get their share of 600 bytes
+	for (auto i (0); i < 6; ++i)
+	{
+		ASSERT_FALSE (shaper.should_drop_outbound (btcnew::message_type::confirm_ack, 100));
+	}
+	ASSERT_TRUE (shaper.should_drop_outbound (btcnew::message_type::confirm_req, 100));
+	ASSERT_EQ (1, stats.count (btcnew::stat::type::traffic_shaper, btcnew::stat::detail::keepalive_class, btcnew::stat::dir::out));
+	ASSERT_EQ (1, stats.count (btcnew::stat::type::traffic_shaper, btcnew::stat::detail::vote_class, btcnew::stat::dir::out));
+	ASSERT_FALSE (shaper.should_drop_outbound (btcnew::message_type::node_id_handshake, 1000));
+	// Inbound traffic has a budget of its own
+	ASSERT_FALSE (shaper.should_drop_inbound (btcnew::endpoint (boost::asio::ip::address_v6::loopback (), 10000), btcnew::message_type::keepalive, 100));
+}
+
+TEST (traffic_shaper, peer_limit)
+{
+	btcnew::stat stats;
+	btcnew::traffic_shaping_config config;
+	btcnew::endpoint endpoint1 (boost::asio::ip::address_v6::loopback (), 10000);
+	btcnew::endpoint endpoint2 (boost::asio::ip::address_v6::loopback (), 10001);
+	{
+		// Disabled on the test network by default
+		btcnew::transport::traffic_shaper shaper (config, stats);
+		for (auto i (0); i < 100; ++i)
+		{
+			ASSERT_FALSE (shaper.should_drop_inbound (endpoint1, btcnew::message_type::publish, 1024 * 1024));
+		}
+	}
+	config.enable = true;
+	config.inbound_limit = 0;
+	config.peer_inbound_limit = 300;
+	btcnew::transport::traffic_shaper shaper (config, stats);
+	for (auto i (0); i < 3; ++i)
+	{
+		ASSERT_FALSE (shaper.should_drop_inbound (endpoint1, btcnew::message_type::publish, 100));
+	}
+	ASSERT_TRUE (shaper.should_drop_inbound (endpoint1, btcnew::message_type::publish, 100));
+	ASSERT_FALSE (shaper.should_drop_inbound (endpoint2, btcnew::message_type::publish, 100));
+	ASSERT_EQ (1, stats.count (btcnew::stat::type::traffic_shaper, btcnew::stat::detail::peer_bucket, btcnew::stat::dir::in));
+	ASSERT_EQ (0, stats.count (btcnew::stat::type::traffic_shaper, btcnew::stat::detail::publish_class, btcnew::stat::dir::in));
+	ASSERT_EQ (2, shaper.peers_size ());
+	// At the limit the least recently active peer is forgotten, endpoint1 gets a new budget while endpoint2 keeps its own
+	for (uint16_t port (20000); shaper.peers_size () < btcnew::transport::traffic_shaper::max_peers; ++port)
+	{
+		ASSERT_FALSE (shaper.should_drop_inbound (btcnew::endpoint (boost::asio::ip::address_v6::loopback (), port), btcnew::message_type::publish, 100));
+	}
+	ASSERT_FALSE (shaper.should_drop_inbound (endpoint2, btcnew::message_type::publish, 100));
+	ASSERT_FALSE (shaper.should_drop_inbound (btcnew::endpoint (boost::asio::ip::address_v6::loopback (), 10002), btcnew::message_type::publish, 100));
+	ASSERT_EQ (btcnew::transport::traffic_shaper::max_peers, shaper.peers_size ());
+	ASSERT_FALSE (shaper.should_drop_inbound (endpoint1, btcnew::message_type::publish, 100));
+	ASSERT_FALSE (shaper.should_drop_inbound (endpoint2, btcnew::message_type::publish, 100));
+	ASSERT_TRUE (shaper.should_drop_inbound (endpoint2, btcnew::message_type::publish, 100));
+	shaper.purge (std::chrono::steady_clock::now () + 1s);
+	ASSERT_EQ (0, shaper.peers_size ());
+}
+
+TEST (peer_limiter, ip_limit)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.traffic_shaping_config.enable = true;
+	node_config.traffic_shaping_config.ip_message_limit = 3;
+	node_config.traffic_shaping_config.node_id_message_limit = 0;
+	auto & limiter (system.add_node (node_config)->network.peer_limiter);
+	btcnew::endpoint endpoint1 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.1"), 10000);
+	btcnew::endpoint endpoint2 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.1"), 10001);
+	btcnew::endpoint endpoint3 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.2"), 10000);
+	for (auto i (0); i < 3; ++i)
+	{
+		ASSERT_FALSE (limiter.should_drop (endpoint1, 0, btcnew::transport::transport_type::udp));
+	}
+	// The budget is shared by every port of an address
+	ASSERT_TRUE (limiter.should_drop (endpoint2, 0, btcnew::transport::transport_type::udp));
+	ASSERT_FALSE (limiter.should_drop (endpoint3, 0, btcnew::transport::transport_type::udp));
+	ASSERT_TRUE (limiter.should_drop (endpoint1, 0, btcnew::transport::transport_type::tcp));
+	ASSERT_EQ (2, system.nodes[0]->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::ip_bucket, btcnew::stat::dir::in));
+	// Exceeding the address budget isn't penalized, the sender of a datagram can't be told apart from others using its address
+	ASSERT_EQ (0, limiter.penalties_size ());
+	// Handshaken TCP channels don't use the address budget, peers behind one address would share it
+	btcnew::keypair key;
+	ASSERT_FALSE (limiter.should_drop (endpoint1, key.pub, btcnew::transport::transport_type::tcp));
+	limiter.purge (std::chrono::steady_clock::now () + 1s);
+	ASSERT_EQ (0, limiter.buckets_size ());
+	ASSERT_EQ (0, limiter.penalties_size ());
+}
+
+TEST (peer_limiter, node_id_limit)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.traffic_shaping_config.enable = true;
+	node_config.traffic_shaping_config.ip_message_limit = 0;
+	node_config.traffic_shaping_config.node_id_message_limit = 2;
+	auto & limiter (system.add_node (node_config)->network.peer_limiter);
+	btcnew::keypair key;
+	btcnew::endpoint endpoint1 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.1"), 10000);
+	btcnew::endpoint endpoint2 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.2"), 10000);
+	ASSERT_FALSE (limiter.should_drop (endpoint1, key.pub, btcnew::transport::transport_type::tcp));
+	ASSERT_FALSE (limiter.should_drop (endpoint2, key.pub, btcnew::transport::transport_type::tcp));
+	ASSERT_TRUE (limiter.should_drop (endpoint1, key.pub, btcnew::transport::transport_type::tcp));
+	// Channels without a completed handshake and UDP are only limited by address
+	ASSERT_FALSE (limiter.should_drop (endpoint1, 0, btcnew::transport::transport_type::tcp));
+	ASSERT_FALSE (limiter.should_drop (endpoint1, key.pub, btcnew::transport::transport_type::udp));
+	ASSERT_EQ (1, system.nodes[0]->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::node_id_bucket, btcnew::stat::dir::in));
+	auto penalties (limiter.list ());
+	ASSERT_EQ (1, penalties.size ());
+	ASSERT_EQ (endpoint1.address (), penalties[0].first);
+	ASSERT_EQ (1, penalties[0].second.score);
+	// Exceeding the budget again within a second adds nothing
+	ASSERT_TRUE (limiter.should_drop (endpoint1, key.pub, btcnew::transport::transport_type::tcp));
+	ASSERT_EQ (1, limiter.list ()[0].second.score);
+}
+
+TEST (peer_limiter, penalties)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.traffic_shaping_config.enable = true;
+	node_config.traffic_shaping_config.penalty_close_score = 5;
+	node_config.traffic_shaping_config.penalty_exclude_score = 10;
+	node_config.traffic_shaping_config.penalty_exclude_time = std::chrono::seconds (1);
+	auto node (system.add_node (node_config));
+	auto & limiter (node->network.peer_limiter);
+	btcnew::endpoint endpoint1 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.1"), 10000);
+	btcnew::endpoint endpoint2 (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.2"), 10000);
+	limiter.penalize (endpoint1, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::invalid_signature);
+	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_close));
+	ASSERT_FALSE (limiter.excluded (endpoint1.address ()));
+	for (auto i (0); i < 2; ++i)
+	{
+		limiter.penalize (endpoint1, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::insufficient_work);
+	}
+	ASSERT_EQ (0, node->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_exclude));
+	limiter.penalize (endpoint1, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::insufficient_work);
+	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_exclude));
+	ASSERT_TRUE (limiter.excluded (endpoint1.address ()));
+	ASSERT_TRUE (limiter.should_drop (endpoint1, 0, btcnew::transport::transport_type::udp));
+	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::excluded_address, btcnew::stat::dir::in));
+	ASSERT_TRUE (node->network.reachout (endpoint1, true));
+	ASSERT_FALSE (node->network.reachout (endpoint2, true));
+	// Penalties for messages queued before the exclusion don't count
+	limiter.penalize (endpoint1, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::invalid_signature);
+	auto penalties (limiter.list ());
+	ASSERT_EQ (1, penalties.size ());
+	ASSERT_EQ (0, penalties[0].second.score);
+	ASSERT_EQ (1, penalties[0].second.exclusions);
+	system.deadline_set (10s);
+	while (limiter.excluded (endpoint1.address ()))
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	// The second exclusion lasts twice as long
+	limiter.penalize (endpoint1, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::invalid_signature);
+	limiter.penalize (endpoint1, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::invalid_signature);
+	penalties = limiter.list ();
+	ASSERT_EQ (2, penalties[0].second.exclusions);
+	ASSERT_GT (penalties[0].second.exclude_until - std::chrono::steady_clock::now (), 1s);
+	// Exclusions are remembered past their end so further ones keep escalating
+	limiter.purge (penalties[0].second.exclude_until);
+	ASSERT_EQ (1, limiter.penalties_size ());
+	limiter.purge (penalties[0].second.exclude_until + 10s);
+	ASSERT_EQ (0, limiter.penalties_size ());
+}
+
+TEST (peer_limiter, exclude_channels)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.traffic_shaping_config.enable = true;
+	node_config.traffic_shaping_config.penalty_exclude_score = 5;
+	auto node0 (system.add_node (node_config));
+	auto node1 (system.add_node (btcnew::node_config (24001, system.logging)));
+	system.deadline_set (10s);
+	while (node0->network.find_node_id (node1->node_id.pub) == nullptr)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	node0->network.peer_limiter.penalize (node0->network.find_node_id (node1->node_id.pub)->get_endpoint (), btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::invalid_signature);
+	ASSERT_EQ (1, node0->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_exclude));
+	// Every channel from the address is closed and none is established again while it is excluded
+	while (node0->network.size () != 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	for (auto i (0); i < 50; ++i)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (0, node0->network.size ());
+}
+
+TEST (peer_limiter, spoofed_udp)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.traffic_shaping_config.enable = true;
+	node_config.traffic_shaping_config.ip_message_limit = 20;
+	node_config.traffic_shaping_config.penalty_close_score = 1;
+	node_config.traffic_shaping_config.penalty_exclude_score = 2;
+	auto node0 (system.add_node (node_config));
+	auto node1 (system.add_node (btcnew::node_config (24001, system.logging)));
+	system.deadline_set (10s);
+	while (node0->network.tcp_channels.find_node_id (node1->node_id.pub) == nullptr)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	auto address (node0->network.tcp_channels.find_node_id (node1->node_id.pub)->get_endpoint ().address ());
+	// Datagrams from the address of the TCP peer with invalid votes, blocks without work and more than the address budget
+	btcnew::transport::channel_udp channel (node1->network.udp_channels, node0->network.endpoint (), node1->network_params.protocol.protocol_version);
+	btcnew::keypair key;
+	auto block (std::make_shared<btcnew::send_block> (0, 1, 20, key.prv, key.pub, 0));
+	auto vote (std::make_shared<btcnew::vote> (key.pub, key.prv, 1, block));
+	vote->signature.bytes[0] ^= 1;
+	for (auto i (0); i < 5; ++i)
+	{
+		channel.send (btcnew::confirm_ack (vote));
+		channel.send (btcnew::publish (block));
+	}
+	while (node0->stats.count (btcnew::stat::type::error, btcnew::stat::detail::insufficient_work) == 0 || node0->stats.count (btcnew::stat::type::message, btcnew::stat::detail::confirm_ack, btcnew::stat::dir::in) == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	node0->vote_processor.flush ();
+	for (auto i (0); i < 100; ++i)
+	{
+		channel.send (btcnew::keepalive ());
+	}
+	while (node0->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::ip_bucket, btcnew::stat::dir::in) == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	// Datagrams over the budget are dropped, but none of them count against the TCP peer
+	ASSERT_EQ (0, node0->network.peer_limiter.penalties_size ());
+	ASSERT_FALSE (node0->network.peer_limiter.excluded (address));
+	ASSERT_EQ (0, node0->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_close));
+	ASSERT_EQ (0, node0->stats.count (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_exclude));
+	ASSERT_NE (nullptr, node0->network.tcp_channels.find_node_id (node1->node_id.pub));
+}
+
+TEST (network, simulated)
+{
+	btcnew::transport::simulation_config config;
+	config.latency = std::chrono::milliseconds (20);
+	config.jitter = std::chrono::milliseconds (5);
+	config.bandwidth = 1024 * 1024;
+	btcnew::system system (24000, 3, config);
+	for (auto & node : system.nodes)
+	{
+		ASSERT_EQ (0, node->network.tcp_channels.size ());
+		ASSERT_NE (0, node->network.udp_channels.size ());
+	}
+	btcnew::keypair key;
+	system.wallet (0)->insert_adhoc (btcnew::test_genesis_key.prv);
+	auto block (system.wallet (0)->send_action (btcnew::test_genesis_key.pub, key.pub, system.nodes[0]->config.receive_minimum.number ()));
+	ASSERT_NE (nullptr, block);
+	system.deadline_set (10s);
+	while (system.nodes[2]->block (block->hash ()) == nullptr)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_NE (0, system.simulated->delivered);
+	ASSERT_EQ (0, system.simulated->lost);
+	ASSERT_EQ (0, system.simulated->unreachable);
+}
+
+TEST (network, simulated_loss)
+{
+	btcnew::system system;
+	btcnew::transport::simulation_config config;
+	config.loss = 0.5;
+	config.seed = 42;
+	auto simulated1 (std::make_shared<btcnew::transport::simulated_network> (system.alarm, config));
+	auto simulated2 (std::make_shared<btcnew::transport::simulated_network> (system.alarm, config));
+	btcnew::endpoint from (boost::asio::ip::address_v6::loopback (), 24000);
+	btcnew::endpoint to (boost::asio::ip::address_v6::loopback (), 24001);
+	btcnew::shared_const_buffer buffer (std::vector<uint8_t> (100));
+	std::vector<bool> lost1;
+	std::vector<bool> lost2;
+	for (auto i (0); i < 100; ++i)
+	{
+		auto before1 (simulated1->lost.load ());
+		simulated1->send (from, to, buffer, nullptr);
+		lost1.push_back (simulated1->lost != before1);
+		auto before2 (simulated2->lost.load ());
+		simulated2->send (from, to, buffer, nullptr);
+		lost2.push_back (simulated2->lost != before2);
+	}
+	// The same seed loses the same datagrams, the rest have no node to go to
+	ASSERT_EQ (lost1, lost2);
+	ASSERT_EQ (100, simulated1->sent);
+	ASSERT_EQ (100, simulated1->lost + simulated1->unreachable);
+	ASSERT_NE (0, simulated1->lost);
+	ASSERT_NE (0, simulated1->unreachable);
+	ASSERT_EQ (0, simulated1->delivered);
+}
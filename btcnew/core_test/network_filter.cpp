@@ -0,0 +1,57 @@
+#include <btcnew/core_test/testutil.hpp>
+#include <btcnew/node/network_filter.hpp>
+#include <btcnew/node/testing.hpp>
+
+#include <gtest/gtest.h>
+
+TEST (network_filter, apply)
+{
+	btcnew::genesis genesis;
+	btcnew::network_filter filter (4);
+	auto block (genesis.open);
+	std::vector<uint8_t> bytes;
+	{
+		btcnew::vectorstream stream (bytes);
+		block->serialize (stream);
+	}
+	uint64_t digest (0);
+	ASSERT_FALSE (filter.apply (bytes.data (), bytes.size (), &digest));
+	ASSERT_EQ (filter.hash (block), digest);
+	ASSERT_TRUE (filter.apply (bytes.data (), bytes.size ()));
+	filter.clear (digest);
+	ASSERT_FALSE (filter.apply (bytes.data (), bytes.size ()));
+	filter.clear ();
+	ASSERT_FALSE (filter.apply (bytes.data (), bytes.size ()));
+	// A digest which no longer occupies its slot is not cleared
+	filter.clear (digest + 4);
+	ASSERT_TRUE (filter.apply (bytes.data (), bytes.size ()));
+}
+
+TEST (network_filter, many)
+{
+	btcnew::network_filter filter (4);
+	btcnew::keypair key;
+	std::vector<std::shared_ptr<btcnew::block>> blocks;
+	for (auto i (0); i < 100; ++i)
+	{
+		auto block (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, i, btcnew::test_genesis_key.pub, btcnew::genesis_amount - i, key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, 0));
+		blocks.push_back (block);
+		std::vector<uint8_t> bytes;
+		{
+			btcnew::vectorstream stream (bytes);
+			block->serialize (stream);
+		}
+		ASSERT_FALSE (filter.apply (bytes.data (), bytes.size ()));
+		ASSERT_TRUE (filter.apply (bytes.data (), bytes.size ()));
+	}
+	filter.clear (blocks);
+	for (auto & block : blocks)
+	{
+		std::vector<uint8_t> bytes;
+		{
+			btcnew::vectorstream stream (bytes);
+			block->serialize (stream);
+		}
+		ASSERT_FALSE (filter.apply (bytes.data (), bytes.size ()));
+	}
+}
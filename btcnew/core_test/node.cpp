@@ -27,6 +27,35 @@ TEST (node, stop)
 	ASSERT_TRUE (true);
 }
 
+TEST (node, io_shards)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.threading_config.io_shards = 2;
+	auto node0 (system.add_node (node_config));
+	node_config.peering_port = 24001;
+	node_config.threading_config.io_shards = 0;
+	auto node1 (system.add_node (node_config));
+	ASSERT_EQ (2, node0->io_shards.size ());
+	ASSERT_EQ (0, node1->io_shards.size ());
+	ASSERT_EQ (&node1->io_ctx, &node1->io_shards.io_ctx (node1->io_shards.assign ()));
+	system.deadline_set (10s);
+	while (node0->network.tcp_channels.size () == 0 || node1->network.tcp_channels.size () == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	// Sockets are spread over both shards, whose threads run their handlers
+	auto load (node0->io_shards.get_load ());
+	ASSERT_EQ (2, load.size ());
+	while (load[0].handlers == 0 || load[1].handlers == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+		load = node0->io_shards.get_load ();
+	}
+	ASSERT_EQ (-1, load[0].cpu);
+	ASSERT_GE (load[0].sockets + load[1].sockets, 2);
+}
+
 TEST (node, block_store_path_failure)
 {
 	auto service (boost::make_shared<boost::asio::io_context> ());
@@ -208,9 +237,9 @@ TEST (node, node_receive_quorum)
 	while (!done)
 	{
 		{
-			btcnew::lock_guard<std::mutex> guard (system.nodes[0]->active.mutex);
-			auto info (system.nodes[0]->active.roots.find (btcnew::qualified_root (previous, previous)));
-			ASSERT_NE (system.nodes[0]->active.roots.end (), info);
+			btcnew::lock_guard<btcnew::elections_mutex> guard (system.nodes[0]->active.mutex);
+			auto info (system.nodes[0]->active.find_root (btcnew::qualified_root (previous, previous)));
+			ASSERT_NE (nullptr, info);
 			done = info->election->confirmation_request_count > 2;
 		}
 		ASSERT_NO_ERROR (system.poll ());
@@ -412,11 +441,11 @@ TEST (node, search_pending_confirmed)
 	system.wallet (0)->insert_adhoc (key2.prv);
 	ASSERT_FALSE (system.wallet (0)->search_pending ());
 	{
-		btcnew::lock_guard<std::mutex> guard (node->active.mutex);
-		auto existing1 (node->active.blocks.find (send1->hash ()));
-		ASSERT_EQ (node->active.blocks.end (), existing1);
-		auto existing2 (node->active.blocks.find (send2->hash ()));
-		ASSERT_EQ (node->active.blocks.end (), existing2);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
+		auto existing1 (node->active.find_election (send1->hash ()));
+		ASSERT_EQ (nullptr, existing1);
+		auto existing2 (node->active.find_election (send2->hash ()));
+		ASSERT_EQ (nullptr, existing2);
 	}
 	system.deadline_set (10s);
 	while (node->balance (key2.pub) != 2 * node->config.receive_minimum.number ())
@@ -961,6 +990,24 @@ TEST (node_config, random_rep)
 	ASSERT_NE (config1.preconfigured_representatives.end (), std::find (config1.preconfigured_representatives.begin (), config1.preconfigured_representatives.end (), rep));
 }
 
+TEST (node_config, cpu_list)
+{
+	std::vector<unsigned> cpus;
+	ASSERT_FALSE (btcnew::threading_config::parse_cpus ("0-3, 8,2", cpus));
+	ASSERT_EQ ((std::vector<unsigned>{ 0, 1, 2, 3, 8 }), cpus);
+	ASSERT_EQ ("0-3,8", btcnew::threading_config::cpus_to_string (cpus));
+	ASSERT_FALSE (btcnew::threading_config::parse_cpus ("", cpus));
+	ASSERT_TRUE (cpus.empty ());
+	ASSERT_EQ ("", btcnew::threading_config::cpus_to_string (cpus));
+	cpus = { 5 };
+	ASSERT_TRUE (btcnew::threading_config::parse_cpus ("3-1", cpus));
+	ASSERT_TRUE (btcnew::threading_config::parse_cpus ("1-2-3", cpus));
+	ASSERT_TRUE (btcnew::threading_config::parse_cpus ("1,,2", cpus));
+	ASSERT_TRUE (btcnew::threading_config::parse_cpus ("a", cpus));
+	// Lists are left untouched on error
+	ASSERT_EQ (std::vector<unsigned>{ 5 }, cpus);
+}
+
 class json_initial_value_test final
 {
 public:
@@ -1157,9 +1204,9 @@ TEST (node, fork_publish)
 		node1.process_active (send1);
 		node1.block_processor.flush ();
 		ASSERT_EQ (1, node1.active.size ());
-		btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
-		auto existing (node1.active.roots.find (send1->qualified_root ()));
-		ASSERT_NE (node1.active.roots.end (), existing);
+		std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
+		auto existing (node1.active.find_root (send1->qualified_root ()));
+		ASSERT_NE (nullptr, existing);
 		auto election (existing->election);
 		lock.unlock ();
 		system.deadline_set (1s);
@@ -1207,9 +1254,9 @@ TEST (node, fork_keep)
 	node1.block_processor.flush ();
 	node2.process_active (send2);
 	node2.block_processor.flush ();
-	btcnew::unique_lock<std::mutex> lock (node2.active.mutex);
-	auto conflict (node2.active.roots.find (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
-	ASSERT_NE (node2.active.roots.end (), conflict);
+	std::unique_lock<btcnew::elections_mutex> lock (node2.active.mutex);
+	auto conflict (node2.active.find_root (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
+	ASSERT_NE (nullptr, conflict);
 	auto votes1 (conflict->election);
 	ASSERT_NE (nullptr, votes1);
 	ASSERT_EQ (1, votes1->last_votes.size ());
@@ -1263,9 +1310,9 @@ TEST (node, fork_flip)
 	node1.block_processor.flush ();
 	node2.network.process_message (publish1, channel2);
 	node2.block_processor.flush ();
-	btcnew::unique_lock<std::mutex> lock (node2.active.mutex);
-	auto conflict (node2.active.roots.find (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
-	ASSERT_NE (node2.active.roots.end (), conflict);
+	std::unique_lock<btcnew::elections_mutex> lock (node2.active.mutex);
+	auto conflict (node2.active.find_root (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
+	ASSERT_NE (nullptr, conflict);
 	auto votes1 (conflict->election);
 	ASSERT_NE (nullptr, votes1);
 	ASSERT_EQ (1, votes1->last_votes.size ());
@@ -1324,9 +1371,9 @@ TEST (node, fork_multi_flip)
 	node1.block_processor.flush ();
 	node2.network.process_message (publish1, node2.network.udp_channels.create (node2.network.endpoint ()));
 	node2.block_processor.flush ();
-	btcnew::unique_lock<std::mutex> lock (node2.active.mutex);
-	auto conflict (node2.active.roots.find (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
-	ASSERT_NE (node2.active.roots.end (), conflict);
+	std::unique_lock<btcnew::elections_mutex> lock (node2.active.mutex);
+	auto conflict (node2.active.find_root (btcnew::qualified_root (genesis.hash (), genesis.hash ())));
+	ASSERT_NE (nullptr, conflict);
 	auto votes1 (conflict->election);
 	ASSERT_NE (nullptr, votes1);
 	ASSERT_EQ (1, votes1->last_votes.size ());
@@ -1457,9 +1504,9 @@ TEST (node, fork_open_flip)
 	node1.block_processor.flush ();
 	node2.process_active (open1);
 	node2.block_processor.flush ();
-	btcnew::unique_lock<std::mutex> lock (node2.active.mutex);
-	auto conflict (node2.active.roots.find (open1->qualified_root ()));
-	ASSERT_NE (node2.active.roots.end (), conflict);
+	std::unique_lock<btcnew::elections_mutex> lock (node2.active.mutex);
+	auto conflict (node2.active.find_root (open1->qualified_root ()));
+	ASSERT_NE (nullptr, conflict);
 	auto votes1 (conflict->election);
 	ASSERT_NE (nullptr, votes1);
 	ASSERT_EQ (1, votes1->last_votes.size ());
@@ -1756,9 +1803,9 @@ TEST (node, rep_self_vote)
 	ASSERT_EQ (btcnew::process_result::progress, node0->process (*block0).code);
 	auto & active (node0->active);
 	active.start (block0);
-	btcnew::unique_lock<std::mutex> lock (active.mutex);
-	auto existing (active.roots.find (block0->qualified_root ()));
-	ASSERT_NE (active.roots.end (), existing);
+	std::unique_lock<btcnew::elections_mutex> lock (active.mutex);
+	auto existing (active.find_root (block0->qualified_root ()));
+	ASSERT_NE (nullptr, existing);
 	auto election (existing->election);
 	lock.unlock ();
 	system.deadline_set (1s);
@@ -1908,9 +1955,9 @@ TEST (node, bootstrap_confirm_frontiers)
 		ASSERT_NO_ERROR (system1.poll ());
 	}
 	{
-		btcnew::lock_guard<std::mutex> guard (node1->active.mutex);
-		auto existing1 (node1->active.blocks.find (send0.hash ()));
-		ASSERT_NE (node1->active.blocks.end (), existing1);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node1->active.mutex);
+		auto existing1 (node1->active.find_election (send0.hash ()));
+		ASSERT_NE (nullptr, existing1);
 	}
 	// Wait for confirmation height update
 	system1.deadline_set (10s);
@@ -2341,9 +2388,9 @@ TEST (node, confirm_quorum)
 	{
 		ASSERT_FALSE (system.nodes[0]->active.empty ());
 		{
-			btcnew::lock_guard<std::mutex> guard (system.nodes[0]->active.mutex);
-			auto info (system.nodes[0]->active.roots.find (btcnew::qualified_root (send1->hash (), send1->hash ())));
-			ASSERT_NE (system.nodes[0]->active.roots.end (), info);
+			btcnew::lock_guard<btcnew::elections_mutex> guard (system.nodes[0]->active.mutex);
+			auto info (system.nodes[0]->active.find_root (btcnew::qualified_root (send1->hash (), send1->hash ())));
+			ASSERT_NE (nullptr, info);
 			done = info->election->confirmation_request_count > 2;
 		}
 		ASSERT_NO_ERROR (system.poll ());
@@ -2370,11 +2417,23 @@ TEST (node, local_votes_cache)
 	btcnew::confirm_req message1 (send1);
 	btcnew::confirm_req message2 (send2);
 	auto channel (node.network.udp_channels.create (node.network.endpoint ()));
+	system.deadline_set (3s);
 	for (auto i (0); i < 100; ++i)
 	{
 		node.network.process_message (message1, channel);
+	}
+	while (node.votes_cache.find (send1->hash ()).empty ())
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	for (auto i (0); i < 100; ++i)
+	{
 		node.network.process_message (message2, channel);
 	}
+	while (node.votes_cache.find (send2->hash ()).empty ())
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
 	{
 		btcnew::lock_guard<std::mutex> lock (node.store.get_cache_mutex ());
 		auto transaction (node.store.tx_begin_read ());
@@ -2391,6 +2450,10 @@ TEST (node, local_votes_cache)
 	{
 		node.network.process_message (message3, channel);
 	}
+	while (node.votes_cache.find (send3->hash ()).empty ())
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
 	{
 		btcnew::lock_guard<std::mutex> lock (node.store.get_cache_mutex ());
 		auto transaction (node.store.tx_begin_read ());
@@ -2423,6 +2486,11 @@ TEST (node, local_votes_cache_generate_new_vote)
 	{
 		node.network.process_message (message1, channel);
 	}
+	system.deadline_set (3s);
+	while (node.votes_cache.find (send1->hash ()).empty ())
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
 	auto votes1 (node.votes_cache.find (send1->hash ()));
 	ASSERT_EQ (1, votes1.size ());
 	ASSERT_EQ (1, votes1[0]->blocks.size ());
@@ -2438,16 +2506,21 @@ TEST (node, local_votes_cache_generate_new_vote)
 		auto transaction (node.store.tx_begin_write ());
 		ASSERT_EQ (btcnew::process_result::progress, node.ledger.process (transaction, *send2).code);
 	}
-	// Generate new vote for request with 2 hashes (one of hashes is cached)
+	// Generate new vote only for the hash missing from the cache in a request with 2 hashes
 	std::vector<std::pair<btcnew::block_hash, btcnew::root>> roots_hashes{ std::make_pair (send1->hash (), send1->root ()), std::make_pair (send2->hash (), send2->root ()) };
 	btcnew::confirm_req message2 (roots_hashes);
 	for (auto i (0); i < 100; ++i)
 	{
 		node.network.process_message (message2, channel);
 	}
-	auto votes2 (node.votes_cache.find (send1->hash ()));
+	while (node.votes_cache.find (send2->hash ()).empty ())
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	auto votes2 (node.votes_cache.find (send2->hash ()));
 	ASSERT_EQ (1, votes2.size ());
-	ASSERT_EQ (2, votes2[0]->blocks.size ());
+	ASSERT_EQ (1, votes2[0]->blocks.size ());
+	ASSERT_EQ (send2->hash (), boost::get<btcnew::block_hash> (votes2[0]->blocks[0]));
 	{
 		btcnew::lock_guard<std::mutex> lock (node.store.get_cache_mutex ());
 		auto transaction (node.store.tx_begin_read ());
@@ -2455,8 +2528,9 @@ TEST (node, local_votes_cache_generate_new_vote)
 		ASSERT_EQ (current_vote->sequence, 2);
 		ASSERT_EQ (current_vote, votes2[0]);
 	}
-	ASSERT_FALSE (node.votes_cache.find (send1->hash ()).empty ());
-	ASSERT_FALSE (node.votes_cache.find (send2->hash ()).empty ());
+	// The cached vote is still used for the first hash
+	ASSERT_EQ (votes1, node.votes_cache.find (send1->hash ()));
+	ASSERT_EQ (2, node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_votes));
 }
 
 TEST (node, vote_republish)
@@ -2649,9 +2723,9 @@ TEST (node, epoch_conflict_confirm)
 		ASSERT_NO_ERROR (system.poll ());
 	}
 	{
-		btcnew::lock_guard<std::mutex> lock (node0->active.mutex);
-		ASSERT_TRUE (node0->active.blocks.find (change->hash ()) != node0->active.blocks.end ());
-		ASSERT_TRUE (node0->active.blocks.find (epoch->hash ()) != node0->active.blocks.end ());
+		btcnew::lock_guard<btcnew::elections_mutex> lock (node0->active.mutex);
+		ASSERT_TRUE (node0->active.find_election (change->hash ()) != nullptr);
+		ASSERT_TRUE (node0->active.find_election (epoch->hash ()) != nullptr);
 	}
 	system.wallet (1)->insert_adhoc (btcnew::test_genesis_key.prv);
 	system.deadline_set (5s);
@@ -2720,7 +2794,6 @@ TEST (node, fork_invalid_block_signature_vote_by_hash)
 	auto vote (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 0, vote_blocks));
 	{
 		auto transaction (system.nodes[0]->store.tx_begin_read ());
-		btcnew::unique_lock<std::mutex> lock (system.nodes[0]->active.mutex);
 		system.nodes[0]->vote_processor.vote_blocking (transaction, vote, std::make_shared<btcnew::transport::channel_udp> (system.nodes[0]->network.udp_channels, system.nodes[0]->network.endpoint (), system.nodes[0]->network_params.protocol.protocol_version));
 	}
 	while (system.nodes[0]->block (send1->hash ()))
@@ -2916,7 +2989,6 @@ TEST (node, confirm_back)
 	auto vote (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 0, vote_blocks));
 	{
 		auto transaction (node.store.tx_begin_read ());
-		btcnew::unique_lock<std::mutex> lock (node.active.mutex);
 		node.vote_processor.vote_blocking (transaction, vote, std::make_shared<btcnew::transport::channel_udp> (node.network.udp_channels, node.network.endpoint (), node.network_params.protocol.protocol_version));
 	}
 	system.deadline_set (10s);
@@ -3201,7 +3273,7 @@ TEST (active_difficulty, recalculate_work)
 	}
 	auto sum (std::accumulate (node1.active.multipliers_cb.begin (), node1.active.multipliers_cb.end (), double(0)));
 	ASSERT_EQ (node1.active.active_difficulty (), btcnew::difficulty::from_multiplier (sum / node1.active.multipliers_cb.size (), node1.network_params.network.publish_threshold));
-	btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
+	std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
 	// Fake history records to force work recalculation
 	for (auto i (0); i < node1.active.multipliers_cb.size (); i++)
 	{
@@ -3217,6 +3289,55 @@ TEST (active_difficulty, recalculate_work)
 	lock.unlock ();
 }
 
+TEST (votes_cache, byte_bound)
+{
+	btcnew::keypair key1;
+	btcnew::keypair key2;
+	std::vector<btcnew::block_hash> hashes;
+	for (auto i (0); i < 12; ++i)
+	{
+		btcnew::block_hash hash;
+		btcnew::random_pool::generate_block (hash.bytes.data (), hash.bytes.size ());
+		hashes.push_back (hash);
+	}
+	auto vote1 (std::make_shared<btcnew::vote> (key1.pub, key1.prv, 1, hashes));
+	auto entry_bytes (btcnew::votes_cache::entry_bytes (*vote1));
+	btcnew::votes_cache cache (2 * hashes.size () * entry_bytes, 2);
+	// The vote is shared by every hash it covers
+	cache.add (vote1);
+	ASSERT_EQ (hashes.size (), cache.size ());
+	ASSERT_EQ (hashes.size () * entry_bytes, cache.bytes ());
+	auto vote2 (std::make_shared<btcnew::vote> (key2.pub, key2.prv, 1, hashes));
+	cache.add (vote2);
+	ASSERT_EQ (hashes.size (), cache.size ());
+	ASSERT_LT (cache.bytes (), 2 * hashes.size () * entry_bytes);
+	ASSERT_EQ (2, cache.find (hashes[0]).size ());
+	// A newer vote from the same representative replaces the old one
+	auto vote3 (std::make_shared<btcnew::vote> (key1.pub, key1.prv, 2, hashes));
+	cache.add (vote3);
+	auto votes (cache.find (hashes[0]));
+	ASSERT_EQ (2, votes.size ());
+	ASSERT_NE (votes.end (), std::find (votes.begin (), votes.end (), vote3));
+	ASSERT_EQ (votes.end (), std::find (votes.begin (), votes.end (), vote1));
+	// Votes for new hashes evict the oldest entries once over budget
+	btcnew::block_hash last;
+	std::shared_ptr<btcnew::vote> last_vote;
+	for (auto i (0); i < 100; ++i)
+	{
+		btcnew::random_pool::generate_block (last.bytes.data (), last.bytes.size ());
+		last_vote = std::make_shared<btcnew::vote> (key1.pub, key1.prv, 3 + i, std::vector<btcnew::block_hash>{ last });
+		cache.add (last_vote);
+		ASSERT_LE (cache.bytes (), 2 * hashes.size () * entry_bytes);
+	}
+	ASSERT_TRUE (cache.find (hashes[0]).empty ());
+	ASSERT_FALSE (cache.find (last).empty ());
+	// Removing an entry releases its memory
+	auto bytes (cache.bytes ());
+	cache.remove (last);
+	ASSERT_TRUE (cache.find (last).empty ());
+	ASSERT_EQ (bytes - btcnew::votes_cache::entry_bytes (*last_vote), cache.bytes ());
+}
+
 namespace
 {
 void add_required_children_node_config_tree (btcnew::jsonconfig & tree)
@@ -3234,3 +3355,80 @@ void add_required_children_node_config_tree (btcnew::jsonconfig & tree)
 	tree.put ("version", std::to_string (btcnew::node_config::json_version ()));
 }
 }
+
+namespace btcnew
+{
+TEST (vote_processor, fair_queue)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	auto channel (std::make_shared<btcnew::transport::channel_udp> (node.network.udp_channels, node.network.endpoint (), node.network_params.protocol.protocol_version));
+	btcnew::genesis genesis;
+	std::vector<btcnew::block_hash> hashes{ genesis.hash () };
+	auto principal_vote (std::make_shared<btcnew::vote> (btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, 1, hashes));
+	std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> batch;
+	{
+		// Holding the mutex keeps the processing threads from taking any of the queued votes
+		btcnew::lock_guard<std::mutex> lock (node.vote_processor.mutex);
+		node.vote_processor.representatives_3.insert (btcnew::test_genesis_key.pub);
+		for (auto i (0); i < 20; ++i)
+		{
+			btcnew::keypair key;
+			auto spam_vote (std::make_shared<btcnew::vote> (key.pub, key.prv, 1, hashes));
+			for (auto j (0); j < 100; ++j)
+			{
+				ASSERT_TRUE (node.vote_processor.enqueue (spam_vote, channel));
+			}
+		}
+		for (auto i (0); i < 10; ++i)
+		{
+			ASSERT_TRUE (node.vote_processor.enqueue (principal_vote, channel));
+		}
+		ASSERT_EQ (2010, node.vote_processor.votes_count);
+		node.vote_processor.take_batch (batch);
+		ASSERT_EQ (btcnew::vote_processor::batch_size, batch.size ());
+		ASSERT_EQ (2010 - btcnew::vote_processor::batch_size, node.vote_processor.votes_count);
+		// Discard the remaining votes so the processing threads only see what was taken here
+		std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> rest;
+		while (node.vote_processor.votes_count > 0)
+		{
+			node.vote_processor.take_batch (rest);
+		}
+		ASSERT_TRUE (node.vote_processor.queues.empty ());
+	}
+	// The principal representative queued last but its votes are served ahead of the spam
+	auto principal_votes (std::count_if (batch.begin (), batch.begin () + 20, [&principal_vote](auto const & item_a) { return item_a.first == principal_vote; }));
+	ASSERT_EQ (10, principal_votes);
+	// Spammers are served round robin rather than one after another
+	ASSERT_NE (batch[11].first, batch[12].first);
+}
+
+TEST (vote_generator, adaptive_delay)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	auto & generator (node.block_processor.generator);
+	std::chrono::steady_clock::duration max_delay (node.config.vote_generator_delay);
+	btcnew::lock_guard<std::mutex> lock (generator.mutex);
+	ASSERT_EQ (max_delay, generator.current_delay);
+	// Single hashes are voted for with low latency instead of being held back
+	for (auto i (0); i < 100; ++i)
+	{
+		generator.update_delay (1, generator.current_delay);
+	}
+	ASSERT_EQ (generator.min_delay, generator.current_delay);
+	// Hashes arriving quickly enough to fill votes are held back longer
+	for (auto i (0); i < 50; ++i)
+	{
+		generator.update_delay (6, generator.current_delay);
+	}
+	ASSERT_GE (generator.current_delay, max_delay - 1ms);
+	// Fast confirmations bound the delay
+	generator.latency = max_delay;
+	for (auto i (0); i < 50; ++i)
+	{
+		generator.update_delay (btcnew::network::confirm_ack_hashes_max, generator.current_delay);
+	}
+	ASSERT_LE (generator.current_delay, max_delay / 4);
+}
+}
@@ -1,3 +1,4 @@
+#include <btcnew/core_test/testutil.hpp>
 #include <btcnew/node/node.hpp>
 #include <btcnew/node/testing.hpp>
 
@@ -127,6 +128,50 @@ TEST (peer_container, list_fanout)
 	ASSERT_EQ (32, list2.size ());
 }
 
+TEST (peer_container, list_fanout_representative)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	std::shared_ptr<btcnew::transport::channel> representative;
+	for (auto i (0); i < 1000; ++i)
+	{
+		auto channel (node.network.udp_channels.insert (btcnew::endpoint (boost::asio::ip::address_v6::loopback (), 10000 + i), node.network_params.protocol.protocol_version));
+		ASSERT_NE (nullptr, channel);
+		if (i == 500)
+		{
+			representative = channel;
+		}
+	}
+	node.rep_crawler.response (representative, btcnew::test_genesis_key.pub, btcnew::genesis_amount);
+	for (auto i (0); i < 10; ++i)
+	{
+		auto list (node.network.list_fanout ());
+		ASSERT_EQ (32, list.size ());
+		ASSERT_EQ (representative, list.front ());
+		ASSERT_EQ (list.size (), std::unordered_set<std::shared_ptr<btcnew::transport::channel>> (list.begin (), list.end ()).size ());
+	}
+}
+
+TEST (channels, snapshot)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	auto snapshot1 (node.network.udp_channels.snapshot ());
+	ASSERT_TRUE (snapshot1->empty ());
+	btcnew::endpoint endpoint1 (boost::asio::ip::address_v6::loopback (), 10000);
+	ASSERT_NE (nullptr, node.network.udp_channels.insert (endpoint1, node.network_params.protocol.protocol_version));
+	auto snapshot2 (node.network.udp_channels.snapshot ());
+	ASSERT_EQ (1, snapshot2->size ());
+	ASSERT_EQ (endpoint1, (*snapshot2)[0]->get_endpoint ());
+	// Unchanged membership reuses the snapshot
+	ASSERT_EQ (snapshot2, node.network.udp_channels.snapshot ());
+	node.network.udp_channels.erase (endpoint1);
+	ASSERT_TRUE (node.network.udp_channels.snapshot ()->empty ());
+	// Readers holding an older snapshot keep their copy
+	ASSERT_TRUE (snapshot1->empty ());
+	ASSERT_EQ (1, snapshot2->size ());
+}
+
 // Test to make sure we don't repeatedly send keepalive messages to nodes that aren't responding
 TEST (peer_container, reachout)
 {
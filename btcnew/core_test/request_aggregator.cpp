@@ -0,0 +1,76 @@
+#include <btcnew/core_test/testutil.hpp>
+#include <btcnew/node/testing.hpp>
+#include <btcnew/node/transport/udp.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST (request_aggregator, one)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	system.wallet (0)->insert_adhoc (btcnew::test_genesis_key.prv);
+	btcnew::genesis genesis;
+	auto send1 (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, genesis.hash (), btcnew::test_genesis_key.pub, btcnew::genesis_amount - btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	{
+		auto transaction (node.store.tx_begin_write ());
+		ASSERT_EQ (btcnew::process_result::progress, node.ledger.process (transaction, *send1).code);
+	}
+	std::vector<std::pair<btcnew::block_hash, btcnew::root>> request{ { send1->hash (), send1->root () } };
+	auto channel (std::make_shared<btcnew::transport::channel_udp> (node.network.udp_channels, node.network.endpoint (), node.network_params.protocol.protocol_version));
+	ASSERT_FALSE (node.aggregator.add (channel, request));
+	system.deadline_set (3s);
+	while (node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_votes) < 1)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_FALSE (node.votes_cache.find (send1->hash ()).empty ());
+	// The second request is answered from the votes cache
+	ASSERT_FALSE (node.aggregator.add (channel, request));
+	while (node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_cached_hashes) < 1)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (1, node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_votes));
+	ASSERT_EQ (0, node.aggregator.size ());
+}
+
+TEST (request_aggregator, shared)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	system.wallet (0)->insert_adhoc (btcnew::test_genesis_key.prv);
+	btcnew::genesis genesis;
+	auto send1 (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, genesis.hash (), btcnew::test_genesis_key.pub, btcnew::genesis_amount - btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	auto send2 (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, send1->hash (), btcnew::test_genesis_key.pub, btcnew::genesis_amount - 2 * btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (send1->hash ())));
+	{
+		auto transaction (node.store.tx_begin_write ());
+		ASSERT_EQ (btcnew::process_result::progress, node.ledger.process (transaction, *send1).code);
+		ASSERT_EQ (btcnew::process_result::progress, node.ledger.process (transaction, *send2).code);
+	}
+	auto channel1 (std::make_shared<btcnew::transport::channel_udp> (node.network.udp_channels, node.network.endpoint (), node.network_params.protocol.protocol_version));
+	auto channel2 (std::make_shared<btcnew::transport::channel_udp> (node.network.udp_channels, btcnew::endpoint (boost::asio::ip::address_v6::loopback (), 24001), node.network_params.protocol.protocol_version));
+	// Both channels request both blocks within the same window, in different order
+	ASSERT_FALSE (node.aggregator.add (channel1, { { send1->hash (), send1->root () }, { send2->hash (), send2->root () } }));
+	ASSERT_FALSE (node.aggregator.add (channel2, { { send2->hash (), send2->root () }, { send1->hash (), send1->root () } }));
+	system.deadline_set (3s);
+	while (node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_hashes) < 2)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	// A single vote covers every requested hash for all channels
+	ASSERT_EQ (2, node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_hashes));
+	ASSERT_EQ (1, node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_votes));
+}
+
+TEST (request_aggregator, channel_limit)
+{
+	btcnew::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	auto channel (std::make_shared<btcnew::transport::channel_udp> (node.network.udp_channels, node.network.endpoint (), node.network_params.protocol.protocol_version));
+	std::vector<std::pair<btcnew::block_hash, btcnew::root>> request (btcnew::request_aggregator::max_channel_requests + 1);
+	ASSERT_TRUE (node.aggregator.add (channel, request));
+	ASSERT_EQ (0, node.aggregator.size ());
+	ASSERT_EQ (1, node.stats.count (btcnew::stat::type::requests, btcnew::stat::detail::requests_dropped));
+}
@@ -140,3 +140,120 @@ TEST (socket, concurrent_writes)
 		t.join ();
 	}
 }
+
+TEST (socket, write_coalescing)
+{
+	btcnew::system system (24000, 1);
+	auto node (system.nodes[0]);
+
+	boost::asio::ip::tcp::endpoint endpoint (boost::asio::ip::address_v4::any (), 25000);
+	auto server_socket (std::make_shared<btcnew::server_socket> (node, endpoint, 1, btcnew::socket::concurrency::multi_writer));
+	boost::system::error_code ec;
+	server_socket->start (ec);
+	ASSERT_FALSE (ec);
+
+	std::shared_ptr<btcnew::socket> server_connection;
+	auto received (std::make_shared<std::vector<uint8_t>> (4));
+	std::atomic<bool> done (false);
+	server_socket->on_connection ([&server_connection, &received, &done] (std::shared_ptr<btcnew::socket> new_connection, boost::system::error_code const & ec_a) {
+		if (!ec_a)
+		{
+			server_connection = new_connection;
+			new_connection->async_read (received, received->size (), [&done] (boost::system::error_code const & ec_a, size_t size_a) {
+				done = !ec_a;
+			});
+		}
+		return true;
+	});
+
+	auto client (std::make_shared<btcnew::socket> (node, boost::none, btcnew::socket::concurrency::multi_writer));
+	std::atomic<bool> connected (false);
+	client->async_connect (boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v4::loopback (), 25000), [&connected] (boost::system::error_code const & ec_a) {
+		connected = !ec_a;
+	});
+	system.deadline_set (5s);
+	while (!connected)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+
+	// The first write goes out alone, the rest queue up behind it and are written together with the non droppable message first
+	size_t written (0);
+	for (auto byte : { 'a', 'b', 'c' })
+	{
+		client->async_write (btcnew::shared_const_buffer (static_cast<uint8_t> (byte)), [&written] (boost::system::error_code const & ec_a, size_t size_a) {
+			written += size_a;
+		});
+	}
+	client->async_write (btcnew::shared_const_buffer (static_cast<uint8_t> ('X')), [&written] (boost::system::error_code const & ec_a, size_t size_a) {
+		written += size_a;
+	},
+	false);
+	while (!done || written < 4)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (4, written);
+	ASSERT_EQ ("aXbc", std::string (received->begin (), received->end ()));
+
+	auto bins (node->stats.get_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_messages, btcnew::stat::dir::out)->get_bins ());
+	uint64_t single (0);
+	uint64_t coalesced (0);
+	for (auto & bin : bins)
+	{
+		(bin.start_inclusive == 1 ? single : coalesced) += bin.value;
+	}
+	ASSERT_GE (single, 1);
+	ASSERT_GE (coalesced, 1);
+}
+
+TEST (socket, priority_queue_overflow)
+{
+	btcnew::system system (24000, 1);
+	auto node (system.nodes[0]);
+
+	boost::asio::ip::tcp::endpoint endpoint (boost::asio::ip::address_v4::any (), 25000);
+	auto server_socket (std::make_shared<btcnew::server_socket> (node, endpoint, 1, btcnew::socket::concurrency::multi_writer));
+	boost::system::error_code ec;
+	server_socket->start (ec);
+	ASSERT_FALSE (ec);
+
+	std::shared_ptr<btcnew::socket> server_connection;
+	server_socket->on_connection ([&server_connection] (std::shared_ptr<btcnew::socket> new_connection, boost::system::error_code const & ec_a) {
+		if (!ec_a)
+		{
+			server_connection = new_connection;
+		}
+		return true;
+	});
+
+	auto client (std::make_shared<btcnew::socket> (node, boost::none, btcnew::socket::concurrency::multi_writer));
+	std::atomic<bool> connected (false);
+	client->async_connect (boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v4::loopback (), 25000), [&connected] (boost::system::error_code const & ec_a) {
+		connected = !ec_a;
+	});
+	system.deadline_set (5s);
+	while (!connected)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+
+	// The server never reads, once the socket buffers are full non droppable messages queue up until the socket is closed
+	btcnew::shared_const_buffer buffer (std::vector<uint8_t> (64 * 1024));
+	std::atomic<bool> overflow (false);
+	for (auto i (0); i < 4096; ++i)
+	{
+		client->async_write (buffer, [&overflow] (boost::system::error_code const & ec_a, size_t size_a) {
+			if (ec_a == boost::system::errc::no_buffer_space)
+			{
+				overflow = true;
+			}
+		},
+		false);
+	}
+	while (!overflow)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (1, node->stats.count (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_overflow, btcnew::stat::dir::out));
+}
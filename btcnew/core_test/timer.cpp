@@ -1,5 +1,6 @@
 #include <btcnew/core_test/testutil.hpp>
 #include <btcnew/lib/timer.hpp>
+#include <btcnew/lib/timer_wheel.hpp>
 
 #include <gtest/gtest.h>
 
@@ -70,3 +71,89 @@ TEST (timer, cummulative_child)
 
 	ASSERT_GT (t1.stop (), 100ms);
 }
+
+TEST (timer_wheel, ordering)
+{
+	auto start (std::chrono::steady_clock::now ());
+	btcnew::timer_wheel<int> wheel (std::chrono::milliseconds (10), start);
+	wheel.insert (2, start + std::chrono::milliseconds (25));
+	wheel.insert (1, start + std::chrono::milliseconds (10));
+	wheel.insert (0, start);
+	ASSERT_EQ (3, wheel.size ());
+	// Already due items are available without advancing
+	ASSERT_EQ (1, wheel.due_size ());
+	ASSERT_EQ (std::vector<int>{ 0 }, wheel.pop (10));
+	wheel.advance (start + std::chrono::milliseconds (15));
+	ASSERT_EQ (std::vector<int>{ 1 }, wheel.pop (10));
+	// Deadlines are rounded down to the start of their tick
+	wheel.advance (start + std::chrono::milliseconds (19));
+	ASSERT_TRUE (wheel.pop (10).empty ());
+	wheel.advance (start + std::chrono::milliseconds (20));
+	ASSERT_EQ (std::vector<int>{ 2 }, wheel.pop (10));
+	ASSERT_EQ (0, wheel.size ());
+}
+
+TEST (timer_wheel, cascade)
+{
+	auto start (std::chrono::steady_clock::now ());
+	btcnew::timer_wheel<size_t> wheel (std::chrono::milliseconds (1), start);
+	// Spread items across every level of the wheel
+	std::vector<size_t> deadlines{ 1, 63, 64, 65, 4095, 4096, 4097, 100000, 262143 };
+	for (auto deadline : deadlines)
+	{
+		wheel.insert (deadline, start + std::chrono::milliseconds (deadline));
+	}
+	for (auto deadline : deadlines)
+	{
+		wheel.advance (start + std::chrono::milliseconds (deadline - 1));
+		ASSERT_TRUE (wheel.pop (deadlines.size ()).empty ());
+		wheel.advance (start + std::chrono::milliseconds (deadline));
+		ASSERT_EQ (std::vector<size_t>{ deadline }, wheel.pop (deadlines.size ()));
+	}
+	ASSERT_EQ (0, wheel.size ());
+	// Deadlines past the range of the wheel expire early rather than being lost
+	wheel.insert (0, start + std::chrono::hours (1));
+	wheel.advance (start + std::chrono::milliseconds (262143 + (1 << 18)));
+	ASSERT_EQ (1, wheel.pop (1).size ());
+}
+
+TEST (timer_wheel, pop_limit)
+{
+	auto start (std::chrono::steady_clock::now ());
+	btcnew::timer_wheel<int> wheel (std::chrono::milliseconds (1), start);
+	for (auto i (0); i < 10; ++i)
+	{
+		wheel.insert (i, start);
+	}
+	ASSERT_EQ (4, wheel.pop (4).size ());
+	ASSERT_EQ (6, wheel.due_size ());
+	ASSERT_EQ (6, wheel.pop (10).size ());
+	wheel.insert (0, start + std::chrono::milliseconds (5));
+	wheel.clear ();
+	ASSERT_EQ (0, wheel.size ());
+	wheel.advance (start + std::chrono::milliseconds (5));
+	ASSERT_EQ (0, wheel.due_size ());
+}
+
+TEST (timer_wheel, erase)
+{
+	auto start (std::chrono::steady_clock::now ());
+	btcnew::timer_wheel<int> wheel (std::chrono::milliseconds (1), start);
+	wheel.insert (0, start + std::chrono::milliseconds (5));
+	wheel.insert (1, start + std::chrono::milliseconds (100));
+	wheel.insert (2, start + std::chrono::milliseconds (10000));
+	ASSERT_FALSE (wheel.erase (1));
+	ASSERT_TRUE (wheel.erase (1));
+	ASSERT_EQ (2, wheel.size ());
+	// Inserting again moves the item rather than adding a second entry
+	wheel.insert (2, start);
+	ASSERT_EQ (2, wheel.size ());
+	ASSERT_EQ (std::vector<int>{ 2 }, wheel.pop (10));
+	wheel.advance (start + std::chrono::milliseconds (10000));
+	ASSERT_EQ (std::vector<int>{ 0 }, wheel.pop (10));
+	ASSERT_EQ (0, wheel.size ());
+	// Due items can be erased before they are popped
+	wheel.insert (3, start);
+	ASSERT_FALSE (wheel.erase (3));
+	ASSERT_EQ (0, wheel.due_size ());
+}
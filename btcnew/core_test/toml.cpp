@@ -121,6 +121,8 @@ TEST (toml, daemon_config_deserialize_defaults)
 	[node.statistics.sampling]
 	[node.websocket]
 	[node.rocksdb]
+	[node.traffic_shaping]
+	[node.threading]
 	[opencl]
 	[rpc]
 	[rpc.child_process]
@@ -249,6 +251,32 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.rocksdb_config.memtable_size, defaults.node.rocksdb_config.memtable_size);
 	ASSERT_EQ (conf.node.rocksdb_config.num_memtables, defaults.node.rocksdb_config.num_memtables);
 	ASSERT_EQ (conf.node.rocksdb_config.total_memtable_size, defaults.node.rocksdb_config.total_memtable_size);
+
+	ASSERT_EQ (conf.node.traffic_shaping_config.enable, defaults.node.traffic_shaping_config.enable);
+	ASSERT_EQ (conf.node.traffic_shaping_config.inbound_limit, defaults.node.traffic_shaping_config.inbound_limit);
+	ASSERT_EQ (conf.node.traffic_shaping_config.outbound_limit, defaults.node.traffic_shaping_config.outbound_limit);
+	ASSERT_EQ (conf.node.traffic_shaping_config.peer_inbound_limit, defaults.node.traffic_shaping_config.peer_inbound_limit);
+	ASSERT_EQ (conf.node.traffic_shaping_config.vote_weight, defaults.node.traffic_shaping_config.vote_weight);
+	ASSERT_EQ (conf.node.traffic_shaping_config.publish_weight, defaults.node.traffic_shaping_config.publish_weight);
+	ASSERT_EQ (conf.node.traffic_shaping_config.keepalive_weight, defaults.node.traffic_shaping_config.keepalive_weight);
+	ASSERT_EQ (conf.node.traffic_shaping_config.bootstrap_weight, defaults.node.traffic_shaping_config.bootstrap_weight);
+	ASSERT_EQ (conf.node.traffic_shaping_config.ip_message_limit, defaults.node.traffic_shaping_config.ip_message_limit);
+	ASSERT_EQ (conf.node.traffic_shaping_config.node_id_message_limit, defaults.node.traffic_shaping_config.node_id_message_limit);
+	ASSERT_EQ (conf.node.traffic_shaping_config.penalty_close_score, defaults.node.traffic_shaping_config.penalty_close_score);
+	ASSERT_EQ (conf.node.traffic_shaping_config.penalty_exclude_score, defaults.node.traffic_shaping_config.penalty_exclude_score);
+	ASSERT_EQ (conf.node.traffic_shaping_config.penalty_exclude_time, defaults.node.traffic_shaping_config.penalty_exclude_time);
+
+	ASSERT_EQ (conf.node.threading_config.io_shards, defaults.node.threading_config.io_shards);
+	ASSERT_EQ (conf.node.threading_config.io_shard_cpus, defaults.node.threading_config.io_shard_cpus);
+	ASSERT_EQ (conf.node.threading_config.io_cpus, defaults.node.threading_config.io_cpus);
+	ASSERT_EQ (conf.node.threading_config.packet_processing_cpus, defaults.node.threading_config.packet_processing_cpus);
+	ASSERT_EQ (conf.node.threading_config.block_processing_cpus, defaults.node.threading_config.block_processing_cpus);
+	ASSERT_EQ (conf.node.threading_config.vote_processing_cpus, defaults.node.threading_config.vote_processing_cpus);
+	ASSERT_EQ (conf.node.threading_config.signature_checking_cpus, defaults.node.threading_config.signature_checking_cpus);
+	ASSERT_EQ (conf.node.threading_config.voting_cpus, defaults.node.threading_config.voting_cpus);
+	ASSERT_EQ (conf.node.threading_config.request_aggregator_cpus, defaults.node.threading_config.request_aggregator_cpus);
+	ASSERT_EQ (conf.node.threading_config.confirmation_height_cpus, defaults.node.threading_config.confirmation_height_cpus);
+	ASSERT_EQ (conf.node.threading_config.work_cpus, defaults.node.threading_config.work_cpus);
 }
 
 TEST (toml, optional_child)
@@ -493,6 +521,34 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	num_memtables = 3
 	total_memtable_size = 0
 
+	[node.traffic_shaping]
+	enable = true
+	inbound_limit = 999
+	outbound_limit = 999
+	peer_inbound_limit = 999
+	vote_weight = 999
+	publish_weight = 999
+	keepalive_weight = 999
+	bootstrap_weight = 999
+	ip_message_limit = 999
+	node_id_message_limit = 999
+	penalty_close_score = 999
+	penalty_exclude_score = 999
+	penalty_exclude_time = 999
+
+	[node.threading]
+	io_shards = 999
+	io_shard_cpus = "999"
+	io_cpus = "999"
+	packet_processing_cpus = "999"
+	block_processing_cpus = "999"
+	vote_processing_cpus = "999"
+	signature_checking_cpus = "999"
+	voting_cpus = "999"
+	request_aggregator_cpus = "999"
+	confirmation_height_cpus = "999"
+	work_cpus = "999"
+
 	[node.experimental]
 	secondary_work_peers = ["test.org:998"]
 
@@ -635,6 +691,32 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.rocksdb_config.memtable_size, defaults.node.rocksdb_config.memtable_size);
 	ASSERT_NE (conf.node.rocksdb_config.num_memtables, defaults.node.rocksdb_config.num_memtables);
 	ASSERT_NE (conf.node.rocksdb_config.total_memtable_size, defaults.node.rocksdb_config.total_memtable_size);
+
+	ASSERT_NE (conf.node.traffic_shaping_config.enable, defaults.node.traffic_shaping_config.enable);
+	ASSERT_NE (conf.node.traffic_shaping_config.inbound_limit, defaults.node.traffic_shaping_config.inbound_limit);
+	ASSERT_NE (conf.node.traffic_shaping_config.outbound_limit, defaults.node.traffic_shaping_config.outbound_limit);
+	ASSERT_NE (conf.node.traffic_shaping_config.peer_inbound_limit, defaults.node.traffic_shaping_config.peer_inbound_limit);
+	ASSERT_NE (conf.node.traffic_shaping_config.vote_weight, defaults.node.traffic_shaping_config.vote_weight);
+	ASSERT_NE (conf.node.traffic_shaping_config.publish_weight, defaults.node.traffic_shaping_config.publish_weight);
+	ASSERT_NE (conf.node.traffic_shaping_config.keepalive_weight, defaults.node.traffic_shaping_config.keepalive_weight);
+	ASSERT_NE (conf.node.traffic_shaping_config.bootstrap_weight, defaults.node.traffic_shaping_config.bootstrap_weight);
+	ASSERT_NE (conf.node.traffic_shaping_config.ip_message_limit, defaults.node.traffic_shaping_config.ip_message_limit);
+	ASSERT_NE (conf.node.traffic_shaping_config.node_id_message_limit, defaults.node.traffic_shaping_config.node_id_message_limit);
+	ASSERT_NE (conf.node.traffic_shaping_config.penalty_close_score, defaults.node.traffic_shaping_config.penalty_close_score);
+	ASSERT_NE (conf.node.traffic_shaping_config.penalty_exclude_score, defaults.node.traffic_shaping_config.penalty_exclude_score);
+	ASSERT_NE (conf.node.traffic_shaping_config.penalty_exclude_time, defaults.node.traffic_shaping_config.penalty_exclude_time);
+
+	ASSERT_NE (conf.node.threading_config.io_shards, defaults.node.threading_config.io_shards);
+	ASSERT_NE (conf.node.threading_config.io_shard_cpus, defaults.node.threading_config.io_shard_cpus);
+	ASSERT_NE (conf.node.threading_config.io_cpus, defaults.node.threading_config.io_cpus);
+	ASSERT_NE (conf.node.threading_config.packet_processing_cpus, defaults.node.threading_config.packet_processing_cpus);
+	ASSERT_NE (conf.node.threading_config.block_processing_cpus, defaults.node.threading_config.block_processing_cpus);
+	ASSERT_NE (conf.node.threading_config.vote_processing_cpus, defaults.node.threading_config.vote_processing_cpus);
+	ASSERT_NE (conf.node.threading_config.signature_checking_cpus, defaults.node.threading_config.signature_checking_cpus);
+	ASSERT_NE (conf.node.threading_config.voting_cpus, defaults.node.threading_config.voting_cpus);
+	ASSERT_NE (conf.node.threading_config.request_aggregator_cpus, defaults.node.threading_config.request_aggregator_cpus);
+	ASSERT_NE (conf.node.threading_config.confirmation_height_cpus, defaults.node.threading_config.confirmation_height_cpus);
+	ASSERT_NE (conf.node.threading_config.work_cpus, defaults.node.threading_config.work_cpus);
 }
 
 /** There should be no required values **/
@@ -654,6 +736,8 @@ TEST (toml, daemon_config_no_required)
 	[node.statistics.sampling]
 	[node.websocket]
 	[node.rocksdb]
+	[node.traffic_shaping]
+	[node.threading]
 	[opencl]
 	[rpc]
 	[rpc.child_process]
@@ -1,3 +1,4 @@
+#include <btcnew/lib/stats.hpp>
 #include <btcnew/lib/timer.hpp>
 #include <btcnew/lib/utility.hpp>
 #include <btcnew/secure/utility.hpp>
@@ -82,3 +83,51 @@ TEST (filesystem, move_all_files)
 	ASSERT_FALSE (boost::filesystem::exists (dummy_file1));
 	ASSERT_FALSE (boost::filesystem::exists (dummy_file2));
 }
+
+TEST (stats, histogram)
+{
+	btcnew::stat stats;
+	// Range split into bins of equal width
+	stats.define_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, { 1, 13 }, 12);
+	auto batch_size (stats.get_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out));
+	ASSERT_NE (nullptr, batch_size);
+	ASSERT_EQ (12, batch_size->get_bins ().size ());
+	stats.update_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, 1);
+	stats.update_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, 12, 3);
+	// Values beyond the range are added to the last bin
+	stats.update_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, 20);
+	auto bins (batch_size->get_bins ());
+	ASSERT_EQ (1, bins[0].value);
+	ASSERT_EQ (0, bins[1].value);
+	ASSERT_EQ (12, bins[11].start_inclusive);
+	ASSERT_EQ (4, bins[11].value);
+
+	// Explicit intervals
+	stats.define_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_queue_delay, btcnew::stat::dir::out, { 0, 10, 100, 1000 });
+	for (auto value : { 5, 10, 99, 5000 })
+	{
+		stats.update_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_queue_delay, btcnew::stat::dir::out, value);
+	}
+	bins = stats.get_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_queue_delay, btcnew::stat::dir::out)->get_bins ();
+	ASSERT_EQ (3, bins.size ());
+	ASSERT_EQ (1, bins[0].value);
+	ASSERT_EQ (2, bins[1].value);
+	ASSERT_EQ (1, bins[2].value);
+
+	// Updating an undefined histogram is a no-op
+	stats.update_histogram (btcnew::stat::type::vote, btcnew::stat::detail::vote_valid, btcnew::stat::dir::in, 1);
+	ASSERT_EQ (nullptr, stats.get_histogram (btcnew::stat::type::vote, btcnew::stat::detail::vote_valid, btcnew::stat::dir::in));
+
+	// Clearing resets the values but keeps the definitions
+	stats.clear ();
+	ASSERT_EQ (batch_size, stats.get_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out));
+	for (auto & bin : batch_size->get_bins ())
+	{
+		ASSERT_EQ (0, bin.value);
+	}
+
+	// Defining it again keeps the existing histogram, as other threads may be updating it
+	stats.define_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, { 1, 5 }, 4);
+	ASSERT_EQ (batch_size, stats.get_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out));
+	ASSERT_EQ (12, batch_size->get_bins ().size ());
+}
@@ -1134,7 +1134,7 @@ TEST (wallet, work_watcher_update)
 	auto multiplier = btcnew::difficulty::to_multiplier (std::max (difficulty1, difficulty2), node.network_params.network.publish_threshold);
 	uint64_t updated_difficulty1{ difficulty1 }, updated_difficulty2{ difficulty2 };
 	{
-		btcnew::unique_lock<std::mutex> lock (node.active.mutex);
+		std::unique_lock<btcnew::elections_mutex> lock (node.active.mutex);
 		// Prevent active difficulty repopulating multipliers
 		node.network_params.network.request_interval_ms = 10000;
 		//fill multipliers_cb and update active difficulty;
@@ -1148,17 +1148,17 @@ TEST (wallet, work_watcher_update)
 	while (updated_difficulty1 == difficulty1 || updated_difficulty2 == difficulty2)
 	{
 		{
-			btcnew::lock_guard<std::mutex> guard (node.active.mutex);
+			btcnew::lock_guard<btcnew::elections_mutex> guard (node.active.mutex);
 			{
-				auto const existing (node.active.roots.find (block1->qualified_root ()));
+				auto const existing (node.active.find_root (block1->qualified_root ()));
 				//if existing is junk the block has been confirmed already
-				ASSERT_NE (existing, node.active.roots.end ());
+				ASSERT_NE (existing, nullptr);
 				updated_difficulty1 = existing->difficulty;
 			}
 			{
-				auto const existing (node.active.roots.find (block2->qualified_root ()));
+				auto const existing (node.active.find_root (block2->qualified_root ()));
 				//if existing is junk the block has been confirmed already
-				ASSERT_NE (existing, node.active.roots.end ());
+				ASSERT_NE (existing, nullptr);
 				updated_difficulty2 = existing->difficulty;
 			}
 		}
@@ -1188,7 +1188,7 @@ TEST (wallet, work_watcher_generation_disabled)
 	auto multiplier = btcnew::difficulty::to_multiplier (difficulty, node.network_params.network.publish_threshold);
 	uint64_t updated_difficulty{ difficulty };
 	{
-		btcnew::unique_lock<std::mutex> lock (node.active.mutex);
+		std::unique_lock<btcnew::elections_mutex> lock (node.active.mutex);
 		// Prevent active difficulty repopulating multipliers
 		node.network_params.network.request_interval_ms = 10000;
 		//fill multipliers_cb and update active difficulty;
@@ -1200,11 +1200,11 @@ TEST (wallet, work_watcher_generation_disabled)
 	}
 	std::this_thread::sleep_for (5s);
 
-	btcnew::lock_guard<std::mutex> guard (node.active.mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (node.active.mutex);
 	{
-		auto const existing (node.active.roots.find (block->qualified_root ()));
+		auto const existing (node.active.find_root (block->qualified_root ()));
 		//if existing is junk the block has been confirmed already
-		ASSERT_NE (existing, node.active.roots.end ());
+		ASSERT_NE (existing, nullptr);
 		updated_difficulty = existing->difficulty;
 	}
 	ASSERT_EQ (updated_difficulty, difficulty);
@@ -1249,7 +1249,7 @@ TEST (wallet, work_watcher_cancel)
 	uint64_t difficulty1 (0);
 	btcnew::work_validate (*block1, &difficulty1);
 	{
-		btcnew::unique_lock<std::mutex> lock (node.active.mutex);
+		std::unique_lock<btcnew::elections_mutex> lock (node.active.mutex);
 		// Prevent active difficulty repopulating multipliers
 		node.network_params.network.request_interval_ms = 10000;
 		// Fill multipliers_cb and update active difficulty;
@@ -189,7 +189,7 @@ TEST (websocket, active_difficulty)
 
 	// Fake history records to force trended_active_difficulty change
 	{
-		btcnew::unique_lock<std::mutex> lock (node1->active.mutex);
+		std::unique_lock<btcnew::elections_mutex> lock (node1->active.mutex);
 		node1->active.multipliers_cb.push_front (10.);
 	}
 
@@ -224,6 +224,105 @@ TEST (websocket, active_difficulty)
 	node1->stop ();
 }
 
+/** Subscribes to latency reports and awaits the next periodic message */
+TEST (websocket, latency)
+{
+	btcnew::system system (24000, 1);
+	btcnew::node_config config;
+	btcnew::node_flags node_flags;
+	config.websocket_config.enabled = true;
+	config.websocket_config.port = 24078;
+
+	auto node1 (std::make_shared<btcnew::node> (system.io_ctx, btcnew::unique_path (), system.alarm, config, system.work, node_flags));
+	node1->start ();
+	system.nodes.push_back (node1);
+
+	ack_ready = false;
+	auto client_task = ([] () -> boost::optional<std::string> {
+		auto response = websocket_test_call ("::1", "24078", R"json({"action": "subscribe", "topic": "latency", "ack": true})json", true, true);
+		return response;
+	});
+	auto client_future = std::async (std::launch::async, client_task);
+
+	system.deadline_set (5s);
+	while (!ack_ready)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (1, node1->websocket_server->subscriber_count (btcnew::websocket::topic::latency));
+
+	// Reports are sent every latency_report_interval
+	system.deadline_set (5s);
+	while (client_future.wait_for (std::chrono::seconds (0)) != std::future_status::ready)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+
+	auto response = client_future.get ();
+	ASSERT_TRUE (response);
+	std::stringstream stream;
+	stream << response;
+	boost::property_tree::ptree event;
+	boost::property_tree::read_json (stream, event);
+	ASSERT_EQ (event.get<std::string> ("topic"), "latency");
+
+	auto message_contents = event.get_child ("message");
+	ASSERT_EQ (btcnew::latency_tracker::stages.size (), message_contents.size ());
+	ASSERT_EQ ("0", message_contents.get<std::string> ("total.count"));
+	ASSERT_EQ ("0", message_contents.get<std::string> ("total.p99"));
+
+	node1->stop ();
+}
+
+/** Subscribes to message statistics and awaits the next periodic message */
+TEST (websocket, message_stats)
+{
+	btcnew::system system (24000, 1);
+	btcnew::node_config config;
+	btcnew::node_flags node_flags;
+	config.websocket_config.enabled = true;
+	config.websocket_config.port = 24078;
+
+	auto node1 (std::make_shared<btcnew::node> (system.io_ctx, btcnew::unique_path (), system.alarm, config, system.work, node_flags));
+	node1->start ();
+	system.nodes.push_back (node1);
+
+	ack_ready = false;
+	auto client_task = ([] () -> boost::optional<std::string> {
+		auto response = websocket_test_call ("::1", "24078", R"json({"action": "subscribe", "topic": "message_stats", "ack": true})json", true, true);
+		return response;
+	});
+	auto client_future = std::async (std::launch::async, client_task);
+
+	system.deadline_set (5s);
+	while (!ack_ready)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (1, node1->websocket_server->subscriber_count (btcnew::websocket::topic::message_stats));
+
+	// Reports are sent along with latency reports
+	system.deadline_set (5s);
+	while (client_future.wait_for (std::chrono::seconds (0)) != std::future_status::ready)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+
+	auto response = client_future.get ();
+	ASSERT_TRUE (response);
+	std::stringstream stream;
+	stream << response;
+	boost::property_tree::ptree event;
+	boost::property_tree::read_json (stream, event);
+	ASSERT_EQ (event.get<std::string> ("topic"), "message_stats");
+
+	auto message_contents = event.get_child ("message");
+	ASSERT_TRUE (message_contents.get_child_optional ("udp"));
+	ASSERT_TRUE (message_contents.get_child_optional ("tcp"));
+
+	node1->stop ();
+}
+
 /** Subscribes to block confirmations, confirms a block and then awaits websocket notification */
 TEST (websocket, confirmation)
 {
@@ -181,3 +181,22 @@ void unique_lock<Mutex, U>::validate () const
 template class unique_lock<std::mutex>;
 }
 #endif
+
+void btcnew::lock_counted (std::mutex & mutex_a, btcnew::lock_counters & counters_a)
+{
+	if (!mutex_a.try_lock ())
+	{
+		auto start (std::chrono::steady_clock::now ());
+		mutex_a.lock ();
+		auto blocked (std::chrono::steady_clock::now () - start);
+		++counters_a.contended;
+		counters_a.blocked_us += std::chrono::duration_cast<std::chrono::microseconds> (blocked).count ();
+#if BTCNEW_TIMED_LOCKS > 0
+		if (blocked >= std::chrono::milliseconds (BTCNEW_TIMED_LOCKS))
+		{
+			output ("blocked", std::chrono::duration_cast<std::chrono::milliseconds> (blocked), mutex_a);
+		}
+#endif
+	}
+	++counters_a.acquired;
+}
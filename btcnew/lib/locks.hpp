@@ -2,6 +2,7 @@
 
 #include <btcnew/lib/timer.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <unordered_map>
@@ -79,4 +80,18 @@ using unique_lock = std::unique_lock<Mutex>;
 
 // For consistency wrapping the less well known _any variant which can be used with any lockable type
 using condition_variable = std::condition_variable_any;
+
+/** Acquisition statistics of a mutex, updated by lock_counted */
+class lock_counters final
+{
+public:
+	std::atomic<uint64_t> acquired{ 0 };
+	// Acquisitions which found the mutex held by another thread
+	std::atomic<uint64_t> contended{ 0 };
+	// Total time spent waiting in contended acquisitions
+	std::atomic<uint64_t> blocked_us{ 0 };
+};
+
+/** Locks \p mutex_a, recording in \p counters_a whether it had to wait for another holder and for how long */
+void lock_counted (std::mutex & mutex_a, btcnew::lock_counters & counters_a);
 }
@@ -6,3 +6,9 @@ void btcnew::thread_role::set_os_name (std::string const & thread_name)
 {
 	pthread_setname_np (thread_name.c_str ());
 }
+
+bool btcnew::thread_role::set_os_affinity (std::vector<unsigned> const &)
+{
+	// macOS only offers affinity hints between threads, not pinning to CPUs
+	return true;
+}
@@ -1,5 +1,8 @@
 #include <btcnew/lib/utility.hpp>
 
+#include <sys/param.h>
+#include <sys/cpuset.h>
+
 #include <pthread.h>
 #include <pthread_np.h>
 
@@ -7,3 +10,17 @@ void btcnew::thread_role::set_os_name (std::string const & thread_name)
 {
 	pthread_set_name_np (pthread_self (), thread_name.c_str ());
 }
+
+bool btcnew::thread_role::set_os_affinity (std::vector<unsigned> const & cpus)
+{
+	cpuset_t set;
+	CPU_ZERO (&set);
+	for (auto cpu : cpus)
+	{
+		if (cpu < CPU_SETSIZE)
+		{
+			CPU_SET (cpu, &set);
+		}
+	}
+	return pthread_setaffinity_np (pthread_self (), sizeof (set), &set) != 0;
+}
@@ -6,3 +6,17 @@ void btcnew::thread_role::set_os_name (std::string const & thread_name)
 {
 	pthread_setname_np (pthread_self (), thread_name.c_str ());
 }
+
+bool btcnew::thread_role::set_os_affinity (std::vector<unsigned> const & cpus)
+{
+	cpu_set_t set;
+	CPU_ZERO (&set);
+	for (auto cpu : cpus)
+	{
+		if (cpu < CPU_SETSIZE)
+		{
+			CPU_SET (cpu, &set);
+		}
+	}
+	return pthread_setaffinity_np (pthread_self (), sizeof (set), &set) != 0;
+}
@@ -13,3 +13,16 @@ void btcnew::thread_role::set_os_name (std::string const & thread_name)
 		SetThreadDescription_local (GetCurrentThread (), thread_name_wide.c_str ());
 	}
 }
+
+bool btcnew::thread_role::set_os_affinity (std::vector<unsigned> const & cpus)
+{
+	DWORD_PTR mask (0);
+	for (auto cpu : cpus)
+	{
+		if (cpu < sizeof (mask) * 8)
+		{
+			mask |= DWORD_PTR (1) << cpu;
+		}
+	}
+	return mask == 0 || SetThreadAffinityMask (GetCurrentThread (), mask) == 0;
+}
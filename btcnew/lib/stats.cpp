@@ -5,6 +5,7 @@
 #include <boost/format.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include <algorithm>
 #include <ctime>
 #include <fstream>
 #include <iostream>
@@ -131,6 +132,19 @@ public:
 		entries.push_back (std::make_pair ("", entry));
 	}
 
+	void write_histogram_bin (tm & tm, std::string const & type, std::string const & detail, std::string const & dir, btcnew::stat_histogram::bin const & bin) override
+	{
+		boost::property_tree::ptree entry;
+		entry.put ("time", boost::format ("%02d:%02d:%02d") % tm.tm_hour % tm.tm_min % tm.tm_sec);
+		entry.put ("type", type);
+		entry.put ("detail", detail);
+		entry.put ("dir", dir);
+		entry.put ("start_inclusive", bin.start_inclusive);
+		entry.put ("end_exclusive", bin.end_exclusive);
+		entry.put ("value", bin.value);
+		entries.push_back (std::make_pair ("", entry));
+	}
+
 	void finalize () override
 	{
 		tree.add_child ("entries", entries);
@@ -184,6 +198,11 @@ public:
 		log << boost::format ("%02d:%02d:%02d") % tm.tm_hour % tm.tm_min % tm.tm_sec << "," << type << "," << detail << "," << dir << "," << value << std::endl;
 	}
 
+	void write_histogram_bin (tm & tm, std::string const & type, std::string const & detail, std::string const & dir, btcnew::stat_histogram::bin const & bin) override
+	{
+		log << boost::format ("%02d:%02d:%02d") % tm.tm_hour % tm.tm_min % tm.tm_sec << "," << type << "," << detail << "," << dir << "," << bin.start_inclusive << "," << bin.end_exclusive << "," << bin.value << std::endl;
+	}
+
 	void rotate () override
 	{
 		log.close ();
@@ -192,11 +211,93 @@ public:
 	}
 };
 
+btcnew::stat_histogram::stat_histogram (std::initializer_list<uint64_t> intervals_a, size_t bin_count_a)
+{
+	if (bin_count_a == 0)
+	{
+		assert (intervals_a.size () > 1);
+		uint64_t start_inclusive_l (*intervals_a.begin ());
+		for (auto it = std::next (intervals_a.begin ()); it != intervals_a.end (); ++it)
+		{
+			uint64_t end_exclusive_l (*it);
+			bins.emplace_back (start_inclusive_l, end_exclusive_l);
+			start_inclusive_l = end_exclusive_l;
+		}
+	}
+	else
+	{
+		assert (intervals_a.size () == 2);
+		uint64_t min_inclusive_l (*intervals_a.begin ());
+		uint64_t max_exclusive_l (*std::next (intervals_a.begin ()));
+		assert (max_exclusive_l > min_inclusive_l);
+		auto bin_size_l ((max_exclusive_l - min_inclusive_l + bin_count_a - 1) / bin_count_a);
+		for (auto start_l (min_inclusive_l); start_l < max_exclusive_l; start_l += bin_size_l)
+		{
+			bins.emplace_back (start_l, std::min (start_l + bin_size_l, max_exclusive_l));
+		}
+	}
+}
+
+void btcnew::stat_histogram::add (uint64_t index_a, uint64_t addend_a)
+{
+	btcnew::lock_guard<std::mutex> lock (histogram_mutex);
+	assert (!bins.empty ());
+
+	// Values outside of the histogram's range are placed in the first or last bin
+	auto & bin (index_a < bins.front ().start_inclusive ? bins.front () : (index_a >= bins.back ().end_exclusive ? bins.back () : *std::upper_bound (bins.begin (), bins.end (), index_a, [] (uint64_t index_a, btcnew::stat_histogram::bin const & bin_a) { return index_a < bin_a.end_exclusive; })));
+	bin.value += addend_a;
+	bin.timestamp = std::chrono::system_clock::now ();
+}
+
+std::vector<btcnew::stat_histogram::bin> btcnew::stat_histogram::get_bins () const
+{
+	btcnew::lock_guard<std::mutex> lock (histogram_mutex);
+	return bins;
+}
+
+void btcnew::stat_histogram::clear ()
+{
+	btcnew::lock_guard<std::mutex> lock (histogram_mutex);
+	for (auto & bin : bins)
+	{
+		bin.value = 0;
+		bin.timestamp = std::chrono::system_clock::now ();
+	}
+}
+
 btcnew::stat::stat (btcnew::stat_config config) :
 config (config)
 {
 }
 
+void btcnew::stat::define_histogram (stat::type type, stat::detail detail, stat::dir dir, std::initializer_list<uint64_t> intervals_a, size_t bin_count_a)
+{
+	// Histograms are updated concurrently, so they are only created under stat_mutex and never replaced once defined
+	btcnew::lock_guard<std::mutex> lock (stat_mutex);
+	auto entry (get_entry_impl (key_of (type, detail, dir), config.interval, config.capacity));
+	if (entry->histogram == nullptr)
+	{
+		entry->histogram = std::make_unique<btcnew::stat_histogram> (intervals_a, bin_count_a);
+	}
+}
+
+void btcnew::stat::update_histogram (stat::type type, stat::detail detail, stat::dir dir, uint64_t index_a, uint64_t addend_a)
+{
+	btcnew::lock_guard<std::mutex> lock (stat_mutex);
+	auto entry (get_entry_impl (key_of (type, detail, dir), config.interval, config.capacity));
+	if (entry->histogram != nullptr)
+	{
+		entry->histogram->add (index_a, addend_a);
+	}
+}
+
+btcnew::stat_histogram * btcnew::stat::get_histogram (stat::type type, stat::detail detail, stat::dir dir)
+{
+	btcnew::lock_guard<std::mutex> lock (stat_mutex);
+	auto entry (get_entry_impl (key_of (type, detail, dir), config.interval, config.capacity));
+	return entry->histogram.get ();
+}
+
 std::shared_ptr<btcnew::stat_entry> btcnew::stat::get_entry (uint32_t key)
 {
 	return get_entry (key, config.interval, config.capacity);
@@ -302,6 +403,41 @@ void btcnew::stat::log_samples_impl (stat_log_sink & sink)
 	sink.finalize ();
 }
 
+void btcnew::stat::log_histograms (stat_log_sink & sink)
+{
+	btcnew::unique_lock<std::mutex> lock (stat_mutex);
+	sink.begin ();
+	if (sink.entries () >= config.log_rotation_count)
+	{
+		sink.rotate ();
+	}
+
+	if (config.log_headers)
+	{
+		auto walltime (std::chrono::system_clock::now ());
+		sink.write_header ("histograms", walltime);
+	}
+
+	for (auto & it : entries)
+	{
+		if (it.second->histogram != nullptr)
+		{
+			auto key = it.first;
+			std::string type = type_to_string (key);
+			std::string detail = detail_to_string (key);
+			std::string dir = dir_to_string (key);
+			for (auto & bin : it.second->histogram->get_bins ())
+			{
+				std::time_t time = std::chrono::system_clock::to_time_t (bin.timestamp);
+				tm local_tm = *localtime (&time);
+				sink.write_histogram_bin (local_tm, type, detail, dir, bin);
+			}
+		}
+	}
+	sink.entries ()++;
+	sink.finalize ();
+}
+
 void btcnew::stat::update (uint32_t key_a, uint64_t value)
 {
 	static file_writer log_count (config.log_counters_filename);
@@ -375,7 +511,19 @@ void btcnew::stat::stop ()
 void btcnew::stat::clear ()
 {
 	btcnew::unique_lock<std::mutex> lock (stat_mutex);
-	entries.clear ();
+	// Histograms are defined once by their owners, so keep the definitions and only reset their values
+	decltype (entries) histograms_l;
+	for (auto & it : entries)
+	{
+		if (it.second->histogram != nullptr)
+		{
+			it.second->histogram->clear ();
+			auto entry (std::make_shared<btcnew::stat_entry> (config.capacity, config.interval));
+			entry->histogram = std::move (it.second->histogram);
+			histograms_l.emplace (it.first, entry);
+		}
+	}
+	entries.swap (histograms_l);
 	timestamp = std::chrono::steady_clock::now ();
 }
 
@@ -438,6 +586,24 @@ std::string btcnew::stat::type_to_string (uint32_t key)
 			break;
 		case btcnew::stat::type::drop:
 			res = "drop";
+			break;
+		case btcnew::stat::type::requests:
+			res = "requests";
+			break;
+		case btcnew::stat::type::vote_generator:
+			res = "vote_generator";
+			break;
+		case btcnew::stat::type::latency:
+			res = "latency";
+			break;
+		case btcnew::stat::type::filter:
+			res = "filter";
+			break;
+		case btcnew::stat::type::traffic_shaper:
+			res = "traffic_shaper";
+			break;
+		case btcnew::stat::type::peer_limiter:
+			res = "peer_limiter";
 	}
 	return res;
 }
@@ -577,12 +743,39 @@ std::string btcnew::stat::detail_to_string (uint32_t key)
 		case btcnew::stat::detail::vote_cached:
 			res = "vote_cached";
 			break;
+		case btcnew::stat::detail::vote_cache_evicted:
+			res = "vote_cache_evicted";
+			break;
+		case btcnew::stat::detail::vote_cache_voter_dropped:
+			res = "vote_cache_voter_dropped";
+			break;
 		case btcnew::stat::detail::late_block:
 			res = "late_block";
 			break;
 		case btcnew::stat::detail::late_block_seconds:
 			res = "late_block_seconds";
 			break;
+		case btcnew::stat::detail::scheduler_queued:
+			res = "scheduler_queued";
+			break;
+		case btcnew::stat::detail::scheduler_dropped:
+			res = "scheduler_dropped";
+			break;
+		case btcnew::stat::detail::scheduler_activated:
+			res = "scheduler_activated";
+			break;
+		case btcnew::stat::detail::shard_lock_contended:
+			res = "shard_lock_contended";
+			break;
+		case btcnew::stat::detail::shard_lock_blocked_us:
+			res = "shard_lock_blocked_us";
+			break;
+		case btcnew::stat::detail::elections_lock_contended:
+			res = "elections_lock_contended";
+			break;
+		case btcnew::stat::detail::elections_lock_blocked_us:
+			res = "elections_lock_blocked_us";
+			break;
 		case btcnew::stat::detail::blocking:
 			res = "blocking";
 			break;
@@ -598,6 +791,18 @@ std::string btcnew::stat::detail_to_string (uint32_t key)
 		case btcnew::stat::detail::tcp_write_drop:
 			res = "tcp_write_drop";
 			break;
+		case btcnew::stat::detail::tcp_write_overflow:
+			res = "tcp_write_overflow";
+			break;
+		case btcnew::stat::detail::tcp_queue_depth:
+			res = "tcp_queue_depth";
+			break;
+		case btcnew::stat::detail::tcp_write_bytes:
+			res = "tcp_write_bytes";
+			break;
+		case btcnew::stat::detail::tcp_write_messages:
+			res = "tcp_write_messages";
+			break;
 		case btcnew::stat::detail::unreachable_host:
 			res = "unreachable_host";
 			break;
@@ -631,11 +836,89 @@ std::string btcnew::stat::detail_to_string (uint32_t key)
 		case btcnew::stat::detail::outdated_version:
 			res = "outdated_version";
 			break;
+		case btcnew::stat::detail::packets_per_syscall:
+			res = "packets_per_syscall";
+			break;
 		case btcnew::stat::detail::invalid_block:
 			res = "invalid_block";
 			break;
 		case btcnew::stat::detail::blocks_confirmed:
 			res = "blocks_confirmed";
+			break;
+		case btcnew::stat::detail::requests_cached_hashes:
+			res = "requests_cached_hashes";
+			break;
+		case btcnew::stat::detail::requests_generated_hashes:
+			res = "requests_generated_hashes";
+			break;
+		case btcnew::stat::detail::requests_generated_votes:
+			res = "requests_generated_votes";
+			break;
+		case btcnew::stat::detail::requests_dropped:
+			res = "requests_dropped";
+			break;
+		case btcnew::stat::detail::generator_batch_size:
+			res = "generator_batch_size";
+			break;
+		case btcnew::stat::detail::generator_queue_delay:
+			res = "generator_queue_delay";
+			break;
+		case btcnew::stat::detail::enqueue:
+			res = "enqueue";
+			break;
+		case btcnew::stat::detail::dequeue:
+			res = "dequeue";
+			break;
+		case btcnew::stat::detail::ledger_process:
+			res = "ledger_process";
+			break;
+		case btcnew::stat::detail::election_start:
+			res = "election_start";
+			break;
+		case btcnew::stat::detail::quorum:
+			res = "quorum";
+			break;
+		case btcnew::stat::detail::cemented:
+			res = "cemented";
+			break;
+		case btcnew::stat::detail::observers:
+			res = "observers";
+			break;
+		case btcnew::stat::detail::total:
+			res = "total";
+			break;
+		case btcnew::stat::detail::duplicate_publish:
+			res = "duplicate_publish";
+			break;
+		case btcnew::stat::detail::vote_class:
+			res = "vote_class";
+			break;
+		case btcnew::stat::detail::publish_class:
+			res = "publish_class";
+			break;
+		case btcnew::stat::detail::keepalive_class:
+			res = "keepalive_class";
+			break;
+		case btcnew::stat::detail::bootstrap_class:
+			res = "bootstrap_class";
+			break;
+		case btcnew::stat::detail::peer_bucket:
+			res = "peer_bucket";
+			break;
+		case btcnew::stat::detail::ip_bucket:
+			res = "ip_bucket";
+			break;
+		case btcnew::stat::detail::node_id_bucket:
+			res = "node_id_bucket";
+			break;
+		case btcnew::stat::detail::excluded_address:
+			res = "excluded_address";
+			break;
+		case btcnew::stat::detail::penalty_close:
+			res = "penalty_close";
+			break;
+		case btcnew::stat::detail::penalty_exclude:
+			res = "penalty_exclude";
 	}
 	return res;
 }
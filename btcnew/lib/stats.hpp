@@ -9,11 +9,13 @@
 
 #include <atomic>
 #include <chrono>
+#include <initializer_list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace btcnew
 {
@@ -118,6 +120,45 @@ private:
 	std::chrono::system_clock::time_point timestamp{ std::chrono::system_clock::now () };
 };
 
+/** Histogram of values, counting how many fall into each bin */
+class stat_histogram final
+{
+public:
+	/**
+	 * Create a histogram from a set of intervals
+	 * @param intervals_a Bin boundaries, each bin is inclusive of its start and exclusive of its end. {1, 5, 8, 15} gives the bins [1, 5), [5, 8) and [8, 15)
+	 * @param bin_count_a If zero, \p intervals_a defines every bin. Otherwise \p intervals_a is the start and end of the range, split into \p bin_count_a bins of equal width
+	 */
+	stat_histogram (std::initializer_list<uint64_t> intervals_a, size_t bin_count_a = 0);
+
+	/** Add \p addend_a to the bin \p index_a falls into, values outside the range are added to the first or last bin */
+	void add (uint64_t index_a, uint64_t addend_a);
+
+	class bin final
+	{
+	public:
+		bin (uint64_t start_inclusive_a, uint64_t end_exclusive_a) :
+		start_inclusive (start_inclusive_a), end_exclusive (end_exclusive_a)
+		{
+		}
+		uint64_t start_inclusive;
+		uint64_t end_exclusive;
+		uint64_t value{ 0 };
+		/** When a value was last added to the bin */
+		std::chrono::system_clock::time_point timestamp{ std::chrono::system_clock::now () };
+	};
+
+	/** Returns a copy of the bins */
+	std::vector<bin> get_bins () const;
+
+	/** Reset the value of every bin */
+	void clear ();
+
+private:
+	mutable std::mutex histogram_mutex;
+	std::vector<bin> bins;
+};
+
 /** Bookkeeping of statistics for a specific type/detail/direction combination */
 class stat_entry final
 {
@@ -147,6 +188,9 @@ public:
 
 	/** Observers for count. Called on each update. */
 	btcnew::observer_set<uint64_t, uint64_t> count_observers;
+
+	/** Optional histogram, only allocated for entries which define one */
+	std::unique_ptr<btcnew::stat_histogram> histogram;
 };
 
 /** Log sink interface */
@@ -178,6 +222,11 @@ public:
 	{
 	}
 
+	/** Write a histogram bin to the log */
+	virtual void write_histogram_bin (tm & tm, std::string const & type, std::string const & detail, std::string const & dir, btcnew::stat_histogram::bin const & bin)
+	{
+	}
+
 	/** Rotates the log (e.g. empty file). This is a no-op for sinks where rotation is not supported. */
 	virtual void rotate ()
 	{
@@ -237,7 +286,13 @@ public:
 		udp,
 		observer,
 		confirmation_height,
-		drop
+		drop,
+		requests,
+		vote_generator,
+		latency,
+		filter,
+		traffic_shaper,
+		peer_limiter
 	};
 
 	/** Optional detail type */
@@ -301,8 +356,17 @@ public:
 		// election specific
 		vote_new,
 		vote_cached,
+		vote_cache_evicted,
+		vote_cache_voter_dropped,
 		late_block,
 		late_block_seconds,
+		scheduler_queued,
+		scheduler_dropped,
+		scheduler_activated,
+		shard_lock_contended,
+		shard_lock_blocked_us,
+		elections_lock_contended,
+		elections_lock_blocked_us,
 
 		// udp
 		blocking,
@@ -317,11 +381,16 @@ public:
 		invalid_confirm_ack_message,
 		invalid_node_id_handshake_message,
 		outdated_version,
+		packets_per_syscall,
 
 		// tcp
 		tcp_accept_success,
 		tcp_accept_failure,
 		tcp_write_drop,
+		tcp_write_overflow,
+		tcp_queue_depth,
+		tcp_write_bytes,
+		tcp_write_messages,
 
 		// ipc
 		invocations,
@@ -331,7 +400,44 @@ public:
 
 		// confirmation height
 		blocks_confirmed,
-		invalid_block
+		invalid_block,
+
+		// request aggregator
+		requests_cached_hashes,
+		requests_generated_hashes,
+		requests_generated_votes,
+		requests_dropped,
+
+		// vote generator
+		generator_batch_size,
+		generator_queue_delay,
+
+		// latency tracker
+		enqueue,
+		dequeue,
+		ledger_process,
+		election_start,
+		quorum,
+		cemented,
+		observers,
+		total,
+
+		// filter
+		duplicate_publish,
+
+		// traffic shaper
+		vote_class,
+		publish_class,
+		keepalive_class,
+		bootstrap_class,
+		peer_bucket,
+
+		// peer limiter
+		ip_bucket,
+		node_id_bucket,
+		excluded_address,
+		penalty_close,
+		penalty_exclude
 	};
 
 	/** Direction of the stat. If the direction is irrelevant, use in */
@@ -448,6 +554,20 @@ public:
 		return &get_entry (key_of (type, detail, dir))->samples;
 	}
 
+	/**
+	 * Define a histogram for the given type, detail and direction combination. Values are added with update_histogram.
+	 * This must be called before the histogram is updated, as part of the initialization of its owner. Defining it again keeps the existing histogram.
+	 * @param intervals_a Bin boundaries, see stat_histogram
+	 * @param bin_count_a If non-zero, \p intervals_a is split into this many bins of equal width
+	 */
+	void define_histogram (stat::type type, stat::detail detail, stat::dir dir, std::initializer_list<uint64_t> intervals_a, size_t bin_count_a = 0);
+
+	/** Add \p addend_a to the histogram bin \p index_a falls into. This is a no-op if no histogram is defined for the key. */
+	void update_histogram (stat::type type, stat::detail detail, stat::dir dir, uint64_t index_a, uint64_t addend_a = 1);
+
+	/** Returns the histogram for the given key, or nullptr if none is defined */
+	btcnew::stat_histogram * get_histogram (stat::type type, stat::detail detail, stat::dir dir);
+
 	/** Returns current value for the given counter at the type level */
 	uint64_t count (stat::type type, stat::dir dir = stat::dir::in)
 	{
@@ -472,6 +592,9 @@ public:
 	/** Log samples to the given log sink */
 	void log_samples (stat_log_sink & sink);
 
+	/** Log histograms to the given log sink */
+	void log_histograms (stat_log_sink & sink);
+
 	/** Returns a new JSON log sink */
 	std::unique_ptr<stat_log_sink> log_sink_json () const;
 
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace btcnew
+{
+/**
+ * Hierarchical timer wheel. Items are bucketed by the tick their deadline falls on so advancing time
+ * only touches the slots that become due, independent of how many items are scheduled.
+ * Items become due once the tick containing their deadline is reached, up to one resolution early.
+ * Deadlines beyond the range of the wheel are clamped to the last slot and expire early.
+ * Each item is scheduled at most once, inserting it again moves it to the new deadline and erasing it is constant time.
+ * Not thread safe, callers provide their own locking.
+ */
+template <typename T, typename CLOCK = std::chrono::steady_clock, typename HASH = std::hash<T>>
+class timer_wheel final
+{
+public:
+	timer_wheel (typename CLOCK::duration resolution_a, typename CLOCK::time_point start_a = CLOCK::now ()) :
+	resolution (resolution_a),
+	start (start_a)
+	{
+		assert (resolution.count () > 0);
+	}
+
+	/** Schedule \p item_a to become due at \p deadline_a, replacing any deadline it already had */
+	void insert (T const & item_a, typename CLOCK::time_point deadline_a)
+	{
+		erase (item_a);
+		uint64_t tick (deadline_a > start ? (deadline_a - start) / resolution : 0);
+		due.emplace_back (entry{ tick, item_a, &due });
+		auto entry_l (std::prev (due.end ()));
+		items.emplace (item_a, entry_l);
+		place (due, entry_l);
+	}
+
+	/** Remove \p item_a, returns true if it was not scheduled */
+	bool erase (T const & item_a)
+	{
+		auto existing (items.find (item_a));
+		auto result (existing == items.end ());
+		if (!result)
+		{
+			existing->second->slot->erase (existing->second);
+			items.erase (existing);
+		}
+		return result;
+	}
+
+	/** Move everything with a deadline at or before \p now_a to the due list */
+	void advance (typename CLOCK::time_point now_a)
+	{
+		uint64_t target (now_a > start ? (now_a - start) / resolution : 0);
+		while (current < target)
+		{
+			++current;
+			if ((current & slot_mask) == 0)
+			{
+				if ((current & ((1 << (2 * slot_bits)) - 1)) == 0)
+				{
+					cascade (levels[2][(current >> (2 * slot_bits)) & slot_mask]);
+				}
+				cascade (levels[1][(current >> slot_bits) & slot_mask]);
+			}
+			auto & slot (levels[0][current & slot_mask]);
+			for (auto & item : slot)
+			{
+				item.slot = &due;
+			}
+			due.splice (due.end (), slot);
+		}
+	}
+
+	/** Take up to \p max_a due items, oldest first */
+	std::vector<T> pop (size_t max_a)
+	{
+		std::vector<T> result;
+		result.reserve (std::min (max_a, due.size ()));
+		while (!due.empty () && result.size () < max_a)
+		{
+			items.erase (due.front ().item);
+			result.push_back (std::move (due.front ().item));
+			due.pop_front ();
+		}
+		return result;
+	}
+
+	/** Number of items which are due but have not been popped */
+	size_t due_size () const
+	{
+		return due.size ();
+	}
+
+	/** Number of items scheduled, including due ones */
+	size_t size () const
+	{
+		return items.size ();
+	}
+
+	void clear ()
+	{
+		for (auto & level : levels)
+		{
+			for (auto & slot : level)
+			{
+				slot.clear ();
+			}
+		}
+		due.clear ();
+		items.clear ();
+	}
+
+	static unsigned constexpr slot_bits = 6;
+	static uint64_t constexpr slot_count = 1 << slot_bits;
+
+private:
+	class entry;
+	using slot_t = std::list<entry>;
+	class entry final
+	{
+	public:
+		uint64_t tick;
+		T item;
+		// The list currently holding this entry, entries are spliced between lists so their iterators stay valid
+		slot_t * slot;
+	};
+
+	void place (slot_t & from_a, typename slot_t::iterator entry_a)
+	{
+		static uint64_t constexpr max_delta ((uint64_t (1) << (3 * slot_bits)) - 1);
+		slot_t * target (&due);
+		if (entry_a->tick > current)
+		{
+			if (entry_a->tick - current > max_delta)
+			{
+				entry_a->tick = current + max_delta;
+			}
+			auto delta (entry_a->tick - current);
+			if (delta < slot_count)
+			{
+				target = &levels[0][entry_a->tick & slot_mask];
+			}
+			else if (delta < (slot_count << slot_bits))
+			{
+				target = &levels[1][(entry_a->tick >> slot_bits) & slot_mask];
+			}
+			else
+			{
+				target = &levels[2][(entry_a->tick >> (2 * slot_bits)) & slot_mask];
+			}
+		}
+		entry_a->slot = target;
+		target->splice (target->end (), from_a, entry_a);
+	}
+
+	void cascade (slot_t & slot_a)
+	{
+		while (!slot_a.empty ())
+		{
+			place (slot_a, slot_a.begin ());
+		}
+	}
+
+	static uint64_t constexpr slot_mask = slot_count - 1;
+	typename CLOCK::duration const resolution;
+	typename CLOCK::time_point const start;
+	uint64_t current{ 0 };
+	std::array<std::array<slot_t, slot_count>, 3> levels;
+	slot_t due;
+	std::unordered_map<T, typename slot_t::iterator, HASH> items;
+};
+}
@@ -3,6 +3,7 @@
 #include <boost/dll/runtime_symbol_info.hpp>
 
 #include <iostream>
+#include <unordered_map>
 
 // Some builds (mac) fail due to "Boost.Stacktrace requires `_Unwind_Backtrace` function".
 #ifndef _WIN32
@@ -88,6 +89,8 @@ namespace thread_role
 	 * Manage thread role
 	 */
 	static thread_local btcnew::thread_role::name current_thread_role = btcnew::thread_role::name::unknown;
+	static std::mutex affinity_mutex;
+	static std::unordered_map<int, std::vector<unsigned>> affinity;
 	btcnew::thread_role::name get ()
 	{
 		return current_thread_role;
@@ -150,6 +153,9 @@ namespace thread_role
 			case btcnew::thread_role::name::worker:
 				thread_role_name_string = "Worker";
 				break;
+			case btcnew::thread_role::name::request_aggregator:
+				thread_role_name_string = "Req aggregator";
+				break;
 		}
 
 		/*
@@ -173,8 +179,35 @@ namespace thread_role
 
 		btcnew::thread_role::set_os_name (thread_role_name_string);
 
+		std::vector<unsigned> cpus;
+		{
+			btcnew::lock_guard<std::mutex> lock (affinity_mutex);
+			auto existing (affinity.find (static_cast<int> (role)));
+			if (existing != affinity.end ())
+			{
+				cpus = existing->second;
+			}
+		}
+		if (!cpus.empty ())
+		{
+			btcnew::thread_role::set_os_affinity (cpus);
+		}
+
 		btcnew::thread_role::current_thread_role = role;
 	}
+
+	void set_affinity (btcnew::thread_role::name role, std::vector<unsigned> const & cpus)
+	{
+		btcnew::lock_guard<std::mutex> lock (affinity_mutex);
+		if (cpus.empty ())
+		{
+			affinity.erase (static_cast<int> (role));
+		}
+		else
+		{
+			affinity[static_cast<int> (role)] = cpus;
+		}
+	}
 }
 }
 
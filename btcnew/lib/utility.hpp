@@ -117,7 +117,8 @@ namespace thread_role
 		rpc_process_container,
 		work_watcher,
 		confirmation_height_processing,
-		worker
+		worker,
+		request_aggregator
 	};
 	/*
 	 * Get/Set the identifier for the current thread
@@ -135,10 +136,21 @@ namespace thread_role
 	 */
 	std::string get_string ();
 
+	/*
+	 * Set the CPUs threads taking on a role are pinned to, an empty list leaves them unpinned.
+	 * Only threads setting their role afterwards are affected.
+	 */
+	void set_affinity (btcnew::thread_role::name, std::vector<unsigned> const &);
+
 	/*
 	 * Internal only, should not be called directly
 	 */
 	void set_os_name (std::string const &);
+
+	/*
+	 * Pin the current thread to the given CPUs, returns true on error or if the platform does not support it
+	 */
+	bool set_os_affinity (std::vector<unsigned> const &);
 }
 
 namespace thread_attributes
@@ -7,20 +7,76 @@
 
 using namespace std::chrono;
 
+btcnew::elections_mutex::elections_mutex (std::array<btcnew::active_shard, btcnew::active_shard_count> & shards_a) :
+shards (shards_a)
+{
+}
+
+void btcnew::elections_mutex::lock ()
+{
+	btcnew::lock_counted (mutex, counters);
+	for (auto & shard : shards)
+	{
+		btcnew::lock_counted (shard.mutex, shard.counters);
+	}
+	owner = std::this_thread::get_id ();
+}
+
+bool btcnew::elections_mutex::try_lock ()
+{
+	auto result (mutex.try_lock ());
+	for (auto i (shards.begin ()), n (shards.end ()); result && i != n; ++i)
+	{
+		if (!i->mutex.try_lock ())
+		{
+			result = false;
+			while (i != shards.begin ())
+			{
+				(--i)->mutex.unlock ();
+			}
+			mutex.unlock ();
+		}
+	}
+	if (result)
+	{
+		owner = std::this_thread::get_id ();
+	}
+	return result;
+}
+
+void btcnew::elections_mutex::unlock ()
+{
+	owner = std::thread::id ();
+	for (auto i (shards.rbegin ()), n (shards.rend ()); i != n; ++i)
+	{
+		i->mutex.unlock ();
+	}
+	mutex.unlock ();
+}
+
+bool btcnew::elections_mutex::owned () const
+{
+	return owner == std::this_thread::get_id ();
+}
+
 btcnew::active_transactions::active_transactions (btcnew::node & node_a) :
+mutex (shards),
 node (node_a),
 long_election_threshold (node.network_params.network.is_test_network () ? 2s : 24s),
 election_request_delay (node.network_params.network.is_test_network () ? 0s : 1s),
 election_time_to_live (node.network_params.network.is_test_network () ? 0s : 10s),
 multipliers_cb (20, 1.),
 trended_active_difficulty (node.network_params.network.publish_threshold),
+scheduler (node_a.config.active_elections_size),
 next_frontier_check (steady_clock::now ()),
+inactive_votes_cache (node_a.stats, node_a.flags.inactive_votes_cache_size),
+scheduled (std::max (std::chrono::milliseconds (1), std::chrono::milliseconds (node.network_params.network.request_interval_ms / 4))),
 thread ([this] () {
 	btcnew::thread_role::set (btcnew::thread_role::name::request_loop);
 	request_loop ();
 })
 {
-	btcnew::unique_lock<std::mutex> lock (mutex);
+	std::unique_lock<btcnew::elections_mutex> lock (mutex);
 	condition.wait (lock, [& started = started] { return started; });
 }
 
@@ -42,7 +98,7 @@ void btcnew::active_transactions::search_frontiers (btcnew::transaction const &
 	auto is_test_network = node.network_params.network.is_test_network ();
 	int test_network_factor = is_test_network ? 1000 : 1;
 	auto roots_size = size ();
-	btcnew::unique_lock<std::mutex> lk (mutex);
+	std::unique_lock<btcnew::elections_mutex> lk (mutex);
 	auto check_time_exceeded = std::chrono::steady_clock::now () >= next_frontier_check;
 	lk.unlock ();
 	auto max_elections = (node.config.active_elections_size / 20);
@@ -104,26 +160,43 @@ void btcnew::active_transactions::search_frontiers (btcnew::transaction const &
 }
 void btcnew::active_transactions::post_confirmation_height_set (btcnew::transaction const & transaction_a, std::shared_ptr<btcnew::block> block_a, btcnew::block_sideband const & sideband_a, btcnew::election_status_type election_status_type_a)
 {
+	auto hash (block_a->hash ());
+	node.latency.stage (hash, btcnew::latency_stage::cemented);
 	if (election_status_type_a == btcnew::election_status_type::inactive_confirmation_height)
 	{
 		btcnew::account account (0);
 		btcnew::uint128_t amount (0);
 		bool is_state_send (false);
 		btcnew::account pending_account (0);
-		node.process_confirmed_data (transaction_a, block_a, block_a->hash (), sideband_a, account, amount, is_state_send, pending_account);
+		node.process_confirmed_data (transaction_a, block_a, hash, sideband_a, account, amount, is_state_send, pending_account);
 		node.observers.blocks.notify (btcnew::election_status{ block_a, 0, std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::system_clock::now ().time_since_epoch ()), std::chrono::duration_values<std::chrono::milliseconds>::zero (), 0, btcnew::election_status_type::inactive_confirmation_height }, account, amount, is_state_send);
 	}
 	else
 	{
-		auto hash (block_a->hash ());
-		btcnew::lock_guard<std::mutex> lock (mutex);
-		auto existing (pending_conf_height.find (hash));
-		if (existing != pending_conf_height.end ())
+		std::shared_ptr<btcnew::election> election;
+		{
+			btcnew::lock_guard<std::mutex> guard (pending_conf_height_mutex);
+			auto existing (pending_conf_height.find (hash));
+			if (existing != pending_conf_height.end ())
+			{
+				election = existing->second;
+			}
+		}
+		if (election != nullptr)
 		{
-			auto election = existing->second;
-			if (election->confirmed && !election->stopped && election->status.winner->hash () == hash)
+			// Observers are notified without holding any election lock, so the fields they need are copied under the shard lock
+			auto confirmed_l (false);
+			btcnew::election_status status_l;
+			unsigned confirmation_request_count_l (0);
+			{
+				auto lock_l (shard (block_a->qualified_root ()).lock ());
+				confirmed_l = election->confirmed && !election->stopped && election->status.winner->hash () == hash;
+				status_l = election->status;
+				confirmation_request_count_l = election->confirmation_request_count;
+			}
+			if (confirmed_l)
 			{
-				add_confirmed (existing->second->status, block_a->qualified_root ());
+				add_confirmed (status_l, block_a->qualified_root ());
 
 				node.receive_confirmed (transaction_a, block_a, hash);
 				btcnew::account account (0);
@@ -131,9 +204,9 @@ void btcnew::active_transactions::post_confirmation_height_set (btcnew::transact
 				bool is_state_send (false);
 				btcnew::account pending_account (0);
 				node.process_confirmed_data (transaction_a, block_a, hash, sideband_a, account, amount, is_state_send, pending_account);
-				election->status.type = election_status_type_a;
-				election->status.confirmation_request_count = election->confirmation_request_count;
-				node.observers.blocks.notify (election->status, account, amount, is_state_send);
+				status_l.type = election_status_type_a;
+				status_l.confirmation_request_count = confirmation_request_count_l;
+				node.observers.blocks.notify (status_l, account, amount, is_state_send);
 				if (amount > 0)
 				{
 					node.observers.account_balance.notify (account, false);
@@ -144,9 +217,11 @@ void btcnew::active_transactions::post_confirmation_height_set (btcnew::transact
 				}
 			}
 
+			btcnew::lock_guard<std::mutex> guard (pending_conf_height_mutex);
 			pending_conf_height.erase (hash);
 		}
 	}
+	node.latency.stage (hash, btcnew::latency_stage::observers);
 }
 
 void btcnew::active_transactions::election_escalate (std::shared_ptr<btcnew::election> & election_l, btcnew::transaction const & transaction_l, size_t const & roots_size_l)
@@ -170,7 +245,7 @@ void btcnew::active_transactions::election_escalate (std::shared_ptr<btcnew::ele
 		if (!previous_hash_l.is_zero ())
 		{
 			previous_l = node.store.block_get (transaction_l, previous_hash_l);
-			if (previous_l != nullptr && blocks.find (previous_hash_l) == blocks.end () && !node.block_confirmed_or_being_confirmed (transaction_l, previous_hash_l))
+			if (previous_l != nullptr && find_election (previous_hash_l) == nullptr && !node.block_confirmed_or_being_confirmed (transaction_l, previous_hash_l))
 			{
 				add (std::move (previous_l), true);
 				escalated_l = true;
@@ -181,7 +256,7 @@ void btcnew::active_transactions::election_escalate (std::shared_ptr<btcnew::ele
 		if (previous_hash_l.is_zero () || previous_l != nullptr)
 		{
 			auto source_hash_l (node.ledger.block_source (transaction_l, *election_l->status.winner));
-			if (!source_hash_l.is_zero () && source_hash_l != previous_hash_l && blocks.find (source_hash_l) == blocks.end ())
+			if (!source_hash_l.is_zero () && source_hash_l != previous_hash_l && find_election (source_hash_l) == nullptr)
 			{
 				auto source_l (node.store.block_get (transaction_l, source_hash_l));
 				if (source_l != nullptr && !node.block_confirmed_or_being_confirmed (transaction_l, source_hash_l))
@@ -212,6 +287,7 @@ void btcnew::active_transactions::election_broadcast (std::shared_ptr<btcnew::el
 	{
 		election_l->stop ();
 		inactive_l.insert (root_l);
+		unschedule (root_l);
 	}
 }
 
@@ -292,9 +368,9 @@ std::unordered_map<std::shared_ptr<btcnew::transport::channel>, std::deque<std::
 	return inserted_into_any_bundle;
 }
 
-void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mutex> & lock_a)
+void btcnew::active_transactions::request_confirm (std::unique_lock<btcnew::elections_mutex> & lock_a)
 {
-	assert (!mutex.try_lock ());
+	assert (mutex.owned ());
 	auto transaction_l (node.store.tx_begin_read ());
 	std::unordered_set<btcnew::qualified_root> inactive_l;
 	std::deque<std::shared_ptr<btcnew::block>> blocks_bundle_l;
@@ -309,7 +385,7 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 	// Due to the confirmation height processor working asynchronously and compressing several roots into one frontier, probably_unconfirmed_frontiers can be wrong
 	{
 		auto pending_confirmation_height_size (node.pending_confirmation_height.size ());
-		bool probably_unconfirmed_frontiers (node.ledger.block_count_cache > node.ledger.cemented_count + roots.size () + pending_confirmation_height_size);
+		bool probably_unconfirmed_frontiers (node.ledger.block_count_cache > node.ledger.cemented_count + roots_size () + pending_confirmation_height_size);
 		bool bootstrap_weight_reached (node.ledger.block_count_cache >= node.ledger.bootstrap_weight_max_blocks);
 		if (node.config.frontiers_confirmation != btcnew::frontiers_confirmation_mode::disabled && bootstrap_weight_reached && probably_unconfirmed_frontiers && pending_confirmation_height_size < confirmed_frontiers_max_pending_cut_off)
 		{
@@ -319,46 +395,85 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 		}
 	}
 
-	// Any new election started from process_live only gets requests after at least 1 second
-	auto cutoff_l (std::chrono::steady_clock::now () - election_request_delay);
+	auto now_l (std::chrono::steady_clock::now ());
 	// Elections taking too long get escalated
-	auto long_election_cutoff_l (std::chrono::steady_clock::now () - long_election_threshold);
+	auto long_election_cutoff_l (now_l - long_election_threshold);
 	// The lowest PoW difficulty elections have a maximum time to live if they are beyond the soft threshold size for the container
-	auto election_ttl_cutoff_l (std::chrono::steady_clock::now () - election_time_to_live);
+	auto election_ttl_cutoff_l (now_l - election_time_to_live);
+	std::chrono::milliseconds request_interval_l (node.network_params.network.request_interval_ms);
+
+	/*
+	 * Elections extending the soft config.active_elections_size limit are flushed after a certain time-to-live cutoff, lowest difficulty first
+	 * Flushed elections are later re-activated via frontier confirmation
+	 */
+	auto roots_size_l (roots_size ());
+	if (roots_size_l > node.config.active_elections_size)
+	{
+		auto sorted_roots_l (sorted_roots ());
+		auto excess_l (roots_size_l - node.config.active_elections_size);
+		for (auto i (sorted_roots_l.rbegin ()), n (sorted_roots_l.rend ()); i != n && excess_l > 0; ++i, --excess_l)
+		{
+			auto election_l (i->election);
+			if (!election_l->confirmed && !election_l->stopped && election_l->election_start < election_ttl_cutoff_l && !node.wallets.watcher->is_watched (i->root))
+			{
+				election_l->stop ();
+				inactive_l.insert (i->root);
+				unschedule (i->root);
+				add_dropped_elections_cache (i->root);
+			}
+		}
+	}
 
 	auto const representatives_l (node.rep_crawler.representatives (std::numeric_limits<size_t>::max ()));
-	auto roots_size_l (roots.size ());
-	auto & sorted_roots_l = roots.get<1> ();
-	size_t count_l{ 0 };
 
 	/*
-	 * Loop through active elections in descending order of proof-of-work difficulty, requesting confirmation
+	 * Broadcast and request confirmation for the elections which are due, releasing the mutex between batches
 	 *
+	 * Any new election started from process_live is first due after election_request_delay
 	 * Only up to a certain amount of elections are queued for confirmation request and block rebroadcasting. The remaining elections can still be confirmed if votes arrive
-	 * We avoid selecting the same elections repeatedly in the next loops, through a modulo on confirmation_request_count
-	 * An election only gets confirmation_request_count increased after the first confirm_req; after that it is increased every loop unless they don't fit in the queues
-	 * Elections extending the soft config.active_elections_size limit are flushed after a certain time-to-live cutoff
-	 * Flushed elections are later re-activated via frontier confirmation
+	 * An election only gets confirmation_request_count increased after the first confirm_req; after that it is increased every interval unless they don't fit in the queues
+	 * The wheel only decides which elections are due, they are visited highest difficulty first so the capped bundles favour them
+	 * Elections are rescheduled for the next interval on which they broadcast or request confirmation, finished elections leave the wheel as soon as they are erased
 	 */
-	for (auto i = sorted_roots_l.begin (), n = sorted_roots_l.end (); i != n; ++i, ++count_l)
+	std::vector<btcnew::qualified_root> due_roots_l;
 	{
-		auto election_l (i->election);
-		auto root_l (i->root);
-		// Erase finished elections
-		if ((election_l->confirmed || election_l->stopped))
-		{
-			inactive_l.insert (root_l);
-		}
-		// Drop elections
-		else if (count_l >= node.config.active_elections_size && election_l->election_start < election_ttl_cutoff_l && !node.wallets.watcher->is_watched (root_l))
+		btcnew::lock_guard<std::mutex> guard (scheduled_mutex);
+		scheduled.advance (now_l);
+		due_roots_l = scheduled.pop (std::numeric_limits<size_t>::max ());
+	}
+	std::vector<btcnew::conflict_info> due_l;
+	for (auto const & root_l : due_roots_l)
+	{
+		auto existing_l (find_root (root_l));
+		if (existing_l != nullptr)
 		{
-			election_l->stop ();
-			inactive_l.insert (root_l);
-			add_dropped_elections_cache (root_l);
+			due_l.push_back (*existing_l);
 		}
-		// Broadcast and request confirmation
-		else if (election_l->skip_delay || election_l->election_start < cutoff_l)
+	}
+	std::sort (due_l.begin (), due_l.end (), [] (btcnew::conflict_info const & lhs, btcnew::conflict_info const & rhs) {
+		return lhs.adjusted_difficulty > rhs.adjusted_difficulty;
+	});
+	for (auto i (due_l.begin ()), n (due_l.end ()); i != n && !stopped;)
+	{
+		roots_size_l = roots_size ();
+		for (auto batch_end_l (i + std::min<size_t> (request_confirm_batch_size, n - i)); i != batch_end_l; ++i)
 		{
+			auto root_l (i->root);
+			auto existing_l (find_root (root_l));
+			// Skip elections which have been erased or replaced while the mutex was released
+			if (existing_l == nullptr || existing_l->election != i->election)
+			{
+				continue;
+			}
+			auto election_l (existing_l->election);
+			// Erase finished elections
+			if (election_l->confirmed || election_l->stopped)
+			{
+				inactive_l.insert (root_l);
+				continue;
+			}
+			// Account for the intervals skipped since the election was last due
+			election_l->confirmation_request_count = next_request_count (election_l->confirmation_request_count);
 			bool increment_counter_l{ true };
 			// Escalate long election after a certain time and number of requests performed
 			if (election_l->confirmation_request_count > 4 && election_l->election_start < long_election_cutoff_l)
@@ -378,12 +493,27 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 				{
 					increment_counter_l = false;
 				}
+				else
+				{
+					node.latency.stage (election_l->status.winner->hash (), btcnew::latency_stage::confirm_req);
+				}
 			}
+			auto next_l (now_l + request_interval_l);
 			if (increment_counter_l)
 			{
-				++election_l->confirmation_request_count;
+				auto count_l (++election_l->confirmation_request_count);
+				next_l += request_interval_l * (next_request_count (count_l) - count_l);
+			}
+			if (!election_l->stopped)
+			{
+				schedule (root_l, next_l);
 			}
 		}
+		if (i != n)
+		{
+			lock_a.unlock ();
+			lock_a.lock ();
+		}
 	}
 	ongoing_broadcasts = !blocks_bundle_l.empty () + !batched_confirm_req_bundle_l.empty () + !single_confirm_req_bundle_l.empty ();
 	lock_a.unlock ();
@@ -394,7 +524,7 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 		node.network.flood_block_many (
 		std::move (blocks_bundle_l), [this] () {
 			{
-				btcnew::lock_guard<std::mutex> guard_l (this->mutex);
+				btcnew::lock_guard<btcnew::elections_mutex> guard_l (this->mutex);
 				--this->ongoing_broadcasts;
 			}
 			this->condition.notify_all ();
@@ -407,7 +537,7 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 		node.network.broadcast_confirm_req_batched_many (
 		batched_confirm_req_bundle_l, [this] () {
 			{
-				btcnew::lock_guard<std::mutex> guard_l (this->mutex);
+				btcnew::lock_guard<btcnew::elections_mutex> guard_l (this->mutex);
 				--this->ongoing_broadcasts;
 			}
 			this->condition.notify_all ();
@@ -420,7 +550,7 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 		node.network.broadcast_confirm_req_many (
 		single_confirm_req_bundle_l, [this] () {
 			{
-				btcnew::lock_guard<std::mutex> guard_l (this->mutex);
+				btcnew::lock_guard<btcnew::elections_mutex> guard_l (this->mutex);
 				--this->ongoing_broadcasts;
 			}
 			this->condition.notify_all ();
@@ -431,19 +561,230 @@ void btcnew::active_transactions::request_confirm (btcnew::unique_lock<std::mute
 	// Erase inactive elections
 	for (auto i (inactive_l.begin ()), n (inactive_l.end ()); i != n; ++i)
 	{
-		auto root_it (roots.find (*i));
-		if (root_it != roots.end ())
+		auto root_it (find_root (*i));
+		if (root_it != nullptr)
+		{
+			auto election_l (root_it->election);
+			election_l->clear_blocks ();
+			election_l->clear_dependent ();
+			erase_root (*i);
+		}
+	}
+	if (!scheduler.empty () && roots_size () < node.config.active_elections_size)
+	{
+		// Blocks processed since the transaction started need to be visible
+		transaction_l.refresh ();
+		activate_scheduled (transaction_l);
+	}
+}
+
+void btcnew::active_transactions::activate_scheduled (btcnew::read_transaction const & transaction_a)
+{
+	assert (mutex.owned ());
+	while (roots_size () < node.config.active_elections_size && !scheduler.empty ())
+	{
+		auto block_l (scheduler.pop ());
+		auto hash_l (block_l->hash ());
+		// Skip blocks which were rolled back or cemented while waiting
+		if (node.store.block_exists (transaction_a, hash_l) && !node.ledger.block_confirmed (transaction_a, hash_l) && !add (block_l))
+		{
+			node.stats.inc (btcnew::stat::type::election, btcnew::stat::detail::scheduler_activated);
+		}
+	}
+}
+
+void btcnew::active_transactions::schedule (btcnew::qualified_root const & root_a, std::chrono::steady_clock::time_point deadline_a)
+{
+	btcnew::lock_guard<std::mutex> guard (scheduled_mutex);
+	scheduled.insert (root_a, deadline_a);
+}
+
+void btcnew::active_transactions::unschedule (btcnew::qualified_root const & root_a)
+{
+	btcnew::lock_guard<std::mutex> guard (scheduled_mutex);
+	scheduled.erase (root_a);
+}
+
+void btcnew::active_transactions::erase_root (btcnew::qualified_root const & root_a)
+{
+	auto & shard_l (shard (root_a));
+	assert (!shard_l.mutex.try_lock ());
+	shard_l.roots.erase (root_a);
+	unschedule (root_a);
+}
+
+std::unique_lock<std::mutex> btcnew::active_shard::lock ()
+{
+	btcnew::lock_counted (mutex, counters);
+	return std::unique_lock<std::mutex> (mutex, std::adopt_lock);
+}
+
+btcnew::active_shard & btcnew::active_transactions::shard (btcnew::qualified_root const & root_a)
+{
+	// The root half is used as previous is zero for every open block
+	return shards[root_a.qwords[4] % btcnew::active_shard_count];
+}
+
+btcnew::conflict_info const * btcnew::active_transactions::find_root (btcnew::qualified_root const & root_a)
+{
+	assert (mutex.owned ());
+	auto & roots_l (shard (root_a).roots);
+	auto existing (roots_l.find (root_a));
+	return existing != roots_l.end () ? &*existing : nullptr;
+}
+
+std::shared_ptr<btcnew::election> btcnew::active_transactions::find_election (btcnew::block_hash const & hash_a)
+{
+	assert (mutex.owned ());
+	std::shared_ptr<btcnew::election> result;
+	for (auto i (shards.begin ()), n (shards.end ()); result == nullptr && i != n; ++i)
+	{
+		auto existing (i->blocks.find (hash_a));
+		if (existing != i->blocks.end ())
+		{
+			result = existing->second;
+		}
+	}
+	return result;
+}
+
+std::vector<btcnew::conflict_info> btcnew::active_transactions::sorted_roots (size_t max_a)
+{
+	assert (mutex.owned ());
+	// Merge the per shard difficulty indexes, highest adjusted difficulty first
+	using iterator = btcnew::active_roots::nth_index<1>::type::const_iterator;
+	auto compare ([] (std::pair<iterator, iterator> const & lhs, std::pair<iterator, iterator> const & rhs) {
+		return lhs.first->adjusted_difficulty < rhs.first->adjusted_difficulty;
+	});
+	std::vector<std::pair<iterator, iterator>> heads;
+	for (auto & shard_l : shards)
+	{
+		auto & sorted_l (shard_l.roots.get<1> ());
+		if (!sorted_l.empty ())
+		{
+			heads.emplace_back (sorted_l.begin (), sorted_l.end ());
+		}
+	}
+	std::make_heap (heads.begin (), heads.end (), compare);
+	std::vector<btcnew::conflict_info> result;
+	result.reserve (std::min (max_a, roots_size ()));
+	while (!heads.empty () && result.size () < max_a)
+	{
+		std::pop_heap (heads.begin (), heads.end (), compare);
+		auto & head (heads.back ());
+		result.push_back (*head.first);
+		if (++head.first != head.second)
+		{
+			std::push_heap (heads.begin (), heads.end (), compare);
+		}
+		else
+		{
+			heads.pop_back ();
+		}
+	}
+	return result;
+}
+
+size_t btcnew::active_transactions::roots_size ()
+{
+	assert (mutex.owned ());
+	size_t result (0);
+	for (auto & shard_l : shards)
+	{
+		result += shard_l.roots.size ();
+	}
+	return result;
+}
+
+size_t btcnew::active_transactions::blocks_size ()
+{
+	assert (mutex.owned ());
+	size_t result (0);
+	for (auto & shard_l : shards)
+	{
+		result += shard_l.blocks.size ();
+	}
+	return result;
+}
+
+void btcnew::active_transactions::defer_update_dependent (std::shared_ptr<btcnew::election> const & election_a)
+{
+	btcnew::lock_guard<std::mutex> guard (deferred_mutex);
+	deferred_dependent.push_back (election_a);
+	deferred = true;
+}
+
+void btcnew::active_transactions::run_deferred ()
+{
+	assert (mutex.owned ());
+	std::vector<std::shared_ptr<btcnew::election>> dependent_l;
+	std::vector<btcnew::block_hash> adjust_l;
+	{
+		btcnew::lock_guard<std::mutex> guard (deferred_mutex);
+		deferred = false;
+		dependent_l.swap (deferred_dependent);
+		adjust_l.swap (deferred_adjust);
+	}
+	for (auto & election_l : dependent_l)
+	{
+		if (!election_l->confirmed && !election_l->stopped)
+		{
+			election_l->update_dependent ();
+		}
+	}
+	for (auto & hash_l : adjust_l)
+	{
+		adjust_difficulty (hash_l);
+	}
+}
+
+void btcnew::active_transactions::flush_deferred ()
+{
+	if (deferred)
+	{
+		btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
+		run_deferred ();
+	}
+}
+
+void btcnew::active_transactions::publish_lock_stats ()
+{
+	uint64_t shard_contended (0);
+	uint64_t shard_blocked_us (0);
+	for (auto & shard_l : shards)
+	{
+		shard_contended += shard_l.counters.contended;
+		shard_blocked_us += shard_l.counters.blocked_us;
+	}
+	uint64_t elections_contended (mutex.counters.contended);
+	uint64_t elections_blocked_us (mutex.counters.blocked_us);
+	node.stats.add (btcnew::stat::type::election, btcnew::stat::detail::shard_lock_contended, btcnew::stat::dir::in, shard_contended - published_shard_contended);
+	node.stats.add (btcnew::stat::type::election, btcnew::stat::detail::shard_lock_blocked_us, btcnew::stat::dir::in, shard_blocked_us - published_shard_blocked_us);
+	node.stats.add (btcnew::stat::type::election, btcnew::stat::detail::elections_lock_contended, btcnew::stat::dir::in, elections_contended - published_elections_contended);
+	node.stats.add (btcnew::stat::type::election, btcnew::stat::detail::elections_lock_blocked_us, btcnew::stat::dir::in, elections_blocked_us - published_elections_blocked_us);
+	published_shard_contended = shard_contended;
+	published_shard_blocked_us = shard_blocked_us;
+	published_elections_contended = elections_contended;
+	published_elections_blocked_us = elections_blocked_us;
+}
+
+unsigned btcnew::active_transactions::next_request_count (unsigned count_a) const
+{
+	auto result (count_a);
+	if (!node.network_params.network.is_test_network ())
+	{
+		// Broadcasts happen on counts 1 mod 8 and confirmation requests on counts 0 mod 4, escalation only on broadcasting counts
+		while (result % 8 != 1 && result % 4 != 0)
 		{
-			root_it->election->clear_blocks ();
-			root_it->election->clear_dependent ();
-			roots.erase (root_it);
+			++result;
 		}
 	}
+	return result;
 }
 
 void btcnew::active_transactions::request_loop ()
 {
-	btcnew::unique_lock<std::mutex> lock (mutex);
+	std::unique_lock<btcnew::elections_mutex> lock (mutex);
 	started = true;
 	lock.unlock ();
 	condition.notify_all ();
@@ -459,8 +800,10 @@ void btcnew::active_transactions::request_loop ()
 		// Account for the time spent in request_confirm by defining the wakeup point beforehand
 		const auto wakeup_l (std::chrono::steady_clock::now () + std::chrono::milliseconds (node.network_params.network.request_interval_ms));
 
+		run_deferred ();
 		update_active_difficulty (lock);
 		request_confirm (lock);
+		publish_lock_stats ();
 
 		// Sleep until all broadcasts are done, plus the remaining loop time
 		while (!stopped && ongoing_broadcasts)
@@ -481,7 +824,7 @@ void btcnew::active_transactions::prioritize_account_for_confirmation (btcnew::a
 	if (info_a.block_count > confirmation_height && !node.pending_confirmation_height.is_processing_block (info_a.head))
 	{
 		auto num_uncemented = info_a.block_count - confirmation_height;
-		btcnew::lock_guard<std::mutex> guard (mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 		auto it = cementable_frontiers_a.find (account_a);
 		if (it != cementable_frontiers_a.end ())
 		{
@@ -525,7 +868,7 @@ void btcnew::active_transactions::prioritize_frontiers_for_confirmation (btcnew:
 		size_t priority_cementable_frontiers_size;
 		size_t priority_wallet_cementable_frontiers_size;
 		{
-			btcnew::lock_guard<std::mutex> guard (mutex);
+			btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 			priority_cementable_frontiers_size = priority_cementable_frontiers.size ();
 			priority_wallet_cementable_frontiers_size = priority_wallet_cementable_frontiers.size ();
 		}
@@ -569,7 +912,7 @@ void btcnew::active_transactions::prioritize_frontiers_for_confirmation (btcnew:
 							auto it = priority_cementable_frontiers.find (account);
 							if (it != priority_cementable_frontiers.end ())
 							{
-								btcnew::lock_guard<std::mutex> guard (mutex);
+								btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 								priority_cementable_frontiers.erase (it);
 								priority_cementable_frontiers_size = priority_cementable_frontiers.size ();
 							}
@@ -635,7 +978,7 @@ void btcnew::active_transactions::prioritize_frontiers_for_confirmation (btcnew:
 
 void btcnew::active_transactions::stop ()
 {
-	btcnew::unique_lock<std::mutex> lock (mutex);
+	std::unique_lock<btcnew::elections_mutex> lock (mutex);
 	if (!started)
 	{
 		condition.wait (lock, [& started = started] { return started; });
@@ -648,33 +991,59 @@ void btcnew::active_transactions::stop ()
 		thread.join ();
 	}
 	lock.lock ();
-	roots.clear ();
+	for (auto & shard_l : shards)
+	{
+		shard_l.roots.clear ();
+	}
+	{
+		btcnew::lock_guard<std::mutex> guard (scheduled_mutex);
+		scheduled.clear ();
+	}
+	scheduler.clear ();
 }
 
 bool btcnew::active_transactions::start (std::shared_ptr<btcnew::block> block_a, bool const skip_delay_a, std::function<void (std::shared_ptr<btcnew::block>)> const & confirmation_action_a)
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> lock (mutex);
 	return add (block_a, skip_delay_a, confirmation_action_a);
 }
 
+void btcnew::active_transactions::activate (std::shared_ptr<btcnew::block> const & block_a, btcnew::uint128_t const & balance_a, std::chrono::seconds idle_a)
+{
+	btcnew::lock_guard<btcnew::elections_mutex> lock (mutex);
+	// Blocks already waiting have priority over new ones, the request loop starts them as elections finish
+	if (roots_size () < node.config.active_elections_size && scheduler.empty ())
+	{
+		add (block_a);
+	}
+	else if (find_root (block_a->qualified_root ()) == nullptr)
+	{
+		auto dropped (scheduler.push (block_a, balance_a, idle_a));
+		node.stats.inc (btcnew::stat::type::election, dropped ? btcnew::stat::detail::scheduler_dropped : btcnew::stat::detail::scheduler_queued);
+	}
+}
+
 bool btcnew::active_transactions::add (std::shared_ptr<btcnew::block> block_a, bool const skip_delay_a, std::function<void (std::shared_ptr<btcnew::block>)> const & confirmation_action_a)
 {
 	auto error (true);
 	if (!stopped)
 	{
 		auto root (block_a->qualified_root ());
-		auto existing (roots.find (root));
-		if (existing == roots.end () && confirmed_set.get<1> ().find (root) == confirmed_set.get<1> ().end ())
+		auto & shard_l (shard (root));
+		auto existing (shard_l.roots.find (root));
+		if (existing == shard_l.roots.end () && !recently_confirmed (root))
 		{
 			auto hash (block_a->hash ());
 			auto election (btcnew::make_shared<btcnew::election> (node, block_a, skip_delay_a, confirmation_action_a));
 			uint64_t difficulty (0);
 			error = btcnew::work_validate (*block_a, &difficulty);
 			release_assert (!error);
-			roots.insert (btcnew::conflict_info{ root, difficulty, difficulty, election });
-			blocks.insert (std::make_pair (hash, election));
+			shard_l.roots.insert (btcnew::conflict_info{ root, difficulty, difficulty, election });
+			shard_l.blocks.insert (std::make_pair (hash, election));
+			schedule (root, election->election_start + (skip_delay_a ? std::chrono::milliseconds (0) : election_request_delay));
 			adjust_difficulty (hash);
 			election->insert_inactive_votes_cache ();
+			node.latency.stage (hash, btcnew::latency_stage::election_start);
 		}
 	}
 	return error;
@@ -686,44 +1055,62 @@ bool btcnew::active_transactions::vote (std::shared_ptr<btcnew::vote> vote_a, bo
 	std::shared_ptr<btcnew::election> election;
 	bool replay (false);
 	bool processed (false);
+	// Each block only locks the shard of its root, so votes for unrelated elections are applied concurrently
+	for (auto vote_block : vote_a->blocks)
 	{
-		btcnew::unique_lock<std::mutex> lock;
-		if (!single_lock)
-		{
-			lock = btcnew::unique_lock<std::mutex> (mutex);
-		}
-		for (auto vote_block : vote_a->blocks)
+		btcnew::election_vote_result result;
+		if (vote_block.which ())
 		{
-			btcnew::election_vote_result result;
-			if (vote_block.which ())
+			auto block_hash (boost::get<btcnew::block_hash> (vote_block));
+			auto found (false);
+			for (auto i (shards.begin ()), n (shards.end ()); !found && i != n; ++i)
 			{
-				auto block_hash (boost::get<btcnew::block_hash> (vote_block));
-				auto existing (blocks.find (block_hash));
-				if (existing != blocks.end ())
+				std::unique_lock<std::mutex> lock;
+				if (!single_lock)
 				{
-					result = existing->second->vote (vote_a->account, vote_a->sequence, block_hash);
+					lock = i->lock ();
 				}
-				else
+				auto existing (i->blocks.find (block_hash));
+				if (existing != i->blocks.end ())
 				{
-					add_inactive_votes_cache (block_hash, vote_a->account);
+					found = true;
+					result = existing->second->vote (vote_a->account, vote_a->sequence, block_hash);
 				}
 			}
-			else
+			if (!found)
+			{
+				add_inactive_votes_cache (block_hash, vote_a->account);
+			}
+		}
+		else
+		{
+			auto block (boost::get<std::shared_ptr<btcnew::block>> (vote_block));
+			auto & shard_l (shard (block->qualified_root ()));
+			auto found (false);
 			{
-				auto block (boost::get<std::shared_ptr<btcnew::block>> (vote_block));
-				auto existing (roots.find (block->qualified_root ()));
-				if (existing != roots.end ())
+				std::unique_lock<std::mutex> lock;
+				if (!single_lock)
 				{
-					result = existing->election->vote (vote_a->account, vote_a->sequence, block->hash ());
+					lock = shard_l.lock ();
 				}
-				else
+				auto existing (shard_l.roots.find (block->qualified_root ()));
+				if (existing != shard_l.roots.end ())
 				{
-					add_inactive_votes_cache (block->hash (), vote_a->account);
+					found = true;
+					result = existing->election->vote (vote_a->account, vote_a->sequence, block->hash ());
 				}
 			}
-			replay = replay || result.replay;
-			processed = processed || result.processed;
+			if (!found)
+			{
+				add_inactive_votes_cache (block->hash (), vote_a->account);
+			}
 		}
+		replay = replay || result.replay;
+		processed = processed || result.processed;
+	}
+	if (!single_lock)
+	{
+		flush_deferred ();
 	}
 	if (processed)
 	{
@@ -734,8 +1121,9 @@ bool btcnew::active_transactions::vote (std::shared_ptr<btcnew::vote> vote_a, bo
 
 bool btcnew::active_transactions::active (btcnew::qualified_root const & root_a)
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	return roots.find (root_a) != roots.end ();
+	auto & shard_l (shard (root_a));
+	auto lock (shard_l.lock ());
+	return shard_l.roots.find (root_a) != shard_l.roots.end ();
 }
 
 bool btcnew::active_transactions::active (btcnew::block const & block_a)
@@ -745,9 +1133,10 @@ bool btcnew::active_transactions::active (btcnew::block const & block_a)
 
 void btcnew::active_transactions::update_difficulty (std::shared_ptr<btcnew::block> block_a, boost::optional<btcnew::write_transaction const &> opt_transaction_a)
 {
-	btcnew::unique_lock<std::mutex> lock (mutex);
-	auto existing_election (roots.find (block_a->qualified_root ()));
-	if (existing_election != roots.end ())
+	std::unique_lock<btcnew::elections_mutex> lock (mutex);
+	auto & shard_l (shard (block_a->qualified_root ()));
+	auto existing_election (shard_l.roots.find (block_a->qualified_root ()));
+	if (existing_election != shard_l.roots.end ())
 	{
 		uint64_t difficulty;
 		auto error (btcnew::work_validate (*block_a, &difficulty));
@@ -759,7 +1148,7 @@ void btcnew::active_transactions::update_difficulty (std::shared_ptr<btcnew::blo
 			{
 				node.logger.try_log (boost::str (boost::format ("Block %1% was updated from difficulty %2% to %3%") % block_a->hash ().to_string () % btcnew::to_string_hex (existing_election->difficulty) % btcnew::to_string_hex (difficulty)));
 			}
-			roots.modify (existing_election, [difficulty] (btcnew::conflict_info & info_a) {
+			shard_l.roots.modify (existing_election, [difficulty] (btcnew::conflict_info & info_a) {
 				info_a.difficulty = difficulty;
 			});
 			adjust_difficulty (block_a->hash ());
@@ -804,7 +1193,14 @@ void btcnew::active_transactions::update_difficulty (std::shared_ptr<btcnew::blo
 
 void btcnew::active_transactions::adjust_difficulty (btcnew::block_hash const & hash_a)
 {
-	assert (!mutex.try_lock ());
+	if (!mutex.owned ())
+	{
+		// Dependencies cross shards, with a single shard locked the walk is left to the holder of all shards
+		btcnew::lock_guard<std::mutex> guard (deferred_mutex);
+		deferred_adjust.push_back (hash_a);
+		deferred = true;
+		return;
+	}
 	std::deque<std::pair<btcnew::block_hash, int64_t>> remaining_blocks;
 	remaining_blocks.emplace_back (hash_a, 0);
 	std::unordered_set<btcnew::block_hash> processed_blocks;
@@ -819,32 +1215,32 @@ void btcnew::active_transactions::adjust_difficulty (btcnew::block_hash const &
 		auto level (item.second);
 		if (processed_blocks.find (hash) == processed_blocks.end ())
 		{
-			auto existing (blocks.find (hash));
-			if (existing != blocks.end () && !existing->second->confirmed && !existing->second->stopped && existing->second->status.winner->hash () == hash)
+			auto existing_election (find_election (hash));
+			if (existing_election != nullptr && !existing_election->confirmed && !existing_election->stopped && existing_election->status.winner->hash () == hash)
 			{
-				auto previous (existing->second->status.winner->previous ());
+				auto previous (existing_election->status.winner->previous ());
 				if (!previous.is_zero ())
 				{
 					remaining_blocks.emplace_back (previous, level + 1);
 				}
-				auto source (existing->second->status.winner->source ());
+				auto source (existing_election->status.winner->source ());
 				if (!source.is_zero () && source != previous)
 				{
 					remaining_blocks.emplace_back (source, level + 1);
 				}
-				auto link (existing->second->status.winner->link ());
+				auto link (existing_election->status.winner->link ());
 				if (!link.is_zero () && !node.ledger.is_epoch_link (link) && link != previous)
 				{
 					remaining_blocks.emplace_back (link, level + 1);
 				}
-				for (auto & dependent_block : existing->second->dependent_blocks)
+				for (auto & dependent_block : existing_election->dependent_blocks)
 				{
 					remaining_blocks.emplace_back (dependent_block, level - 1);
 				}
 				processed_blocks.insert (hash);
-				btcnew::qualified_root root (previous, existing->second->status.winner->root ());
-				auto existing_root (roots.find (root));
-				if (existing_root != roots.end ())
+				btcnew::qualified_root root (previous, existing_election->status.winner->root ());
+				auto existing_root (find_root (root));
+				if (existing_root != nullptr)
 				{
 					sum += btcnew::difficulty::to_multiplier (existing_root->difficulty, node.network_params.network.publish_threshold);
 					elections_list.emplace_back (root, level);
@@ -883,31 +1279,31 @@ void btcnew::active_transactions::adjust_difficulty (btcnew::block_hash const &
 		// Set adjusted difficulty
 		for (auto & item : elections_list)
 		{
-			auto existing_root (roots.find (item.first));
+			auto & shard_l (shard (item.first));
+			auto existing_root (shard_l.roots.find (item.first));
 			uint64_t difficulty_a = average + item.second - limiter;
-			roots.modify (existing_root, [difficulty_a] (btcnew::conflict_info & info_a) {
+			shard_l.roots.modify (existing_root, [difficulty_a] (btcnew::conflict_info & info_a) {
 				info_a.adjusted_difficulty = difficulty_a;
 			});
 		}
 	}
 }
 
-void btcnew::active_transactions::update_active_difficulty (btcnew::unique_lock<std::mutex> & lock_a)
+void btcnew::active_transactions::update_active_difficulty (std::unique_lock<btcnew::elections_mutex> & lock_a)
 {
-	assert (!mutex.try_lock ());
+	assert (mutex.owned ());
 	double multiplier (1.);
-	if (!roots.empty ())
+	auto sorted_roots_l (sorted_roots (node.config.active_elections_size));
+	if (!sorted_roots_l.empty ())
 	{
-		auto & sorted_roots = roots.get<1> ();
 		std::vector<uint64_t> active_root_difficulties;
-		active_root_difficulties.reserve (std::min (roots.size (), node.config.active_elections_size));
-		size_t count (0);
+		active_root_difficulties.reserve (sorted_roots_l.size ());
 		auto cutoff (std::chrono::steady_clock::now () - election_request_delay - 1s);
-		for (auto it (sorted_roots.begin ()), end (sorted_roots.end ()); it != end && count++ < node.config.active_elections_size; ++it)
+		for (auto const & info : sorted_roots_l)
 		{
-			if (!it->election->confirmed && !it->election->stopped && it->election->election_start < cutoff)
+			if (!info.election->confirmed && !info.election->stopped && info.election->election_start < cutoff)
 			{
-				active_root_difficulties.push_back (it->adjusted_difficulty);
+				active_root_difficulties.push_back (info.adjusted_difficulty);
 			}
 		}
 		if (active_root_difficulties.size () > 10 || (!active_root_difficulties.empty () && node.network_params.network.is_test_network ()))
@@ -922,12 +1318,11 @@ void btcnew::active_transactions::update_active_difficulty (btcnew::unique_lock<
 	assert (difficulty >= node.network_params.network.publish_threshold);
 
 	trended_active_difficulty = difficulty;
-	node.observers.difficulty.notify (trended_active_difficulty);
+	node.observers.difficulty.notify (difficulty);
 }
 
 uint64_t btcnew::active_transactions::active_difficulty ()
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
 	return trended_active_difficulty;
 }
 
@@ -940,26 +1335,30 @@ uint64_t btcnew::active_transactions::limited_active_difficulty ()
 std::deque<std::shared_ptr<btcnew::block>> btcnew::active_transactions::list_blocks (bool single_lock)
 {
 	std::deque<std::shared_ptr<btcnew::block>> result;
-	btcnew::unique_lock<std::mutex> lock;
+	std::unique_lock<btcnew::elections_mutex> lock;
 	if (!single_lock)
 	{
-		lock = btcnew::unique_lock<std::mutex> (mutex);
+		lock = std::unique_lock<btcnew::elections_mutex> (mutex);
 	}
-	for (auto i (roots.begin ()), n (roots.end ()); i != n; ++i)
+	for (auto & shard_l : shards)
 	{
-		result.push_back (i->election->status.winner);
+		for (auto i (shard_l.roots.begin ()), n (shard_l.roots.end ()); i != n; ++i)
+		{
+			result.push_back (i->election->status.winner);
+		}
 	}
 	return result;
 }
 
 std::deque<btcnew::election_status> btcnew::active_transactions::list_confirmed ()
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
+	btcnew::lock_guard<std::mutex> lock (confirmed_mutex);
 	return confirmed;
 }
 
 void btcnew::active_transactions::add_confirmed (btcnew::election_status const & status_a, btcnew::qualified_root const & root_a)
 {
+	btcnew::lock_guard<std::mutex> guard (confirmed_mutex);
 	confirmed.push_back (status_a);
 	auto inserted (confirmed_set.insert (btcnew::election_timepoint{ std::chrono::steady_clock::now (), root_a }));
 	if (confirmed.size () > node.config.confirmation_history_size)
@@ -972,44 +1371,56 @@ void btcnew::active_transactions::add_confirmed (btcnew::election_status const &
 	}
 }
 
+bool btcnew::active_transactions::recently_confirmed (btcnew::qualified_root const & root_a)
+{
+	btcnew::lock_guard<std::mutex> guard (confirmed_mutex);
+	return confirmed_set.get<1> ().find (root_a) != confirmed_set.get<1> ().end ();
+}
+
 void btcnew::active_transactions::erase (btcnew::block const & block_a)
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	auto root_it (roots.find (block_a.qualified_root ()));
-	if (root_it != roots.end ())
+	btcnew::lock_guard<btcnew::elections_mutex> lock (mutex);
+	auto root_it (find_root (block_a.qualified_root ()));
+	if (root_it != nullptr)
 	{
-		root_it->election->stop ();
-		root_it->election->clear_blocks ();
-		root_it->election->clear_dependent ();
-		roots.erase (root_it);
+		auto election_l (root_it->election);
+		election_l->stop ();
+		election_l->clear_blocks ();
+		election_l->clear_dependent ();
+		erase_root (block_a.qualified_root ());
 		node.logger.try_log (boost::str (boost::format ("Election erased for block block %1% root %2%") % block_a.hash ().to_string () % block_a.root ().to_string ()));
 	}
 }
 
 bool btcnew::active_transactions::empty ()
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	return roots.empty ();
+	return size () == 0;
 }
 
 size_t btcnew::active_transactions::size ()
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	return roots.size ();
+	size_t result (0);
+	for (auto & shard_l : shards)
+	{
+		auto lock (shard_l.lock ());
+		result += shard_l.roots.size ();
+	}
+	return result;
 }
 
 bool btcnew::active_transactions::publish (std::shared_ptr<btcnew::block> block_a)
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	auto existing (roots.find (block_a->qualified_root ()));
+	btcnew::lock_guard<btcnew::elections_mutex> lock (mutex);
+	auto & shard_l (shard (block_a->qualified_root ()));
+	auto existing (shard_l.roots.find (block_a->qualified_root ()));
 	auto result (true);
-	if (existing != roots.end ())
+	if (existing != shard_l.roots.end ())
 	{
 		auto election (existing->election);
 		result = election->publish (block_a);
 		if (!result && !election->confirmed)
 		{
-			blocks.insert (std::make_pair (block_a->hash (), election));
+			shard_l.blocks.insert (std::make_pair (block_a->hash (), election));
 		}
 	}
 	return result;
@@ -1017,7 +1428,7 @@ bool btcnew::active_transactions::publish (std::shared_ptr<btcnew::block> block_
 
 void btcnew::active_transactions::clear_block (btcnew::block_hash const & hash_a)
 {
-	btcnew::lock_guard<std::mutex> guard (mutex);
+	btcnew::lock_guard<std::mutex> guard (pending_conf_height_mutex);
 	pending_conf_height.erase (hash_a);
 }
 
@@ -1025,47 +1436,49 @@ void btcnew::active_transactions::clear_block (btcnew::block_hash const & hash_a
 boost::optional<btcnew::election_status_type> btcnew::active_transactions::confirm_block (btcnew::transaction const & transaction_a, std::shared_ptr<btcnew::block> block_a)
 {
 	auto hash (block_a->hash ());
-	btcnew::unique_lock<std::mutex> lock (mutex);
-	auto existing (blocks.find (hash));
-	if (existing != blocks.end ())
+	boost::optional<btcnew::election_status_type> result (btcnew::election_status_type::inactive_confirmation_height);
 	{
-		if (!existing->second->confirmed && !existing->second->stopped && existing->second->status.winner->hash () == hash)
+		// An election is indexed in the shard of its root, which all of its blocks share
+		auto & shard_l (shard (block_a->qualified_root ()));
+		auto lock (shard_l.lock ());
+		auto existing (shard_l.blocks.find (hash));
+		if (existing != shard_l.blocks.end ())
 		{
-			existing->second->confirm_once (btcnew::election_status_type::active_confirmation_height);
-			return btcnew::election_status_type::active_confirmation_height;
-		}
-		else
-		{
-			return boost::optional<btcnew::election_status_type>{};
+			if (!existing->second->confirmed && !existing->second->stopped && existing->second->status.winner->hash () == hash)
+			{
+				existing->second->confirm_once (btcnew::election_status_type::active_confirmation_height);
+				result = btcnew::election_status_type::active_confirmation_height;
+			}
+			else
+			{
+				result = boost::none;
+			}
 		}
 	}
-	else
-	{
-		return btcnew::election_status_type::inactive_confirmation_height;
-	}
+	flush_deferred ();
+	return result;
 }
 
 size_t btcnew::active_transactions::priority_cementable_frontiers_size ()
 {
-	btcnew::lock_guard<std::mutex> guard (mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 	return priority_cementable_frontiers.size ();
 }
 
 size_t btcnew::active_transactions::priority_wallet_cementable_frontiers_size ()
 {
-	btcnew::lock_guard<std::mutex> guard (mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 	return priority_wallet_cementable_frontiers.size ();
 }
 
 boost::circular_buffer<double> btcnew::active_transactions::difficulty_trend ()
 {
-	btcnew::lock_guard<std::mutex> guard (mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 	return multipliers_cb;
 }
 
 size_t btcnew::active_transactions::inactive_votes_cache_size ()
 {
-	btcnew::lock_guard<std::mutex> guard (mutex);
 	return inactive_votes_cache.size ();
 }
 
@@ -1074,63 +1487,28 @@ void btcnew::active_transactions::add_inactive_votes_cache (btcnew::block_hash c
 	// Check principal representative status
 	if (node.ledger.weight (representative_a) > node.minimum_principal_weight ())
 	{
-		auto existing (inactive_votes_cache.get<1> ().find (hash_a));
-		if (existing != inactive_votes_cache.get<1> ().end () && !existing->confirmed)
+		std::vector<btcnew::account> voters;
+		if (inactive_votes_cache.vote (hash_a, representative_a, voters) && node.gap_cache.bootstrap_check (voters, hash_a))
 		{
-			auto is_new (false);
-			inactive_votes_cache.get<1> ().modify (existing, [representative_a, &is_new] (btcnew::gap_information & info) {
-				auto it = std::find (info.voters.begin (), info.voters.end (), representative_a);
-				is_new = (it == info.voters.end ());
-				if (is_new)
-				{
-					info.arrival = std::chrono::steady_clock::now ();
-					info.voters.push_back (representative_a);
-				}
-			});
-
-			if (is_new)
-			{
-				if (node.gap_cache.bootstrap_check (existing->voters, hash_a))
-				{
-					inactive_votes_cache.get<1> ().modify (existing, [] (btcnew::gap_information & info) {
-						info.confirmed = true;
-					});
-				}
-			}
-		}
-		else
-		{
-			inactive_votes_cache.insert ({ std::chrono::steady_clock::now (), hash_a, std::vector<btcnew::account> (1, representative_a) });
-			if (inactive_votes_cache.size () > inactive_votes_cache_max)
-			{
-				inactive_votes_cache.get<0> ().erase (inactive_votes_cache.get<0> ().begin ());
-			}
+			inactive_votes_cache.confirm (hash_a);
 		}
 	}
 }
 
 btcnew::gap_information btcnew::active_transactions::find_inactive_votes_cache (btcnew::block_hash const & hash_a)
 {
-	auto existing (inactive_votes_cache.get<1> ().find (hash_a));
-	if (existing != inactive_votes_cache.get<1> ().end ())
-	{
-		return *existing;
-	}
-	else
-	{
-		return btcnew::gap_information{ std::chrono::steady_clock::time_point{}, 0, std::vector<btcnew::account>{} };
-	}
+	return inactive_votes_cache.find (hash_a);
 }
 
 size_t btcnew::active_transactions::dropped_elections_cache_size ()
 {
-	btcnew::lock_guard<std::mutex> guard (mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> guard (mutex);
 	return dropped_elections_cache.size ();
 }
 
 void btcnew::active_transactions::add_dropped_elections_cache (btcnew::qualified_root const & root_a)
 {
-	assert (!mutex.try_lock ());
+	assert (mutex.owned ());
 	dropped_elections_cache.insert (btcnew::election_timepoint{ std::chrono::steady_clock::now (), root_a });
 	if (dropped_elections_cache.size () > dropped_elections_cache_max)
 	{
@@ -1138,9 +1516,15 @@ void btcnew::active_transactions::add_dropped_elections_cache (btcnew::qualified
 	}
 }
 
+size_t btcnew::active_transactions::scheduled_size ()
+{
+	btcnew::lock_guard<std::mutex> guard (scheduled_mutex);
+	return scheduled.size ();
+}
+
 std::chrono::steady_clock::time_point btcnew::active_transactions::find_dropped_elections_cache (btcnew::qualified_root const & root_a)
 {
-	assert (!mutex.try_lock ());
+	assert (mutex.owned ());
 	auto existing (dropped_elections_cache.get<1> ().find (root_a));
 	if (existing != dropped_elections_cache.get<1> ().end ())
 	{
@@ -1167,22 +1551,33 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (active_transaction
 	size_t pending_conf_height_count = 0;
 
 	{
-		btcnew::lock_guard<std::mutex> guard (active_transactions.mutex);
-		roots_count = active_transactions.roots.size ();
-		blocks_count = active_transactions.blocks.size ();
+		btcnew::lock_guard<btcnew::elections_mutex> guard (active_transactions.mutex);
+		roots_count = active_transactions.roots_size ();
+		blocks_count = active_transactions.blocks_size ();
+	}
+	{
+		btcnew::lock_guard<std::mutex> guard (active_transactions.confirmed_mutex);
 		confirmed_count = active_transactions.confirmed.size ();
+	}
+	{
+		btcnew::lock_guard<std::mutex> guard (active_transactions.pending_conf_height_mutex);
 		pending_conf_height_count = active_transactions.pending_conf_height.size ();
 	}
 
 	auto composite = std::make_unique<seq_con_info_composite> (name);
-	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "roots", roots_count, sizeof (decltype (active_transactions.roots)::value_type) }));
-	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "blocks", blocks_count, sizeof (decltype (active_transactions.blocks)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "roots", roots_count, sizeof (btcnew::conflict_info) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "blocks", blocks_count, sizeof (decltype (btcnew::active_shard::blocks)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "pending_conf_height", pending_conf_height_count, sizeof (decltype (active_transactions.pending_conf_height)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "confirmed", confirmed_count, sizeof (decltype (active_transactions.confirmed)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "priority_wallet_cementable_frontiers_count", active_transactions.priority_wallet_cementable_frontiers_size (), sizeof (btcnew::cementable_account) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "priority_cementable_frontiers_count", active_transactions.priority_cementable_frontiers_size (), sizeof (btcnew::cementable_account) }));
-	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "inactive_votes_cache_count", active_transactions.inactive_votes_cache_size (), sizeof (btcnew::gap_information) }));
+	composite->add_component (collect_seq_con_info (active_transactions.inactive_votes_cache, "inactive_votes_cache"));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "dropped_elections_count", active_transactions.dropped_elections_cache_size (), sizeof (btcnew::election_timepoint) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "scheduled", active_transactions.scheduled_size (), sizeof (btcnew::qualified_root) }));
+	{
+		btcnew::lock_guard<btcnew::elections_mutex> guard (active_transactions.mutex);
+		composite->add_component (collect_seq_con_info (active_transactions.scheduler, "scheduler"));
+	}
 	return composite;
 }
 }
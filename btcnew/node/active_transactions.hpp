@@ -1,8 +1,12 @@
 #pragma once
 
+#include <btcnew/lib/locks.hpp>
 #include <btcnew/lib/numbers.hpp>
 #include <btcnew/lib/timer.hpp>
+#include <btcnew/lib/timer_wheel.hpp>
+#include <btcnew/node/election_scheduler.hpp>
 #include <btcnew/node/gap_cache.hpp>
+#include <btcnew/node/inactive_votes_cache.hpp>
 #include <btcnew/node/repcrawler.hpp>
 #include <btcnew/node/transport/transport.hpp>
 #include <btcnew/secure/blockstore.hpp>
@@ -17,12 +21,15 @@
 #include <boost/pool/pool_alloc.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <set>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -44,6 +51,50 @@ public:
 	std::shared_ptr<btcnew::election> election;
 };
 
+using active_roots = boost::multi_index_container<
+btcnew::conflict_info,
+boost::multi_index::indexed_by<
+boost::multi_index::hashed_unique<
+boost::multi_index::member<btcnew::conflict_info, btcnew::qualified_root, &btcnew::conflict_info::root>>,
+boost::multi_index::ordered_non_unique<
+boost::multi_index::member<btcnew::conflict_info, uint64_t, &btcnew::conflict_info::adjusted_difficulty>,
+std::greater<uint64_t>>>>;
+
+/** Elections whose qualified roots hash to the same shard, with the indexes used to find them */
+class active_shard final
+{
+public:
+	/** Lock the shard, counting contention */
+	std::unique_lock<std::mutex> lock ();
+	std::mutex mutex;
+	btcnew::active_roots roots;
+	std::unordered_map<btcnew::block_hash, std::shared_ptr<btcnew::election>> blocks;
+	btcnew::lock_counters counters;
+};
+
+size_t constexpr active_shard_count = 8;
+
+/**
+ * Lock over every election, taking the state shared between elections and then each shard in order.
+ * Operations spanning several roots hold it, votes and lookups for a single root only lock that root's shard.
+ */
+class elections_mutex final
+{
+public:
+	explicit elections_mutex (std::array<btcnew::active_shard, btcnew::active_shard_count> &);
+	void lock ();
+	bool try_lock ();
+	void unlock ();
+	/** Whether the calling thread holds the lock */
+	bool owned () const;
+	btcnew::lock_counters counters;
+
+private:
+	std::mutex mutex;
+	std::array<btcnew::active_shard, btcnew::active_shard_count> & shards;
+	std::atomic<std::thread::id> owner{ std::thread::id () };
+};
+
 enum class election_status_type : uint8_t
 {
 	ongoing = 0,
@@ -91,6 +142,8 @@ public:
 	// clang-format off
 	bool start (std::shared_ptr<btcnew::block>, bool const = false, std::function<void(std::shared_ptr<btcnew::block>)> const & = [](std::shared_ptr<btcnew::block>) {});
 	// clang-format on
+	// Start an election for a live block, or queue it by priority if the container is full
+	void activate (std::shared_ptr<btcnew::block> const &, btcnew::uint128_t const &, std::chrono::seconds);
 	// If this returns true, the vote is a replay
 	// If this returns false, the vote may or may not be a replay
 	bool vote (std::shared_ptr<btcnew::vote>, bool = false);
@@ -99,7 +152,7 @@ public:
 	bool active (btcnew::qualified_root const &);
 	void update_difficulty (std::shared_ptr<btcnew::block>, boost::optional<btcnew::write_transaction const &> = boost::none);
 	void adjust_difficulty (btcnew::block_hash const &);
-	void update_active_difficulty (btcnew::unique_lock<std::mutex> &);
+	void update_active_difficulty (std::unique_lock<btcnew::elections_mutex> &);
 	uint64_t active_difficulty ();
 	uint64_t limited_active_difficulty ();
 	std::deque<std::shared_ptr<btcnew::block>> list_blocks (bool = false);
@@ -110,23 +163,32 @@ public:
 	bool publish (std::shared_ptr<btcnew::block> block_a);
 	boost::optional<btcnew::election_status_type> confirm_block (btcnew::transaction const &, std::shared_ptr<btcnew::block>);
 	void post_confirmation_height_set (btcnew::transaction const & transaction_a, std::shared_ptr<btcnew::block> block_a, btcnew::block_sideband const & sideband_a, btcnew::election_status_type election_status_type_a);
-	boost::multi_index_container<
-	btcnew::conflict_info,
-	boost::multi_index::indexed_by<
-	boost::multi_index::hashed_unique<
-	boost::multi_index::member<btcnew::conflict_info, btcnew::qualified_root, &btcnew::conflict_info::root>>,
-	boost::multi_index::ordered_non_unique<
-	boost::multi_index::member<btcnew::conflict_info, uint64_t, &btcnew::conflict_info::adjusted_difficulty>,
-	std::greater<uint64_t>>>>
-	roots;
-	std::unordered_map<btcnew::block_hash, std::shared_ptr<btcnew::election>> blocks;
+	// Elections sharded by the hash of their qualified root
+	std::array<btcnew::active_shard, btcnew::active_shard_count> shards;
+	btcnew::active_shard & shard (btcnew::qualified_root const &);
+	// The remaining members guarded by mutex are shared between shards
+	btcnew::elections_mutex mutex;
+	// Requires mutex, nullptr if there is no election for the root
+	btcnew::conflict_info const * find_root (btcnew::qualified_root const &);
+	// Requires mutex, nullptr if the block is not part of an election
+	std::shared_ptr<btcnew::election> find_election (btcnew::block_hash const &);
+	// Requires mutex, every election ordered by adjusted difficulty, highest first
+	std::vector<btcnew::conflict_info> sorted_roots (size_t = std::numeric_limits<size_t>::max ());
+	// Requires mutex
+	size_t roots_size ();
+	size_t blocks_size ();
+	// Requires the shard of the root, or mutex
+	void erase_root (btcnew::qualified_root const &);
+	// Cross shard work requested by elections holding only their own shard
+	void defer_update_dependent (std::shared_ptr<btcnew::election> const &);
 	std::deque<btcnew::election_status> list_confirmed ();
 	std::deque<btcnew::election_status> confirmed;
+	// Guards confirmed and the recently confirmed roots, so history queries don't contend with elections
+	std::mutex confirmed_mutex;
 	void add_confirmed (btcnew::election_status const &, btcnew::qualified_root const &);
 	void add_inactive_votes_cache (btcnew::block_hash const &, btcnew::account const &);
 	btcnew::gap_information find_inactive_votes_cache (btcnew::block_hash const &);
 	btcnew::node & node;
-	std::mutex mutex;
 	std::chrono::seconds const long_election_threshold;
 	// Delay until requesting confirmation for an election
 	std::chrono::milliseconds const election_request_delay;
@@ -137,16 +199,22 @@ public:
 	static size_t constexpr max_confirm_req_batches = 20;
 	static size_t constexpr max_confirm_req = 5;
 	boost::circular_buffer<double> multipliers_cb;
-	uint64_t trended_active_difficulty;
+	// Written under mutex, read without it by work generation and RPC
+	std::atomic<uint64_t> trended_active_difficulty;
 	size_t priority_cementable_frontiers_size ();
 	size_t priority_wallet_cementable_frontiers_size ();
 	boost::circular_buffer<double> difficulty_trend ();
 	size_t inactive_votes_cache_size ();
 	std::unordered_map<btcnew::block_hash, std::shared_ptr<btcnew::election>> pending_conf_height;
+	// Guards pending_conf_height, acquired after mutex when both are held
+	std::mutex pending_conf_height_mutex;
 	void clear_block (btcnew::block_hash const & hash_a);
 	void add_dropped_elections_cache (btcnew::qualified_root const &);
 	std::chrono::steady_clock::time_point find_dropped_elections_cache (btcnew::qualified_root const &);
 	size_t dropped_elections_cache_size ();
+	size_t scheduled_size ();
+	// Live blocks waiting for room in roots, guarded by mutex
+	btcnew::election_scheduler scheduler;
 
 private:
 	// Call action with confirmed block, may be different than what we started with
@@ -160,7 +228,13 @@ private:
 	bool election_request_confirm (std::shared_ptr<btcnew::election> &, std::vector<btcnew::representative> const &, size_t const &,
 	std::deque<std::pair<std::shared_ptr<btcnew::block>, std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>>>>> & single_confirm_req_bundle_l,
 	std::unordered_map<std::shared_ptr<btcnew::transport::channel>, std::deque<std::pair<btcnew::block_hash, btcnew::root>>> & batched_confirm_req_bundle_l);
-	void request_confirm (btcnew::unique_lock<std::mutex> &);
+	void request_confirm (std::unique_lock<btcnew::elections_mutex> &);
+	void activate_scheduled (btcnew::read_transaction const &);
+	bool recently_confirmed (btcnew::qualified_root const &);
+	void schedule (btcnew::qualified_root const &, std::chrono::steady_clock::time_point);
+	void unschedule (btcnew::qualified_root const &);
+	// First request count at or after the argument on which an election broadcasts or requests confirmation
+	unsigned next_request_count (unsigned) const;
 	btcnew::account next_frontier_account{ 0 };
 	std::chrono::steady_clock::time_point next_frontier_check{ std::chrono::steady_clock::now () };
 	btcnew::condition_variable condition;
@@ -190,15 +264,28 @@ private:
 	void prioritize_account_for_confirmation (prioritize_num_uncemented &, size_t &, btcnew::account const &, btcnew::account_info const &, uint64_t);
 	static size_t constexpr max_priority_cementable_frontiers{ 100000 };
 	static size_t constexpr confirmed_frontiers_max_pending_cut_off{ 1000 };
-	boost::multi_index_container<
-	btcnew::gap_information,
-	boost::multi_index::indexed_by<
-	boost::multi_index::ordered_non_unique<boost::multi_index::member<btcnew::gap_information, std::chrono::steady_clock::time_point, &btcnew::gap_information::arrival>>,
-	boost::multi_index::hashed_unique<boost::multi_index::member<btcnew::gap_information, btcnew::block_hash, &btcnew::gap_information::hash>>>>
-	inactive_votes_cache;
-	static size_t constexpr inactive_votes_cache_max{ 16 * 1024 };
+	btcnew::inactive_votes_cache inactive_votes_cache;
 	ordered_elections_timepoint dropped_elections_cache;
 	static size_t constexpr dropped_elections_cache_max{ 32 * 1024 };
+	// Roots of active elections keyed by when their next broadcast or confirmation request is due, guarded by scheduled_mutex so elections can leave it holding only their shard
+	btcnew::timer_wheel<btcnew::qualified_root> scheduled;
+	std::mutex scheduled_mutex;
+	// Run cross shard work deferred by elections, requires mutex
+	void run_deferred ();
+	// Take mutex to run deferred work if there is any
+	void flush_deferred ();
+	std::mutex deferred_mutex;
+	std::vector<btcnew::block_hash> deferred_adjust;
+	std::vector<std::shared_ptr<btcnew::election>> deferred_dependent;
+	std::atomic<bool> deferred{ false };
+	// Add lock contention since the last call to the election stats
+	void publish_lock_stats ();
+	uint64_t published_shard_contended{ 0 };
+	uint64_t published_shard_blocked_us{ 0 };
+	uint64_t published_elections_contended{ 0 };
+	uint64_t published_elections_blocked_us{ 0 };
+	// Maximum number of due elections handled before the mutex is released
+	static size_t constexpr request_confirm_batch_size{ 512 };
 	boost::thread thread;
 
 	friend class confirmation_height_prioritize_frontiers_Test;
@@ -206,6 +293,7 @@ private:
 	friend class confirmation_height_many_accounts_single_confirmation_Test;
 	friend class confirmation_height_many_accounts_many_confirmations_Test;
 	friend class confirmation_height_long_chains_Test;
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (active_transactions &, const std::string &);
 };
 
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (active_transactions & active_transactions, const std::string & name);
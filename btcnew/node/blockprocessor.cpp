@@ -69,8 +69,9 @@ void btcnew::block_processor::add (btcnew::unchecked_info const & info_a)
 {
 	if (!btcnew::work_validate (info_a.block->root (), info_a.block->block_work ()))
 	{
+		auto hash (info_a.block->hash ());
+		auto queued (false);
 		{
-			auto hash (info_a.block->hash ());
 			auto filter_hash (filter_item (hash, info_a.block->block_signature ()));
 			btcnew::lock_guard<std::mutex> lock (mutex);
 			if (blocks_filter.find (filter_hash) == blocks_filter.end () && rolled_back.get<1> ().find (hash) == rolled_back.get<1> ().end ())
@@ -84,8 +85,13 @@ void btcnew::block_processor::add (btcnew::unchecked_info const & info_a)
 					blocks.push_back (info_a);
 				}
 				blocks_filter.insert (filter_hash);
+				queued = true;
 			}
 		}
+		if (queued)
+		{
+			node.latency.stage (hash, btcnew::latency_stage::enqueue);
+		}
 		condition.notify_all ();
 	}
 	else
@@ -266,6 +272,7 @@ void btcnew::block_processor::process_batch (btcnew::unique_lock<std::mutex> & l
 	// Processing blocks
 	auto first_time (true);
 	unsigned number_of_blocks_processed (0), number_of_forced_processed (0);
+	auto rolled_back_blocks (false);
 	while ((!blocks.empty () || !forced.empty ()) && (timer_l.before_deadline (node.config.block_processor_batch_max_time) || (number_of_blocks_processed < node.flags.block_processor_batch_size)) && !awaiting_write)
 	{
 		auto log_this_record (false);
@@ -308,6 +315,7 @@ void btcnew::block_processor::process_batch (btcnew::unique_lock<std::mutex> & l
 			number_of_forced_processed++;
 		}
 		lock_a.unlock ();
+		node.latency.stage (hash, btcnew::latency_stage::dequeue);
 		if (force)
 		{
 			auto successor (node.ledger.successor (transaction, info.block->qualified_root ()));
@@ -323,6 +331,7 @@ void btcnew::block_processor::process_batch (btcnew::unique_lock<std::mutex> & l
 				else
 				{
 					node.logger.always_log (boost::str (boost::format ("%1% blocks rolled back") % rollback_list.size ()));
+					rolled_back_blocks = true;
 				}
 				lock_a.lock ();
 				// Prevent rolled back blocks second insertion
@@ -338,6 +347,8 @@ void btcnew::block_processor::process_batch (btcnew::unique_lock<std::mutex> & l
 					}
 				}
 				lock_a.unlock ();
+				// Rolled back blocks may be published again
+				node.network.publish_filter.clear (rollback_list);
 				// Deleting from votes cache & wallet work watcher, stop active transaction
 				for (auto & i : rollback_list)
 				{
@@ -360,16 +371,46 @@ void btcnew::block_processor::process_batch (btcnew::unique_lock<std::mutex> & l
 	awaiting_write = false;
 	lock_a.unlock ();
 
+	if (rolled_back_blocks)
+	{
+		// Blocks read ahead for cementing may have been rolled back, drop them once the rollback is visible to new readers
+		transaction.commit ();
+		node.confirmation_height_processor.invalidate_prefetched ();
+		transaction.renew ();
+	}
+
 	if (node.config.logging.timing_logging () && number_of_blocks_processed != 0)
 	{
 		node.logger.always_log (boost::str (boost::format ("Processed %1% blocks (%2% blocks were forced) in %3% %4%") % number_of_blocks_processed % number_of_forced_processed % timer_l.stop ().count () % timer_l.unit ()));
 	}
 }
 
-void btcnew::block_processor::process_live (btcnew::block_hash const & hash_a, std::shared_ptr<btcnew::block> block_a, const bool watch_work_a)
+void btcnew::block_processor::process_live (btcnew::transaction const & transaction_a, btcnew::block_hash const & hash_a, std::shared_ptr<btcnew::block> block_a, const bool watch_work_a)
 {
-	// Start collecting quorum on block
-	node.active.start (block_a, false);
+	if (watch_work_a || node.wallets.watcher->is_watched (block_a->qualified_root ()))
+	{
+		// Local blocks start collecting quorum right away, wallets add theirs to the work watcher before processing them
+		node.active.start (block_a, false);
+	}
+	else
+	{
+		// Prioritize by the larger of the balances before and after the block, and by how long the account was idle since its last confirmed block
+		auto balance (node.ledger.balance (transaction_a, hash_a));
+		std::chrono::seconds idle (0);
+		auto previous (block_a->previous ());
+		if (!previous.is_zero ())
+		{
+			balance = std::max (balance, node.ledger.balance (transaction_a, previous));
+			btcnew::block_sideband sideband;
+			if (node.store.block_get (transaction_a, previous, &sideband) != nullptr && node.ledger.block_confirmed (transaction_a, previous))
+			{
+				auto now (btcnew::seconds_since_epoch ());
+				idle = std::chrono::seconds (now > sideband.timestamp ? now - sideband.timestamp : 0);
+			}
+		}
+		// Start collecting quorum on block, or queue it if there are too many active elections
+		node.active.activate (block_a, balance, idle);
+	}
 	//add block to watcher if desired after block has been added to active
 	if (watch_work_a)
 	{
@@ -389,6 +430,7 @@ btcnew::process_return btcnew::block_processor::process_one (btcnew::write_trans
 	btcnew::process_return result;
 	auto hash (info_a.block->hash ());
 	result = node.ledger.process (transaction_a, *(info_a.block), info_a.verified);
+	node.latency.stage (hash, btcnew::latency_stage::ledger_process);
 	switch (result.code)
 	{
 		case btcnew::process_result::progress: {
@@ -401,7 +443,7 @@ btcnew::process_return btcnew::block_processor::process_one (btcnew::write_trans
 			}
 			if (info_a.modified > btcnew::seconds_since_epoch () - 300 && node.block_arrival.recent (hash))
 			{
-				process_live (hash, info_a.block, watch_work_a);
+				process_live (transaction_a, hash, info_a.block, watch_work_a);
 			}
 			queue_unchecked (transaction_a, hash);
 			break;
@@ -58,7 +58,7 @@ private:
 	void queue_unchecked (btcnew::write_transaction const &, btcnew::block_hash const &);
 	void verify_state_blocks (btcnew::unique_lock<std::mutex> &, size_t = std::numeric_limits<size_t>::max ());
 	void process_batch (btcnew::unique_lock<std::mutex> &);
-	void process_live (btcnew::block_hash const &, std::shared_ptr<btcnew::block>, const bool = false);
+	void process_live (btcnew::transaction const &, btcnew::block_hash const &, std::shared_ptr<btcnew::block>, const bool = false);
 	void requeue_invalid (btcnew::block_hash const &, btcnew::unchecked_info const &);
 	bool stopped;
 	bool active;
@@ -739,7 +739,6 @@ bool btcnew::bootstrap_attempt::confirm_frontiers (btcnew::unique_lock<std::mute
 				}
 				else
 				{
-					btcnew::lock_guard<std::mutex> active_lock (node->active.mutex);
 					auto existing (node->active.find_inactive_votes_cache (*ii));
 					btcnew::uint128_t tally;
 					for (auto & voter : existing.voters)
@@ -487,18 +487,33 @@ void btcnew::bulk_pull_server::send_next ()
 			btcnew::vectorstream stream (send_buffer);
 			btcnew::serialize_block (stream, *block);
 		}
-		auto this_l (shared_from_this ());
 		if (connection->node->config.logging.bulk_pull_logging ())
 		{
 			connection->node->logger.try_log (boost::str (boost::format ("Sending block: %1%") % block->hash ().to_string ()));
 		}
-		connection->socket->async_write (btcnew::shared_const_buffer (std::move (send_buffer)), [this_l] (boost::system::error_code const & ec, size_t size_a) {
+		send_paced (btcnew::shared_const_buffer (std::move (send_buffer)));
+	}
+	else
+	{
+		send_finished ();
+	}
+}
+
+void btcnew::bulk_pull_server::send_paced (btcnew::shared_const_buffer const & buffer_a)
+{
+	auto this_l (shared_from_this ());
+	if (!connection->node->network.traffic_shaper.should_drop_outbound (btcnew::message_type::bulk_pull, buffer_a.size ()))
+	{
+		connection->socket->async_write (buffer_a, [this_l] (boost::system::error_code const & ec, size_t size_a) {
 			this_l->sent_action (ec, size_a);
 		});
 	}
 	else
 	{
-		send_finished ();
+		// Bootstrap serving is paced rather than dropped, the budget is checked again after a short delay to let its class refill
+		connection->node->alarm.add (std::chrono::steady_clock::now () + std::chrono::milliseconds (10), [this_l, buffer_a] () {
+			this_l->send_paced (buffer_a);
+		});
 	}
 }
 
@@ -62,6 +62,8 @@ public:
 	void set_current_end ();
 	std::shared_ptr<btcnew::block> get_next ();
 	void send_next ();
+	/** Write \p buffer_a once the outbound bootstrap traffic budget allows it */
+	void send_paced (btcnew::shared_const_buffer const & buffer_a);
 	void sent_action (boost::system::error_code const &, size_t);
 	void send_finished ();
 	void no_block_sent (boost::system::error_code const &, size_t);
@@ -25,6 +25,11 @@ void btcnew::bootstrap_listener::start ()
 			keep_accepting = false;
 			this->node.logger.try_log (boost::str (boost::format ("Error while accepting incoming TCP/bootstrap connections: %1%") % ec_a.message ()));
 		}
+		else if (this->node.network.peer_limiter.excluded (btcnew::transport::map_tcp_to_endpoint (new_connection->remote_endpoint ()).address ()))
+		{
+			// Dropping the socket closes the connection
+			this->node.stats.inc (btcnew::stat::type::peer_limiter, btcnew::stat::detail::excluded_address, btcnew::stat::dir::in);
+		}
 		else
 		{
 			accept_action (ec_a, new_connection);
@@ -154,73 +159,88 @@ void btcnew::bootstrap_server::receive_header_action (boost::system::error_code
 		if (!error)
 		{
 			auto this_l (shared_from_this ());
-			switch (header.type)
+			auto endpoint_l (btcnew::transport::map_tcp_to_endpoint (remote_endpoint));
+			if (is_realtime_connection () && (node->network.peer_limiter.should_drop (endpoint_l, remote_node_id, btcnew::transport::transport_type::tcp) || node->network.traffic_shaper.should_drop_inbound (endpoint_l, header.type, header.size + header.payload_length_bytes ())))
 			{
-				case btcnew::message_type::bulk_pull: {
-					node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::bulk_pull, btcnew::stat::dir::in);
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_bulk_pull_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::bulk_pull_account: {
-					node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::bulk_pull_account, btcnew::stat::dir::in);
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_bulk_pull_account_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::frontier_req: {
-					node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::frontier_req, btcnew::stat::dir::in);
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_frontier_req_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::bulk_push: {
-					node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::bulk_push, btcnew::stat::dir::in);
-					if (is_bootstrap_connection ())
+				// The payload is still read to stay in step with the stream, it is discarded without being parsed
+				socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l] (boost::system::error_code const & ec, size_t size_a) {
+					if (!ec)
 					{
-						add_request (std::unique_ptr<btcnew::message> (new btcnew::bulk_push (header)));
+						this_l->receive ();
 					}
-					break;
-				}
-				case btcnew::message_type::keepalive: {
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_keepalive_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::publish: {
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_publish_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::confirm_ack: {
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_confirm_ack_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::confirm_req: {
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_confirm_req_action (ec, size_a, header);
-					});
-					break;
-				}
-				case btcnew::message_type::node_id_handshake: {
-					socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
-						this_l->receive_node_id_handshake_action (ec, size_a, header);
-					});
-					break;
-				}
-				default: {
-					if (node->config.logging.network_logging ())
-					{
-						node->logger.try_log (boost::str (boost::format ("Received invalid type from bootstrap connection %1%") % static_cast<uint8_t> (header.type)));
+				});
+			}
+			else
+			{
+				node->network.message_histograms.add (btcnew::transport::transport_type::tcp, header.type, btcnew::message_histograms::metric::size, header.size + header.payload_length_bytes ());
+				switch (header.type)
+				{
+					case btcnew::message_type::bulk_pull: {
+						node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::bulk_pull, btcnew::stat::dir::in);
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_bulk_pull_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::bulk_pull_account: {
+						node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::bulk_pull_account, btcnew::stat::dir::in);
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_bulk_pull_account_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::frontier_req: {
+						node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::frontier_req, btcnew::stat::dir::in);
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_frontier_req_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::bulk_push: {
+						node->stats.inc (btcnew::stat::type::bootstrap, btcnew::stat::detail::bulk_push, btcnew::stat::dir::in);
+						if (is_bootstrap_connection ())
+						{
+							add_request (std::unique_ptr<btcnew::message> (new btcnew::bulk_push (header)));
+						}
+						break;
+					}
+					case btcnew::message_type::keepalive: {
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_keepalive_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::publish: {
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_publish_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::confirm_ack: {
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_confirm_ack_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::confirm_req: {
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_confirm_req_action (ec, size_a, header);
+						});
+						break;
+					}
+					case btcnew::message_type::node_id_handshake: {
+						socket->async_read (receive_buffer, header.payload_length_bytes (), [this_l, header] (boost::system::error_code const & ec, size_t size_a) {
+							this_l->receive_node_id_handshake_action (ec, size_a, header);
+						});
+						break;
+					}
+					default: {
+						if (node->config.logging.network_logging ())
+						{
+							node->logger.try_log (boost::str (boost::format ("Received invalid type from bootstrap connection %1%") % static_cast<uint8_t> (header.type)));
+						}
+						break;
 					}
-					break;
 				}
 			}
 		}
@@ -312,11 +332,13 @@ void btcnew::bootstrap_server::receive_keepalive_action (boost::system::error_co
 {
 	if (!ec)
 	{
+		auto start (std::chrono::steady_clock::now ());
 		auto error (false);
 		btcnew::bufferstream stream (receive_buffer->data (), size_a);
 		std::unique_ptr<btcnew::keepalive> request (new btcnew::keepalive (error, stream, header_a));
 		if (!error)
 		{
+			node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, header_a.type, btcnew::message_histograms::metric::parse, start);
 			if (is_realtime_connection ())
 			{
 				add_request (std::unique_ptr<btcnew::message> (request.release ()));
@@ -337,15 +359,34 @@ void btcnew::bootstrap_server::receive_publish_action (boost::system::error_code
 {
 	if (!ec)
 	{
-		auto error (false);
-		btcnew::bufferstream stream (receive_buffer->data (), size_a);
-		std::unique_ptr<btcnew::publish> request (new btcnew::publish (error, stream, header_a));
-		if (!error)
+		auto start (std::chrono::steady_clock::now ());
+		uint64_t digest;
+		if (!node->network.publish_filter.apply (receive_buffer->data (), size_a, &digest))
 		{
-			if (is_realtime_connection ())
+			auto error (false);
+			btcnew::bufferstream stream (receive_buffer->data (), size_a);
+			std::unique_ptr<btcnew::publish> request (new btcnew::publish (error, stream, header_a, digest));
+			if (!error)
 			{
-				add_request (std::unique_ptr<btcnew::message> (request.release ()));
+				node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, header_a.type, btcnew::message_histograms::metric::parse, start);
+				if (is_realtime_connection ())
+				{
+					if (!btcnew::work_validate (*request->block))
+					{
+						add_request (std::unique_ptr<btcnew::message> (request.release ()));
+					}
+					else
+					{
+						node->stats.inc (btcnew::stat::type::error, btcnew::stat::detail::insufficient_work);
+						node->network.peer_limiter.penalize (btcnew::transport::map_tcp_to_endpoint (remote_endpoint), btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::insufficient_work);
+					}
+				}
+				receive ();
 			}
+		}
+		else
+		{
+			node->stats.inc (btcnew::stat::type::filter, btcnew::stat::detail::duplicate_publish);
 			receive ();
 		}
 	}
@@ -362,11 +403,13 @@ void btcnew::bootstrap_server::receive_confirm_req_action (boost::system::error_
 {
 	if (!ec)
 	{
+		auto start (std::chrono::steady_clock::now ());
 		auto error (false);
 		btcnew::bufferstream stream (receive_buffer->data (), size_a);
 		std::unique_ptr<btcnew::confirm_req> request (new btcnew::confirm_req (error, stream, header_a));
 		if (!error)
 		{
+			node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, header_a.type, btcnew::message_histograms::metric::parse, start);
 			if (is_realtime_connection ())
 			{
 				add_request (std::unique_ptr<btcnew::message> (request.release ()));
@@ -384,11 +427,13 @@ void btcnew::bootstrap_server::receive_confirm_ack_action (boost::system::error_
 {
 	if (!ec)
 	{
+		auto start (std::chrono::steady_clock::now ());
 		auto error (false);
 		btcnew::bufferstream stream (receive_buffer->data (), size_a);
 		std::unique_ptr<btcnew::confirm_ack> request (new btcnew::confirm_ack (error, stream, header_a));
 		if (!error)
 		{
+			node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, header_a.type, btcnew::message_histograms::metric::parse, start);
 			if (is_realtime_connection ())
 			{
 				add_request (std::unique_ptr<btcnew::message> (request.release ()));
@@ -406,11 +451,13 @@ void btcnew::bootstrap_server::receive_node_id_handshake_action (boost::system::
 {
 	if (!ec)
 	{
+		auto start (std::chrono::steady_clock::now ());
 		auto error (false);
 		btcnew::bufferstream stream (receive_buffer->data (), size_a);
 		std::unique_ptr<btcnew::node_id_handshake> request (new btcnew::node_id_handshake (error, stream, header_a));
 		if (!error)
 		{
+			node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, header_a.type, btcnew::message_histograms::metric::parse, start);
 			if (type == btcnew::bootstrap_server_type::undefined && !node->flags.disable_tcp_realtime)
 			{
 				add_request (std::unique_ptr<btcnew::message> (request.release ()));
@@ -505,7 +552,9 @@ public:
 	{
 		connection->finish_request_async ();
 		auto connection_l (connection->shared_from_this ());
-		connection->node->background ([connection_l, message_a] () {
+		auto queued (std::chrono::steady_clock::now ());
+		connection->node->background ([connection_l, message_a, queued] () {
+			connection_l->node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, message_a.header.type, btcnew::message_histograms::metric::queue, queued);
 			connection_l->node->network.tcp_channels.process_keepalive (message_a, connection_l->remote_endpoint);
 		});
 	}
@@ -513,7 +562,9 @@ public:
 	{
 		connection->finish_request_async ();
 		auto connection_l (connection->shared_from_this ());
-		connection->node->background ([connection_l, message_a] () {
+		auto queued (std::chrono::steady_clock::now ());
+		connection->node->background ([connection_l, message_a, queued] () {
+			connection_l->node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, message_a.header.type, btcnew::message_histograms::metric::queue, queued);
 			connection_l->node->network.tcp_channels.process_message (message_a, connection_l->remote_endpoint, connection_l->remote_node_id, connection_l->socket, connection_l->type);
 		});
 	}
@@ -521,7 +572,9 @@ public:
 	{
 		connection->finish_request_async ();
 		auto connection_l (connection->shared_from_this ());
-		connection->node->background ([connection_l, message_a] () {
+		auto queued (std::chrono::steady_clock::now ());
+		connection->node->background ([connection_l, message_a, queued] () {
+			connection_l->node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, message_a.header.type, btcnew::message_histograms::metric::queue, queued);
 			connection_l->node->network.tcp_channels.process_message (message_a, connection_l->remote_endpoint, connection_l->remote_node_id, connection_l->socket, connection_l->type);
 		});
 	}
@@ -529,7 +582,9 @@ public:
 	{
 		connection->finish_request_async ();
 		auto connection_l (connection->shared_from_this ());
-		connection->node->background ([connection_l, message_a] () {
+		auto queued (std::chrono::steady_clock::now ());
+		connection->node->background ([connection_l, message_a, queued] () {
+			connection_l->node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, message_a.header.type, btcnew::message_histograms::metric::queue, queued);
 			connection_l->node->network.tcp_channels.process_message (message_a, connection_l->remote_endpoint, connection_l->remote_node_id, connection_l->socket, connection_l->type);
 		});
 	}
@@ -612,7 +667,9 @@ public:
 		btcnew::bootstrap_server_type type (connection->type);
 		assert (node_id.is_zero () || type == btcnew::bootstrap_server_type::realtime);
 		auto connection_l (connection->shared_from_this ());
-		connection->node->background ([connection_l, message_a, node_id, type] () {
+		auto queued (std::chrono::steady_clock::now ());
+		connection->node->background ([connection_l, message_a, node_id, type, queued] () {
+			connection_l->node->network.message_histograms.add_elapsed (btcnew::transport::transport_type::tcp, message_a.header.type, btcnew::message_histograms::metric::queue, queued);
 			connection_l->node->network.tcp_channels.process_message (message_a, connection_l->remote_endpoint, node_id, connection_l->socket, type);
 		});
 	}
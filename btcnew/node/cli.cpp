@@ -89,11 +89,15 @@ void btcnew::add_node_flag_options (boost::program_options::options_description
 		("disable_udp", "Disables UDP realtime network")
 		("disable_unchecked_cleanup", "Disables periodic cleanup of old records from unchecked table")
 		("disable_unchecked_drop", "Disables drop of unchecked table at startup")
+		("cache_confirmation_heights", "Keep the confirmation height of every account in memory to answer confirmation checks without database reads")
 		("fast_bootstrap", "Increase bootstrap speed for high end nodes with higher limits")
 		("batch_size", boost::program_options::value<std::size_t>(), "Increase sideband batch size, default 512")
 		("block_processor_batch_size", boost::program_options::value<std::size_t>(), "Increase block processor transaction batch write size, default 0 (limited by config block_processor_batch_max_time), 256k for fast_bootstrap")
 		("block_processor_full_size", boost::program_options::value<std::size_t>(), "Increase block processor allowed blocks queue size before dropping live network packets and holding bootstrap download, default 65536, 1 million for fast_bootstrap")
-		("block_processor_verification_size", boost::program_options::value<std::size_t>(), "Increase batch signature verification size in block processor, default 0 (limited by config signature_checker_threads), unlimited for fast_bootstrap");
+		("block_processor_verification_size", boost::program_options::value<std::size_t>(), "Increase batch signature verification size in block processor, default 0 (limited by config signature_checker_threads), unlimited for fast_bootstrap")
+		("confirmation_height_prefetch_threads", boost::program_options::value<unsigned>(), "Number of threads reading ahead blocks to be cemented, default is 0 which disables prefetching")
+		("inactive_votes_cache_size", boost::program_options::value<std::size_t>(), "Number of blocks without an election whose votes are cached, default 16384")
+		("vote_processor_threads", boost::program_options::value<unsigned>(), "Number of threads verifying and applying votes, default is half the hardware threads (between 1 and 4)");
 	// clang-format on
 }
 
@@ -118,6 +122,7 @@ std::error_code btcnew::update_flags (btcnew::node_flags & flags_a, boost::progr
 	}
 	flags_a.disable_unchecked_cleanup = (vm.count ("disable_unchecked_cleanup") > 0);
 	flags_a.disable_unchecked_drop = (vm.count ("disable_unchecked_drop") > 0);
+	flags_a.cache_confirmation_heights = (vm.count ("cache_confirmation_heights") > 0);
 	flags_a.fast_bootstrap = (vm.count ("fast_bootstrap") > 0);
 	if (flags_a.fast_bootstrap)
 	{
@@ -140,6 +145,21 @@ std::error_code btcnew::update_flags (btcnew::node_flags & flags_a, boost::progr
 	{
 		flags_a.block_processor_verification_size = block_processor_verification_size_it->second.as<size_t> ();
 	}
+	auto confirmation_height_prefetch_threads_it = vm.find ("confirmation_height_prefetch_threads");
+	if (confirmation_height_prefetch_threads_it != vm.end ())
+	{
+		flags_a.confirmation_height_prefetch_threads = confirmation_height_prefetch_threads_it->second.as<unsigned> ();
+	}
+	auto inactive_votes_cache_size_it = vm.find ("inactive_votes_cache_size");
+	if (inactive_votes_cache_size_it != vm.end ())
+	{
+		flags_a.inactive_votes_cache_size = inactive_votes_cache_size_it->second.as<size_t> ();
+	}
+	auto vote_processor_threads_it = vm.find ("vote_processor_threads");
+	if (vote_processor_threads_it != vm.end ())
+	{
+		flags_a.vote_processor_threads = vote_processor_threads_it->second.as<unsigned> ();
+	}
 	return ec;
 }
 
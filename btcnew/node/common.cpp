@@ -3,6 +3,7 @@
 #include <btcnew/lib/work.hpp>
 #include <btcnew/node/common.hpp>
 #include <btcnew/node/election.hpp>
+#include <btcnew/node/network_filter.hpp>
 #include <btcnew/node/wallet.hpp>
 
 #include <boost/endian/conversion.hpp>
@@ -235,6 +236,9 @@ std::string btcnew::message_parser::status_string ()
 		case btcnew::message_parser::parse_status::invalid_network: {
 			return "invalid_network";
 		}
+		case btcnew::message_parser::parse_status::duplicate_publish_message: {
+			return "duplicate_publish_message";
+		}
 	}
 
 	assert (false);
@@ -242,7 +246,8 @@ std::string btcnew::message_parser::status_string ()
 	return "[unknown parse_status]";
 }
 
-btcnew::message_parser::message_parser (btcnew::block_uniquer & block_uniquer_a, btcnew::vote_uniquer & vote_uniquer_a, btcnew::message_visitor & visitor_a, btcnew::work_pool & pool_a) :
+btcnew::message_parser::message_parser (btcnew::network_filter & publish_filter_a, btcnew::block_uniquer & block_uniquer_a, btcnew::vote_uniquer & vote_uniquer_a, btcnew::message_visitor & visitor_a, btcnew::work_pool & pool_a) :
+publish_filter (publish_filter_a),
 block_uniquer (block_uniquer_a),
 vote_uniquer (vote_uniquer_a),
 visitor (visitor_a),
@@ -276,7 +281,15 @@ void btcnew::message_parser::deserialize_buffer (uint8_t const * buffer_a, size_
 						break;
 					}
 					case btcnew::message_type::publish: {
-						deserialize_publish (stream, header);
+						uint64_t digest;
+						if (!publish_filter.apply (buffer_a + header.size, size_a - header.size, &digest))
+						{
+							deserialize_publish (stream, header, digest);
+						}
+						else
+						{
+							status = parse_status::duplicate_publish_message;
+						}
 						break;
 					}
 					case btcnew::message_type::confirm_req: {
@@ -319,14 +332,18 @@ void btcnew::message_parser::deserialize_keepalive (btcnew::stream & stream_a, b
 	}
 }
 
-void btcnew::message_parser::deserialize_publish (btcnew::stream & stream_a, btcnew::message_header const & header_a)
+void btcnew::message_parser::deserialize_publish (btcnew::stream & stream_a, btcnew::message_header const & header_a, uint64_t const digest_a)
 {
 	auto error (false);
-	btcnew::publish incoming (error, stream_a, header_a, &block_uniquer);
+	auto insufficient_work (false);
+	auto block (deserialize_block_checked (stream_a, header_a.block_type (), error, insufficient_work));
 	if (!error && at_end (stream_a))
 	{
-		if (!btcnew::work_validate (*incoming.block))
+		if (!insufficient_work)
 		{
+			btcnew::publish incoming (block_uniquer.unique (block));
+			incoming.header = header_a;
+			incoming.digest = digest_a;
 			visitor.publish (incoming);
 		}
 		else
@@ -343,21 +360,39 @@ void btcnew::message_parser::deserialize_publish (btcnew::stream & stream_a, btc
 void btcnew::message_parser::deserialize_confirm_req (btcnew::stream & stream_a, btcnew::message_header const & header_a)
 {
 	auto error (false);
-	btcnew::confirm_req incoming (error, stream_a, header_a, &block_uniquer);
-	if (!error && at_end (stream_a))
+	if (header_a.block_type () == btcnew::block_type::not_a_block)
 	{
-		if (incoming.block == nullptr || !btcnew::work_validate (*incoming.block))
+		btcnew::confirm_req incoming (error, stream_a, header_a);
+		if (!error && at_end (stream_a))
 		{
 			visitor.confirm_req (incoming);
 		}
 		else
 		{
-			status = parse_status::insufficient_work;
+			status = parse_status::invalid_confirm_req_message;
 		}
 	}
 	else
 	{
-		status = parse_status::invalid_confirm_req_message;
+		auto insufficient_work (false);
+		auto block (deserialize_block_checked (stream_a, header_a.block_type (), error, insufficient_work));
+		if (!error && at_end (stream_a))
+		{
+			if (!insufficient_work)
+			{
+				btcnew::confirm_req incoming (block_uniquer.unique (block));
+				incoming.header = header_a;
+				visitor.confirm_req (incoming);
+			}
+			else
+			{
+				status = parse_status::insufficient_work;
+			}
+		}
+		else
+		{
+			status = parse_status::invalid_confirm_req_message;
+		}
 	}
 }
 
@@ -411,6 +446,52 @@ bool btcnew::message_parser::at_end (btcnew::stream & stream_a)
 	return end;
 }
 
+namespace
+{
+template <typename T>
+std::shared_ptr<btcnew::block> deserialize_block_checked (btcnew::stream & stream_a, bool & error_a, bool & insufficient_work_a)
+{
+	std::shared_ptr<btcnew::block> result;
+	T block (error_a, stream_a);
+	if (!error_a)
+	{
+		insufficient_work_a = btcnew::work_validate (block);
+		if (!insufficient_work_a)
+		{
+			result = btcnew::make_shared<T> (std::move (block));
+		}
+	}
+	return result;
+}
+}
+
+std::shared_ptr<btcnew::block> btcnew::message_parser::deserialize_block_checked (btcnew::stream & stream_a, btcnew::block_type type_a, bool & error_a, bool & insufficient_work_a)
+{
+	std::shared_ptr<btcnew::block> result;
+	switch (type_a)
+	{
+		case btcnew::block_type::receive:
+			result = ::deserialize_block_checked<btcnew::receive_block> (stream_a, error_a, insufficient_work_a);
+			break;
+		case btcnew::block_type::send:
+			result = ::deserialize_block_checked<btcnew::send_block> (stream_a, error_a, insufficient_work_a);
+			break;
+		case btcnew::block_type::open:
+			result = ::deserialize_block_checked<btcnew::open_block> (stream_a, error_a, insufficient_work_a);
+			break;
+		case btcnew::block_type::change:
+			result = ::deserialize_block_checked<btcnew::change_block> (stream_a, error_a, insufficient_work_a);
+			break;
+		case btcnew::block_type::state:
+			result = ::deserialize_block_checked<btcnew::state_block> (stream_a, error_a, insufficient_work_a);
+			break;
+		default:
+			error_a = true;
+			break;
+	}
+	return result;
+}
+
 btcnew::keepalive::keepalive () :
 message (btcnew::message_type::keepalive)
 {
@@ -472,8 +553,9 @@ bool btcnew::keepalive::operator== (btcnew::keepalive const & other_a) const
 	return peers == other_a.peers;
 }
 
-btcnew::publish::publish (bool & error_a, btcnew::stream & stream_a, btcnew::message_header const & header_a, btcnew::block_uniquer * uniquer_a) :
-message (header_a)
+btcnew::publish::publish (bool & error_a, btcnew::stream & stream_a, btcnew::message_header const & header_a, uint64_t const digest_a, btcnew::block_uniquer * uniquer_a) :
+message (header_a),
+digest (digest_a)
 {
 	if (!error_a)
 	{
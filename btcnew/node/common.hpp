@@ -225,6 +225,8 @@ public:
 
 	static std::bitset<16> constexpr block_type_mask = std::bitset<16> (0x0f00);
 	static std::bitset<16> constexpr count_mask = std::bitset<16> (0xf000);
+	/** Size of the serialized header: magic number, versions, type and extensions */
+	static size_t constexpr size = sizeof (std::array<uint8_t, 2>) + sizeof (version_max) + sizeof (version_using) + sizeof (version_min) + sizeof (type) + sizeof (uint16_t);
 };
 class message
 {
@@ -248,6 +250,7 @@ public:
 	btcnew::message_header header;
 };
 class work_pool;
+class network_filter;
 class message_parser final
 {
 public:
@@ -264,16 +267,23 @@ public:
 		invalid_node_id_handshake_message,
 		outdated_version,
 		invalid_magic,
-		invalid_network
+		invalid_network,
+		duplicate_publish_message
 	};
-	message_parser (btcnew::block_uniquer &, btcnew::vote_uniquer &, btcnew::message_visitor &, btcnew::work_pool &);
+	message_parser (btcnew::network_filter &, btcnew::block_uniquer &, btcnew::vote_uniquer &, btcnew::message_visitor &, btcnew::work_pool &);
 	void deserialize_buffer (uint8_t const *, size_t);
 	void deserialize_keepalive (btcnew::stream &, btcnew::message_header const &);
-	void deserialize_publish (btcnew::stream &, btcnew::message_header const &);
+	void deserialize_publish (btcnew::stream &, btcnew::message_header const &, uint64_t const = 0);
 	void deserialize_confirm_req (btcnew::stream &, btcnew::message_header const &);
 	void deserialize_confirm_ack (btcnew::stream &, btcnew::message_header const &);
 	void deserialize_node_id_handshake (btcnew::stream &, btcnew::message_header const &);
 	bool at_end (btcnew::stream &);
+	/**
+	 * Deserializes a block onto the stack and checks its work before allocating it, so blocks which are rejected cost no allocation.
+	 * Returns nullptr if the block can't be deserialized, setting the error, or if its work is insufficient, setting \p insufficient_work_a
+	 */
+	static std::shared_ptr<btcnew::block> deserialize_block_checked (btcnew::stream &, btcnew::block_type, bool & error_a, bool & insufficient_work_a);
+	btcnew::network_filter & publish_filter;
 	btcnew::block_uniquer & block_uniquer;
 	btcnew::vote_uniquer & vote_uniquer;
 	btcnew::message_visitor & visitor;
@@ -297,13 +307,15 @@ public:
 class publish final : public message
 {
 public:
-	publish (bool &, btcnew::stream &, btcnew::message_header const &, btcnew::block_uniquer * = nullptr);
+	publish (bool &, btcnew::stream &, btcnew::message_header const &, uint64_t const = 0, btcnew::block_uniquer * = nullptr);
 	explicit publish (std::shared_ptr<btcnew::block>);
 	void visit (btcnew::message_visitor &) const override;
 	void serialize (btcnew::stream &) const override;
 	bool deserialize (btcnew::stream &, btcnew::block_uniquer * = nullptr);
 	bool operator== (btcnew::publish const &) const;
 	std::shared_ptr<btcnew::block> block;
+	/** Digest of the payload in btcnew::network::publish_filter, zero if it was not filtered */
+	uint64_t digest{ 0 };
 };
 class confirm_req final : public message
 {
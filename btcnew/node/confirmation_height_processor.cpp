@@ -15,7 +15,7 @@
 #include <cassert>
 #include <numeric>
 
-btcnew::confirmation_height_processor::confirmation_height_processor (btcnew::pending_confirmation_height & pending_confirmation_height_a, btcnew::ledger & ledger_a, btcnew::active_transactions & active_a, btcnew::write_database_queue & write_database_queue_a, std::chrono::milliseconds batch_separate_pending_min_time_a, btcnew::logger_mt & logger_a) :
+btcnew::confirmation_height_processor::confirmation_height_processor (btcnew::pending_confirmation_height & pending_confirmation_height_a, btcnew::ledger & ledger_a, btcnew::active_transactions & active_a, btcnew::write_database_queue & write_database_queue_a, std::chrono::milliseconds batch_separate_pending_min_time_a, btcnew::logger_mt & logger_a, unsigned num_prefetch_threads_a) :
 pending_confirmations (pending_confirmation_height_a),
 ledger (ledger_a),
 active (active_a),
@@ -27,6 +27,13 @@ thread ([this] () {
 	this->run ();
 })
 {
+	for (auto i (0u); i < num_prefetch_threads_a; ++i)
+	{
+		prefetch_threads.emplace_back ([this] () {
+			btcnew::thread_role::set (btcnew::thread_role::name::confirmation_height_processing);
+			this->run_prefetch ();
+		});
+	}
 }
 
 btcnew::confirmation_height_processor::~confirmation_height_processor ()
@@ -36,8 +43,19 @@ btcnew::confirmation_height_processor::~confirmation_height_processor ()
 
 void btcnew::confirmation_height_processor::stop ()
 {
-	stopped = true;
+	{
+		btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+		stopped = true;
+	}
 	condition.notify_one ();
+	prefetch_condition.notify_all ();
+	for (auto & prefetch_thread : prefetch_threads)
+	{
+		if (prefetch_thread.joinable ())
+		{
+			prefetch_thread.join ();
+		}
+	}
 	if (thread.joinable ())
 	{
 		thread.join ();
@@ -61,6 +79,13 @@ void btcnew::confirmation_height_processor::run ()
 				// Separate blocks which are pending confirmation height can be batched by a minimum processing time (to improve disk write performance), so make sure the slate is clean when a new batch is starting.
 				confirmed_iterated_pairs.clear ();
 				timer.restart ();
+				if (prefetched_size >= max_prefetched_blocks)
+				{
+					// Prefetched blocks are only removed once used, so drop any which were not needed to allow prefetching to continue
+					btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+					prefetched.clear ();
+					prefetched_size = 0;
+				}
 			}
 			add_confirmation_height (current_pending_block);
 			lk.lock ();
@@ -78,12 +103,120 @@ void btcnew::confirmation_height_processor::run ()
 			}
 			else
 			{
+				if (prefetched_size > 0)
+				{
+					btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+					prefetched.clear ();
+					prefetched_size = 0;
+				}
 				condition.wait (lk);
 			}
 		}
 	}
 }
 
+void btcnew::confirmation_height_processor::run_prefetch ()
+{
+	btcnew::unique_lock<std::mutex> lock (prefetch_mutex);
+	while (!stopped)
+	{
+		if (!prefetch_queue.empty ())
+		{
+			auto hash (prefetch_queue.front ());
+			prefetch_queue.pop_front ();
+			lock.unlock ();
+			prefetch (hash);
+			lock.lock ();
+		}
+		else
+		{
+			prefetch_condition.wait (lock);
+		}
+	}
+}
+
+/*
+ * Reads the uncemented part of the account chain below this block, and the chains of any sources found, so that
+ * the cementing thread rarely has to go to disk itself. The walk is bounded by batch_read_size blocks per queued block.
+ */
+void btcnew::confirmation_height_processor::prefetch (btcnew::block_hash const & hash_a)
+{
+	std::vector<std::pair<btcnew::block_hash, prefetched_block>> blocks;
+	std::vector<btcnew::block_hash> hashes{ hash_a };
+	uint64_t generation;
+	{
+		btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+		generation = prefetch_generation;
+	}
+	auto transaction (ledger.store.tx_begin_read ());
+	while (!hashes.empty () && blocks.size () < batch_read_size && prefetched_size + blocks.size () < max_prefetched_blocks && !stopped)
+	{
+		auto hash (hashes.back ());
+		hashes.pop_back ();
+		btcnew::block_sideband sideband;
+		auto block (ledger.store.block_get (transaction, hash, &sideband));
+		auto confirmation_height (std::numeric_limits<uint64_t>::max ());
+		if (block != nullptr)
+		{
+			auto account (block->account ().is_zero () ? sideband.account : block->account ());
+			ledger.store.confirmation_height_get (transaction, account, confirmation_height);
+		}
+		while (block != nullptr && sideband.height > confirmation_height && blocks.size () < batch_read_size)
+		{
+			auto source (block->source ());
+			if (source.is_zero ())
+			{
+				source = block->link ();
+			}
+			// Links which are not block hashes (send destinations) are discarded when they are not found
+			if (!source.is_zero () && !ledger.is_epoch_link (source))
+			{
+				hashes.push_back (source);
+			}
+			auto previous (block->previous ());
+			blocks.emplace_back (hash, prefetched_block{ block, sideband });
+			hash = previous;
+			block = hash.is_zero () ? nullptr : ledger.store.block_get (transaction, hash, &sideband);
+		}
+	}
+	if (!blocks.empty ())
+	{
+		btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+		// The snapshot read from may predate a rollback
+		if (generation == prefetch_generation)
+		{
+			prefetched.insert (blocks.begin (), blocks.end ());
+			prefetched_size = prefetched.size ();
+		}
+	}
+}
+
+void btcnew::confirmation_height_processor::invalidate_prefetched ()
+{
+	btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+	++prefetch_generation;
+	prefetched.clear ();
+	prefetched_size = 0;
+}
+
+std::shared_ptr<btcnew::block> btcnew::confirmation_height_processor::block_get (btcnew::read_transaction const & transaction_a, btcnew::block_hash const & hash_a, btcnew::block_sideband & sideband_a)
+{
+	if (prefetched_size > 0)
+	{
+		btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+		auto existing (prefetched.find (hash_a));
+		if (existing != prefetched.end ())
+		{
+			auto block (existing->second.block);
+			sideband_a = existing->second.sideband;
+			prefetched.erase (existing);
+			prefetched_size = prefetched.size ();
+			return block;
+		}
+	}
+	return ledger.store.block_get (transaction_a, hash_a, &sideband_a);
+}
+
 void btcnew::confirmation_height_processor::pause ()
 {
 	paused = true;
@@ -102,6 +235,17 @@ void btcnew::confirmation_height_processor::add (btcnew::block_hash const & hash
 		pending_confirmations.pending.insert (hash_a);
 	}
 	condition.notify_one ();
+	if (!prefetch_threads.empty ())
+	{
+		{
+			btcnew::lock_guard<std::mutex> guard (prefetch_mutex);
+			if (prefetch_queue.size () < max_prefetch_queue)
+			{
+				prefetch_queue.push_back (hash_a);
+			}
+		}
+		prefetch_condition.notify_one ();
+	}
 }
 
 /**
@@ -297,63 +441,74 @@ bool btcnew::confirmation_height_processor::write_pending (std::deque<conf_heigh
 	});
 
 	// Write in batches
-	while (total_pending_write_block_count > 0)
+	auto block_missing (false);
+	while (!block_missing && total_pending_write_block_count > 0)
 	{
-		uint64_t num_accounts_processed = 0;
-		auto transaction (ledger.store.tx_begin_write ({}, { btcnew::tables::confirmation_height }));
-		while (!all_pending_a.empty ())
+		std::vector<std::pair<btcnew::account, uint64_t>> cemented_heights;
 		{
-			const auto & pending = all_pending_a.front ();
-			uint64_t confirmation_height;
-			auto error = ledger.store.confirmation_height_get (transaction, pending.account, confirmation_height);
-			release_assert (!error);
-			if (pending.height > confirmation_height)
+			uint64_t num_accounts_processed = 0;
+			auto transaction (ledger.store.tx_begin_write ({}, { btcnew::tables::confirmation_height }));
+			while (!all_pending_a.empty ())
 			{
+				const auto & pending = all_pending_a.front ();
+				uint64_t confirmation_height;
+				auto error = ledger.store.confirmation_height_get (transaction, pending.account, confirmation_height);
+				release_assert (!error);
+				if (pending.height > confirmation_height)
+				{
 #ifndef NDEBUG
-				// Do more thorough checking in Debug mode, indicates programming error.
-				btcnew::block_sideband sideband;
-				auto block = ledger.store.block_get (transaction, pending.hash, &sideband);
-				static btcnew::network_constants network_constants;
-				assert (network_constants.is_test_network () || block != nullptr);
-				assert (network_constants.is_test_network () || sideband.height == pending.height);
+					// Do more thorough checking in Debug mode, indicates programming error.
+					btcnew::block_sideband sideband;
+					auto block = ledger.store.block_get (transaction, pending.hash, &sideband);
+					static btcnew::network_constants network_constants;
+					assert (network_constants.is_test_network () || block != nullptr);
+					assert (network_constants.is_test_network () || sideband.height == pending.height);
 #else
-				auto block = ledger.store.block_get (transaction, pending.hash);
+					auto block = ledger.store.block_get (transaction, pending.hash);
 #endif
-				// Check that the block still exists as there may have been changes outside this processor.
-				if (!block)
-				{
-					logger.always_log ("Failed to write confirmation height for: ", pending.hash.to_string ());
-					ledger.stats.inc (btcnew::stat::type::confirmation_height, btcnew::stat::detail::invalid_block);
-					receive_source_pairs.clear ();
-					receive_source_pairs_size = 0;
-					all_pending_a.clear ();
-					return true;
+					// Check that the block still exists as there may have been changes outside this processor.
+					if (!block)
+					{
+						logger.always_log ("Failed to write confirmation height for: ", pending.hash.to_string ());
+						ledger.stats.inc (btcnew::stat::type::confirmation_height, btcnew::stat::detail::invalid_block);
+						receive_source_pairs.clear ();
+						receive_source_pairs_size = 0;
+						all_pending_a.clear ();
+						block_missing = true;
+						break;
+					}
+
+					for (auto & callback_data : pending.block_callbacks_required)
+					{
+						active.post_confirmation_height_set (transaction, callback_data.block, callback_data.sideband, callback_data.election_status_type);
+					}
+
+					ledger.stats.add (btcnew::stat::type::confirmation_height, btcnew::stat::detail::blocks_confirmed, btcnew::stat::dir::in, pending.height - confirmation_height);
+					assert (pending.num_blocks_confirmed == pending.height - confirmation_height);
+					confirmation_height = pending.height;
+					ledger.cemented_count += pending.num_blocks_confirmed;
+					ledger.store.confirmation_height_put (transaction, pending.account, confirmation_height);
+					cemented_heights.emplace_back (pending.account, confirmation_height);
 				}
+				total_pending_write_block_count -= pending.num_blocks_confirmed;
+				++num_accounts_processed;
+				all_pending_a.erase (all_pending_a.begin ());
 
-				for (auto & callback_data : pending.block_callbacks_required)
+				if (num_accounts_processed >= batch_write_size)
 				{
-					active.post_confirmation_height_set (transaction, callback_data.block, callback_data.sideband, callback_data.election_status_type);
+					// Commit changes periodically to reduce time holding write locks for long chains
+					break;
 				}
-
-				ledger.stats.add (btcnew::stat::type::confirmation_height, btcnew::stat::detail::blocks_confirmed, btcnew::stat::dir::in, pending.height - confirmation_height);
-				assert (pending.num_blocks_confirmed == pending.height - confirmation_height);
-				confirmation_height = pending.height;
-				ledger.cemented_count += pending.num_blocks_confirmed;
-				ledger.store.confirmation_height_put (transaction, pending.account, confirmation_height);
-			}
-			total_pending_write_block_count -= pending.num_blocks_confirmed;
-			++num_accounts_processed;
-			all_pending_a.erase (all_pending_a.begin ());
-
-			if (num_accounts_processed >= batch_write_size)
-			{
-				// Commit changes periodically to reduce time holding write locks for long chains
-				break;
 			}
 		}
+		// Only cache heights once committed so readers of the cache never run ahead of the store
+		for (auto const & cemented : cemented_heights)
+		{
+			ledger.confirmation_height_cache.put (cemented.first, cemented.second);
+		}
 	}
 	assert (all_pending_a.empty ());
-	return false;
+	return block_missing;
 }
 
 void btcnew::confirmation_height_processor::collect_unconfirmed_receive_and_sources_for_account (uint64_t block_height_a, uint64_t confirmation_height_a, btcnew::block_hash const & hash_a, btcnew::account const & account_a, btcnew::read_transaction const & transaction_a, std::vector<callback_data> & block_callbacks_required)
@@ -367,7 +522,7 @@ void btcnew::confirmation_height_processor::collect_unconfirmed_receive_and_sour
 	while ((num_to_confirm > 0) && !hash.is_zero () && !stopped)
 	{
 		btcnew::block_sideband sideband;
-		auto block (ledger.store.block_get (transaction_a, hash, &sideband));
+		auto block (block_get (transaction_a, hash, sideband));
 		if (block)
 		{
 			if (!pending_confirmations.is_processing_block (hash))
@@ -465,6 +620,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (confirmation_heigh
 	size_t receive_source_pairs_count = confirmation_height_processor_a.receive_source_pairs_size;
 	auto composite = std::make_unique<seq_con_info_composite> (name_a);
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "receive_source_pairs", receive_source_pairs_count, sizeof (decltype (confirmation_height_processor_a.receive_source_pairs)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "prefetched", confirmation_height_processor_a.prefetched_size, sizeof (decltype (confirmation_height_processor_a.prefetched)::value_type) }));
 	return composite;
 }
 }
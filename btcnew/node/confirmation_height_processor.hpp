@@ -8,6 +8,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace btcnew
@@ -41,7 +42,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (pending_confirmati
 class confirmation_height_processor final
 {
 public:
-	confirmation_height_processor (pending_confirmation_height &, btcnew::ledger &, btcnew::active_transactions &, btcnew::write_database_queue &, std::chrono::milliseconds, btcnew::logger_mt &);
+	confirmation_height_processor (pending_confirmation_height &, btcnew::ledger &, btcnew::active_transactions &, btcnew::write_database_queue &, std::chrono::milliseconds, btcnew::logger_mt &, unsigned = 0);
 	~confirmation_height_processor ();
 	void add (btcnew::block_hash const &);
 	void stop ();
@@ -54,6 +55,13 @@ public:
 	/** The maximum number of blocks to be read in while iterating over a long account chain */
 	static uint64_t constexpr batch_read_size = 4096;
 
+	/** The maximum number of blocks read ahead by the prefetch threads which have not yet been used for cementing */
+	static size_t constexpr max_prefetched_blocks = 65536;
+	/** The maximum number of queued blocks waiting for a prefetch thread, further ones are cemented without reading ahead */
+	static size_t constexpr max_prefetch_queue = 4096;
+	/** Drop blocks read ahead, called when blocks are rolled back so stale blocks are never cemented */
+	void invalidate_prefetched ();
+
 private:
 	class callback_data final
 	{
@@ -110,15 +118,38 @@ private:
 	btcnew::timer<std::chrono::milliseconds> timer;
 	btcnew::write_database_queue & write_database_queue;
 	std::chrono::milliseconds batch_separate_pending_min_time;
+
+	/*
+	 * Dependency graphs of queued blocks are walked in parallel by the prefetch threads, each in their own read transaction.
+	 * The blocks read are handed to the cementing thread, which keeps ordering and writing single threaded.
+	 */
+	class prefetched_block final
+	{
+	public:
+		std::shared_ptr<btcnew::block> block;
+		btcnew::block_sideband sideband;
+	};
+	std::mutex prefetch_mutex;
+	btcnew::condition_variable prefetch_condition;
+	std::deque<btcnew::block_hash> prefetch_queue;
+	std::unordered_map<btcnew::block_hash, prefetched_block> prefetched;
+	std::atomic<uint64_t> prefetched_size{ 0 };
+	/** Incremented when prefetched blocks are invalidated, blocks read under an earlier generation are discarded */
+	uint64_t prefetch_generation{ 0 };
+	std::vector<std::thread> prefetch_threads;
 	std::thread thread;
 
 	void run ();
+	void run_prefetch ();
+	void prefetch (btcnew::block_hash const &);
+	std::shared_ptr<btcnew::block> block_get (btcnew::read_transaction const &, btcnew::block_hash const &, btcnew::block_sideband &);
 	void add_confirmation_height (btcnew::block_hash const &);
 	void collect_unconfirmed_receive_and_sources_for_account (uint64_t, uint64_t, btcnew::block_hash const &, btcnew::account const &, btcnew::read_transaction const &, std::vector<callback_data> &);
 	bool write_pending (std::deque<conf_height_details> &);
 
 	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (confirmation_height_processor &, const std::string &);
 	friend class confirmation_height_pending_observer_callbacks_Test;
+	friend class confirmation_height_prefetch_Test;
 };
 
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (confirmation_height_processor &, const std::string &);
@@ -1,6 +1,8 @@
 #include <btcnew/node/election.hpp>
 #include <btcnew/node/node.hpp>
 
+std::chrono::seconds constexpr btcnew::election::tally_reconcile_interval;
+
 btcnew::election_vote_result::election_vote_result (bool replay_a, bool processed_a)
 {
 	replay = replay_a;
@@ -14,9 +16,10 @@ election_start (std::chrono::steady_clock::now ()),
 status ({ block_a, 0, std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::system_clock::now ().time_since_epoch ()), std::chrono::duration_values<std::chrono::milliseconds>::zero (), 0, btcnew::election_status_type::ongoing }),
 skip_delay (skip_delay_a),
 confirmed (false),
-stopped (false)
+stopped (false),
+next_tally_reconcile (election_start + tally_reconcile_interval)
 {
-	last_votes.insert (std::make_pair (node.network_params.random.not_an_account, btcnew::vote_info{ std::chrono::steady_clock::now (), 0, block_a->hash () }));
+	tally_insert (node.network_params.random.not_an_account, btcnew::vote_info{ std::chrono::steady_clock::now (), 0, block_a->hash () });
 	blocks.insert (std::make_pair (block_a->hash (), block_a));
 	update_dependent ();
 }
@@ -40,6 +43,16 @@ void btcnew::election::confirm_once (btcnew::election_status_type type_a)
 		status.election_duration = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - election_start);
 		status.confirmation_request_count = confirmation_request_count;
 		status.type = type_a;
+		if (type_a == btcnew::election_status_type::active_confirmed_quorum)
+		{
+			node.block_processor.generator.confirmation_latency (status.election_duration);
+			node.latency.stage (status.winner->hash (), btcnew::latency_stage::quorum);
+		}
+		// Registered before cementing is requested, the cemented callback only holds pending_conf_height_mutex and may otherwise miss the election
+		{
+			btcnew::lock_guard<std::mutex> guard (node.active.pending_conf_height_mutex);
+			node.active.pending_conf_height.emplace (status.winner->hash (), shared_from_this ());
+		}
 		auto status_l (status);
 		auto node_l (node.shared ());
 		auto confirmation_action_l (confirmation_action);
@@ -48,10 +61,9 @@ void btcnew::election::confirm_once (btcnew::election_status_type type_a)
 			confirmation_action_l (status_l.winner);
 		});
 		auto root (status.winner->qualified_root ());
-		node.active.pending_conf_height.emplace (status.winner->hash (), shared_from_this ());
 		clear_blocks ();
 		clear_dependent ();
-		node.active.roots.erase (root);
+		node.active.erase_root (root);
 	}
 }
 
@@ -81,16 +93,53 @@ bool btcnew::election::have_quorum (btcnew::tally_t const & tally_a, btcnew::uin
 	return result;
 }
 
+void btcnew::election::tally_insert (btcnew::account const & rep_a, btcnew::vote_info const & info_a)
+{
+	auto existing (last_votes.find (rep_a));
+	if (existing != last_votes.end ())
+	{
+		// Replacing an earlier vote, take its weight off the block it was for
+		auto const & previous_hash (existing->second.hash);
+		last_tally[previous_hash] -= existing->second.weight;
+		if (--last_tally_votes[previous_hash] == 0)
+		{
+			last_tally.erase (previous_hash);
+			last_tally_votes.erase (previous_hash);
+		}
+		existing->second = info_a;
+	}
+	else
+	{
+		existing = last_votes.emplace (rep_a, info_a).first;
+	}
+	auto & vote_l (existing->second);
+	vote_l.weight = node.ledger.weight (rep_a);
+	last_tally[vote_l.hash] += vote_l.weight;
+	++last_tally_votes[vote_l.hash];
+}
+
+void btcnew::election::reconcile_tally ()
+{
+	last_tally.clear ();
+	last_tally_votes.clear ();
+	for (auto & vote_l : last_votes)
+	{
+		vote_l.second.weight = node.ledger.weight (vote_l.first);
+		last_tally[vote_l.second.hash] += vote_l.second.weight;
+		++last_tally_votes[vote_l.second.hash];
+	}
+	next_tally_reconcile = std::chrono::steady_clock::now () + tally_reconcile_interval;
+}
+
 btcnew::tally_t btcnew::election::tally ()
 {
-	std::unordered_map<btcnew::block_hash, btcnew::uint128_t> block_weights;
-	for (auto vote_info : last_votes)
+	// Representative weights change as blocks are processed, the running totals only use the weight at the time of each vote
+	if (std::chrono::steady_clock::now () >= next_tally_reconcile)
 	{
-		block_weights[vote_info.second.hash] += node.ledger.weight (vote_info.first);
+		reconcile_tally ();
 	}
-	last_tally = block_weights;
 	btcnew::tally_t result;
-	for (auto item : block_weights)
+	for (auto const & item : last_tally)
 	{
 		auto block (blocks.find (item.first));
 		if (block != blocks.end ())
@@ -192,7 +241,7 @@ btcnew::election_vote_result btcnew::election::vote (btcnew::account rep, uint64
 		if (should_process)
 		{
 			node.stats.inc (btcnew::stat::type::election, btcnew::stat::detail::vote_new);
-			last_votes[rep] = { std::chrono::steady_clock::now (), sequence, block_hash };
+			tally_insert (rep, btcnew::vote_info{ std::chrono::steady_clock::now (), sequence, block_hash });
 			if (!confirmed)
 			{
 				confirm_if_quorum ();
@@ -235,13 +284,18 @@ bool btcnew::election::publish (std::shared_ptr<btcnew::block> block_a)
 
 size_t btcnew::election::last_votes_size ()
 {
-	btcnew::lock_guard<std::mutex> lock (node.active.mutex);
+	btcnew::lock_guard<btcnew::elections_mutex> lock (node.active.mutex);
 	return last_votes.size ();
 }
 
 void btcnew::election::update_dependent ()
 {
-	assert (!node.active.mutex.try_lock ());
+	if (!node.active.mutex.owned ())
+	{
+		// The blocks depended upon may be in other shards
+		node.active.defer_update_dependent (shared_from_this ());
+		return;
+	}
 	std::vector<btcnew::block_hash> blocks_search;
 	auto hash (status.winner->hash ());
 	auto previous (status.winner->previous ());
@@ -261,12 +315,12 @@ void btcnew::election::update_dependent ()
 	}
 	for (auto & block_search : blocks_search)
 	{
-		auto existing (node.active.blocks.find (block_search));
-		if (existing != node.active.blocks.end () && !existing->second->confirmed && !existing->second->stopped)
+		auto existing (node.active.find_election (block_search));
+		if (existing != nullptr && !existing->confirmed && !existing->stopped)
 		{
-			if (existing->second->dependent_blocks.find (hash) == existing->second->dependent_blocks.end ())
+			if (existing->dependent_blocks.find (hash) == existing->dependent_blocks.end ())
 			{
-				existing->second->dependent_blocks.insert (hash);
+				existing->dependent_blocks.insert (hash);
 			}
 		}
 	}
@@ -283,10 +337,11 @@ void btcnew::election::clear_dependent ()
 void btcnew::election::clear_blocks ()
 {
 	auto winner_hash (status.winner->hash ());
+	auto & shard_blocks (node.active.shard (status.winner->qualified_root ()).blocks);
 	for (auto & block : blocks)
 	{
 		auto & hash (block.first);
-		auto erased (node.active.blocks.erase (hash));
+		auto erased (shard_blocks.erase (hash));
 		(void)erased;
 		// clear_blocks () can be called in active_transactions::publish () before blocks insertion if election was confirmed
 		assert (erased == 1 || confirmed);
@@ -294,6 +349,8 @@ void btcnew::election::clear_blocks ()
 		if (stopped || hash != winner_hash)
 		{
 			node.observers.active_stopped.notify (hash);
+			// Let the block be published again, it may be needed to restart the election
+			node.network.publish_filter.clear (block.second);
 		}
 	}
 }
@@ -304,9 +361,9 @@ void btcnew::election::insert_inactive_votes_cache ()
 	auto cache (node.active.find_inactive_votes_cache (winner_hash));
 	for (auto & rep : cache.voters)
 	{
-		auto inserted (last_votes.emplace (rep, btcnew::vote_info{ std::chrono::steady_clock::time_point::min (), 0, winner_hash }));
-		if (inserted.second)
+		if (last_votes.find (rep) == last_votes.end ())
 		{
+			tally_insert (rep, btcnew::vote_info{ std::chrono::steady_clock::time_point::min (), 0, winner_hash });
 			node.stats.inc (btcnew::stat::type::election, btcnew::stat::detail::vote_cached);
 		}
 	}
@@ -20,6 +20,8 @@ public:
 	std::chrono::steady_clock::time_point time;
 	uint64_t sequence;
 	btcnew::block_hash hash;
+	// Representative weight this vote contributes to the tally
+	btcnew::uint128_t weight{ 0 };
 };
 class election_vote_result final
 {
@@ -37,6 +39,8 @@ public:
 	election (btcnew::node &, std::shared_ptr<btcnew::block>, bool const, std::function<void (std::shared_ptr<btcnew::block>)> const &);
 	btcnew::election_vote_result vote (btcnew::account, uint64_t, btcnew::block_hash);
 	btcnew::tally_t tally ();
+	// Recompute the tally from scratch to pick up representative weight changes
+	void reconcile_tally ();
 	// Check if we have vote quorum
 	bool have_quorum (btcnew::tally_t const &, btcnew::uint128_t) const;
 	// Change our winner to agree with the network
@@ -60,9 +64,16 @@ public:
 	bool skip_delay;
 	std::atomic<bool> confirmed;
 	bool stopped;
+	// Running weight totals per block, updated as votes are added or replaced
 	std::unordered_map<btcnew::block_hash, btcnew::uint128_t> last_tally;
 	unsigned confirmation_request_count{ 0 };
 	std::unordered_set<btcnew::block_hash> dependent_blocks;
 	std::chrono::seconds late_blocks_delay{ 5 };
+	static std::chrono::seconds constexpr tally_reconcile_interval{ 1 };
+
+private:
+	void tally_insert (btcnew::account const &, btcnew::vote_info const &);
+	std::unordered_map<btcnew::block_hash, size_t> last_tally_votes;
+	std::chrono::steady_clock::time_point next_tally_reconcile;
 };
 }
@@ -0,0 +1,103 @@
+#include <btcnew/node/election_scheduler.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+size_t constexpr btcnew::election_scheduler::bucket_count;
+
+bool btcnew::election_scheduler::entry::operator< (btcnew::election_scheduler::entry const & other_a) const
+{
+	// Longest idle first, then oldest queued
+	return idle > other_a.idle || (idle == other_a.idle && sequence < other_a.sequence);
+}
+
+btcnew::election_scheduler::election_scheduler (size_t max_bucket_size_a) :
+max_bucket_size (max_bucket_size_a),
+buckets (bucket_count)
+{
+}
+
+bool btcnew::election_scheduler::push (std::shared_ptr<btcnew::block> const & block_a, btcnew::uint128_t const & balance_a, std::chrono::seconds idle_a)
+{
+	auto & bucket (buckets[bucket_index (balance_a)]);
+	btcnew::election_scheduler::entry entry_l{ static_cast<uint64_t> (std::max<std::chrono::seconds::rep> (idle_a.count (), 0)), sequence++, block_a };
+	auto dropped (false);
+	if (bucket.size () >= max_bucket_size)
+	{
+		auto lowest (std::prev (bucket.end ()));
+		if (entry_l < *lowest)
+		{
+			bucket.erase (lowest);
+			--count;
+		}
+		else
+		{
+			dropped = true;
+		}
+	}
+	if (!dropped)
+	{
+		bucket.insert (std::move (entry_l));
+		++count;
+	}
+	return dropped;
+}
+
+std::shared_ptr<btcnew::block> btcnew::election_scheduler::pop ()
+{
+	std::shared_ptr<btcnew::block> result;
+	for (auto i (0u); i < bucket_count && result == nullptr; ++i)
+	{
+		auto & bucket (buckets[current]);
+		current = (current + 1) % bucket_count;
+		if (!bucket.empty ())
+		{
+			result = bucket.begin ()->block;
+			bucket.erase (bucket.begin ());
+			--count;
+		}
+	}
+	return result;
+}
+
+bool btcnew::election_scheduler::empty () const
+{
+	return count == 0;
+}
+
+size_t btcnew::election_scheduler::size () const
+{
+	return count;
+}
+
+size_t btcnew::election_scheduler::bucket_size (size_t index_a) const
+{
+	assert (index_a < bucket_count);
+	return buckets[index_a].size ();
+}
+
+void btcnew::election_scheduler::clear ()
+{
+	for (auto & bucket : buckets)
+	{
+		bucket.clear ();
+	}
+	count = 0;
+}
+
+size_t btcnew::election_scheduler::bucket_index (btcnew::uint128_t const & balance_a)
+{
+	size_t bits (balance_a == 0 ? 0 : boost::multiprecision::msb (balance_a) + 1);
+	return (std::max<size_t> (bits, 64) - 61) / 4;
+}
+
+namespace btcnew
+{
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (election_scheduler & election_scheduler, const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "blocks", election_scheduler.size (), sizeof (std::shared_ptr<btcnew::block>) + 2 * sizeof (uint64_t) }));
+	return composite;
+}
+}
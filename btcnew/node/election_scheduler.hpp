@@ -0,0 +1,55 @@
+#pragma once
+
+#include <btcnew/lib/numbers.hpp>
+#include <btcnew/lib/utility.hpp>
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace btcnew
+{
+class block;
+
+/**
+ * Blocks waiting for an election while the active elections container is full.
+ * Blocks are bucketed by the balance of their account, buckets take turns when capacity frees up so a flood
+ * of low value blocks only delays elections in its own bucket. Within a bucket accounts which have been idle
+ * the longest since their last confirmed block go first, so long unconfirmed chains are served last.
+ * Not thread safe, callers provide their own locking.
+ */
+class election_scheduler final
+{
+public:
+	explicit election_scheduler (size_t max_bucket_size_a);
+	/** Queue \p block_a, returns true if it was dropped because its bucket is full of higher priority blocks */
+	bool push (std::shared_ptr<btcnew::block> const & block_a, btcnew::uint128_t const & balance_a, std::chrono::seconds idle_a);
+	/** Take the highest priority block of the next non empty bucket */
+	std::shared_ptr<btcnew::block> pop ();
+	bool empty () const;
+	size_t size () const;
+	size_t bucket_size (size_t) const;
+	void clear ();
+	static size_t bucket_index (btcnew::uint128_t const &);
+	/** Balances below 2^64 raw share the first bucket, every further 4 bits of balance get a bucket of their own */
+	static size_t constexpr bucket_count{ 17 };
+	size_t const max_bucket_size;
+
+private:
+	class entry final
+	{
+	public:
+		uint64_t idle;
+		uint64_t sequence;
+		std::shared_ptr<btcnew::block> block;
+		bool operator< (entry const &) const;
+	};
+	std::vector<std::set<entry>> buckets;
+	size_t current{ 0 };
+	uint64_t sequence{ 0 };
+	size_t count{ 0 };
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (election_scheduler & election_scheduler, const std::string & name);
+}
@@ -0,0 +1,214 @@
+#include <btcnew/lib/stats.hpp>
+#include <btcnew/node/inactive_votes_cache.hpp>
+
+#include <algorithm>
+
+size_t constexpr btcnew::inactive_votes_cache::max_voters;
+uint32_t constexpr btcnew::inactive_votes_cache::empty_slot;
+size_t constexpr btcnew::inactive_votes_cache::not_found;
+
+namespace
+{
+size_t table_size (size_t entries_a)
+{
+	// Keep the table at most half full so probe sequences stay short
+	size_t result (1);
+	while (result < entries_a * 2)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+}
+
+btcnew::inactive_votes_cache::inactive_votes_cache (btcnew::stat & stats_a, size_t max_entries_a) :
+stats (stats_a),
+max_entries (max_entries_a),
+slots (table_size (max_entries_a), empty_slot),
+filter (table_size (max_entries_a) * 2, 0)
+{
+	assert (max_entries_a > 0 && max_entries_a < empty_slot);
+}
+
+bool btcnew::inactive_votes_cache::vote (btcnew::block_hash const & hash_a, btcnew::account const & representative_a, std::vector<btcnew::account> & voters_a)
+{
+	auto result (false);
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	auto slot (filter_contains (hash_a) ? find_slot (hash_a) : not_found);
+	if (slot == not_found)
+	{
+		insert (hash_a, representative_a);
+	}
+	else
+	{
+		auto & entry (entries[slots[slot]]);
+		if (!entry.confirmed && std::find (entry.voters.begin (), entry.voters.end (), representative_a) == entry.voters.end ())
+		{
+			if (entry.voters.size () < max_voters)
+			{
+				entry.arrival = std::chrono::steady_clock::now ();
+				entry.voters.push_back (representative_a);
+				voters_a = entry.voters;
+				result = true;
+			}
+			else
+			{
+				stats.inc (btcnew::stat::type::election, btcnew::stat::detail::vote_cache_voter_dropped);
+			}
+		}
+	}
+	return result;
+}
+
+void btcnew::inactive_votes_cache::confirm (btcnew::block_hash const & hash_a)
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	auto slot (find_slot (hash_a));
+	if (slot != not_found)
+	{
+		entries[slots[slot]].confirmed = true;
+	}
+}
+
+btcnew::gap_information btcnew::inactive_votes_cache::find (btcnew::block_hash const & hash_a)
+{
+	btcnew::gap_information result{ std::chrono::steady_clock::time_point{}, 0, std::vector<btcnew::account>{} };
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	if (filter_contains (hash_a))
+	{
+		auto slot (find_slot (hash_a));
+		if (slot != not_found)
+		{
+			auto const & entry (entries[slots[slot]]);
+			result.arrival = entry.arrival;
+			result.hash = entry.hash;
+			result.voters = entry.voters;
+			result.confirmed = entry.confirmed;
+		}
+	}
+	return result;
+}
+
+size_t btcnew::inactive_votes_cache::size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return entries.size ();
+}
+
+size_t btcnew::inactive_votes_cache::find_slot (btcnew::block_hash const & hash_a) const
+{
+	auto result (not_found);
+	auto mask (slots.size () - 1);
+	for (auto i (hash_a.qwords[0] & mask); slots[i] != empty_slot && result == not_found; i = (i + 1) & mask)
+	{
+		if (entries[slots[i]].hash == hash_a)
+		{
+			result = i;
+		}
+	}
+	return result;
+}
+
+void btcnew::inactive_votes_cache::insert (btcnew::block_hash const & hash_a, btcnew::account const & representative_a)
+{
+	if (entries.size () < max_entries)
+	{
+		entries.emplace_back ();
+	}
+	else
+	{
+		// Evict the oldest inserted entry which occupies the ring position being reused
+		auto & oldest (entries[next_entry]);
+		auto slot (find_slot (oldest.hash));
+		assert (slot != not_found);
+		erase_slot (slot);
+		filter_remove (oldest.hash);
+		stats.inc (btcnew::stat::type::election, btcnew::stat::detail::vote_cache_evicted);
+	}
+	auto & entry (entries[next_entry]);
+	entry.hash = hash_a;
+	entry.arrival = std::chrono::steady_clock::now ();
+	entry.voters.assign (1, representative_a);
+	entry.confirmed = false;
+	auto mask (slots.size () - 1);
+	auto i (hash_a.qwords[0] & mask);
+	while (slots[i] != empty_slot)
+	{
+		i = (i + 1) & mask;
+	}
+	slots[i] = static_cast<uint32_t> (next_entry);
+	filter_add (hash_a);
+	next_entry = (next_entry + 1) % max_entries;
+}
+
+void btcnew::inactive_votes_cache::erase_slot (size_t slot_a)
+{
+	// Backward shift deletion, moves later members of the probe sequence into the hole so lookups never stop early
+	auto mask (slots.size () - 1);
+	auto hole (slot_a);
+	for (auto i ((hole + 1) & mask); slots[i] != empty_slot; i = (i + 1) & mask)
+	{
+		auto home (entries[slots[i]].hash.qwords[0] & mask);
+		auto stays (hole <= i ? (hole < home && home <= i) : (hole < home || home <= i));
+		if (!stays)
+		{
+			slots[hole] = slots[i];
+			hole = i;
+		}
+	}
+	slots[hole] = empty_slot;
+}
+
+void btcnew::inactive_votes_cache::filter_add (btcnew::block_hash const & hash_a)
+{
+	auto mask (filter.size () - 1);
+	for (auto index : { hash_a.qwords[2] & mask, hash_a.qwords[3] & mask })
+	{
+		// Saturated counters are never decremented, they only cost a probe
+		if (filter[index] != std::numeric_limits<uint8_t>::max ())
+		{
+			++filter[index];
+		}
+	}
+}
+
+void btcnew::inactive_votes_cache::filter_remove (btcnew::block_hash const & hash_a)
+{
+	auto mask (filter.size () - 1);
+	for (auto index : { hash_a.qwords[2] & mask, hash_a.qwords[3] & mask })
+	{
+		if (filter[index] != std::numeric_limits<uint8_t>::max ())
+		{
+			assert (filter[index] > 0);
+			--filter[index];
+		}
+	}
+}
+
+bool btcnew::inactive_votes_cache::filter_contains (btcnew::block_hash const & hash_a) const
+{
+	auto mask (filter.size () - 1);
+	return filter[hash_a.qwords[2] & mask] != 0 && filter[hash_a.qwords[3] & mask] != 0;
+}
+
+namespace btcnew
+{
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (inactive_votes_cache & inactive_votes_cache, const std::string & name)
+{
+	size_t count (0);
+	size_t voters_count (0);
+	{
+		btcnew::lock_guard<std::mutex> lock (inactive_votes_cache.mutex);
+		count = inactive_votes_cache.entries.size ();
+		for (auto const & entry : inactive_votes_cache.entries)
+		{
+			voters_count += entry.voters.capacity ();
+		}
+	}
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "entries", count, sizeof (btcnew::inactive_votes_cache::entry) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "voters", voters_count, sizeof (btcnew::account) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "slots", inactive_votes_cache.slots.size (), sizeof (uint32_t) }));
+	return composite;
+}
+}
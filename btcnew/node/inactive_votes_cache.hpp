@@ -0,0 +1,71 @@
+#pragma once
+
+#include <btcnew/lib/numbers.hpp>
+#include <btcnew/lib/utility.hpp>
+#include <btcnew/node/gap_cache.hpp>
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace btcnew
+{
+class stat;
+
+/**
+ * Votes for blocks which don't have an election yet, so a later election can be seeded with them.
+ * Entries live in a ring which evicts the oldest inserted entry when full, indexed by an open-addressed table.
+ * Only the index is allocated up front, entries and their voters are allocated as votes arrive.
+ * A counting filter answers most lookups for uncached blocks without probing.
+ */
+class inactive_votes_cache final
+{
+public:
+	inactive_votes_cache (btcnew::stat &, size_t = 16 * 1024);
+	/**
+	 * Record a vote by \p representative_a for \p hash_a
+	 * Returns true if the representative was added to an existing unconfirmed entry, filling \p voters_a with its voters
+	 */
+	bool vote (btcnew::block_hash const & hash_a, btcnew::account const & representative_a, std::vector<btcnew::account> & voters_a);
+	// Mark the entry as having enough votes to warrant bootstrapping the block
+	void confirm (btcnew::block_hash const &);
+	btcnew::gap_information find (btcnew::block_hash const &);
+	size_t size ();
+	// Voters recorded per entry, further voters for the same block are dropped
+	static size_t constexpr max_voters{ 32 };
+
+private:
+	class entry final
+	{
+	public:
+		btcnew::block_hash hash;
+		std::chrono::steady_clock::time_point arrival;
+		std::vector<btcnew::account> voters;
+		bool confirmed;
+	};
+	size_t find_slot (btcnew::block_hash const &) const;
+	void insert (btcnew::block_hash const &, btcnew::account const &);
+	void erase_slot (size_t);
+	void filter_add (btcnew::block_hash const &);
+	void filter_remove (btcnew::block_hash const &);
+	bool filter_contains (btcnew::block_hash const &) const;
+	btcnew::stat & stats;
+	std::mutex mutex;
+	size_t const max_entries;
+	// Grows up to max_entries, then the oldest entry is reused
+	std::vector<entry> entries;
+	// Index into entries for each slot, empty_slot if unused
+	std::vector<uint32_t> slots;
+	// Counting filter over the cached hashes, a zero counter means the hash is definitely not cached
+	std::vector<uint8_t> filter;
+	size_t next_entry{ 0 };
+	static uint32_t constexpr empty_slot{ std::numeric_limits<uint32_t>::max () };
+	static size_t constexpr not_found{ std::numeric_limits<size_t>::max () };
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (inactive_votes_cache &, const std::string &);
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (inactive_votes_cache & inactive_votes_cache, const std::string & name);
+}
@@ -0,0 +1,152 @@
+#include <btcnew/node/io_shards.hpp>
+#include <btcnew/node/threadingconfig.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <iostream>
+
+size_t constexpr btcnew::io_shards::none;
+
+btcnew::io_shards::shard::shard (int cpu_a) :
+io_guard (boost::asio::make_work_guard (io_ctx)),
+cpu (cpu_a)
+{
+}
+
+btcnew::io_shards::io_shards (boost::asio::io_context & io_ctx_a, btcnew::threading_config const & config_a) :
+io_ctx_shared (io_ctx_a)
+{
+	boost::thread::attributes attrs;
+	btcnew::thread_attributes::set (attrs);
+	for (auto i (0u); i < config_a.io_shards; ++i)
+	{
+		auto cpu (config_a.io_shard_cpus.empty () ? -1 : static_cast<int> (config_a.io_shard_cpus[i % config_a.io_shard_cpus.size ()]));
+		auto shard_l (std::make_shared<shard> (cpu));
+		shards.push_back (shard_l);
+		// The thread keeps its shard alive as it may still be running when this object is destroyed from a shard thread
+		shard_l->thread = boost::thread (attrs, [shard_l] () {
+			run (*shard_l);
+		});
+	}
+}
+
+btcnew::io_shards::~io_shards ()
+{
+	stop ();
+}
+
+void btcnew::io_shards::run (btcnew::io_shards::shard & shard_a)
+{
+	btcnew::thread_role::set (btcnew::thread_role::name::io);
+	if (shard_a.cpu >= 0)
+	{
+		// Shards are pinned to a single CPU of their own, replacing any affinity of the I/O role
+		btcnew::thread_role::set_os_affinity ({ static_cast<unsigned> (shard_a.cpu) });
+	}
+	try
+	{
+		while (shard_a.io_ctx.run_one () != 0)
+		{
+			shard_a.handlers.fetch_add (1, std::memory_order_relaxed);
+		}
+	}
+	catch (std::exception const & ex)
+	{
+		std::cerr << ex.what () << std::endl;
+#ifndef NDEBUG
+		throw;
+#endif
+	}
+}
+
+size_t btcnew::io_shards::assign ()
+{
+	size_t result (0);
+	for (size_t i (1); i < shards.size (); ++i)
+	{
+		if (shards[i]->sockets < shards[result]->sockets)
+		{
+			result = i;
+		}
+	}
+	if (!shards.empty ())
+	{
+		++shards[result]->sockets;
+	}
+	return result;
+}
+
+void btcnew::io_shards::release (size_t index_a)
+{
+	if (index_a < shards.size ())
+	{
+		--shards[index_a]->sockets;
+	}
+}
+
+boost::asio::io_context & btcnew::io_shards::io_ctx (size_t index_a)
+{
+	return index_a < shards.size () ? shards[index_a]->io_ctx : io_ctx_shared;
+}
+
+std::shared_ptr<boost::asio::io_context> btcnew::io_shards::owned_io_ctx (size_t index_a)
+{
+	std::shared_ptr<boost::asio::io_context> result;
+	if (index_a < shards.size ())
+	{
+		result = std::shared_ptr<boost::asio::io_context> (shards[index_a], &shards[index_a]->io_ctx);
+	}
+	return result;
+}
+
+void btcnew::io_shards::stop ()
+{
+	// Operations of sockets which weren't closed would keep the shards running, their handlers are destroyed with the io_context
+	for (auto & shard : shards)
+	{
+		shard->io_guard.reset ();
+		shard->io_ctx.stop ();
+	}
+	for (auto & shard : shards)
+	{
+		if (shard->thread.joinable ())
+		{
+			// The last reference to the node may be released by a handler on a shard thread, which can't join itself
+			if (shard->thread.get_id () != boost::this_thread::get_id ())
+			{
+				shard->thread.join ();
+			}
+			else
+			{
+				shard->thread.detach ();
+			}
+		}
+	}
+}
+
+size_t btcnew::io_shards::size () const
+{
+	return shards.size ();
+}
+
+std::vector<btcnew::io_shards::load> btcnew::io_shards::get_load () const
+{
+	std::vector<btcnew::io_shards::load> result;
+	for (auto & shard : shards)
+	{
+		result.push_back (btcnew::io_shards::load{ shard->cpu, shard->sockets, shard->handlers });
+	}
+	return result;
+}
+
+void btcnew::io_shards::serialize_json (boost::property_tree::ptree & tree_a) const
+{
+	for (auto & load : get_load ())
+	{
+		boost::property_tree::ptree entry;
+		entry.put ("cpu", std::to_string (load.cpu));
+		entry.put ("sockets", std::to_string (load.sockets));
+		entry.put ("handlers", std::to_string (load.handlers));
+		tree_a.push_back (std::make_pair ("", entry));
+	}
+}
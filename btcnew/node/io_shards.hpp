@@ -0,0 +1,70 @@
+#pragma once
+
+#include <btcnew/boost/asio.hpp>
+#include <btcnew/lib/utility.hpp>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace btcnew
+{
+class threading_config;
+
+/**
+ * Additional io_contexts each run by a single thread, optionally pinned to a CPU. TCP sockets are spread over them
+ * so the handlers of a connection always run on the same core. Without shards every socket uses the shared io_context.
+ */
+class io_shards final
+{
+public:
+	io_shards (boost::asio::io_context &, btcnew::threading_config const &);
+	~io_shards ();
+	/** Pick the shard with the fewest sockets for a new socket, returns its index */
+	size_t assign ();
+	/** A socket assigned to shard \p index_a is destroyed */
+	void release (size_t index_a);
+	/** The io_context of shard \p index_a, the shared io_context if there are no shards or \p index_a is btcnew::io_shards::none */
+	boost::asio::io_context & io_ctx (size_t index_a);
+	/** Keeps the io_context of shard \p index_a alive for sockets outliving the node, null for the shared io_context */
+	std::shared_ptr<boost::asio::io_context> owned_io_ctx (size_t index_a);
+	/** Stop the shards, dropping their outstanding handlers, and join their threads */
+	void stop ();
+	size_t size () const;
+	class load final
+	{
+	public:
+		/** CPU the shard thread is pinned to, -1 if it isn't pinned */
+		int cpu;
+		uint64_t sockets;
+		/** Handlers run since the shard started */
+		uint64_t handlers;
+	};
+	std::vector<btcnew::io_shards::load> get_load () const;
+	/** Index standing for the shared io_context, for sockets which aren't connections such as listeners */
+	static size_t constexpr none{ std::numeric_limits<size_t>::max () };
+	/** Write the load of every shard to \p tree_a */
+	void serialize_json (boost::property_tree::ptree & tree_a) const;
+
+private:
+	class shard final
+	{
+	public:
+		explicit shard (int);
+		boost::asio::io_context io_ctx;
+		boost::asio::executor_work_guard<boost::asio::io_context::executor_type> io_guard;
+		int const cpu;
+		std::atomic<uint64_t> sockets{ 0 };
+		std::atomic<uint64_t> handlers{ 0 };
+		boost::thread thread;
+	};
+	static void run (btcnew::io_shards::shard &);
+	boost::asio::io_context & io_ctx_shared;
+	/** Shared with the shard threads and the sockets of each shard, which may outlive this object */
+	std::vector<std::shared_ptr<shard>> shards;
+};
+}
@@ -1018,7 +1018,7 @@ void btcnew::json_handler::block_confirm ()
 				// Add record in confirmation history for confirmed block
 				btcnew::election_status status{ block_l, 0, std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::system_clock::now ().time_since_epoch ()), std::chrono::duration_values<std::chrono::milliseconds>::zero (), 0, btcnew::election_status_type::active_confirmation_height };
 				{
-					btcnew::lock_guard<std::mutex> lock (node.active.mutex);
+					btcnew::lock_guard<std::mutex> lock (node.active.confirmed_mutex);
 					node.active.confirmed.push_back (status);
 					if (node.active.confirmed.size () > node.config.confirmation_history_size)
 					{
@@ -1759,14 +1759,17 @@ void btcnew::json_handler::confirmation_active ()
 	}
 	boost::property_tree::ptree elections;
 	{
-		btcnew::lock_guard<std::mutex> lock (node.active.mutex);
-		for (auto i (node.active.roots.begin ()), n (node.active.roots.end ()); i != n; ++i)
+		btcnew::lock_guard<btcnew::elections_mutex> lock (node.active.mutex);
+		for (auto & shard : node.active.shards)
 		{
-			if (i->election->confirmation_request_count >= announcements && !i->election->confirmed && !i->election->stopped)
+			for (auto i (shard.roots.begin ()), n (shard.roots.end ()); i != n; ++i)
 			{
-				boost::property_tree::ptree entry;
-				entry.put ("", i->root.to_string ());
-				elections.push_back (std::make_pair ("", entry));
+				if (i->election->confirmation_request_count >= announcements && !i->election->confirmed && !i->election->stopped)
+				{
+					boost::property_tree::ptree entry;
+					entry.put ("", i->root.to_string ());
+					elections.push_back (std::make_pair ("", entry));
+				}
 			}
 		}
 	}
@@ -1836,9 +1839,9 @@ void btcnew::json_handler::confirmation_info ()
 	btcnew::qualified_root root;
 	if (!root.decode_hex (root_text))
 	{
-		btcnew::lock_guard<std::mutex> lock (node.active.mutex);
-		auto conflict_info (node.active.roots.find (root));
-		if (conflict_info != node.active.roots.end ())
+		btcnew::lock_guard<btcnew::elections_mutex> lock (node.active.mutex);
+		auto conflict_info (node.active.find_root (root));
+		if (conflict_info != nullptr)
 		{
 			response_l.put ("announcements", std::to_string (conflict_info->election->confirmation_request_count));
 			auto election (conflict_info->election);
@@ -1962,6 +1965,9 @@ void btcnew::json_handler::database_txn_tracker ()
 		{
 			node.store.serialize_mdb_tracker (json, std::chrono::milliseconds (min_read_time_milliseconds), std::chrono::milliseconds (min_write_time_milliseconds));
 			response_l.put_child ("txn_tracking", json);
+			boost::property_tree::ptree totals;
+			node.store.serialize_txn_totals (totals);
+			response_l.put_child ("totals", totals);
 		}
 	}
 	else
@@ -2237,6 +2243,22 @@ void epoch_upgrader (std::shared_ptr<btcnew::node> node_a, btcnew::private_key c
 /*
  * @warning This is an internal/diagnostic RPC, do not rely on its interface being stable
  */
+void btcnew::json_handler::election_scheduler ()
+{
+	boost::property_tree::ptree buckets;
+	{
+		btcnew::lock_guard<btcnew::elections_mutex> lock (node.active.mutex);
+		for (auto i (0u); i < btcnew::election_scheduler::bucket_count; ++i)
+		{
+			buckets.put (std::to_string (i), std::to_string (node.active.scheduler.bucket_size (i)));
+		}
+		response_l.put ("elections", std::to_string (node.active.roots_size ()));
+	}
+	response_l.put ("max_bucket_size", std::to_string (node.active.scheduler.max_bucket_size));
+	response_l.add_child ("buckets", buckets);
+	response_errors ();
+}
+
 void btcnew::json_handler::epoch_upgrade ()
 {
 	btcnew::epoch epoch (btcnew::epoch::invalid);
@@ -2586,6 +2608,14 @@ void btcnew::json_handler::account_history ()
 	response_errors ();
 }
 
+void btcnew::json_handler::io_shards ()
+{
+	boost::property_tree::ptree shards;
+	node.io_shards.serialize_json (shards);
+	response_l.add_child ("shards", shards);
+	response_errors ();
+}
+
 void btcnew::json_handler::keepalive ()
 {
 	if (!ec)
@@ -2633,6 +2663,15 @@ void btcnew::json_handler::key_expand ()
 	response_errors ();
 }
 
+void btcnew::json_handler::latency ()
+{
+	boost::property_tree::ptree stages;
+	node.latency.serialize_json (stages);
+	response_l.add_child ("stages", stages);
+	response_l.put ("tracked", std::to_string (node.latency.size ()));
+	response_errors ();
+}
+
 void btcnew::json_handler::ledger ()
 {
 	auto count (count_optional_impl ());
@@ -2868,6 +2907,24 @@ void btcnew::json_handler::password_valid (bool wallet_locked)
 	response_errors ();
 }
 
+void btcnew::json_handler::peer_penalties ()
+{
+	auto now (std::chrono::steady_clock::now ());
+	boost::property_tree::ptree penalties;
+	for (auto & entry : node.network.peer_limiter.list ())
+	{
+		boost::property_tree::ptree penalty_l;
+		penalty_l.put ("address", entry.first.to_string ());
+		penalty_l.put ("score", std::to_string (entry.second.score));
+		penalty_l.put ("exclusions", std::to_string (entry.second.exclusions));
+		auto excluded_seconds (entry.second.exclude_until > now ? std::chrono::duration_cast<std::chrono::seconds> (entry.second.exclude_until - now).count () : 0);
+		penalty_l.put ("excluded_seconds", std::to_string (excluded_seconds));
+		penalties.push_back (std::make_pair ("", penalty_l));
+	}
+	response_l.add_child ("penalties", penalties);
+	response_errors ();
+}
+
 void btcnew::json_handler::peers ()
 {
 	boost::property_tree::ptree peers_l;
@@ -3853,6 +3910,15 @@ void btcnew::json_handler::stats ()
 		node.stats.log_samples (*sink);
 		use_sink = true;
 	}
+	else if (type == "histograms")
+	{
+		node.stats.log_histograms (*sink);
+		use_sink = true;
+	}
+	else if (type == "messages")
+	{
+		node.network.message_histograms.serialize_json (response_l);
+	}
 	else
 	{
 		ec = btcnew::error_rpc::invalid_missing_type;
@@ -4997,12 +5063,15 @@ ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ()
 	no_arg_funcs.emplace ("delegators", &btcnew::json_handler::delegators);
 	no_arg_funcs.emplace ("delegators_count", &btcnew::json_handler::delegators_count);
 	no_arg_funcs.emplace ("deterministic_key", &btcnew::json_handler::deterministic_key);
+	no_arg_funcs.emplace ("election_scheduler", &btcnew::json_handler::election_scheduler);
 	no_arg_funcs.emplace ("epoch_upgrade", &btcnew::json_handler::epoch_upgrade);
 	no_arg_funcs.emplace ("frontiers", &btcnew::json_handler::frontiers);
 	no_arg_funcs.emplace ("frontier_count", &btcnew::json_handler::account_count);
+	no_arg_funcs.emplace ("io_shards", &btcnew::json_handler::io_shards);
 	no_arg_funcs.emplace ("keepalive", &btcnew::json_handler::keepalive);
 	no_arg_funcs.emplace ("key_create", &btcnew::json_handler::key_create);
 	no_arg_funcs.emplace ("key_expand", &btcnew::json_handler::key_expand);
+	no_arg_funcs.emplace ("latency", &btcnew::json_handler::latency);
 	no_arg_funcs.emplace ("ledger", &btcnew::json_handler::ledger);
 	no_arg_funcs.emplace ("node_id", &btcnew::json_handler::node_id);
 	no_arg_funcs.emplace ("node_id_delete", &btcnew::json_handler::node_id_delete);
@@ -5013,6 +5082,7 @@ ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ()
 	no_arg_funcs.emplace ("payment_init", &btcnew::json_handler::payment_init);
 	no_arg_funcs.emplace ("payment_end", &btcnew::json_handler::payment_end);
 	no_arg_funcs.emplace ("payment_wait", &btcnew::json_handler::payment_wait);
+	no_arg_funcs.emplace ("peer_penalties", &btcnew::json_handler::peer_penalties);
 	no_arg_funcs.emplace ("peers", &btcnew::json_handler::peers);
 	no_arg_funcs.emplace ("pending", &btcnew::json_handler::pending);
 	no_arg_funcs.emplace ("pending_exists", &btcnew::json_handler::pending_exists);
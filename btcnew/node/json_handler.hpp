@@ -63,11 +63,14 @@ public:
 	void delegators ();
 	void delegators_count ();
 	void deterministic_key ();
+	void election_scheduler ();
 	void epoch_upgrade ();
 	void frontiers ();
+	void io_shards ();
 	void keepalive ();
 	void key_create ();
 	void key_expand ();
+	void latency ();
 	void ledger ();
 	void mbtcnew_to_raw (btcnew::uint128_t = btcnew::Mbtcnew_ratio);
 	void mbtcnew_from_raw (btcnew::uint128_t = btcnew::Mbtcnew_ratio);
@@ -80,6 +83,7 @@ public:
 	void payment_init ();
 	void payment_end ();
 	void payment_wait ();
+	void peer_penalties ();
 	void peers ();
 	void pending ();
 	void pending_exists ();
@@ -0,0 +1,201 @@
+#include <btcnew/lib/stats.hpp>
+#include <btcnew/node/latency_tracker.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+size_t constexpr btcnew::latency_tracker::max_size;
+std::array<btcnew::latency_stage, 9> const btcnew::latency_tracker::stages{ { btcnew::latency_stage::enqueue, btcnew::latency_stage::dequeue, btcnew::latency_stage::ledger_process, btcnew::latency_stage::election_start, btcnew::latency_stage::confirm_req, btcnew::latency_stage::quorum, btcnew::latency_stage::cemented, btcnew::latency_stage::observers, btcnew::latency_stage::total } };
+
+namespace
+{
+btcnew::stat::detail detail_of (btcnew::latency_stage stage_a)
+{
+	auto result (btcnew::stat::detail::all);
+	switch (stage_a)
+	{
+		case btcnew::latency_stage::arrival:
+			assert (false);
+			break;
+		case btcnew::latency_stage::enqueue:
+			result = btcnew::stat::detail::enqueue;
+			break;
+		case btcnew::latency_stage::dequeue:
+			result = btcnew::stat::detail::dequeue;
+			break;
+		case btcnew::latency_stage::ledger_process:
+			result = btcnew::stat::detail::ledger_process;
+			break;
+		case btcnew::latency_stage::election_start:
+			result = btcnew::stat::detail::election_start;
+			break;
+		case btcnew::latency_stage::confirm_req:
+			result = btcnew::stat::detail::confirm_req;
+			break;
+		case btcnew::latency_stage::quorum:
+			result = btcnew::stat::detail::quorum;
+			break;
+		case btcnew::latency_stage::cemented:
+			result = btcnew::stat::detail::cemented;
+			break;
+		case btcnew::latency_stage::observers:
+			result = btcnew::stat::detail::observers;
+			break;
+		case btcnew::latency_stage::total:
+			result = btcnew::stat::detail::total;
+	}
+	return result;
+}
+
+uint64_t percentile (std::vector<btcnew::stat_histogram::bin> const & bins_a, uint64_t count_a, double fraction_a)
+{
+	uint64_t result (0);
+	if (count_a > 0)
+	{
+		auto target (static_cast<uint64_t> (std::ceil (count_a * fraction_a)));
+		uint64_t seen (0);
+		for (auto & bin : bins_a)
+		{
+			seen += bin.value;
+			if (seen >= target)
+			{
+				// The last bin is unbounded, its start is the best estimate available
+				result = &bin == &bins_a.back () ? bin.start_inclusive : bin.end_exclusive;
+				break;
+			}
+		}
+	}
+	return result;
+}
+}
+
+btcnew::latency_tracker::latency_tracker (btcnew::stat & stats_a) :
+stats (stats_a)
+{
+	for (auto stage : stages)
+	{
+		stats.define_histogram (btcnew::stat::type::latency, detail_of (stage), btcnew::stat::dir::in, { 0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, 60000, 300000, std::numeric_limits<uint64_t>::max () });
+	}
+}
+
+void btcnew::latency_tracker::arrival (btcnew::block_hash const & hash_a)
+{
+	auto now (std::chrono::steady_clock::now ());
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	auto inserted (entries.push_back (entry{ hash_a, now, now }));
+	if (inserted.second && entries.size () > max_size)
+	{
+		entries.pop_front ();
+	}
+}
+
+void btcnew::latency_tracker::stage (btcnew::block_hash const & hash_a, btcnew::latency_stage stage_a)
+{
+	assert (stage_a != btcnew::latency_stage::arrival && stage_a != btcnew::latency_stage::total);
+	auto now (std::chrono::steady_clock::now ());
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	auto & hashes (entries.get<1> ());
+	auto existing (hashes.find (hash_a));
+	if (existing != hashes.end ())
+	{
+		stats.update_histogram (btcnew::stat::type::latency, detail_of (stage_a), btcnew::stat::dir::in, std::chrono::duration_cast<std::chrono::milliseconds> (now - existing->last).count ());
+		if (stage_a == btcnew::latency_stage::observers)
+		{
+			stats.update_histogram (btcnew::stat::type::latency, btcnew::stat::detail::total, btcnew::stat::dir::in, std::chrono::duration_cast<std::chrono::milliseconds> (now - existing->arrival).count ());
+			hashes.erase (existing);
+		}
+		else
+		{
+			hashes.modify (existing, [now] (entry & entry_a) { entry_a.last = now; });
+		}
+	}
+}
+
+size_t btcnew::latency_tracker::size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return entries.size ();
+}
+
+btcnew::latency_tracker::summary btcnew::latency_tracker::get_summary (btcnew::latency_stage stage_a)
+{
+	btcnew::latency_tracker::summary result;
+	auto histogram (stats.get_histogram (btcnew::stat::type::latency, detail_of (stage_a), btcnew::stat::dir::in));
+	if (histogram != nullptr)
+	{
+		auto bins (histogram->get_bins ());
+		for (auto & bin : bins)
+		{
+			result.count += bin.value;
+		}
+		result.p50 = percentile (bins, result.count, 0.5);
+		result.p90 = percentile (bins, result.count, 0.9);
+		result.p99 = percentile (bins, result.count, 0.99);
+	}
+	return result;
+}
+
+void btcnew::latency_tracker::serialize_json (boost::property_tree::ptree & tree_a)
+{
+	for (auto stage : stages)
+	{
+		auto summary (get_summary (stage));
+		boost::property_tree::ptree stage_l;
+		stage_l.put ("count", std::to_string (summary.count));
+		stage_l.put ("p50", std::to_string (summary.p50));
+		stage_l.put ("p90", std::to_string (summary.p90));
+		stage_l.put ("p99", std::to_string (summary.p99));
+		tree_a.add_child (stage_to_string (stage), stage_l);
+	}
+}
+
+std::string btcnew::latency_tracker::stage_to_string (btcnew::latency_stage stage_a)
+{
+	std::string result;
+	switch (stage_a)
+	{
+		case btcnew::latency_stage::arrival:
+			result = "arrival";
+			break;
+		case btcnew::latency_stage::enqueue:
+			result = "enqueue";
+			break;
+		case btcnew::latency_stage::dequeue:
+			result = "dequeue";
+			break;
+		case btcnew::latency_stage::ledger_process:
+			result = "ledger_process";
+			break;
+		case btcnew::latency_stage::election_start:
+			result = "election_start";
+			break;
+		case btcnew::latency_stage::confirm_req:
+			result = "confirm_req";
+			break;
+		case btcnew::latency_stage::quorum:
+			result = "quorum";
+			break;
+		case btcnew::latency_stage::cemented:
+			result = "cemented";
+			break;
+		case btcnew::latency_stage::observers:
+			result = "observers";
+			break;
+		case btcnew::latency_stage::total:
+			result = "total";
+	}
+	return result;
+}
+
+namespace btcnew
+{
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (latency_tracker & latency_tracker, const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "entries", latency_tracker.size (), sizeof (decltype (latency_tracker.entries)::value_type) }));
+	return composite;
+}
+}
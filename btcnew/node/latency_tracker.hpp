@@ -0,0 +1,89 @@
+#pragma once
+
+#include <btcnew/lib/utility.hpp>
+#include <btcnew/secure/common.hpp>
+
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace btcnew
+{
+class stat;
+
+/** Points in the life of a live block, from arriving off the network to its confirmation observers being notified */
+enum class latency_stage : uint8_t
+{
+	arrival,
+	enqueue,
+	dequeue,
+	ledger_process,
+	election_start,
+	confirm_req,
+	quorum,
+	cemented,
+	observers,
+	/** Arrival to observers, recorded once per block */
+	total
+};
+
+/**
+ * Timestamps live blocks as they move through the node and adds the time spent since the previous stage to a histogram per stage.
+ * Only blocks which went through btcnew::latency_stage::arrival are followed, later stages of other blocks are ignored.
+ */
+class latency_tracker final
+{
+public:
+	explicit latency_tracker (btcnew::stat &);
+	/** Start following \p hash_a */
+	void arrival (btcnew::block_hash const & hash_a);
+	/** Record that \p hash_a reached \p stage_a. Reaching btcnew::latency_stage::observers completes the block */
+	void stage (btcnew::block_hash const & hash_a, btcnew::latency_stage stage_a);
+	size_t size ();
+	class summary final
+	{
+	public:
+		uint64_t count{ 0 };
+		/** Upper bounds of the bins holding the percentiles, in milliseconds */
+		uint64_t p50{ 0 };
+		uint64_t p90{ 0 };
+		uint64_t p99{ 0 };
+	};
+	/** Percentiles of the time spent reaching \p stage_a */
+	summary get_summary (btcnew::latency_stage stage_a);
+	/** Write the summary of every stage to \p tree_a, keyed by stage name */
+	void serialize_json (boost::property_tree::ptree & tree_a);
+	static std::string stage_to_string (btcnew::latency_stage);
+	/** Stages with a histogram, every stage except btcnew::latency_stage::arrival */
+	static std::array<btcnew::latency_stage, 9> const stages;
+	/** Blocks followed at once, the oldest is forgotten when a new one arrives */
+	static size_t constexpr max_size{ 64 * 1024 };
+
+private:
+	class entry final
+	{
+	public:
+		btcnew::block_hash hash;
+		std::chrono::steady_clock::time_point arrival;
+		std::chrono::steady_clock::time_point last;
+	};
+	btcnew::stat & stats;
+	boost::multi_index_container<entry,
+	boost::multi_index::indexed_by<
+	boost::multi_index::sequenced<>,
+	boost::multi_index::hashed_unique<boost::multi_index::member<entry, btcnew::block_hash, &entry::hash>>>>
+	entries;
+	std::mutex mutex;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (latency_tracker &, const std::string &);
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (latency_tracker & latency_tracker, const std::string & name);
+}
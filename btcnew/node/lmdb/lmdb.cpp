@@ -42,13 +42,16 @@ btcnew::mdb_store::mdb_store (btcnew::logger_mt & logger_a, boost::filesystem::p
 logger (logger_a),
 env (error, path_a, lmdb_max_dbs, true),
 mdb_txn_tracker (logger_a, txn_tracking_config_a, block_processor_batch_max_time_a),
-txn_tracking_enabled (txn_tracking_config_a.enable)
+txn_tracking_enabled (txn_tracking_config_a.enable),
+read_txn_pool ([this]() {
+	return std::make_unique<btcnew::read_mdb_txn> (env, create_txn_callbacks ());
+})
 {
 	if (!error)
 	{
 		auto is_fully_upgraded (false);
 		{
-			auto transaction (tx_begin_read ());
+			auto transaction (env.tx_begin_read (create_txn_callbacks ()));
 			auto err = mdb_dbi_open (env.tx (transaction), "meta", 0, &meta);
 			if (err == MDB_SUCCESS)
 			{
@@ -84,7 +87,7 @@ txn_tracking_enabled (txn_tracking_config_a.enable)
 		}
 		else
 		{
-			auto transaction (tx_begin_read ());
+			auto transaction (env.tx_begin_read (create_txn_callbacks ()));
 			open_databases (error, transaction, 0);
 		}
 	}
@@ -109,7 +112,7 @@ bool btcnew::mdb_store::vacuum_after_upgrade (boost::filesystem::path const & pa
 		env.init (error, path_a, lmdb_max_dbs, true);
 		if (!error)
 		{
-			auto transaction (tx_begin_read ());
+			auto transaction (env.tx_begin_read (create_txn_callbacks ()));
 			open_databases (error, transaction, 0);
 		}
 	}
@@ -126,6 +129,14 @@ void btcnew::mdb_store::serialize_mdb_tracker (boost::property_tree::ptree & jso
 	mdb_txn_tracker.serialize_json (json, min_read_time, min_write_time);
 }
 
+void btcnew::mdb_store::serialize_txn_totals (boost::property_tree::ptree & json)
+{
+	mdb_txn_tracker.serialize_totals (json);
+	json.put ("read_pool_created", read_txn_pool.created.load ());
+	json.put ("read_pool_renewed", read_txn_pool.renewed.load ());
+	json.put ("read_pool_discarded", read_txn_pool.discarded.load ());
+}
+
 btcnew::write_transaction btcnew::mdb_store::tx_begin_write (std::vector<btcnew::tables> const &, std::vector<btcnew::tables> const &)
 {
 	return env.tx_begin_write (create_txn_callbacks ());
@@ -133,7 +144,14 @@ btcnew::write_transaction btcnew::mdb_store::tx_begin_write (std::vector<btcnew:
 
 btcnew::read_transaction btcnew::mdb_store::tx_begin_read ()
 {
-	return env.tx_begin_read (create_txn_callbacks ());
+	return read_txn_pool.tx_begin_read ();
+}
+
+std::unique_ptr<btcnew::seq_con_info_component> btcnew::mdb_store::collect_seq_con_info (const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (btcnew::collect_seq_con_info (read_txn_pool, "read_txn_pool"));
+	return composite;
 }
 
 btcnew::mdb_txn_callbacks btcnew::mdb_store::create_txn_callbacks ()
@@ -41,6 +41,8 @@ public:
 	void version_put (btcnew::write_transaction const &, int) override;
 
 	void serialize_mdb_tracker (boost::property_tree::ptree &, std::chrono::milliseconds, std::chrono::milliseconds) override;
+	void serialize_txn_totals (boost::property_tree::ptree &) override;
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (const std::string & name) override;
 
 	static void create_backup_file (btcnew::mdb_env &, boost::filesystem::path const &, btcnew::logger_mt &);
 
@@ -247,6 +249,8 @@ private:
 	btcnew::mdb_txn_tracker mdb_txn_tracker;
 	btcnew::mdb_txn_callbacks create_txn_callbacks ();
 	bool txn_tracking_enabled;
+	/** Must be declared after env so that pooled transactions are closed before the environment */
+	btcnew::read_transaction_pool read_txn_pool;
 
 	size_t count (btcnew::transaction const & transaction_a, tables table_a) const override;
 
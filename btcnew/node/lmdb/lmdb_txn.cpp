@@ -49,6 +49,7 @@ private:
 }
 
 btcnew::read_mdb_txn::read_mdb_txn (btcnew::mdb_env const & environment_a, btcnew::mdb_txn_callbacks txn_callbacks_a) :
+env (environment_a),
 txn_callbacks (txn_callbacks_a)
 {
 	auto status (mdb_txn_begin (environment_a, nullptr, MDB_RDONLY, &handle));
@@ -73,6 +74,12 @@ void btcnew::read_mdb_txn::reset ()
 void btcnew::read_mdb_txn::renew ()
 {
 	auto status (mdb_txn_renew (handle));
+	if (status == MDB_BAD_RSLOT)
+	{
+		// Closing another environment on the same file within this process releases the reader slots of reset transactions
+		mdb_txn_abort (handle);
+		status = mdb_txn_begin (env, nullptr, MDB_RDONLY, &handle);
+	}
 	release_assert (status == 0);
 	txn_callbacks.txn_start (this);
 }
@@ -198,6 +205,19 @@ void btcnew::mdb_txn_tracker::output_finished (btcnew::mdb_txn_stats const & mdb
 	}
 }
 
+void btcnew::mdb_txn_tracker::serialize_totals (boost::property_tree::ptree & json) const
+{
+	auto seconds_elapsed (std::max<uint64_t> (1, std::chrono::duration_cast<std::chrono::seconds> (std::chrono::steady_clock::now () - start).count ()));
+	auto read_count_l (read_count.load ());
+	auto write_count_l (write_count.load ());
+	json.put ("read_count", read_count_l);
+	json.put ("read_per_second", read_count_l / seconds_elapsed);
+	json.put ("read_held_total_ms", read_held_ms.load ());
+	json.put ("write_count", write_count_l);
+	json.put ("write_per_second", write_count_l / seconds_elapsed);
+	json.put ("write_held_total_ms", write_held_ms.load ());
+}
+
 void btcnew::mdb_txn_tracker::add (const btcnew::transaction_impl * transaction_impl)
 {
 	btcnew::lock_guard<std::mutex> guard (mutex);
@@ -205,6 +225,7 @@ void btcnew::mdb_txn_tracker::add (const btcnew::transaction_impl * transaction_
 	assert (std::find_if (stats.cbegin (), stats.cend (), matches_txn (transaction_impl)) == stats.cend ());
 	// clang-format on
 	stats.emplace_back (transaction_impl);
+	++(stats.back ().is_write () ? write_count : read_count);
 }
 
 /** Can be called without error if transaction does not exist */
@@ -216,6 +237,7 @@ void btcnew::mdb_txn_tracker::erase (const btcnew::transaction_impl * transactio
 	// clang-format on
 	if (it != stats.end ())
 	{
+		(it->is_write () ? write_held_ms : read_held_ms) += it->timer.since_start ().count ();
 		output_finished (*it);
 		it->timer.stop ();
 		stats.erase (it);
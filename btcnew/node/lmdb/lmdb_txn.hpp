@@ -7,6 +7,7 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/stacktrace/stacktrace_fwd.hpp>
 
+#include <atomic>
 #include <mutex>
 
 #include <lmdb/libraries/liblmdb/lmdb.h>
@@ -35,6 +36,7 @@ public:
 	void renew () override;
 	void * get_handle () const override;
 	MDB_txn * handle;
+	btcnew::mdb_env const & env;
 	mdb_txn_callbacks txn_callbacks;
 };
 
@@ -70,10 +72,18 @@ class mdb_txn_tracker
 public:
 	mdb_txn_tracker (btcnew::logger_mt & logger_a, btcnew::txn_tracking_config const & txn_tracking_config_a, std::chrono::milliseconds block_processor_batch_max_time_a);
 	void serialize_json (boost::property_tree::ptree & json, std::chrono::milliseconds min_read_time, std::chrono::milliseconds min_write_time);
+	void serialize_totals (boost::property_tree::ptree & json) const;
 	void add (const btcnew::transaction_impl * transaction_impl);
 	void erase (const btcnew::transaction_impl * transaction_impl);
 
 private:
+	/** Number of transactions started (including renewals) and the total time they were held open */
+	std::atomic<uint64_t> read_count{ 0 };
+	std::atomic<uint64_t> write_count{ 0 };
+	std::atomic<uint64_t> read_held_ms{ 0 };
+	std::atomic<uint64_t> write_held_ms{ 0 };
+	std::chrono::steady_clock::time_point const start{ std::chrono::steady_clock::now () };
+
 	std::mutex mutex;
 	std::vector<mdb_txn_stats> stats;
 	btcnew::logger_mt & logger;
@@ -0,0 +1,223 @@
+#include <btcnew/node/message_histograms.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <cmath>
+
+size_t constexpr btcnew::message_histograms::bin_count;
+size_t constexpr btcnew::message_histograms::transport_count;
+size_t constexpr btcnew::message_histograms::message_type_count;
+size_t constexpr btcnew::message_histograms::metric_count;
+
+namespace
+{
+std::atomic<uint64_t> next_id{ 0 };
+
+size_t bin_of (uint64_t value_a)
+{
+	// Bin 0 holds 0, bin i holds [2^(i-1), 2^i)
+	size_t result (0);
+	while (value_a != 0 && result < btcnew::message_histograms::bin_count - 1)
+	{
+		value_a >>= 1;
+		++result;
+	}
+	return result;
+}
+
+uint64_t percentile (std::array<uint64_t, btcnew::message_histograms::bin_count> const & bins_a, uint64_t count_a, double fraction_a)
+{
+	uint64_t result (0);
+	if (count_a > 0)
+	{
+		auto target (static_cast<uint64_t> (std::ceil (count_a * fraction_a)));
+		uint64_t seen (0);
+		for (size_t i (0); i < bins_a.size (); ++i)
+		{
+			seen += bins_a[i];
+			if (seen >= target)
+			{
+				// The last bin is unbounded, its start is the best estimate available
+				result = i == bins_a.size () - 1 ? uint64_t (1) << (i - 1) : uint64_t (1) << i;
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+std::string message_type_to_string (btcnew::message_type type_a)
+{
+	std::string result ("invalid");
+	switch (type_a)
+	{
+		case btcnew::message_type::invalid:
+			result = "invalid";
+			break;
+		case btcnew::message_type::not_a_type:
+			result = "not_a_type";
+			break;
+		case btcnew::message_type::keepalive:
+			result = "keepalive";
+			break;
+		case btcnew::message_type::publish:
+			result = "publish";
+			break;
+		case btcnew::message_type::confirm_req:
+			result = "confirm_req";
+			break;
+		case btcnew::message_type::confirm_ack:
+			result = "confirm_ack";
+			break;
+		case btcnew::message_type::bulk_pull:
+			result = "bulk_pull";
+			break;
+		case btcnew::message_type::bulk_push:
+			result = "bulk_push";
+			break;
+		case btcnew::message_type::frontier_req:
+			result = "frontier_req";
+			break;
+		case btcnew::message_type::node_id_handshake:
+			result = "node_id_handshake";
+			break;
+		case btcnew::message_type::bulk_pull_account:
+			result = "bulk_pull_account";
+	}
+	return result;
+}
+}
+
+btcnew::message_histograms::message_histograms () :
+id (next_id++)
+{
+}
+
+void btcnew::message_histograms::add (btcnew::transport::transport_type transport_a, btcnew::message_type type_a, btcnew::message_histograms::metric metric_a, uint64_t value_a)
+{
+	size_t offset_l;
+	if (!offset (transport_a, type_a, metric_a, offset_l))
+	{
+		// Only this thread writes to its buffer, readers tolerate a count being added while they sum
+		local ().bins[offset_l + bin_of (value_a)].fetch_add (1, std::memory_order_relaxed);
+	}
+}
+
+void btcnew::message_histograms::add_elapsed (btcnew::transport::transport_type transport_a, btcnew::message_type type_a, btcnew::message_histograms::metric metric_a, std::chrono::steady_clock::time_point const & start_a)
+{
+	add (transport_a, type_a, metric_a, std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start_a).count ());
+}
+
+btcnew::message_histograms::summary btcnew::message_histograms::get_summary (btcnew::transport::transport_type transport_a, btcnew::message_type type_a, btcnew::message_histograms::metric metric_a)
+{
+	btcnew::message_histograms::summary result;
+	size_t offset_l;
+	if (!offset (transport_a, type_a, metric_a, offset_l))
+	{
+		auto bins (merged (offset_l));
+		for (auto bin : bins)
+		{
+			result.count += bin;
+		}
+		result.p50 = percentile (bins, result.count, 0.5);
+		result.p90 = percentile (bins, result.count, 0.9);
+		result.p99 = percentile (bins, result.count, 0.99);
+	}
+	return result;
+}
+
+void btcnew::message_histograms::serialize_json (boost::property_tree::ptree & tree_a)
+{
+	std::array<std::pair<btcnew::message_histograms::metric, char const *>, metric_count> const metrics{ { { metric::size, "size_bytes" }, { metric::parse, "parse_us" }, { metric::queue, "queue_us" }, { metric::handler, "handler_us" } } };
+	for (auto transport : { btcnew::transport::transport_type::udp, btcnew::transport::transport_type::tcp })
+	{
+		boost::property_tree::ptree transport_l;
+		for (size_t type (0); type < message_type_count; ++type)
+		{
+			boost::property_tree::ptree type_l;
+			for (auto & metric : metrics)
+			{
+				auto summary (get_summary (transport, static_cast<btcnew::message_type> (type), metric.first));
+				if (summary.count > 0)
+				{
+					boost::property_tree::ptree metric_l;
+					metric_l.put ("count", std::to_string (summary.count));
+					metric_l.put ("p50", std::to_string (summary.p50));
+					metric_l.put ("p90", std::to_string (summary.p90));
+					metric_l.put ("p99", std::to_string (summary.p99));
+					type_l.add_child (metric.second, metric_l);
+				}
+			}
+			if (!type_l.empty ())
+			{
+				transport_l.add_child (message_type_to_string (static_cast<btcnew::message_type> (type)), type_l);
+			}
+		}
+		tree_a.add_child (transport == btcnew::transport::transport_type::udp ? "udp" : "tcp", transport_l);
+	}
+}
+
+size_t btcnew::message_histograms::buffers_size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return buffers.size ();
+}
+
+btcnew::message_histograms::buffer & btcnew::message_histograms::local ()
+{
+	// Buffers of this thread, one per instance it has recorded to
+	thread_local std::vector<std::pair<uint64_t, buffer *>> cache;
+	buffer * result (nullptr);
+	for (auto & entry : cache)
+	{
+		if (entry.first == id)
+		{
+			result = entry.second;
+			break;
+		}
+	}
+	if (result == nullptr)
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		buffers.push_back (std::make_unique<buffer> ());
+		result = buffers.back ().get ();
+		cache.emplace_back (id, result);
+	}
+	return *result;
+}
+
+std::array<uint64_t, btcnew::message_histograms::bin_count> btcnew::message_histograms::merged (size_t offset_a)
+{
+	std::array<uint64_t, bin_count> result{};
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	for (auto & buffer : buffers)
+	{
+		for (size_t i (0); i < bin_count; ++i)
+		{
+			result[i] += buffer->bins[offset_a + i].load (std::memory_order_relaxed);
+		}
+	}
+	return result;
+}
+
+bool btcnew::message_histograms::offset (btcnew::transport::transport_type transport_a, btcnew::message_type type_a, btcnew::message_histograms::metric metric_a, size_t & offset_a)
+{
+	auto transport_l (static_cast<size_t> (transport_a));
+	auto type_l (static_cast<size_t> (type_a));
+	auto error (transport_l == 0 || transport_l > transport_count || type_l >= message_type_count);
+	if (!error)
+	{
+		offset_a = (((transport_l - 1) * message_type_count + type_l) * metric_count + static_cast<size_t> (metric_a)) * bin_count;
+	}
+	return error;
+}
+
+namespace btcnew
+{
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (message_histograms & message_histograms, const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "buffers", message_histograms.buffers_size (), sizeof (decltype (message_histograms.buffers)::value_type::element_type) }));
+	return composite;
+}
+}
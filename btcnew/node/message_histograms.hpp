@@ -0,0 +1,75 @@
+#pragma once
+
+#include <btcnew/lib/utility.hpp>
+#include <btcnew/node/common.hpp>
+#include <btcnew/node/transport/transport.hpp>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace btcnew
+{
+/**
+ * Histograms of inbound realtime messages per transport and message type: payload size, parse time, time queued
+ * before handling and handler time.
+ * Every thread adds to a buffer of its own so recording never takes a lock, the buffers are summed when read.
+ * Bins are powers of two, sizes are in bytes and times in microseconds.
+ */
+class message_histograms final
+{
+public:
+	enum class metric : uint8_t
+	{
+		size,
+		parse,
+		queue,
+		handler
+	};
+	message_histograms ();
+	void add (btcnew::transport::transport_type, btcnew::message_type, btcnew::message_histograms::metric, uint64_t value_a);
+	/** Add the microseconds elapsed since \p start_a */
+	void add_elapsed (btcnew::transport::transport_type, btcnew::message_type, btcnew::message_histograms::metric, std::chrono::steady_clock::time_point const & start_a);
+	class summary final
+	{
+	public:
+		uint64_t count{ 0 };
+		/** Upper bounds of the bins holding the percentiles */
+		uint64_t p50{ 0 };
+		uint64_t p90{ 0 };
+		uint64_t p99{ 0 };
+	};
+	summary get_summary (btcnew::transport::transport_type, btcnew::message_type, btcnew::message_histograms::metric);
+	/** Write a summary of every metric to \p tree_a, keyed by transport and message type. Message types never seen are left out */
+	void serialize_json (boost::property_tree::ptree & tree_a);
+	size_t buffers_size ();
+	static size_t constexpr bin_count{ 32 };
+
+private:
+	static size_t constexpr transport_count{ 2 };
+	static size_t constexpr message_type_count{ 12 };
+	static size_t constexpr metric_count{ 4 };
+	class buffer final
+	{
+	public:
+		std::array<std::atomic<uint64_t>, transport_count * message_type_count * metric_count * bin_count> bins{};
+	};
+	buffer & local ();
+	/** Bins of a histogram summed over every buffer */
+	std::array<uint64_t, bin_count> merged (size_t offset_a);
+	static bool offset (btcnew::transport::transport_type, btcnew::message_type, btcnew::message_histograms::metric, size_t & offset_a);
+	/** Unique across instances so threads never pick up the buffer of a destroyed instance at the same address */
+	uint64_t const id;
+	std::vector<std::unique_ptr<buffer>> buffers;
+	std::mutex mutex;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (message_histograms &, const std::string &);
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (message_histograms & message_histograms, const std::string & name);
+}
@@ -10,6 +10,9 @@ resolver (node_a.io_ctx),
 node (node_a),
 udp_channels (node_a, port_a),
 tcp_channels (node_a),
+publish_filter (publish_filter_size),
+traffic_shaper (node_a.config.traffic_shaping_config, node_a.stats),
+peer_limiter (node_a),
 disconnect_observer ([] () {})
 {
 	boost::thread::attributes attrs;
@@ -133,94 +136,6 @@ void btcnew::network::send_node_id_handshake (std::shared_ptr<btcnew::transport:
 	channel_a->send (message);
 }
 
-template <typename T>
-bool confirm_block (btcnew::transaction const & transaction_a, btcnew::node & node_a, T & list_a, std::shared_ptr<btcnew::block> block_a, bool also_publish)
-{
-	bool result (false);
-	if (node_a.config.enable_voting)
-	{
-		auto hash (block_a->hash ());
-		// Search in cache
-		auto votes (node_a.votes_cache.find (hash));
-		if (votes.empty ())
-		{
-			// Generate new vote
-			node_a.wallets.foreach_representative ([&result, &list_a, &node_a, &transaction_a, &hash] (btcnew::public_key const & pub_a, btcnew::raw_key const & prv_a) {
-				result = true;
-				auto vote (node_a.store.vote_generate (transaction_a, pub_a, prv_a, std::vector<btcnew::block_hash> (1, hash)));
-				btcnew::confirm_ack confirm (vote);
-				for (auto j (list_a.begin ()), m (list_a.end ()); j != m; ++j)
-				{
-					j->get ()->send (confirm);
-				}
-				node_a.votes_cache.add (vote);
-			});
-		}
-		else
-		{
-			// Send from cache
-			for (auto & vote : votes)
-			{
-				btcnew::confirm_ack confirm (vote);
-				for (auto j (list_a.begin ()), m (list_a.end ()); j != m; ++j)
-				{
-					j->get ()->send (confirm);
-				}
-			}
-		}
-		// Republish if required
-		if (also_publish)
-		{
-			btcnew::publish publish (block_a);
-			for (auto j (list_a.begin ()), m (list_a.end ()); j != m; ++j)
-			{
-				j->get ()->send (publish);
-			}
-		}
-	}
-	return result;
-}
-
-bool confirm_block (btcnew::transaction const & transaction_a, btcnew::node & node_a, std::shared_ptr<btcnew::transport::channel> channel_a, std::shared_ptr<btcnew::block> block_a, bool also_publish)
-{
-	std::array<std::shared_ptr<btcnew::transport::channel>, 1> endpoints = { channel_a };
-	auto result (confirm_block (transaction_a, node_a, endpoints, std::move (block_a), also_publish));
-	return result;
-}
-
-void btcnew::network::confirm_hashes (btcnew::transaction const & transaction_a, std::shared_ptr<btcnew::transport::channel> channel_a, std::vector<btcnew::block_hash> blocks_bundle_a)
-{
-	if (node.config.enable_voting)
-	{
-		node.wallets.foreach_representative ([this, &blocks_bundle_a, &channel_a, &transaction_a] (btcnew::public_key const & pub_a, btcnew::raw_key const & prv_a) {
-			auto vote (this->node.store.vote_generate (transaction_a, pub_a, prv_a, blocks_bundle_a));
-			btcnew::confirm_ack confirm (vote);
-			std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
-			{
-				btcnew::vectorstream stream (*bytes);
-				confirm.serialize (stream);
-			}
-			channel_a->send (confirm);
-			this->node.votes_cache.add (vote);
-		});
-	}
-}
-
-bool btcnew::network::send_votes_cache (std::shared_ptr<btcnew::transport::channel> channel_a, btcnew::block_hash const & hash_a)
-{
-	// Search in cache
-	auto votes (node.votes_cache.find (hash_a));
-	// Send from cache
-	for (auto & vote : votes)
-	{
-		btcnew::confirm_ack confirm (vote);
-		channel_a->send (confirm);
-	}
-	// Returns true if votes were sent
-	bool result (!votes.empty ());
-	return result;
-}
-
 void btcnew::network::flood_message (btcnew::message const & message_a, bool const is_droppable_a)
 {
 	auto list (list_fanout ());
@@ -434,6 +349,8 @@ public:
 		}
 		else
 		{
+			// Let the block through the filter when it is published again
+			node.network.publish_filter.clear (message_a.digest);
 			node.stats.inc (btcnew::stat::type::drop, btcnew::stat::detail::publish, btcnew::stat::dir::in);
 		}
 		node.active.publish (message_a.block);
@@ -457,83 +374,11 @@ public:
 		{
 			if (message_a.block != nullptr)
 			{
-				auto hash (message_a.block->hash ());
-				if (!node.network.send_votes_cache (channel, hash))
-				{
-					auto transaction (node.store.tx_begin_read ());
-					auto successor (node.ledger.successor (transaction, message_a.block->qualified_root ()));
-					if (successor != nullptr)
-					{
-						auto same_block (successor->hash () == hash);
-						confirm_block (transaction, node, channel, std::move (successor), !same_block);
-					}
-				}
+				node.aggregator.add (channel, { std::make_pair (message_a.block->hash (), message_a.block->root ()) });
 			}
 			else if (!message_a.roots_hashes.empty ())
 			{
-				auto transaction (node.store.tx_begin_read ());
-				std::vector<btcnew::block_hash> blocks_bundle;
-				std::vector<std::shared_ptr<btcnew::vote>> cached_votes;
-				size_t cached_count (0);
-				for (auto & root_hash : message_a.roots_hashes)
-				{
-					auto find_votes (node.votes_cache.find (root_hash.first));
-					if (!find_votes.empty ())
-					{
-						++cached_count;
-						cached_votes.insert (cached_votes.end (), find_votes.begin (), find_votes.end ());
-					}
-					if (!find_votes.empty () || (!root_hash.first.is_zero () && node.store.block_exists (transaction, root_hash.first)))
-					{
-						blocks_bundle.push_back (root_hash.first);
-					}
-					else if (!root_hash.second.is_zero ())
-					{
-						btcnew::block_hash successor (0);
-						// Search for block root
-						successor = node.store.block_successor (transaction, root_hash.second);
-						// Search for account root
-						if (successor.is_zero ())
-						{
-							btcnew::account_info info;
-							auto error (node.store.account_get (transaction, root_hash.second, info));
-							if (!error)
-							{
-								successor = info.open_block;
-							}
-						}
-						if (!successor.is_zero ())
-						{
-							auto find_successor_votes (node.votes_cache.find (successor));
-							if (!find_successor_votes.empty ())
-							{
-								++cached_count;
-								cached_votes.insert (cached_votes.end (), find_successor_votes.begin (), find_successor_votes.end ());
-							}
-							blocks_bundle.push_back (successor);
-							auto successor_block (node.store.block_get (transaction, successor));
-							assert (successor_block != nullptr);
-							btcnew::publish publish (successor_block);
-							channel->send (publish);
-						}
-					}
-				}
-				/* Decide to send cached votes or to create new vote
-				If there is at least one new hash to confirm, then create new batch vote
-				Otherwise use more bandwidth & save local resources required to sign vote */
-				if (!blocks_bundle.empty () && cached_count < blocks_bundle.size ())
-				{
-					node.network.confirm_hashes (transaction, channel, blocks_bundle);
-				}
-				else
-				{
-					// Send from cache
-					for (auto & vote : cached_votes)
-					{
-						btcnew::confirm_ack confirm (vote);
-						channel->send (confirm);
-					}
-				}
+				node.aggregator.add (channel, message_a.roots_hashes);
 			}
 		}
 	}
@@ -589,8 +434,10 @@ public:
 
 void btcnew::network::process_message (btcnew::message const & message_a, std::shared_ptr<btcnew::transport::channel> channel_a)
 {
+	auto start (std::chrono::steady_clock::now ());
 	network_message_visitor visitor (node, channel_a);
 	message_a.visit (visitor);
+	message_histograms.add_elapsed (channel_a->get_type (), message_a.header.type, btcnew::message_histograms::metric::handler, start);
 }
 
 // Send keepalives to all the peers we've been notified of
@@ -638,6 +485,8 @@ bool btcnew::network::reachout (btcnew::endpoint const & endpoint_a, bool allow_
 {
 	// Don't contact invalid IPs
 	bool error = not_a_peer (endpoint_a, allow_local_peers);
+	// Nor addresses excluded for misbehaving
+	error |= peer_limiter.excluded (endpoint_a.address ());
 	if (!error)
 	{
 		error |= udp_channels.reachout (endpoint_a);
@@ -649,20 +498,60 @@ bool btcnew::network::reachout (btcnew::endpoint const & endpoint_a, bool allow_
 std::deque<std::shared_ptr<btcnew::transport::channel>> btcnew::network::list (size_t count_a)
 {
 	std::deque<std::shared_ptr<btcnew::transport::channel>> result;
-	tcp_channels.list (result);
-	udp_channels.list (result);
-	random_pool::shuffle (result.begin (), result.end ());
-	if (result.size () > count_a)
+	auto tcp_peers (tcp_channels.snapshot ());
+	auto udp_peers (udp_channels.snapshot ());
+	auto total (tcp_peers->size () + udp_peers->size ());
+	if (count_a >= (total + 1) / 2)
+	{
+		result.insert (result.end (), tcp_peers->begin (), tcp_peers->end ());
+		result.insert (result.end (), udp_peers->begin (), udp_peers->end ());
+		random_pool::shuffle (result.begin (), result.end ());
+		if (result.size () > count_a)
+		{
+			result.resize (count_a, nullptr);
+		}
+	}
+	else
 	{
-		result.resize (count_a, nullptr);
+		// Sampling distinct indices only touches the chosen channels, at most half of the indices are ever taken so this finishes quickly
+		std::unordered_set<size_t> indices;
+		while (result.size () < count_a)
+		{
+			auto index (btcnew::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (total - 1)));
+			if (indices.insert (index).second)
+			{
+				result.push_back (index < tcp_peers->size () ? (*tcp_peers)[index] : (*udp_peers)[index - tcp_peers->size ()]);
+			}
+		}
 	}
 	return result;
 }
 
 // Simulating with sqrt_broadcast_simulate shows we only need to broadcast to sqrt(total_peers) random peers in order to successfully publish to everyone with high probability
+// Up to half of those are the heaviest known representatives so blocks and votes reach voting weight in a single hop
 std::deque<std::shared_ptr<btcnew::transport::channel>> btcnew::network::list_fanout ()
 {
-	auto result (list (size_sqrt ()));
+	auto fanout (size_sqrt ());
+	std::deque<std::shared_ptr<btcnew::transport::channel>> result;
+	std::unordered_set<std::shared_ptr<btcnew::transport::channel>> included;
+	for (auto & channel : node.rep_crawler.representative_endpoints (fanout / 2))
+	{
+		if (included.insert (channel).second)
+		{
+			result.push_back (channel);
+		}
+	}
+	for (auto & channel : list (fanout + result.size ()))
+	{
+		if (result.size () >= fanout)
+		{
+			break;
+		}
+		if (included.insert (channel).second)
+		{
+			result.push_back (channel);
+		}
+	}
 	return result;
 }
 
@@ -742,6 +631,8 @@ void btcnew::network::cleanup (std::chrono::steady_clock::time_point const & cut
 {
 	tcp_channels.purge (cutoff_a);
 	udp_channels.purge (cutoff_a);
+	traffic_shaper.purge (cutoff_a);
+	peer_limiter.purge (cutoff_a);
 	if (node.network.empty ())
 	{
 		disconnect_observer ();
@@ -844,9 +735,30 @@ btcnew::message_buffer * btcnew::message_buffer_manager::allocate ()
 	return result;
 }
 
+void btcnew::message_buffer_manager::allocate (std::vector<btcnew::message_buffer *> & buffers_a, size_t count_a)
+{
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		while (!free.empty () && buffers_a.size () < count_a)
+		{
+			buffers_a.push_back (free.front ());
+			free.pop_front ();
+		}
+	}
+	if (buffers_a.empty ())
+	{
+		auto buffer (allocate ());
+		if (buffer != nullptr)
+		{
+			buffers_a.push_back (buffer);
+		}
+	}
+}
+
 void btcnew::message_buffer_manager::enqueue (btcnew::message_buffer * data_a)
 {
 	assert (data_a != nullptr);
+	data_a->received = std::chrono::steady_clock::now ();
 	{
 		btcnew::lock_guard<std::mutex> lock (mutex);
 		full.push_back (data_a);
@@ -2,7 +2,11 @@
 
 #include <btcnew/boost/asio.hpp>
 #include <btcnew/node/common.hpp>
+#include <btcnew/node/message_histograms.hpp>
+#include <btcnew/node/network_filter.hpp>
 #include <btcnew/node/transport/tcp.hpp>
+#include <btcnew/node/transport/peer_limiter.hpp>
+#include <btcnew/node/transport/traffic_shaper.hpp>
 #include <btcnew/node/transport/udp.hpp>
 
 #include <boost/thread/thread.hpp>
@@ -22,6 +26,8 @@ public:
 	uint8_t * buffer{ nullptr };
 	size_t size{ 0 };
 	btcnew::endpoint endpoint;
+	/** When the buffer was queued for processing */
+	std::chrono::steady_clock::time_point received;
 };
 /**
   * A circular buffer for servicing btcnew realtime messages.
@@ -44,6 +50,9 @@ public:
 	// Function will block if there are no free or unserviced buffers
 	// Return nullptr if the container has stopped
 	btcnew::message_buffer * allocate ();
+	// Append up to count_a free buffers to buffers_a without dequeueing unserviced ones
+	// If there are no free buffers a single buffer is returned as by allocate ()
+	void allocate (std::vector<btcnew::message_buffer *> & buffers_a, size_t count_a);
 	// Queue a buffer that has been filled with message data and notify servicing threads
 	void enqueue (btcnew::message_buffer *);
 	// Return a buffer that has been filled with message data
@@ -127,8 +136,6 @@ public:
 	void broadcast_confirm_req_base (std::shared_ptr<btcnew::block>, std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>>>, unsigned, bool = false);
 	void broadcast_confirm_req_batched_many (std::unordered_map<std::shared_ptr<btcnew::transport::channel>, std::deque<std::pair<btcnew::block_hash, btcnew::root>>>, std::function<void ()> = nullptr, unsigned = broadcast_interval_ms, bool = false);
 	void broadcast_confirm_req_many (std::deque<std::pair<std::shared_ptr<btcnew::block>, std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>>>>>, std::function<void ()> = nullptr, unsigned = broadcast_interval_ms);
-	void confirm_hashes (btcnew::transaction const &, std::shared_ptr<btcnew::transport::channel>, std::vector<btcnew::block_hash>);
-	bool send_votes_cache (std::shared_ptr<btcnew::transport::channel>, btcnew::block_hash const &);
 	std::shared_ptr<btcnew::transport::channel> find_node_id (btcnew::account const &);
 	std::shared_ptr<btcnew::transport::channel> find_channel (btcnew::endpoint const &);
 	void process_message (btcnew::message const &, std::shared_ptr<btcnew::transport::channel>);
@@ -136,7 +143,7 @@ public:
 	// Should we reach out to this endpoint with a keepalive message
 	bool reachout (btcnew::endpoint const &, bool = false);
 	std::deque<std::shared_ptr<btcnew::transport::channel>> list (size_t);
-	// A list of random peers sized for the configured rebroadcast fanout
+	// A list of peers sized for the configured rebroadcast fanout, the heaviest known representatives first and random peers after them
 	std::deque<std::shared_ptr<btcnew::transport::channel>> list_fanout ();
 	void random_fill (std::array<btcnew::endpoint, 8> &) const;
 	std::unordered_set<std::shared_ptr<btcnew::transport::channel>> random_set (size_t) const;
@@ -158,6 +165,13 @@ public:
 	btcnew::node & node;
 	btcnew::transport::udp_channels udp_channels;
 	btcnew::transport::tcp_channels tcp_channels;
+	/** Digests of recently received publish payloads, duplicates are dropped before deserialization */
+	btcnew::network_filter publish_filter;
+	/** Limits realtime traffic per message class in both directions and per peer inbound */
+	btcnew::transport::traffic_shaper traffic_shaper;
+	/** Limits inbound realtime messages per IP address and node ID and penalizes misbehaving addresses */
+	btcnew::transport::peer_limiter peer_limiter;
+	btcnew::message_histograms message_histograms;
 	std::function<void ()> disconnect_observer;
 	// Called when a new channel is observed
 	std::function<void (std::shared_ptr<btcnew::transport::channel>)> channel_observer;
@@ -165,5 +179,7 @@ public:
 	static unsigned const broadcast_interval_ms = 10;
 	static size_t const buffer_size = 512;
 	static size_t const confirm_req_hashes_max = 7;
+	static size_t const confirm_ack_hashes_max = 12;
+	static size_t const publish_filter_size = 256 * 1024;
 };
 }
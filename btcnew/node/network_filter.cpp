@@ -0,0 +1,86 @@
+#include <btcnew/crypto_lib/random_pool.hpp>
+#include <btcnew/lib/blocks.hpp>
+#include <btcnew/node/network_filter.hpp>
+#include <btcnew/secure/utility.hpp>
+
+#include <crypto/cryptopp/siphash.h>
+
+#include <cassert>
+
+uint64_t constexpr btcnew::network_filter::empty;
+
+btcnew::network_filter::network_filter (size_t size_a) :
+items (new std::atomic<uint64_t>[size_a]),
+size (size_a)
+{
+	assert (size > 0);
+	btcnew::random_pool::generate_block (key.bytes.data (), key.bytes.size ());
+	clear ();
+}
+
+bool btcnew::network_filter::apply (uint8_t const * bytes_a, size_t count_a, uint64_t * digest_a)
+{
+	auto digest (hash (bytes_a, count_a));
+	if (digest_a != nullptr)
+	{
+		*digest_a = digest;
+	}
+	auto & element (get_element (digest));
+	auto existed (element.load () == digest);
+	if (!existed)
+	{
+		// Replace likely old element with a new one
+		element.store (digest);
+	}
+	return existed;
+}
+
+void btcnew::network_filter::clear (uint64_t digest_a)
+{
+	auto expected (digest_a);
+	get_element (digest_a).compare_exchange_strong (expected, empty);
+}
+
+void btcnew::network_filter::clear (std::vector<std::shared_ptr<btcnew::block>> const & blocks_a)
+{
+	for (auto const & block : blocks_a)
+	{
+		clear (block);
+	}
+}
+
+void btcnew::network_filter::clear (std::shared_ptr<btcnew::block> const & block_a)
+{
+	clear (hash (block_a));
+}
+
+void btcnew::network_filter::clear ()
+{
+	for (size_t i (0); i < size; ++i)
+	{
+		items[i].store (empty);
+	}
+}
+
+uint64_t btcnew::network_filter::hash (uint8_t const * bytes_a, size_t count_a) const
+{
+	uint64_t result;
+	CryptoPP::SipHash<2, 4, false> siphash (key.bytes.data (), static_cast<unsigned> (key.bytes.size ()));
+	siphash.CalculateDigest (reinterpret_cast<uint8_t *> (&result), bytes_a, count_a);
+	return result == empty ? 1 : result;
+}
+
+uint64_t btcnew::network_filter::hash (std::shared_ptr<btcnew::block> const & block_a) const
+{
+	std::vector<uint8_t> bytes;
+	{
+		btcnew::vectorstream stream (bytes);
+		block_a->serialize (stream);
+	}
+	return hash (bytes.data (), bytes.size ());
+}
+
+std::atomic<uint64_t> & btcnew::network_filter::get_element (uint64_t digest_a)
+{
+	return items[digest_a % size];
+}
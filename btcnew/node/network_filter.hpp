@@ -0,0 +1,47 @@
+#pragma once
+
+#include <btcnew/lib/numbers.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace btcnew
+{
+class block;
+
+/**
+ * Fixed size filter of message payload digests, used to drop messages which were already received before deserializing them.
+ * Each slot holds the 64 bit SipHash digest of one payload, keyed with a random key so peers can't construct collisions.
+ * A payload whose digest lands on an occupied slot replaces the previous digest, so old entries are forgotten as new ones arrive.
+ * Slots are single atomics, the filter does not lock.
+ */
+class network_filter final
+{
+public:
+	explicit network_filter (size_t size_a);
+	/**
+	 * Reads \p count_a bytes starting from \p bytes_a and inserts their digest
+	 * @param digest_a if not null, set to the digest of the bytes
+	 * @return true if the bytes were already in the filter
+	 */
+	bool apply (uint8_t const * bytes_a, size_t count_a, uint64_t * digest_a = nullptr);
+	/** Remove \p digest_a if its slot still holds it */
+	void clear (uint64_t digest_a);
+	/** Remove the digests of the serialized \p blocks_a, which are the payloads of publish messages carrying them */
+	void clear (std::vector<std::shared_ptr<btcnew::block>> const & blocks_a);
+	void clear (std::shared_ptr<btcnew::block> const & block_a);
+	/** Empty the filter */
+	void clear ();
+	uint64_t hash (uint8_t const * bytes_a, size_t count_a) const;
+	uint64_t hash (std::shared_ptr<btcnew::block> const & block_a) const;
+
+private:
+	std::atomic<uint64_t> & get_element (uint64_t digest_a);
+	/** Zero marks an empty slot, digests are never zero */
+	static uint64_t constexpr empty{ 0 };
+	std::unique_ptr<std::atomic<uint64_t>[]> items;
+	size_t const size;
+	btcnew::uint128_union key;
+};
+}
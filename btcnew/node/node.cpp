@@ -118,6 +118,8 @@ io_ctx (io_ctx_a),
 node_initialized_latch (1),
 config (config_a),
 stats (config.stat_config),
+latency (stats),
+io_shards (io_ctx_a, config.threading_config),
 flags (flags_a),
 alarm (alarm_a),
 work (work_a),
@@ -128,7 +130,7 @@ store (*store_impl),
 wallets_store_impl (std::make_unique<btcnew::mdb_wallets_store> (application_path_a / "wallets.ldb", config_a.lmdb_max_dbs)),
 wallets_store (*wallets_store_impl),
 gap_cache (*this),
-ledger (store, stats, flags_a.cache_representative_weights_from_frontiers),
+ledger (store, stats, flags_a.cache_representative_weights_from_frontiers, true, flags_a.cache_confirmation_heights),
 checker (config.signature_checker_threads),
 network (*this, config.peering_port),
 bootstrap_initiator (*this),
@@ -144,15 +146,18 @@ block_processor_thread ([this] () {
 	this->block_processor.process_blocks ();
 }),
 online_reps (*this, config.online_weight_minimum.number ()),
+votes_cache (network_params.voting.max_cache_bytes, network_params.voting.cache_stripes),
 vote_uniquer (block_uniquer),
 active (*this),
-confirmation_height_processor (pending_confirmation_height, ledger, active, write_database_queue, config.conf_height_processor_batch_min_time, logger),
+confirmation_height_processor (pending_confirmation_height, ledger, active, write_database_queue, config.conf_height_processor_batch_min_time, logger, flags.confirmation_height_prefetch_threads),
 payment_observer_processor (observers.blocks),
 wallets (wallets_store.init_error (), *this),
+aggregator (*this),
 startup_time (std::chrono::steady_clock::now ())
 {
 	if (!init_error ())
 	{
+		store.vote_reservation_set (network_params.voting.sequence_reservation);
 		if (config.websocket_config.enabled)
 		{
 			auto endpoint_l (btcnew::tcp_endpoint (config.websocket_config.address, config.websocket_config.port));
@@ -334,7 +339,7 @@ startup_time (std::chrono::steady_clock::now ())
 					{
 						logger.try_log (boost::str (boost::format ("Found a representative at %1%") % channel_a->to_string ()));
 						// Rebroadcasting all active votes to new representative
-						auto blocks (this->active.list_blocks (true));
+						auto blocks (this->active.list_blocks ());
 						for (auto i (blocks.begin ()), n (blocks.end ()); i != n; ++i)
 						{
 							if (*i != nullptr)
@@ -593,11 +598,15 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (node & node, const
 	composite->add_component (collect_seq_con_info (node.work, "work"));
 	composite->add_component (collect_seq_con_info (node.gap_cache, "gap_cache"));
 	composite->add_component (collect_seq_con_info (node.ledger, "ledger"));
+	composite->add_component (node.store.collect_seq_con_info ("store"));
 	composite->add_component (collect_seq_con_info (node.active, "active"));
 	composite->add_component (collect_seq_con_info (node.bootstrap_initiator, "bootstrap_initiator"));
 	composite->add_component (collect_seq_con_info (node.bootstrap, "bootstrap"));
 	composite->add_component (node.network.tcp_channels.collect_seq_con_info ("tcp_channels"));
 	composite->add_component (node.network.udp_channels.collect_seq_con_info ("udp_channels"));
+	composite->add_component (collect_seq_con_info (node.network.traffic_shaper, "traffic_shaper"));
+	composite->add_component (collect_seq_con_info (node.network.peer_limiter, "peer_limiter"));
+	composite->add_component (collect_seq_con_info (node.network.message_histograms, "message_histograms"));
 	composite->add_component (node.network.syn_cookies.collect_seq_con_info ("syn_cookies"));
 	composite->add_component (collect_seq_con_info (node.observers, "observers"));
 	composite->add_component (collect_seq_con_info (node.wallets, "wallets"));
@@ -605,8 +614,10 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (node & node, const
 	composite->add_component (collect_seq_con_info (node.rep_crawler, "rep_crawler"));
 	composite->add_component (collect_seq_con_info (node.block_processor, "block_processor"));
 	composite->add_component (collect_seq_con_info (node.block_arrival, "block_arrival"));
+	composite->add_component (collect_seq_con_info (node.latency, "latency"));
 	composite->add_component (collect_seq_con_info (node.online_reps, "online_reps"));
 	composite->add_component (collect_seq_con_info (node.votes_cache, "votes_cache"));
+	composite->add_component (collect_seq_con_info (node.aggregator, "request_aggregator"));
 	composite->add_component (collect_seq_con_info (node.block_uniquer, "block_uniquer"));
 	composite->add_component (collect_seq_con_info (node.vote_uniquer, "vote_uniquer"));
 	composite->add_component (collect_seq_con_info (node.confirmation_height_processor, "confirmation_height_processor"));
@@ -619,7 +630,10 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (node & node, const
 
 void btcnew::node::process_active (std::shared_ptr<btcnew::block> incoming)
 {
-	block_arrival.add (incoming->hash ());
+	if (!block_arrival.add (incoming->hash ()))
+	{
+		latency.arrival (incoming->hash ());
+	}
 	block_processor.add (incoming, btcnew::seconds_since_epoch ());
 }
 
@@ -659,6 +673,7 @@ void btcnew::node::start ()
 		});
 	}
 	ongoing_store_flush ();
+	ongoing_latency_report ();
 	if (!flags.disable_rep_crawler)
 	{
 		rep_crawler.start ();
@@ -704,6 +719,7 @@ void btcnew::node::stop ()
 			block_processor_thread.join ();
 		}
 		vote_processor.stop ();
+		aggregator.stop ();
 		confirmation_height_processor.stop ();
 		active.stop ();
 		network.stop ();
@@ -713,6 +729,7 @@ void btcnew::node::stop ()
 		}
 		bootstrap_initiator.stop ();
 		bootstrap.stop ();
+		io_shards.stop ();
 		port_mapping.stop ();
 		checker.stop ();
 		wallets.stop ();
@@ -821,12 +838,16 @@ void btcnew::node::ongoing_bootstrap ()
 
 void btcnew::node::ongoing_store_flush ()
 {
+	// Votes are written in batches every few seconds, sooner if a sequence reservation is waiting
+	auto now (std::chrono::steady_clock::now ());
+	if (now >= next_store_flush || store.vote_flush_required ())
 	{
-		auto transaction (store.tx_begin_write ({ tables::vote }));
-		store.flush (transaction);
+		auto scoped_write_guard = write_database_queue.wait (btcnew::writer::voting);
+		store.vote_flush ();
+		next_store_flush = now + std::chrono::seconds (5);
 	}
 	std::weak_ptr<btcnew::node> node_w (shared_from_this ());
-	alarm.add (std::chrono::steady_clock::now () + std::chrono::seconds (5), [node_w] () {
+	alarm.add (now + network_params.voting.flush_check_interval, [node_w] () {
 		if (auto node_l = node_w.lock ())
 		{
 			node_l->worker.push_task ([node_l] () {
@@ -836,6 +857,27 @@ void btcnew::node::ongoing_store_flush ()
 	});
 }
 
+void btcnew::node::ongoing_latency_report ()
+{
+	if (websocket_server && websocket_server->any_subscriber (btcnew::websocket::topic::latency))
+	{
+		btcnew::websocket::message_builder builder;
+		websocket_server->broadcast (builder.latency (latency));
+	}
+	if (websocket_server && websocket_server->any_subscriber (btcnew::websocket::topic::message_stats))
+	{
+		btcnew::websocket::message_builder builder;
+		websocket_server->broadcast (builder.message_stats (network.message_histograms));
+	}
+	std::weak_ptr<btcnew::node> node_w (shared_from_this ());
+	alarm.add (std::chrono::steady_clock::now () + network_params.node.latency_report_interval, [node_w] () {
+		if (auto node_l = node_w.lock ())
+		{
+			node_l->ongoing_latency_report ();
+		}
+	});
+}
+
 void btcnew::node::ongoing_peer_store ()
 {
 	bool stored (network.tcp_channels.store_all (true));
@@ -16,6 +16,8 @@
 #include <btcnew/node/distributed_work.hpp>
 #include <btcnew/node/election.hpp>
 #include <btcnew/node/gap_cache.hpp>
+#include <btcnew/node/io_shards.hpp>
+#include <btcnew/node/latency_tracker.hpp>
 #include <btcnew/node/logging.hpp>
 #include <btcnew/node/network.hpp>
 #include <btcnew/node/node_observers.hpp>
@@ -24,6 +26,7 @@
 #include <btcnew/node/payment_observer_processor.hpp>
 #include <btcnew/node/portmapping.hpp>
 #include <btcnew/node/repcrawler.hpp>
+#include <btcnew/node/request_aggregator.hpp>
 #include <btcnew/node/signatures.hpp>
 #include <btcnew/node/vote_processor.hpp>
 #include <btcnew/node/wallet.hpp>
@@ -116,6 +119,7 @@ public:
 	void ongoing_rep_calculation ();
 	void ongoing_bootstrap ();
 	void ongoing_store_flush ();
+	void ongoing_latency_report ();
 	void ongoing_peer_store ();
 	void ongoing_unchecked_cleanup ();
 	void backup_wallet ();
@@ -150,6 +154,8 @@ public:
 	btcnew::network_params network_params;
 	btcnew::node_config config;
 	btcnew::stat stats;
+	btcnew::latency_tracker latency;
+	btcnew::io_shards io_shards;
 	std::shared_ptr<btcnew::websocket::listener> websocket_server;
 	btcnew::node_flags flags;
 	btcnew::alarm & alarm;
@@ -185,7 +191,9 @@ public:
 	btcnew::confirmation_height_processor confirmation_height_processor;
 	btcnew::payment_observer_processor payment_observer_processor;
 	btcnew::wallets wallets;
+	btcnew::request_aggregator aggregator;
 	const std::chrono::steady_clock::time_point startup_time;
+	std::chrono::steady_clock::time_point next_store_flush;
 	std::chrono::seconds unchecked_cutoff = std::chrono::seconds (7 * 24 * 60 * 60); // Week
 	std::atomic<bool> unresponsive_work_peers{ false };
 	std::atomic<bool> stopped{ false };
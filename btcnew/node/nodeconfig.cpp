@@ -75,8 +75,8 @@ btcnew::error btcnew::node_config::serialize_toml (btcnew::tomlconfig & toml) co
 	toml.put ("block_processor_batch_max_time", block_processor_batch_max_time.count (), "The maximum time the block processor can continously process blocks for.\ntype:milliseconds");
 	toml.put ("allow_local_peers", allow_local_peers, "Enable or disable local host peering.\ntype:bool");
 	toml.put ("vote_minimum", vote_minimum.to_string_dec (), "Local representatives do not vote if the delegated weight is under this threshold. Saves on system resources.\ntype:string,amount,raw");
-	toml.put ("vote_generator_delay", vote_generator_delay.count (), "Delay before votes are sent to allow for efficient bundling of hashes in votes.\ntype:milliseconds");
-	toml.put ("vote_generator_threshold", vote_generator_threshold, "Number of bundled hashes required for an additional generator delay.\ntype:uint64,[1..11]");
+	toml.put ("vote_generator_delay", vote_generator_delay.count (), "Longest delay before votes are sent to allow for efficient bundling of hashes in votes. The delay adapts to how quickly hashes arrive.\ntype:milliseconds");
+	toml.put ("vote_generator_threshold", vote_generator_threshold, "Number of hashes expected to arrive within the delay for hashes to be held back for bundling.\ntype:uint64,[1..11]");
 	toml.put ("unchecked_cutoff_time", unchecked_cutoff_time.count (), "Number of seconds before deleting an unchecked entry.\nWarning: lower values (e.g., 3600 seconds, or 1 hour) may result in unsuccessful bootstraps, especially a bootstrap from scratch.\ntype:seconds");
 	toml.put ("tcp_io_timeout", tcp_io_timeout.count (), "Timeout for TCP connect-, read- and write operations.\nWarning: a low value (e.g., below 5 seconds) may result in TCP connections failing.\ntype:seconds");
 	toml.put ("pow_sleep_interval", pow_sleep_interval.count (), "Time to sleep between batch work generation attempts. Reduces max CPU usage at the expense of a longer generation time.\ntype:nanoseconds");
@@ -150,6 +150,14 @@ btcnew::error btcnew::node_config::serialize_toml (btcnew::tomlconfig & toml) co
 	rocksdb_config.serialize_toml (rocksdb_l);
 	toml.put_child ("rocksdb", rocksdb_l);
 
+	btcnew::tomlconfig traffic_shaping_l;
+	traffic_shaping_config.serialize_toml (traffic_shaping_l);
+	toml.put_child ("traffic_shaping", traffic_shaping_l);
+
+	btcnew::tomlconfig threading_l;
+	threading_config.serialize_toml (threading_l);
+	toml.put_child ("threading", threading_l);
+
 	return toml.get_error ();
 }
 
@@ -201,6 +209,18 @@ btcnew::error btcnew::node_config::deserialize_toml (btcnew::tomlconfig & toml)
 			rocksdb_config.deserialize_toml (rocksdb_config_l);
 		}
 
+		if (toml.has_key ("traffic_shaping"))
+		{
+			auto traffic_shaping_config_l (toml.get_required_child ("traffic_shaping"));
+			traffic_shaping_config.deserialize_toml (traffic_shaping_config_l);
+		}
+
+		if (toml.has_key ("threading"))
+		{
+			auto threading_config_l (toml.get_required_child ("threading"));
+			threading_config.deserialize_toml (threading_config_l);
+		}
+
 		if (toml.has_key ("work_peers"))
 		{
 			work_peers.clear ();
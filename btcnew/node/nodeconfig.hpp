@@ -9,10 +9,14 @@
 #include <btcnew/lib/stats.hpp>
 #include <btcnew/node/ipcconfig.hpp>
 #include <btcnew/node/logging.hpp>
+#include <btcnew/node/threadingconfig.hpp>
+#include <btcnew/node/trafficshapingconfig.hpp>
 #include <btcnew/node/websocketconfig.hpp>
 #include <btcnew/secure/common.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <thread>
 #include <vector>
 
 namespace btcnew
@@ -94,6 +98,8 @@ public:
 	double max_work_generate_multiplier{ 64. };
 	uint64_t max_work_generate_difficulty{ btcnew::network_constants::publish_full_threshold };
 	btcnew::rocksdb_config rocksdb_config;
+	btcnew::traffic_shaping_config traffic_shaping_config;
+	btcnew::threading_config threading_config;
 	btcnew::frontiers_confirmation_mode frontiers_confirmation{ btcnew::frontiers_confirmation_mode::automatic };
 	std::string serialize_frontiers_confirmation (btcnew::frontiers_confirmation_mode) const;
 	btcnew::frontiers_confirmation_mode deserialize_frontiers_confirmation (std::string const &);
@@ -128,10 +134,18 @@ public:
 	bool cache_representative_weights_from_frontiers{ true };
 	/** Whether to read all frontiers and construct the total cemented count */
 	bool cache_cemented_count_from_frontiers{ true };
+	/** Whether to keep the confirmation height of every account in memory, so confirmation checks don't read it from the database */
+	bool cache_confirmation_heights{ false };
 	bool inactive_node{ false };
 	size_t sideband_batch_size{ 512 };
 	size_t block_processor_batch_size{ 0 };
 	size_t block_processor_full_size{ 65536 };
 	size_t block_processor_verification_size{ 0 };
+	/** Threads reading ahead the dependencies of blocks queued for cementing, 0 disables prefetching */
+	unsigned confirmation_height_prefetch_threads{ 0 };
+	/** Blocks without an election whose votes are cached, entries are allocated as votes arrive */
+	size_t inactive_votes_cache_size{ 16 * 1024 };
+	/** Threads verifying and applying queued votes */
+	unsigned vote_processor_threads{ std::min (4u, std::max (1u, std::thread::hardware_concurrency () / 2)) };
 };
 }
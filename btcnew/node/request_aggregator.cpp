@@ -0,0 +1,218 @@
+#include <btcnew/node/node.hpp>
+#include <btcnew/node/request_aggregator.hpp>
+
+#include <unordered_set>
+
+size_t constexpr btcnew::request_aggregator::max_channel_requests;
+
+btcnew::request_aggregator::request_aggregator (btcnew::node & node_a) :
+max_delay (node_a.network_params.network.is_test_network () ? 10 : 50),
+node (node_a),
+thread ([this] () { run (); })
+{
+	btcnew::unique_lock<std::mutex> lock (mutex);
+	condition.wait (lock, [& started = started] { return started; });
+}
+
+bool btcnew::request_aggregator::add (std::shared_ptr<btcnew::transport::channel> const & channel_a, std::vector<std::pair<btcnew::block_hash, btcnew::root>> const & roots_hashes_a)
+{
+	bool error (true);
+	bool notify (false);
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		if (!stopped)
+		{
+			auto & existing (requests[channel_a]);
+			if (existing.size () + roots_hashes_a.size () <= max_channel_requests)
+			{
+				error = false;
+				// The window starts with the first request, later ones are answered with it
+				if (requests_count == 0)
+				{
+					deadline = std::chrono::steady_clock::now () + max_delay;
+					notify = true;
+				}
+				existing.insert (existing.end (), roots_hashes_a.begin (), roots_hashes_a.end ());
+				requests_count += roots_hashes_a.size ();
+			}
+			else if (existing.empty ())
+			{
+				requests.erase (channel_a);
+			}
+		}
+	}
+	if (notify)
+	{
+		condition.notify_all ();
+	}
+	if (error)
+	{
+		node.stats.inc (btcnew::stat::type::requests, btcnew::stat::detail::requests_dropped);
+	}
+	return error;
+}
+
+void btcnew::request_aggregator::stop ()
+{
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		stopped = true;
+	}
+	condition.notify_all ();
+	if (thread.joinable ())
+	{
+		thread.join ();
+	}
+}
+
+size_t btcnew::request_aggregator::size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return requests_count;
+}
+
+void btcnew::request_aggregator::run ()
+{
+	btcnew::thread_role::set (btcnew::thread_role::name::request_aggregator);
+	btcnew::unique_lock<std::mutex> lock (mutex);
+	started = true;
+	lock.unlock ();
+	condition.notify_all ();
+	lock.lock ();
+	while (!stopped)
+	{
+		if (!requests.empty ())
+		{
+			if (std::chrono::steady_clock::now () >= deadline)
+			{
+				requests_t requests_l;
+				requests_l.swap (requests);
+				requests_count = 0;
+				lock.unlock ();
+				process (requests_l);
+				lock.lock ();
+			}
+			else
+			{
+				condition.wait_until (lock, deadline);
+			}
+		}
+		else
+		{
+			condition.wait (lock);
+		}
+	}
+}
+
+void btcnew::request_aggregator::process (requests_t const & requests_a)
+{
+	// Votes for every requested hash, shared by all channels requesting it
+	std::unordered_map<btcnew::block_hash, std::vector<std::shared_ptr<btcnew::vote>>> votes_l;
+	std::unordered_map<std::shared_ptr<btcnew::transport::channel>, std::unordered_set<btcnew::block_hash>> hashes_l;
+	auto transaction (node.store.tx_begin_read ());
+	for (auto & request : requests_a)
+	{
+		auto & channel (request.first);
+		auto & channel_hashes (hashes_l[channel]);
+		for (auto & root_hash : request.second)
+		{
+			auto existing (votes_l.find (root_hash.first));
+			if (existing == votes_l.end () && !root_hash.first.is_zero ())
+			{
+				auto cached (node.votes_cache.find (root_hash.first));
+				if (!cached.empty () || node.store.block_exists (transaction, root_hash.first))
+				{
+					existing = votes_l.emplace (root_hash.first, std::move (cached)).first;
+				}
+			}
+			if (existing != votes_l.end ())
+			{
+				channel_hashes.insert (root_hash.first);
+			}
+			else if (!root_hash.second.is_zero ())
+			{
+				btcnew::block_hash successor (0);
+				// Search for block root
+				successor = node.store.block_successor (transaction, root_hash.second);
+				// Search for account root
+				if (successor.is_zero ())
+				{
+					btcnew::account_info info;
+					auto error (node.store.account_get (transaction, root_hash.second, info));
+					if (!error)
+					{
+						successor = info.open_block;
+					}
+				}
+				if (!successor.is_zero ())
+				{
+					if (votes_l.find (successor) == votes_l.end ())
+					{
+						votes_l.emplace (successor, node.votes_cache.find (successor));
+					}
+					channel_hashes.insert (successor);
+					auto successor_block (node.store.block_get (transaction, successor));
+					assert (successor_block != nullptr);
+					btcnew::publish publish (successor_block);
+					channel->send (publish);
+				}
+			}
+		}
+	}
+	std::vector<btcnew::block_hash> to_generate;
+	for (auto & hash_votes : votes_l)
+	{
+		if (hash_votes.second.empty ())
+		{
+			to_generate.push_back (hash_votes.first);
+		}
+	}
+	node.stats.add (btcnew::stat::type::requests, btcnew::stat::detail::requests_cached_hashes, btcnew::stat::dir::in, votes_l.size () - to_generate.size ());
+	if (!to_generate.empty ())
+	{
+		auto generated (node.block_processor.generator.generate (transaction, to_generate));
+		for (auto & vote : generated)
+		{
+			for (auto hash : *vote)
+			{
+				votes_l[hash].push_back (vote);
+			}
+		}
+		node.stats.add (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_hashes, btcnew::stat::dir::in, to_generate.size ());
+		node.stats.add (btcnew::stat::type::requests, btcnew::stat::detail::requests_generated_votes, btcnew::stat::dir::in, generated.size ());
+	}
+	// A vote covers several hashes, send it once per channel no matter how many of them were requested
+	for (auto & channel_hashes : hashes_l)
+	{
+		std::unordered_set<btcnew::vote const *> sent;
+		for (auto & hash : channel_hashes.second)
+		{
+			for (auto & vote : votes_l[hash])
+			{
+				if (sent.insert (vote.get ()).second)
+				{
+					btcnew::confirm_ack confirm (vote);
+					channel_hashes.first->send (confirm);
+				}
+			}
+		}
+	}
+}
+
+namespace btcnew
+{
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (request_aggregator & request_aggregator, const std::string & name)
+{
+	size_t requests_count = 0;
+	size_t channels_count = 0;
+	{
+		btcnew::lock_guard<std::mutex> guard (request_aggregator.mutex);
+		requests_count = request_aggregator.requests_count;
+		channels_count = request_aggregator.requests.size ();
+	}
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "requests", requests_count, sizeof (std::pair<btcnew::block_hash, btcnew::root>) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "channels", channels_count, sizeof (decltype (request_aggregator.requests)::value_type) }));
+	return composite;
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <btcnew/lib/numbers.hpp>
+#include <btcnew/lib/utility.hpp>
+
+#include <boost/thread/thread.hpp>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace btcnew
+{
+class node;
+namespace transport
+{
+	class channel;
+}
+
+/**
+ * Pools confirm_req roots from all channels over a short window and answers them together.
+ * Each requested hash is looked up in the votes cache once, votes missing from it are generated in full size batches
+ * and every channel is sent the votes covering its own requests.
+ */
+class request_aggregator final
+{
+public:
+	explicit request_aggregator (btcnew::node &);
+	/** Queue \p roots_hashes_a requested by \p channel_a, returns true if the channel has too many pending requests and they were dropped */
+	bool add (std::shared_ptr<btcnew::transport::channel> const & channel_a, std::vector<std::pair<btcnew::block_hash, btcnew::root>> const & roots_hashes_a);
+	void stop ();
+	/** Number of roots waiting to be answered */
+	size_t size ();
+	/** Time a request is pooled for, so requests for the same hashes from other channels can be answered with it */
+	std::chrono::milliseconds const max_delay;
+	/** Roots pooled per channel before further requests from it are dropped */
+	static size_t constexpr max_channel_requests{ 4096 };
+
+private:
+	using requests_t = std::unordered_map<std::shared_ptr<btcnew::transport::channel>, std::vector<std::pair<btcnew::block_hash, btcnew::root>>>;
+	void run ();
+	void process (requests_t const &);
+	btcnew::node & node;
+	requests_t requests;
+	size_t requests_count{ 0 };
+	std::chrono::steady_clock::time_point deadline;
+	std::mutex mutex;
+	btcnew::condition_variable condition;
+	bool started{ false };
+	bool stopped{ false };
+	boost::thread thread;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (request_aggregator &, const std::string &);
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (request_aggregator & request_aggregator, const std::string & name);
+}
@@ -42,7 +42,10 @@ void rocksdb_val::convert_buffer_to_value ()
 
 btcnew::rocksdb_store::rocksdb_store (btcnew::logger_mt & logger_a, boost::filesystem::path const & path_a, btcnew::rocksdb_config const & rocksdb_config_a, bool open_read_only_a) :
 logger (logger_a),
-rocksdb_config (rocksdb_config_a)
+rocksdb_config (rocksdb_config_a),
+read_txn_pool ([this]() {
+	return std::make_unique<btcnew::read_rocksdb_txn> (db);
+})
 {
 	boost::system::error_code error_mkdir, error_chmod;
 	boost::filesystem::create_directories (path_a, error_mkdir);
@@ -63,6 +66,9 @@ rocksdb_config (rocksdb_config_a)
 
 btcnew::rocksdb_store::~rocksdb_store ()
 {
+	// Pooled transactions reference the database
+	read_txn_pool.clear ();
+
 	for (auto handle : handles)
 	{
 		delete handle;
@@ -133,7 +139,21 @@ btcnew::write_transaction btcnew::rocksdb_store::tx_begin_write (std::vector<btc
 
 btcnew::read_transaction btcnew::rocksdb_store::tx_begin_read ()
 {
-	return btcnew::read_transaction{ std::make_unique<btcnew::read_rocksdb_txn> (db) };
+	return read_txn_pool.tx_begin_read ();
+}
+
+void btcnew::rocksdb_store::serialize_txn_totals (boost::property_tree::ptree & json)
+{
+	json.put ("read_pool_created", read_txn_pool.created.load ());
+	json.put ("read_pool_renewed", read_txn_pool.renewed.load ());
+	json.put ("read_pool_discarded", read_txn_pool.discarded.load ());
+}
+
+std::unique_ptr<btcnew::seq_con_info_component> btcnew::rocksdb_store::collect_seq_con_info (const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (btcnew::collect_seq_con_info (read_txn_pool, "read_txn_pool"));
+	return composite;
 }
 
 rocksdb::ColumnFamilyHandle * btcnew::rocksdb_store::table_to_column_family (tables table_a) const
@@ -44,6 +44,9 @@ public:
 		// Do nothing
 	}
 
+	void serialize_txn_totals (boost::property_tree::ptree &) override;
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (const std::string & name) override;
+
 	std::shared_ptr<btcnew::block> block_get_v14 (btcnew::transaction const &, btcnew::block_hash const &, btcnew::block_sideband_v14 * = nullptr, bool * = nullptr) const override
 	{
 		// Should not be called as RocksDB has no such upgrade path
@@ -99,5 +102,6 @@ private:
 	rocksdb::Options get_db_options () const;
 	rocksdb::BlockBasedTableOptions get_table_options () const;
 	btcnew::rocksdb_config rocksdb_config;
+	btcnew::read_transaction_pool read_txn_pool;
 };
 }
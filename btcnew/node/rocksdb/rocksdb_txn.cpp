@@ -13,7 +13,12 @@ btcnew::read_rocksdb_txn::~read_rocksdb_txn ()
 
 void btcnew::read_rocksdb_txn::reset ()
 {
-	db->ReleaseSnapshot (options.snapshot);
+	// Pooled transactions are destroyed after being reset, so only release the snapshot once
+	if (options.snapshot != nullptr)
+	{
+		db->ReleaseSnapshot (options.snapshot);
+		options.snapshot = nullptr;
+	}
 }
 
 void btcnew::read_rocksdb_txn::renew ()
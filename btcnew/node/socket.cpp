@@ -1,11 +1,19 @@
 #include <btcnew/node/node.hpp>
 #include <btcnew/node/socket.hpp>
 
+#include <algorithm>
 #include <limits>
 
 btcnew::socket::socket (std::shared_ptr<btcnew::node> node_a, boost::optional<std::chrono::seconds> io_timeout_a, btcnew::socket::concurrency concurrency_a) :
-strand (node_a->io_ctx.get_executor ()),
-tcp_socket (node_a->io_ctx),
+socket (node_a, node_a->io_shards.assign (), io_timeout_a, concurrency_a)
+{
+}
+
+btcnew::socket::socket (std::shared_ptr<btcnew::node> node_a, size_t io_shard_a, boost::optional<std::chrono::seconds> io_timeout_a, btcnew::socket::concurrency concurrency_a) :
+io_shard (io_shard_a),
+shard_io_ctx (node_a->io_shards.owned_io_ctx (io_shard)),
+strand (node_a->io_shards.io_ctx (io_shard).get_executor ()),
+tcp_socket (node_a->io_shards.io_ctx (io_shard)),
 node (node_a),
 writer_concurrency (concurrency_a),
 next_deadline (std::numeric_limits<uint64_t>::max ()),
@@ -21,6 +29,10 @@ io_timeout (io_timeout_a)
 btcnew::socket::~socket ()
 {
 	close_internal ();
+	if (auto node_l = node.lock ())
+	{
+		node_l->io_shards.release (io_shard);
+	}
 }
 
 void btcnew::socket::async_connect (btcnew::tcp_endpoint const & endpoint_a, std::function<void (boost::system::error_code const &)> callback_a)
@@ -59,27 +71,50 @@ void btcnew::socket::async_read (std::shared_ptr<std::vector<uint8_t>> buffer_a,
 	}
 }
 
-void btcnew::socket::async_write (btcnew::shared_const_buffer const & buffer_a, std::function<void (boost::system::error_code const &, size_t)> callback_a)
+void btcnew::socket::async_write (btcnew::shared_const_buffer const & buffer_a, std::function<void (boost::system::error_code const &, size_t)> callback_a, bool const droppable_a)
 {
 	auto this_l (shared_from_this ());
 	if (!closed)
 	{
 		if (writer_concurrency == btcnew::socket::concurrency::multi_writer)
 		{
-			boost::asio::post (strand, boost::asio::bind_executor (strand, [buffer_a, callback_a, this_l] () {
-				bool write_in_progress = !this_l->send_queue.empty ();
-				auto queue_size = this_l->send_queue.size ();
-				if (queue_size < this_l->queue_size_max)
-				{
-					this_l->send_queue.emplace_back (btcnew::socket::queue_item{ buffer_a, callback_a });
-				}
-				else if (auto node_l = this_l->node.lock ())
-				{
-					node_l->stats.inc (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_drop, btcnew::stat::dir::out);
-				}
-				if (!write_in_progress)
+			boost::asio::post (strand, boost::asio::bind_executor (strand, [buffer_a, callback_a, droppable_a, this_l] () {
+				// Writes posted before the socket closed are discarded with the rest of the queue
+				if (!this_l->closed)
 				{
-					this_l->write_queued_messages ();
+					if (!droppable_a)
+					{
+						if (this_l->priority_count < this_l->priority_queue_size_max)
+						{
+							// Non droppable messages go after earlier non droppable ones, ahead of all droppable ones
+							this_l->send_queue.emplace (this_l->send_queue.begin () + this_l->priority_count, btcnew::socket::queue_item{ buffer_a, callback_a, droppable_a });
+							++this_l->priority_count;
+						}
+						else
+						{
+							if (auto node_l = this_l->node.lock ())
+							{
+								node_l->stats.inc (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_overflow, btcnew::stat::dir::out);
+							}
+							this_l->close_internal ();
+							if (callback_a)
+							{
+								callback_a (boost::system::errc::make_error_code (boost::system::errc::no_buffer_space), 0);
+							}
+						}
+					}
+					else if (this_l->send_queue.size () < this_l->queue_size_max)
+					{
+						this_l->send_queue.emplace_back (btcnew::socket::queue_item{ buffer_a, callback_a, droppable_a });
+					}
+					else if (auto node_l = this_l->node.lock ())
+					{
+						node_l->stats.inc (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_drop, btcnew::stat::dir::out);
+					}
+					if (!this_l->write_in_progress && !this_l->send_queue.empty ())
+					{
+						this_l->write_queued_messages ();
+					}
 				}
 			}));
 		}
@@ -107,12 +142,37 @@ void btcnew::socket::write_queued_messages ()
 {
 	if (!closed)
 	{
+		assert (!write_in_progress && !send_queue.empty ());
+		auto queue_depth (send_queue.size ());
+		// Take messages from the front of the queue while they fit, always taking at least one
+		auto batch (std::make_shared<std::vector<queue_item>> ());
+		size_t batch_bytes (0);
+		std::vector<boost::asio::const_buffer> buffers;
+		while (!send_queue.empty () && (batch->empty () || batch_bytes + send_queue.front ().buffer.size () <= write_batch_bytes_max))
+		{
+			auto & item (send_queue.front ());
+			if (!item.droppable)
+			{
+				assert (priority_count > 0);
+				--priority_count;
+			}
+			batch_bytes += item.buffer.size ();
+			buffers.insert (buffers.end (), item.buffer.begin (), item.buffer.end ());
+			batch->push_back (std::move (item));
+			send_queue.pop_front ();
+		}
+		if (auto node_l = node.lock ())
+		{
+			node_l->stats.update_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_queue_depth, btcnew::stat::dir::out, queue_depth);
+			node_l->stats.update_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_messages, btcnew::stat::dir::out, batch->size ());
+			node_l->stats.update_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_bytes, btcnew::stat::dir::out, batch_bytes);
+		}
 		std::weak_ptr<btcnew::socket> this_w (shared_from_this ());
-		auto msg (send_queue.front ());
+		write_in_progress = true;
 		start_timer ();
-		btcnew::async_write (tcp_socket, msg.buffer,
+		boost::asio::async_write (tcp_socket, buffers,
 		boost::asio::bind_executor (strand,
-		[msg, this_w] (boost::system::error_code ec, std::size_t size_a) {
+		[batch, this_w] (boost::system::error_code ec, std::size_t size_a) {
 			if (auto this_l = this_w.lock ())
 			{
 				if (auto node = this_l->node.lock ())
@@ -120,15 +180,22 @@ void btcnew::socket::write_queued_messages ()
 					node->stats.add (btcnew::stat::type::traffic_tcp, btcnew::stat::dir::out, size_a);
 
 					this_l->stop_timer ();
+					this_l->write_in_progress = false;
 
 					if (!this_l->closed)
 					{
-						if (msg.callback)
+						// Each message is told how much of it was written
+						auto remaining (size_a);
+						for (auto & item : *batch)
 						{
-							msg.callback (ec, size_a);
+							auto written (std::min (remaining, item.buffer.size ()));
+							remaining -= written;
+							if (item.callback)
+							{
+								item.callback (ec, written);
+							}
 						}
 
-						this_l->send_queue.pop_front ();
 						if (!ec && !this_l->send_queue.empty ())
 						{
 							this_l->write_queued_messages ();
@@ -232,6 +299,7 @@ void btcnew::socket::close_internal ()
 		tcp_socket.shutdown (boost::asio::ip::tcp::socket::shutdown_both, ec);
 		tcp_socket.close (ec);
 		send_queue.clear ();
+		priority_count = 0;
 		if (ec)
 		{
 			if (auto node_l = node.lock ())
@@ -254,7 +322,7 @@ void btcnew::socket::set_writer_concurrency (concurrency writer_concurrency_a)
 }
 
 btcnew::server_socket::server_socket (std::shared_ptr<btcnew::node> node_a, boost::asio::ip::tcp::endpoint local_a, size_t max_connections_a, btcnew::socket::concurrency concurrency_a) :
-socket (node_a, std::chrono::seconds::max (), concurrency_a), acceptor (node_a->io_ctx), local (local_a), deferred_accept_timer (node_a->io_ctx), max_inbound_connections (max_connections_a), concurrency_new_connections (concurrency_a)
+socket (node_a, btcnew::io_shards::none, std::chrono::seconds::max (), concurrency_a), acceptor (node_a->io_ctx), local (local_a), deferred_accept_timer (node_a->io_ctx), max_inbound_connections (max_connections_a), concurrency_new_connections (concurrency_a)
 {
 }
 
@@ -45,7 +45,12 @@ public:
 	virtual ~socket ();
 	void async_connect (boost::asio::ip::tcp::endpoint const &, std::function<void (boost::system::error_code const &)>);
 	void async_read (std::shared_ptr<std::vector<uint8_t>>, size_t, std::function<void (boost::system::error_code const &, size_t)>);
-	void async_write (btcnew::shared_const_buffer const &, std::function<void (boost::system::error_code const &, size_t)> = nullptr);
+	/**
+	 * With multi_writer, queued messages are coalesced into a single write of up to write_batch_bytes_max.
+	 * Non droppable messages are written ahead of droppable ones and are queued even if the queue is full, up to
+	 * priority_queue_size_max. Beyond that the socket is closed and the callback is called with an error.
+	 */
+	void async_write (btcnew::shared_const_buffer const &, std::function<void (boost::system::error_code const &, size_t)> = nullptr, bool const droppable_a = true);
 
 	void close ();
 	boost::asio::ip::tcp::endpoint remote_endpoint () const;
@@ -58,22 +63,32 @@ public:
 	void set_writer_concurrency (concurrency writer_concurrency_a);
 
 protected:
+	/** Runs the handlers of the socket on io shard \p io_shard_a, btcnew::io_shards::none for the shared io_context */
+	socket (std::shared_ptr<btcnew::node> node, size_t io_shard_a, boost::optional<std::chrono::seconds> io_timeout, concurrency);
 	/** Holds the buffer and callback for queued writes */
 	class queue_item
 	{
 	public:
 		btcnew::shared_const_buffer buffer;
 		std::function<void (boost::system::error_code const &, size_t)> callback;
+		bool droppable;
 	};
 
+	/** Index of the io shard running the handlers of this socket */
+	size_t const io_shard;
+	/** Keeps the io_context of the shard alive until tcp_socket is destroyed */
+	std::shared_ptr<boost::asio::io_context> shard_io_ctx;
 	boost::asio::strand<boost::asio::io_context::executor_type> strand;
 	boost::asio::ip::tcp::socket tcp_socket;
 	std::weak_ptr<btcnew::node> node;
 
 	/** The other end of the connection */
 	boost::asio::ip::tcp::endpoint remote;
-	/** Send queue, protected by always being accessed in the strand */
+	/** Send queue, protected by always being accessed in the strand. The first priority_count items are non droppable */
 	std::deque<queue_item> send_queue;
+	size_t priority_count{ 0 };
+	/** Set while a write from the send queue is in progress, protected by always being accessed in the strand */
+	bool write_in_progress{ false };
 	std::atomic<concurrency> writer_concurrency;
 
 	std::atomic<uint64_t> next_deadline;
@@ -81,6 +96,9 @@ protected:
 	std::atomic<bool> timed_out{ false };
 	boost::optional<std::chrono::seconds> io_timeout;
 	size_t const queue_size_max = 128;
+	/** Non droppable messages queued at most, a peer not reading them makes the socket close rather than grow the queue */
+	size_t const priority_queue_size_max = 1024;
+	size_t const write_batch_bytes_max = 64 * 1024;
 
 	/** Set by close() - completion handlers must check this. This is more reliable than checking
 	 error codes as the OS may have already completed the async operation. */
@@ -25,8 +25,17 @@ std::string btcnew::error_system_messages::message (int ev) const
 /** Returns the node added. */
 std::shared_ptr<btcnew::node> btcnew::system::add_node (btcnew::node_config const & node_config_a, btcnew::node_flags node_flags_a, btcnew::transport::transport_type type_a)
 {
+	if (simulated != nullptr)
+	{
+		node_flags_a.disable_tcp_realtime = true;
+		type_a = btcnew::transport::transport_type::udp;
+	}
 	auto node (std::make_shared<btcnew::node> (io_ctx, btcnew::unique_path (), alarm, node_config_a, work, node_flags_a));
 	assert (!node->init_error ());
+	if (simulated != nullptr)
+	{
+		simulated->attach (node);
+	}
 	node->start ();
 	node->wallets.create (btcnew::random_wallet_id ());
 	nodes.reserve (nodes.size () + 1);
@@ -116,6 +125,18 @@ system ()
 	}
 }
 
+btcnew::system::system (uint16_t port_a, uint16_t count_a, btcnew::transport::simulation_config const & config_a) :
+system ()
+{
+	simulated = std::make_shared<btcnew::transport::simulated_network> (alarm, config_a);
+	nodes.reserve (count_a);
+	for (uint16_t i (0); i < count_a; ++i)
+	{
+		btcnew::node_config config (port_a + i, logging);
+		add_node (config);
+	}
+}
+
 btcnew::system::~system ()
 {
 	for (auto & i : nodes)
@@ -3,6 +3,7 @@
 #include <btcnew/lib/errors.hpp>
 #include <btcnew/lib/utility.hpp>
 #include <btcnew/node/node.hpp>
+#include <btcnew/node/transport/simulated.hpp>
 
 #include <chrono>
 
@@ -19,6 +20,8 @@ class system final
 public:
 	system ();
 	system (uint16_t, uint16_t, btcnew::transport::transport_type = btcnew::transport::transport_type::tcp);
+	/** Nodes exchange realtime messages through an in-process btcnew::transport::simulated_network instead of sockets */
+	system (uint16_t, uint16_t, btcnew::transport::simulation_config const &);
 	~system ();
 	void generate_activity (btcnew::node &, std::vector<btcnew::account> &);
 	void generate_mass_activity (uint32_t, btcnew::node &);
@@ -45,6 +48,8 @@ public:
 	boost::asio::io_context io_ctx;
 	btcnew::alarm alarm{ io_ctx };
 	std::vector<std::shared_ptr<btcnew::node>> nodes;
+	/** Set to attach nodes added afterwards to an in-process network, their realtime traffic then only uses UDP channels */
+	std::shared_ptr<btcnew::transport::simulated_network> simulated;
 	btcnew::logging logging;
 	btcnew::work_pool work{ 1 };
 	std::chrono::time_point<std::chrono::steady_clock, std::chrono::duration<double>> deadline{ std::chrono::steady_clock::time_point::max () };
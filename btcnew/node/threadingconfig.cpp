@@ -0,0 +1,130 @@
+#include <btcnew/lib/tomlconfig.hpp>
+#include <btcnew/lib/utility.hpp>
+#include <btcnew/node/threadingconfig.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+
+namespace
+{
+void get_cpus (btcnew::tomlconfig & toml_a, std::string const & key_a, std::vector<unsigned> & cpus_a)
+{
+	std::string text (btcnew::threading_config::cpus_to_string (cpus_a));
+	toml_a.get_optional<std::string> (key_a, text);
+	if (btcnew::threading_config::parse_cpus (text, cpus_a))
+	{
+		toml_a.get_error ().set ("invalid CPU list for " + key_a + ": " + text);
+	}
+}
+}
+
+btcnew::error btcnew::threading_config::serialize_toml (btcnew::tomlconfig & toml) const
+{
+	toml.put ("io_shards", io_shards, "Number of additional I/O contexts, each run by its own thread, that TCP connections are spread over so the work of a connection stays on one core. 0 keeps every connection on the shared I/O threads.\ntype:uint32");
+	toml.put ("io_shard_cpus", cpus_to_string (io_shard_cpus), "CPUs the I/O shard threads are pinned to, one CPU per shard in turn. For example \"0-3,8\". Empty leaves them unpinned.\ntype:string");
+	toml.put ("io_cpus", cpus_to_string (io_cpus), "CPUs the shared I/O threads are pinned to. Empty leaves them unpinned.\ntype:string");
+	toml.put ("packet_processing_cpus", cpus_to_string (packet_processing_cpus), "CPUs the network packet processing threads are pinned to. Empty leaves them unpinned.\ntype:string");
+	toml.put ("block_processing_cpus", cpus_to_string (block_processing_cpus), "CPUs the block processor thread is pinned to. Empty leaves it unpinned.\ntype:string");
+	toml.put ("vote_processing_cpus", cpus_to_string (vote_processing_cpus), "CPUs the vote processing threads are pinned to. Empty leaves them unpinned.\ntype:string");
+	toml.put ("signature_checking_cpus", cpus_to_string (signature_checking_cpus), "CPUs the signature checking threads are pinned to. Empty leaves them unpinned.\ntype:string");
+	toml.put ("voting_cpus", cpus_to_string (voting_cpus), "CPUs the vote generator thread is pinned to. Empty leaves it unpinned.\ntype:string");
+	toml.put ("request_aggregator_cpus", cpus_to_string (request_aggregator_cpus), "CPUs the request aggregator threads are pinned to. Empty leaves them unpinned.\ntype:string");
+	toml.put ("confirmation_height_cpus", cpus_to_string (confirmation_height_cpus), "CPUs the confirmation height processor thread is pinned to. Empty leaves it unpinned.\ntype:string");
+	toml.put ("work_cpus", cpus_to_string (work_cpus), "CPUs the local work generation threads are pinned to. Empty leaves them unpinned.\ntype:string");
+	return toml.get_error ();
+}
+
+btcnew::error btcnew::threading_config::deserialize_toml (btcnew::tomlconfig & toml)
+{
+	toml.get_optional<unsigned> ("io_shards", io_shards);
+	get_cpus (toml, "io_shard_cpus", io_shard_cpus);
+	get_cpus (toml, "io_cpus", io_cpus);
+	get_cpus (toml, "packet_processing_cpus", packet_processing_cpus);
+	get_cpus (toml, "block_processing_cpus", block_processing_cpus);
+	get_cpus (toml, "vote_processing_cpus", vote_processing_cpus);
+	get_cpus (toml, "signature_checking_cpus", signature_checking_cpus);
+	get_cpus (toml, "voting_cpus", voting_cpus);
+	get_cpus (toml, "request_aggregator_cpus", request_aggregator_cpus);
+	get_cpus (toml, "confirmation_height_cpus", confirmation_height_cpus);
+	get_cpus (toml, "work_cpus", work_cpus);
+	return toml.get_error ();
+}
+
+void btcnew::threading_config::apply_affinity () const
+{
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::io, io_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::packet_processing, packet_processing_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::block_processing, block_processing_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::vote_processing, vote_processing_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::signature_checking, signature_checking_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::voting, voting_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::request_aggregator, request_aggregator_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::confirmation_height_processing, confirmation_height_cpus);
+	btcnew::thread_role::set_affinity (btcnew::thread_role::name::work, work_cpus);
+}
+
+bool btcnew::threading_config::parse_cpus (std::string const & text_a, std::vector<unsigned> & cpus_a)
+{
+	auto error (false);
+	std::vector<unsigned> result;
+	std::vector<std::string> ranges;
+	auto text_l (boost::algorithm::trim_copy (text_a));
+	if (!text_l.empty ())
+	{
+		boost::split (ranges, text_l, boost::is_any_of (","));
+	}
+	for (auto i (ranges.begin ()), n (ranges.end ()); i != n && !error; ++i)
+	{
+		std::vector<std::string> bounds;
+		boost::split (bounds, *i, boost::is_any_of ("-"));
+		try
+		{
+			auto first (boost::lexical_cast<unsigned> (boost::algorithm::trim_copy (bounds.front ())));
+			auto last (boost::lexical_cast<unsigned> (boost::algorithm::trim_copy (bounds.back ())));
+			// Bound ranges so a typo can't allocate without limit
+			error = bounds.size () > 2 || first > last || last >= 4096;
+			for (auto cpu (first); !error && cpu <= last; ++cpu)
+			{
+				result.push_back (cpu);
+			}
+		}
+		catch (boost::bad_lexical_cast const &)
+		{
+			error = true;
+		}
+	}
+	if (!error)
+	{
+		std::sort (result.begin (), result.end ());
+		result.erase (std::unique (result.begin (), result.end ()), result.end ());
+		cpus_a = result;
+	}
+	return error;
+}
+
+std::string btcnew::threading_config::cpus_to_string (std::vector<unsigned> const & cpus_a)
+{
+	std::string result;
+	for (auto i (cpus_a.begin ()), n (cpus_a.end ()); i != n;)
+	{
+		// Collapse consecutive CPUs into a range
+		auto last (i);
+		while (std::next (last) != n && *std::next (last) == *last + 1)
+		{
+			++last;
+		}
+		if (!result.empty ())
+		{
+			result += ",";
+		}
+		result += std::to_string (*i);
+		if (last != i)
+		{
+			result += "-" + std::to_string (*last);
+		}
+		i = std::next (last);
+	}
+	return result;
+}
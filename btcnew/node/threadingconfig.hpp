@@ -0,0 +1,35 @@
+#pragma once
+
+#include <btcnew/lib/errors.hpp>
+
+#include <string>
+#include <vector>
+
+namespace btcnew
+{
+class tomlconfig;
+
+/** Configuration options for io_context sharding and pinning threads to CPUs */
+class threading_config final
+{
+public:
+	btcnew::error serialize_toml (btcnew::tomlconfig & toml_a) const;
+	btcnew::error deserialize_toml (btcnew::tomlconfig & toml_a);
+	/** Pin threads of every configured role to their CPUs when they start, must be called before the node is created */
+	void apply_affinity () const;
+	/** Parse a list of CPUs such as "0-3,8", returns true on error */
+	static bool parse_cpus (std::string const & text_a, std::vector<unsigned> & cpus_a);
+	static std::string cpus_to_string (std::vector<unsigned> const & cpus_a);
+	unsigned io_shards{ 0 };
+	std::vector<unsigned> io_shard_cpus;
+	std::vector<unsigned> io_cpus;
+	std::vector<unsigned> packet_processing_cpus;
+	std::vector<unsigned> block_processing_cpus;
+	std::vector<unsigned> vote_processing_cpus;
+	std::vector<unsigned> signature_checking_cpus;
+	std::vector<unsigned> voting_cpus;
+	std::vector<unsigned> request_aggregator_cpus;
+	std::vector<unsigned> confirmation_height_cpus;
+	std::vector<unsigned> work_cpus;
+};
+}
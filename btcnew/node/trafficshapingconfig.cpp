@@ -0,0 +1,49 @@
+#include <btcnew/lib/tomlconfig.hpp>
+#include <btcnew/node/trafficshapingconfig.hpp>
+
+btcnew::error btcnew::traffic_shaping_config::serialize_toml (btcnew::tomlconfig & toml) const
+{
+	toml.put ("enable", enable, "Whether to limit realtime network traffic per message class and per peer.\ntype:bool");
+	toml.put ("inbound_limit", inbound_limit, "Inbound realtime traffic in bytes/sec shared by all message classes, set to 0 for unbounded.\ntype:uint64");
+	toml.put ("outbound_limit", outbound_limit, "Outbound droppable realtime traffic and bootstrap serving in bytes/sec shared by all message classes, set to 0 for unbounded.\ntype:uint64");
+	toml.put ("peer_inbound_limit", peer_inbound_limit, "Inbound realtime traffic in bytes/sec accepted from a single peer, set to 0 for unbounded.\ntype:uint64");
+	toml.put ("vote_weight", vote_weight, "Share of the limits guaranteed to confirm_ack and confirm_req messages, relative to the other weights.\ntype:uint32");
+	toml.put ("publish_weight", publish_weight, "Share of the limits guaranteed to publish messages, relative to the other weights.\ntype:uint32");
+	toml.put ("keepalive_weight", keepalive_weight, "Share of the limits guaranteed to keepalive messages, relative to the other weights.\ntype:uint32");
+	toml.put ("bootstrap_weight", bootstrap_weight, "Share of the limits guaranteed to bootstrap requests and serving, relative to the other weights.\ntype:uint32");
+	toml.put ("ip_message_limit", ip_message_limit, "Inbound realtime messages/sec accepted from a single IP address before they are parsed, over UDP and TCP channels without a completed handshake. Exceeding it drops messages without a penalty. Set to 0 for unbounded.\ntype:uint64");
+	toml.put ("node_id_message_limit", node_id_message_limit, "Inbound realtime messages/sec accepted from a single node ID across all of its TCP channels, set to 0 for unbounded.\ntype:uint64");
+	toml.put ("penalty_close_score", penalty_close_score, "Penalty score at which the channels of an IP address are closed. Exceeding a message limit adds 1 at most once per second, insufficient work adds 2 and an invalid vote signature adds 5. Set to 0 to never close.\ntype:uint64");
+	toml.put ("penalty_exclude_score", penalty_exclude_score, "Penalty score at which all traffic from an IP address is dropped and no channel to it is established for penalty_exclude_time, doubling with every further exclusion. Set to 0 to never exclude.\ntype:uint64");
+	toml.put ("penalty_exclude_time", penalty_exclude_time.count (), "Number of seconds a penalized IP address is first excluded for.\ntype:seconds");
+	return toml.get_error ();
+}
+
+btcnew::error btcnew::traffic_shaping_config::deserialize_toml (btcnew::tomlconfig & toml)
+{
+	toml.get_optional<bool> ("enable", enable);
+	toml.get_optional<size_t> ("inbound_limit", inbound_limit);
+	toml.get_optional<size_t> ("outbound_limit", outbound_limit);
+	toml.get_optional<size_t> ("peer_inbound_limit", peer_inbound_limit);
+	toml.get_optional<unsigned> ("vote_weight", vote_weight);
+	toml.get_optional<unsigned> ("publish_weight", publish_weight);
+	toml.get_optional<unsigned> ("keepalive_weight", keepalive_weight);
+	toml.get_optional<unsigned> ("bootstrap_weight", bootstrap_weight);
+	toml.get_optional<size_t> ("ip_message_limit", ip_message_limit);
+	toml.get_optional<size_t> ("node_id_message_limit", node_id_message_limit);
+	toml.get_optional<uint64_t> ("penalty_close_score", penalty_close_score);
+	toml.get_optional<uint64_t> ("penalty_exclude_score", penalty_exclude_score);
+	auto penalty_exclude_time_l = static_cast<unsigned long> (penalty_exclude_time.count ());
+	toml.get_optional<unsigned long> ("penalty_exclude_time", penalty_exclude_time_l);
+	penalty_exclude_time = std::chrono::seconds (penalty_exclude_time_l);
+
+	if (vote_weight == 0 || publish_weight == 0 || keepalive_weight == 0 || bootstrap_weight == 0)
+	{
+		toml.get_error ().set ("traffic shaping weights must be non-zero");
+	}
+	if (penalty_exclude_time < std::chrono::seconds (1))
+	{
+		toml.get_error ().set ("penalty_exclude_time must be at least 1 second");
+	}
+	return toml.get_error ();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <btcnew/lib/config.hpp>
+#include <btcnew/lib/errors.hpp>
+
+#include <chrono>
+
+namespace btcnew
+{
+class tomlconfig;
+
+/** Configuration options for shaping realtime network traffic by message class and peer, and for penalizing peers exceeding their limits */
+class traffic_shaping_config final
+{
+public:
+	btcnew::error serialize_toml (btcnew::tomlconfig & toml_a) const;
+	btcnew::error deserialize_toml (btcnew::tomlconfig & toml_a);
+	btcnew::network_constants network_constants;
+	bool enable{ !network_constants.is_test_network () };
+	size_t inbound_limit{ 32 * 1024 * 1024 }; // bytes/sec
+	size_t outbound_limit{ 32 * 1024 * 1024 }; // bytes/sec
+	size_t peer_inbound_limit{ 2 * 1024 * 1024 }; // bytes/sec
+	unsigned vote_weight{ 8 };
+	unsigned publish_weight{ 4 };
+	unsigned keepalive_weight{ 1 };
+	unsigned bootstrap_weight{ 1 };
+	size_t ip_message_limit{ 2000 }; // messages/sec
+	size_t node_id_message_limit{ 1000 }; // messages/sec
+	uint64_t penalty_close_score{ 10 };
+	uint64_t penalty_exclude_score{ 20 };
+	std::chrono::seconds penalty_exclude_time{ std::chrono::seconds (10 * 60) };
+};
+}
@@ -0,0 +1,293 @@
+#include <btcnew/node/node.hpp>
+#include <btcnew/node/transport/peer_limiter.hpp>
+
+#include <algorithm>
+
+size_t constexpr btcnew::transport::peer_limiter::max_entries;
+
+namespace
+{
+template <typename Key>
+btcnew::token_bucket * bucket (std::unordered_map<Key, btcnew::token_bucket> & buckets_a, Key const & key_a, size_t limit_a)
+{
+	btcnew::token_bucket * result (nullptr);
+	if (limit_a != 0)
+	{
+		auto existing (buckets_a.find (key_a));
+		if (existing != buckets_a.end ())
+		{
+			result = &existing->second;
+		}
+		else if (buckets_a.size () < btcnew::transport::peer_limiter::max_entries)
+		{
+			result = &buckets_a.emplace (key_a, btcnew::token_bucket (limit_a)).first->second;
+		}
+	}
+	return result;
+}
+
+template <typename Key>
+void purge_buckets (std::unordered_map<Key, btcnew::token_bucket> & buckets_a, std::chrono::steady_clock::time_point const & cutoff_a)
+{
+	for (auto i (buckets_a.begin ()), n (buckets_a.end ()); i != n;)
+	{
+		if (i->second.last_refill < cutoff_a)
+		{
+			i = buckets_a.erase (i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+}
+
+btcnew::transport::peer_limiter::peer_limiter (btcnew::node & node_a) :
+enable (node_a.config.traffic_shaping_config.enable),
+node (node_a),
+ip_message_limit (node_a.config.traffic_shaping_config.ip_message_limit),
+node_id_message_limit (node_a.config.traffic_shaping_config.node_id_message_limit),
+penalty_close_score (node_a.config.traffic_shaping_config.penalty_close_score),
+penalty_exclude_score (node_a.config.traffic_shaping_config.penalty_exclude_score),
+penalty_exclude_time (node_a.config.traffic_shaping_config.penalty_exclude_time)
+{
+}
+
+bool btcnew::transport::peer_limiter::should_drop (btcnew::endpoint const & endpoint_a, btcnew::account const & node_id_a, btcnew::transport::transport_type type_a)
+{
+	auto result (false);
+	if (enable)
+	{
+		auto now (std::chrono::steady_clock::now ());
+		auto address (endpoint_a.address ());
+		auto exceeded (false);
+		{
+			btcnew::lock_guard<std::mutex> lock (mutex);
+			auto existing (penalties.find (address));
+			if (existing != penalties.end () && existing->second.exclude_until > now)
+			{
+				result = true;
+				node.stats.inc (btcnew::stat::type::peer_limiter, btcnew::stat::detail::excluded_address, btcnew::stat::dir::in);
+			}
+			else
+			{
+				// The sender of a TCP message is proven by the connection, a UDP channel's node ID says nothing about who sent a datagram
+				if (type_a == btcnew::transport::transport_type::tcp && !node_id_a.is_zero ())
+				{
+					auto node_id_bucket (bucket (node_id_buckets, node_id_a, node_id_message_limit));
+					if (node_id_bucket != nullptr && !node_id_bucket->available (1, now))
+					{
+						exceeded = true;
+						result = true;
+						node.stats.inc (btcnew::stat::type::peer_limiter, btcnew::stat::detail::node_id_bucket, btcnew::stat::dir::in);
+					}
+					else if (node_id_bucket != nullptr)
+					{
+						node_id_bucket->consume (1);
+					}
+				}
+				else
+				{
+					auto ip_bucket (bucket (ip_buckets, address, ip_message_limit));
+					if (ip_bucket != nullptr && !ip_bucket->available (1, now))
+					{
+						result = true;
+						node.stats.inc (btcnew::stat::type::peer_limiter, btcnew::stat::detail::ip_bucket, btcnew::stat::dir::in);
+					}
+					else if (ip_bucket != nullptr)
+					{
+						ip_bucket->consume (1);
+					}
+				}
+			}
+		}
+		if (exceeded)
+		{
+			penalize (endpoint_a, type_a, btcnew::transport::penalty_reason::rate_limit);
+		}
+	}
+	return result;
+}
+
+void btcnew::transport::peer_limiter::penalize (btcnew::endpoint const & endpoint_a, btcnew::transport::transport_type type_a, btcnew::transport::penalty_reason reason_a)
+{
+	// Anyone can send datagrams with the address of another peer, so they are only ever dropped
+	if (enable && type_a == btcnew::transport::transport_type::tcp)
+	{
+		auto now (std::chrono::steady_clock::now ());
+		auto address (endpoint_a.address ());
+		auto close (false);
+		auto exclude (false);
+		{
+			btcnew::lock_guard<std::mutex> lock (mutex);
+			auto existing (penalties.find (address));
+			if (existing == penalties.end () && penalties.size () < max_entries)
+			{
+				existing = penalties.emplace (address, penalty ()).first;
+			}
+			// Messages already queued when the address got excluded don't extend the exclusion
+			if (existing != penalties.end () && existing->second.exclude_until <= now)
+			{
+				auto & penalty_l (existing->second);
+				if (reason_a != btcnew::transport::penalty_reason::rate_limit || now - penalty_l.last_rate_penalty >= std::chrono::seconds (1))
+				{
+					if (reason_a == btcnew::transport::penalty_reason::rate_limit)
+					{
+						penalty_l.last_rate_penalty = now;
+					}
+					penalty_l.last_violation = now;
+					auto previous (penalty_l.score);
+					penalty_l.score += weight (reason_a);
+					if (penalty_exclude_score != 0 && penalty_l.score >= penalty_exclude_score)
+					{
+						penalty_l.exclude_until = now + exclude_duration (penalty_l.exclusions);
+						++penalty_l.exclusions;
+						penalty_l.score = 0;
+						exclude = true;
+					}
+					else if (penalty_close_score != 0 && previous < penalty_close_score && penalty_l.score >= penalty_close_score)
+					{
+						close = true;
+					}
+				}
+			}
+		}
+		if (exclude)
+		{
+			node.stats.inc (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_exclude);
+			if (node.config.logging.network_logging ())
+			{
+				node.logger.try_log (boost::str (boost::format ("Excluding %1% for exceeding the penalty score") % address.to_string ()));
+			}
+			close_channels (address);
+		}
+		else if (close)
+		{
+			node.stats.inc (btcnew::stat::type::peer_limiter, btcnew::stat::detail::penalty_close);
+			close_channels (address);
+		}
+	}
+}
+
+bool btcnew::transport::peer_limiter::excluded (boost::asio::ip::address const & address_a)
+{
+	auto result (false);
+	if (enable)
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		auto existing (penalties.find (address_a));
+		result = existing != penalties.end () && existing->second.exclude_until > std::chrono::steady_clock::now ();
+	}
+	return result;
+}
+
+void btcnew::transport::peer_limiter::purge (std::chrono::steady_clock::time_point const & cutoff_a)
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	purge_buckets (ip_buckets, cutoff_a);
+	purge_buckets (node_id_buckets, cutoff_a);
+	for (auto i (penalties.begin ()), n (penalties.end ()); i != n;)
+	{
+		auto & penalty_l (i->second);
+		// Exclusions are remembered for as long as the next one would last so repeated offences escalate
+		auto keep_until (penalty_l.last_violation);
+		if (penalty_l.exclusions > 0)
+		{
+			keep_until = std::max (keep_until, penalty_l.exclude_until + exclude_duration (penalty_l.exclusions));
+		}
+		if (keep_until < cutoff_a)
+		{
+			i = penalties.erase (i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+std::vector<std::pair<boost::asio::ip::address, btcnew::transport::peer_limiter::penalty>> btcnew::transport::peer_limiter::list ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return std::vector<std::pair<boost::asio::ip::address, penalty>> (penalties.begin (), penalties.end ());
+}
+
+size_t btcnew::transport::peer_limiter::buckets_size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return ip_buckets.size () + node_id_buckets.size ();
+}
+
+size_t btcnew::transport::peer_limiter::penalties_size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return penalties.size ();
+}
+
+uint64_t btcnew::transport::peer_limiter::weight (btcnew::transport::penalty_reason reason_a)
+{
+	uint64_t result (1);
+	switch (reason_a)
+	{
+		case btcnew::transport::penalty_reason::rate_limit:
+			result = 1;
+			break;
+		case btcnew::transport::penalty_reason::insufficient_work:
+			result = 2;
+			break;
+		case btcnew::transport::penalty_reason::invalid_signature:
+			result = 5;
+	}
+	return result;
+}
+
+std::chrono::steady_clock::duration btcnew::transport::peer_limiter::exclude_duration (uint64_t exclusions_a) const
+{
+	return penalty_exclude_time * (1 << std::min<uint64_t> (exclusions_a, 10));
+}
+
+void btcnew::transport::peer_limiter::close_channels (boost::asio::ip::address const & address_a)
+{
+	// Closed from the io_context as penalties are given by threads holding locks of other components
+	std::weak_ptr<btcnew::node> node_w (node.shared ());
+	node.background ([node_w, address_a] () {
+		if (auto node_l = node_w.lock ())
+		{
+			for (auto & channel : *node_l->network.tcp_channels.snapshot ())
+			{
+				if (channel->get_endpoint ().address () == address_a)
+				{
+					auto endpoint (channel->get_tcp_endpoint ());
+					// Inbound channels share their socket with the server reading from it, which erasing the channel leaves open
+					if (auto socket_l = std::static_pointer_cast<btcnew::transport::channel_tcp> (channel)->socket.lock ())
+					{
+						socket_l->close ();
+					}
+					node_l->network.tcp_channels.erase (endpoint);
+				}
+			}
+			for (auto & channel : *node_l->network.udp_channels.snapshot ())
+			{
+				if (channel->get_endpoint ().address () == address_a)
+				{
+					node_l->network.udp_channels.erase (channel->get_endpoint ());
+				}
+			}
+		}
+	});
+}
+
+namespace btcnew
+{
+namespace transport
+{
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (peer_limiter & peer_limiter, const std::string & name)
+	{
+		auto composite = std::make_unique<seq_con_info_composite> (name);
+		composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "buckets", peer_limiter.buckets_size (), sizeof (decltype (peer_limiter.ip_buckets)::value_type) }));
+		composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "penalties", peer_limiter.penalties_size (), sizeof (decltype (peer_limiter.penalties)::value_type) }));
+		return composite;
+	}
+}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <btcnew/node/common.hpp>
+#include <btcnew/node/transport/traffic_shaper.hpp>
+#include <btcnew/node/transport/transport.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace btcnew
+{
+class node;
+namespace transport
+{
+	/** Misbehaviour adding to the penalty score of an IP address */
+	enum class penalty_reason : uint8_t
+	{
+		rate_limit,
+		insufficient_work,
+		invalid_signature
+	};
+
+	/**
+	 * Inbound realtime message budgets checked before messages are parsed, and escalating penalties for misbehaving peers.
+	 * TCP channels which completed a handshake have a budget per node ID, so peers sharing an address don't limit each other.
+	 * Other traffic, including all UDP traffic, shares a budget per IP address.
+	 * Only TCP peers are penalized, as UDP source addresses can be spoofed: their UDP traffic is dropped over budget but
+	 * never adds to a penalty. Penalties add to a score per address, for exceeding the node ID budget, sending blocks with
+	 * insufficient work or votes with invalid signatures. Reaching penalty_close_score closes the channels of the address,
+	 * reaching penalty_exclude_score also drops all of its traffic and refuses channels to it for penalty_exclude_time, twice
+	 * as long with every further exclusion, similar to btcnew::bootstrap_excluded_peers.
+	 */
+	class peer_limiter final
+	{
+	public:
+		explicit peer_limiter (btcnew::node &);
+		/** Returns true if a message received from \p endpoint_a over \p type_a should be dropped before it is parsed. \p node_id_a is zero until the channel completed a handshake */
+		bool should_drop (btcnew::endpoint const & endpoint_a, btcnew::account const & node_id_a, btcnew::transport::transport_type type_a);
+		/** Adds to the penalty of the address of \p endpoint_a, messages received over UDP are ignored */
+		void penalize (btcnew::endpoint const & endpoint_a, btcnew::transport::transport_type type_a, btcnew::transport::penalty_reason reason_a);
+		bool excluded (boost::asio::ip::address const & address_a);
+		/** Forget budgets unused since \p cutoff_a and penalties of addresses which have behaved since */
+		void purge (std::chrono::steady_clock::time_point const & cutoff_a);
+		class penalty final
+		{
+		public:
+			uint64_t score{ 0 };
+			uint64_t exclusions{ 0 };
+			std::chrono::steady_clock::time_point exclude_until;
+			std::chrono::steady_clock::time_point last_violation;
+			/** Exceeding a budget adds to the score at most once per second */
+			std::chrono::steady_clock::time_point last_rate_penalty;
+		};
+		std::vector<std::pair<boost::asio::ip::address, penalty>> list ();
+		size_t buckets_size ();
+		size_t penalties_size ();
+		static uint64_t weight (btcnew::transport::penalty_reason);
+		/** Addresses and node IDs tracked each, further ones are only limited by the btcnew::transport::traffic_shaper */
+		static size_t constexpr max_entries{ 64 * 1024 };
+		bool const enable;
+
+	private:
+		/** How long the next exclusion of an address excluded \p exclusions_a times before lasts */
+		std::chrono::steady_clock::duration exclude_duration (uint64_t exclusions_a) const;
+		void close_channels (boost::asio::ip::address const &);
+		btcnew::node & node;
+		size_t const ip_message_limit;
+		size_t const node_id_message_limit;
+		uint64_t const penalty_close_score;
+		uint64_t const penalty_exclude_score;
+		std::chrono::seconds const penalty_exclude_time;
+		std::unordered_map<boost::asio::ip::address, btcnew::token_bucket> ip_buckets;
+		std::unordered_map<btcnew::account, btcnew::token_bucket> node_id_buckets;
+		std::unordered_map<boost::asio::ip::address, penalty> penalties;
+		std::mutex mutex;
+
+		friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (peer_limiter &, const std::string &);
+	};
+
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (peer_limiter & peer_limiter, const std::string & name);
+}
+}
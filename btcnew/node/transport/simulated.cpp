@@ -0,0 +1,82 @@
+#include <btcnew/node/node.hpp>
+#include <btcnew/node/transport/simulated.hpp>
+
+btcnew::transport::simulated_network::simulated_network (btcnew::alarm & alarm_a, btcnew::transport::simulation_config const & config_a) :
+alarm (alarm_a),
+config (config_a),
+generator (config_a.seed)
+{
+}
+
+void btcnew::transport::simulated_network::set_config (btcnew::transport::simulation_config const & config_a)
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	config = config_a;
+}
+
+void btcnew::transport::simulated_network::attach (std::shared_ptr<btcnew::node> const & node_a)
+{
+	assert (node_a->network.udp_channels.simulated == nullptr);
+	node_a->network.udp_channels.simulated = shared_from_this ();
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	nodes[node_a->network.endpoint ()] = node_a;
+}
+
+void btcnew::transport::simulated_network::send (btcnew::endpoint const & from_a, btcnew::endpoint const & to_a, btcnew::shared_const_buffer const & buffer_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a)
+{
+	++sent;
+	auto now (std::chrono::steady_clock::now ());
+	auto size (buffer_a.size ());
+	std::weak_ptr<btcnew::node> destination;
+	std::chrono::steady_clock::time_point arrival;
+	auto drop (false);
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		// Always draw both values so one outcome doesn't shift the sequence seen by later datagrams
+		auto lose (std::uniform_real_distribution<double> (0., 1.) (generator) < config.loss);
+		std::chrono::milliseconds jitter (std::uniform_int_distribution<std::chrono::milliseconds::rep> (0, config.jitter.count ()) (generator));
+		auto existing (nodes.find (to_a));
+		if (lose)
+		{
+			drop = true;
+			++lost;
+		}
+		else if (existing == nodes.end ())
+		{
+			drop = true;
+			++unreachable;
+		}
+		else
+		{
+			destination = existing->second;
+			auto & busy_until (links[std::make_pair (from_a, to_a)]);
+			auto transmitted (std::max (now, busy_until));
+			if (config.bandwidth != 0)
+			{
+				transmitted += std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::duration<double> (static_cast<double> (size) / config.bandwidth));
+			}
+			busy_until = transmitted;
+			arrival = transmitted + config.latency + jitter;
+		}
+	}
+	// Like a datagram socket the sender never learns about losses
+	if (callback_a)
+	{
+		boost::asio::post (alarm.io_ctx, [callback_a, size] () {
+			callback_a (boost::system::error_code (), size);
+		});
+	}
+	if (!drop)
+	{
+		std::weak_ptr<btcnew::transport::simulated_network> this_w (shared_from_this ());
+		alarm.add (arrival, [this_w, destination, from_a, buffer_a] () {
+			auto this_l (this_w.lock ());
+			auto node_l (destination.lock ());
+			if (this_l && node_l && !node_l->stopped)
+			{
+				node_l->network.udp_channels.receive_simulated (from_a, buffer_a);
+				++this_l->delivered;
+			}
+		});
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <btcnew/lib/asio.hpp>
+#include <btcnew/node/common.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+namespace btcnew
+{
+class alarm;
+class node;
+namespace transport
+{
+	/** Properties of every link of a btcnew::transport::simulated_network, a link being one direction between two endpoints */
+	class simulation_config final
+	{
+	public:
+		std::chrono::milliseconds latency{ 0 };
+		/** Extra delay per datagram, drawn uniformly from [0, jitter] */
+		std::chrono::milliseconds jitter{ 0 };
+		/** Probability of a datagram being lost, from 0 to 1 */
+		double loss{ 0. };
+		/** Bytes/sec a link transmits, datagrams queue behind each other. 0 is unbounded */
+		size_t bandwidth{ 0 };
+		/** Seed of the generator drawing losses and jitter, only used when the network is constructed */
+		uint64_t seed{ 0 };
+	};
+
+	/**
+	 * Carries UDP datagrams between nodes of the same process through in-memory queues instead of sockets.
+	 * Nodes are attached before they start, their udp_channels then hand every datagram to this network which delivers it to the
+	 * packet processing queue of the node listening on the destination endpoint once the link delay has passed.
+	 * Losses and jitter come from a generator seeded by the config, so the same sequence of sends sees the same drops and delays.
+	 */
+	class simulated_network final : public std::enable_shared_from_this<simulated_network>
+	{
+	public:
+		simulated_network (btcnew::alarm &, btcnew::transport::simulation_config const &);
+		/** Route the realtime UDP traffic of \p node_a through this network, must be called before the node starts */
+		void attach (std::shared_ptr<btcnew::node> const & node_a);
+		void send (btcnew::endpoint const & from_a, btcnew::endpoint const & to_a, btcnew::shared_const_buffer const & buffer_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a);
+		/** Change the link properties for datagrams sent from now on, e.g. to only introduce losses once nodes are connected */
+		void set_config (btcnew::transport::simulation_config const &);
+		std::atomic<uint64_t> sent{ 0 };
+		std::atomic<uint64_t> lost{ 0 };
+		/** Datagrams to endpoints no attached node listens on */
+		std::atomic<uint64_t> unreachable{ 0 };
+		std::atomic<uint64_t> delivered{ 0 };
+
+	private:
+		btcnew::alarm & alarm;
+		std::mutex mutex;
+		btcnew::transport::simulation_config config;
+		std::mt19937_64 generator;
+		std::unordered_map<btcnew::endpoint, std::weak_ptr<btcnew::node>> nodes;
+		/** Time each link finishes transmitting the datagrams queued on it */
+		std::map<std::pair<btcnew::endpoint, btcnew::endpoint>, std::chrono::steady_clock::time_point> links;
+	};
+}
+}
@@ -2,6 +2,8 @@
 #include <btcnew/node/node.hpp>
 #include <btcnew/node/transport/tcp.hpp>
 
+#include <limits>
+
 btcnew::transport::channel_tcp::channel_tcp (btcnew::node & node_a, std::weak_ptr<btcnew::socket> socket_a) :
 channel (node_a),
 socket (socket_a)
@@ -48,11 +50,11 @@ bool btcnew::transport::channel_tcp::operator== (btcnew::transport::channel cons
 	return result;
 }
 
-void btcnew::transport::channel_tcp::send_buffer (btcnew::shared_const_buffer const & buffer_a, btcnew::stat::detail detail_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a)
+void btcnew::transport::channel_tcp::send_buffer (btcnew::shared_const_buffer const & buffer_a, btcnew::stat::detail detail_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a, bool const is_droppable_a)
 {
 	if (auto socket_l = socket.lock ())
 	{
-		socket_l->async_write (buffer_a, tcp_callback (detail_a, socket_l->remote_endpoint (), callback_a));
+		socket_l->async_write (buffer_a, tcp_callback (detail_a, socket_l->remote_endpoint (), callback_a), is_droppable_a);
 	}
 }
 
@@ -97,6 +99,9 @@ std::string btcnew::transport::channel_tcp::to_string () const
 btcnew::transport::tcp_channels::tcp_channels (btcnew::node & node_a) :
 node (node_a)
 {
+	node.stats.define_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_queue_depth, btcnew::stat::dir::out, { 1, 2, 3, 5, 9, 17, 33, 65, 129, 257, std::numeric_limits<uint64_t>::max () });
+	node.stats.define_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_messages, btcnew::stat::dir::out, { 1, 2, 3, 5, 9, 17, 33, 65, 129, 257, std::numeric_limits<uint64_t>::max () });
+	node.stats.define_histogram (btcnew::stat::type::tcp, btcnew::stat::detail::tcp_write_bytes, btcnew::stat::dir::out, { 0, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536, std::numeric_limits<uint64_t>::max () });
 }
 
 bool btcnew::transport::tcp_channels::insert (std::shared_ptr<btcnew::transport::channel_tcp> channel_a, std::shared_ptr<btcnew::socket> socket_a, std::shared_ptr<btcnew::bootstrap_server> bootstrap_server_a)
@@ -117,6 +122,7 @@ bool btcnew::transport::tcp_channels::insert (std::shared_ptr<btcnew::transport:
 				channels.get<node_id_tag> ().erase (node_id);
 			}
 			channels.get<endpoint_tag> ().insert ({ channel_a, socket_a, bootstrap_server_a });
+			snapshot_stale = true;
 			error = false;
 			lock.unlock ();
 			node.network.channel_observer (channel_a);
@@ -133,6 +139,7 @@ void btcnew::transport::tcp_channels::erase (btcnew::tcp_endpoint const & endpoi
 {
 	btcnew::lock_guard<std::mutex> lock (mutex);
 	channels.get<endpoint_tag> ().erase (endpoint_a);
+	snapshot_stale = true;
 }
 
 size_t btcnew::transport::tcp_channels::size () const
@@ -157,23 +164,40 @@ std::unordered_set<std::shared_ptr<btcnew::transport::channel>> btcnew::transpor
 {
 	std::unordered_set<std::shared_ptr<btcnew::transport::channel>> result;
 	result.reserve (count_a);
-	btcnew::lock_guard<std::mutex> lock (mutex);
+	auto peers (snapshot ());
 	// Stop trying to fill result with random samples after this many attempts
 	auto random_cutoff (count_a * 2);
-	auto peers_size (channels.size ());
 	// Usually count_a will be much smaller than peers.size()
 	// Otherwise make sure we have a cutoff on attempting to randomly fill
-	if (!channels.empty ())
+	if (!peers->empty ())
 	{
 		for (auto i (0); i < random_cutoff && result.size () < count_a; ++i)
 		{
-			auto index (btcnew::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (peers_size - 1)));
-			result.insert (channels.get<random_access_tag> ()[index].channel);
+			auto index (btcnew::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (peers->size () - 1)));
+			result.insert ((*peers)[index]);
 		}
 	}
 	return result;
 }
 
+std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>> const> btcnew::transport::tcp_channels::snapshot () const
+{
+	auto result (std::atomic_load (&channels_snapshot));
+	if (snapshot_stale.exchange (false) || result == nullptr)
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		auto rebuilt (std::make_shared<std::vector<std::shared_ptr<btcnew::transport::channel>>> ());
+		rebuilt->reserve (channels.size ());
+		for (auto & wrapper : channels)
+		{
+			rebuilt->push_back (wrapper.channel);
+		}
+		result = rebuilt;
+		std::atomic_store (&channels_snapshot, result);
+	}
+	return result;
+}
+
 void btcnew::transport::tcp_channels::random_fill (std::array<btcnew::endpoint, 8> & target_a) const
 {
 	auto peers (random_set (target_a.size ()));
@@ -339,6 +363,7 @@ void btcnew::transport::tcp_channels::stop ()
 		}
 	}
 	channels.clear ();
+	snapshot_stale = true;
 	node_id_handshake_sockets.clear ();
 }
 
@@ -391,6 +416,7 @@ void btcnew::transport::tcp_channels::purge (std::chrono::steady_clock::time_poi
 	btcnew::lock_guard<std::mutex> lock (mutex);
 	auto disconnect_cutoff (channels.get<last_packet_sent_tag> ().lower_bound (cutoff_a));
 	channels.get<last_packet_sent_tag> ().erase (channels.get<last_packet_sent_tag> ().begin (), disconnect_cutoff);
+	snapshot_stale = true;
 	// Remove keepalive attempt tracking for attempts older than cutoff
 	auto attempts_cutoff (attempts.get<1> ().lower_bound (cutoff_a));
 	attempts.get<1> ().erase (attempts.get<1> ().begin (), attempts_cutoff);
@@ -447,11 +473,8 @@ void btcnew::transport::tcp_channels::ongoing_keepalive ()
 
 void btcnew::transport::tcp_channels::list (std::deque<std::shared_ptr<btcnew::transport::channel>> & deque_a)
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	for (auto i (channels.begin ()), j (channels.end ()); i != j; ++i)
-	{
-		deque_a.push_back (i->channel);
-	}
+	auto peers (snapshot ());
+	deque_a.insert (deque_a.end (), peers->begin (), peers->end ());
 }
 
 void btcnew::transport::tcp_channels::modify (std::shared_ptr<btcnew::transport::channel_tcp> channel_a, std::function<void (std::shared_ptr<btcnew::transport::channel_tcp>)> modify_callback_a)
@@ -27,7 +27,7 @@ namespace transport
 		~channel_tcp ();
 		size_t hash_code () const override;
 		bool operator== (btcnew::transport::channel const &) const override;
-		void send_buffer (btcnew::shared_const_buffer const &, btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) override;
+		void send_buffer (btcnew::shared_const_buffer const &, btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr, bool const = true) override;
 		std::function<void (boost::system::error_code const &, size_t)> callback (btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) const override;
 		std::function<void (boost::system::error_code const &, size_t)> tcp_callback (btcnew::stat::detail, btcnew::tcp_endpoint const &, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) const;
 		std::string to_string () const override;
@@ -82,6 +82,8 @@ namespace transport
 		std::shared_ptr<btcnew::transport::channel_tcp> find_channel (btcnew::tcp_endpoint const &) const;
 		void random_fill (std::array<btcnew::endpoint, 8> &) const;
 		std::unordered_set<std::shared_ptr<btcnew::transport::channel>> random_set (size_t) const;
+		/** Channels at the time of the last membership change, shared by readers without taking the mutex */
+		std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>> const> snapshot () const;
 		bool store_all (bool = true);
 		std::shared_ptr<btcnew::transport::channel_tcp> find_node_id (btcnew::account const &);
 		// Get the next peer for attempting a tcp connection
@@ -164,6 +166,9 @@ namespace transport
 			std::chrono::steady_clock::time_point last_attempt;
 		};
 		mutable std::mutex mutex;
+		/** Copy on write list of channels, rebuilt by the first reader after \p snapshot_stale is set under \p mutex */
+		mutable std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>> const> channels_snapshot;
+		mutable std::atomic<bool> snapshot_stale{ true };
 		boost::multi_index_container<
 		channel_tcp_wrapper,
 		boost::multi_index::indexed_by<
@@ -0,0 +1,221 @@
+#include <btcnew/lib/stats.hpp>
+#include <btcnew/node/transport/traffic_shaper.hpp>
+
+#include <algorithm>
+
+size_t constexpr btcnew::transport::traffic_shaper::max_peers;
+
+btcnew::token_bucket::token_bucket (size_t rate_a) :
+rate (rate_a),
+last_refill (std::chrono::steady_clock::now ()),
+tokens (static_cast<double> (rate_a))
+{
+}
+
+bool btcnew::token_bucket::available (size_t size_a, std::chrono::steady_clock::time_point now_a)
+{
+	auto result (true);
+	if (rate != 0)
+	{
+		if (now_a > last_refill)
+		{
+			tokens = std::min (static_cast<double> (rate), tokens + std::chrono::duration<double> (now_a - last_refill).count () * rate);
+			last_refill = now_a;
+		}
+		result = tokens >= size_a;
+	}
+	return result;
+}
+
+void btcnew::token_bucket::consume (size_t size_a)
+{
+	tokens = std::max (0., tokens - size_a);
+}
+
+namespace
+{
+btcnew::stat::detail detail_of (btcnew::transport::traffic_class class_a)
+{
+	auto result (btcnew::stat::detail::keepalive_class);
+	switch (class_a)
+	{
+		case btcnew::transport::traffic_class::vote:
+			result = btcnew::stat::detail::vote_class;
+			break;
+		case btcnew::transport::traffic_class::publish:
+			result = btcnew::stat::detail::publish_class;
+			break;
+		case btcnew::transport::traffic_class::keepalive:
+			result = btcnew::stat::detail::keepalive_class;
+			break;
+		case btcnew::transport::traffic_class::bootstrap:
+			result = btcnew::stat::detail::bootstrap_class;
+	}
+	return result;
+}
+
+size_t share (size_t limit_a, unsigned weight_a, btcnew::traffic_shaping_config const & config_a)
+{
+	auto weights (config_a.vote_weight + config_a.publish_weight + config_a.keepalive_weight + config_a.bootstrap_weight);
+	// Keep unbounded limits unbounded and every bounded class above zero
+	return limit_a == 0 ? 0 : std::max<size_t> (1, static_cast<size_t> (static_cast<double> (limit_a) * weight_a / weights));
+}
+}
+
+btcnew::transport::traffic_shaper::direction::direction (size_t limit_a, btcnew::traffic_shaping_config const & config_a) :
+total (limit_a),
+classes{ { btcnew::token_bucket (share (limit_a, config_a.vote_weight, config_a)), btcnew::token_bucket (share (limit_a, config_a.publish_weight, config_a)), btcnew::token_bucket (share (limit_a, config_a.keepalive_weight, config_a)), btcnew::token_bucket (share (limit_a, config_a.bootstrap_weight, config_a)) } }
+{
+}
+
+btcnew::transport::traffic_shaper::traffic_shaper (btcnew::traffic_shaping_config const & config_a, btcnew::stat & stats_a) :
+stats (stats_a),
+enable (config_a.enable),
+peer_inbound_limit (config_a.peer_inbound_limit),
+inbound (config_a.inbound_limit, config_a),
+outbound (config_a.outbound_limit, config_a)
+{
+}
+
+bool btcnew::transport::traffic_shaper::should_drop_inbound (btcnew::endpoint const & endpoint_a, btcnew::message_type type_a, size_t size_a)
+{
+	auto result (false);
+	// Handshakes are never limited so peers can always establish a channel
+	if (enable && type_a != btcnew::message_type::node_id_handshake)
+	{
+		auto now (std::chrono::steady_clock::now ());
+		auto class_l (classify (type_a));
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		btcnew::token_bucket * peer (nullptr);
+		if (peer_inbound_limit != 0)
+		{
+			auto & endpoints (peers.get<1> ());
+			auto existing (endpoints.find (endpoint_a));
+			if (existing != endpoints.end ())
+			{
+				peers.relocate (peers.end (), peers.project<0> (existing));
+			}
+			else
+			{
+				if (peers.size () >= max_peers)
+				{
+					peers.pop_front ();
+				}
+				existing = endpoints.insert ({ endpoint_a, btcnew::token_bucket (peer_inbound_limit) }).first;
+			}
+			peer = &existing->bucket;
+		}
+		if (peer != nullptr && !peer->available (size_a, now))
+		{
+			result = true;
+			stats.inc (btcnew::stat::type::traffic_shaper, btcnew::stat::detail::peer_bucket, btcnew::stat::dir::in);
+		}
+		else
+		{
+			result = should_drop (inbound, class_l, size_a, now);
+			if (result)
+			{
+				stats.inc (btcnew::stat::type::traffic_shaper, detail_of (class_l), btcnew::stat::dir::in);
+			}
+			else if (peer != nullptr)
+			{
+				peer->consume (size_a);
+			}
+		}
+	}
+	return result;
+}
+
+bool btcnew::transport::traffic_shaper::should_drop_outbound (btcnew::message_type type_a, size_t size_a)
+{
+	auto result (false);
+	if (enable && type_a != btcnew::message_type::node_id_handshake)
+	{
+		auto now (std::chrono::steady_clock::now ());
+		auto class_l (classify (type_a));
+		{
+			btcnew::lock_guard<std::mutex> lock (mutex);
+			result = should_drop (outbound, class_l, size_a, now);
+		}
+		if (result)
+		{
+			stats.inc (btcnew::stat::type::traffic_shaper, detail_of (class_l), btcnew::stat::dir::out);
+		}
+	}
+	return result;
+}
+
+bool btcnew::transport::traffic_shaper::should_drop (direction & direction_a, btcnew::transport::traffic_class class_a, size_t size_a, std::chrono::steady_clock::time_point now_a)
+{
+	auto & bucket (direction_a.classes[static_cast<size_t> (class_a)]);
+	auto result (false);
+	if (bucket.available (size_a, now_a))
+	{
+		// Traffic within the guaranteed share always passes, it still counts against the node wide budget other classes borrow from
+		bucket.consume (size_a);
+		direction_a.total.available (size_a, now_a);
+		direction_a.total.consume (size_a);
+	}
+	else if (direction_a.total.available (size_a, now_a))
+	{
+		direction_a.total.consume (size_a);
+	}
+	else
+	{
+		result = true;
+	}
+	return result;
+}
+
+void btcnew::transport::traffic_shaper::purge (std::chrono::steady_clock::time_point const & cutoff_a)
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	// Peers are refilled whenever they send, so the least recently active ones are at the front
+	while (!peers.empty () && peers.front ().bucket.last_refill < cutoff_a)
+	{
+		peers.pop_front ();
+	}
+}
+
+size_t btcnew::transport::traffic_shaper::peers_size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return peers.size ();
+}
+
+btcnew::transport::traffic_class btcnew::transport::traffic_shaper::classify (btcnew::message_type type_a)
+{
+	auto result (btcnew::transport::traffic_class::keepalive);
+	switch (type_a)
+	{
+		case btcnew::message_type::confirm_req:
+		case btcnew::message_type::confirm_ack:
+			result = btcnew::transport::traffic_class::vote;
+			break;
+		case btcnew::message_type::publish:
+			result = btcnew::transport::traffic_class::publish;
+			break;
+		case btcnew::message_type::bulk_pull:
+		case btcnew::message_type::bulk_pull_account:
+		case btcnew::message_type::bulk_push:
+		case btcnew::message_type::frontier_req:
+			result = btcnew::transport::traffic_class::bootstrap;
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+namespace btcnew
+{
+namespace transport
+{
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (traffic_shaper & traffic_shaper, const std::string & name)
+	{
+		auto composite = std::make_unique<seq_con_info_composite> (name);
+		composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "peers", traffic_shaper.peers_size (), sizeof (decltype (traffic_shaper.peers)::value_type) }));
+		return composite;
+	}
+}
+}
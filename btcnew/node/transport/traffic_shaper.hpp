@@ -0,0 +1,102 @@
+#pragma once
+
+#include <btcnew/node/common.hpp>
+#include <btcnew/node/trafficshapingconfig.hpp>
+
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+
+namespace btcnew
+{
+class stat;
+
+/** Byte budget refilled at a fixed rate, holding at most one second worth of tokens. Not thread safe */
+class token_bucket final
+{
+public:
+	/** A rate of 0 is unbounded */
+	explicit token_bucket (size_t rate_a);
+	/** Whether \p size_a tokens are available at \p now_a */
+	bool available (size_t size_a, std::chrono::steady_clock::time_point now_a);
+	/** Take up to \p size_a tokens, the balance never goes below zero */
+	void consume (size_t size_a);
+	size_t const rate;
+	std::chrono::steady_clock::time_point last_refill;
+
+private:
+	double tokens;
+};
+
+namespace transport
+{
+	/** Message classes sharing the traffic limits by weight */
+	enum class traffic_class : uint8_t
+	{
+		vote,
+		publish,
+		keepalive,
+		bootstrap
+	};
+
+	/**
+	 * Hierarchical token buckets for realtime traffic.
+	 * Each direction has a node wide bucket and one bucket per btcnew::transport::traffic_class with a share of the node wide rate
+	 * set by the class weights. A message is admitted while its class has tokens, or borrows from the node wide bucket when other
+	 * classes leave it unused, so favoured classes keep their share when another class floods.
+	 * Inbound messages are also limited per remote endpoint.
+	 */
+	class traffic_shaper final
+	{
+	public:
+		traffic_shaper (btcnew::traffic_shaping_config const &, btcnew::stat &);
+		/** Returns true if a message of \p type_a and \p size_a bytes received from \p endpoint_a should be dropped before it is parsed */
+		bool should_drop_inbound (btcnew::endpoint const & endpoint_a, btcnew::message_type type_a, size_t size_a);
+		/** Returns true if a droppable message of \p type_a and \p size_a bytes should not be sent */
+		bool should_drop_outbound (btcnew::message_type type_a, size_t size_a);
+		/** Forget peers which have not sent anything since \p cutoff_a */
+		void purge (std::chrono::steady_clock::time_point const & cutoff_a);
+		size_t peers_size ();
+		static traffic_class classify (btcnew::message_type);
+		/** Peers with their own inbound bucket, the least recently active one is forgotten when a new peer arrives */
+		static size_t constexpr max_peers{ 4 * 1024 };
+
+	private:
+		class direction final
+		{
+		public:
+			direction (size_t, btcnew::traffic_shaping_config const &);
+			btcnew::token_bucket total;
+			std::array<btcnew::token_bucket, 4> classes;
+		};
+		class peer final
+		{
+		public:
+			btcnew::endpoint endpoint;
+			mutable btcnew::token_bucket bucket;
+		};
+		bool should_drop (direction &, traffic_class, size_t, std::chrono::steady_clock::time_point);
+		btcnew::stat & stats;
+		bool const enable;
+		size_t const peer_inbound_limit;
+		direction inbound;
+		direction outbound;
+		/** Ordered from the least to the most recently active peer */
+		boost::multi_index_container<peer,
+		boost::multi_index::indexed_by<
+		boost::multi_index::sequenced<>,
+		boost::multi_index::hashed_unique<boost::multi_index::member<peer, btcnew::endpoint, &peer::endpoint>>>>
+		peers;
+		std::mutex mutex;
+
+		friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (traffic_shaper &, const std::string &);
+	};
+
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (traffic_shaper & traffic_shaper, const std::string & name);
+}
+}
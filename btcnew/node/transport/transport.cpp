@@ -82,9 +82,9 @@ void btcnew::transport::channel::send (btcnew::message const & message_a, std::f
 	message_a.visit (visitor);
 	auto buffer (message_a.to_shared_const_buffer ());
 	auto detail (visitor.result);
-	if (!is_droppable_a || !limiter.should_drop (buffer.size ()))
+	if (!is_droppable_a || (!limiter.should_drop (buffer.size ()) && !node.network.traffic_shaper.should_drop_outbound (message_a.header.type, buffer.size ())))
 	{
-		send_buffer (buffer, detail, callback_a);
+		send_buffer (buffer, detail, callback_a, is_droppable_a);
 		node.stats.inc (btcnew::stat::type::message, detail, btcnew::stat::dir::out);
 	}
 	else
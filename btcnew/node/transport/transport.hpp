@@ -54,7 +54,7 @@ namespace transport
 		virtual size_t hash_code () const = 0;
 		virtual bool operator== (btcnew::transport::channel const &) const = 0;
 		void send (btcnew::message const &, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr, bool const = true);
-		virtual void send_buffer (btcnew::shared_const_buffer const &, btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) = 0;
+		virtual void send_buffer (btcnew::shared_const_buffer const &, btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr, bool const = true) = 0;
 		virtual std::function<void (boost::system::error_code const &, size_t)> callback (btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) const = 0;
 		virtual std::string to_string () const = 0;
 		virtual btcnew::endpoint get_endpoint () const = 0;
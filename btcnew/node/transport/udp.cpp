@@ -1,8 +1,19 @@
 #include <btcnew/crypto_lib/random_pool.hpp>
 #include <btcnew/lib/stats.hpp>
 #include <btcnew/node/node.hpp>
+#include <btcnew/node/transport/simulated.hpp>
 #include <btcnew/node/transport/udp.hpp>
 
+#ifdef __linux__
+#include <sys/socket.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#endif
+
+size_t constexpr btcnew::transport::udp_channels::max_batch;
+
 btcnew::transport::channel_udp::channel_udp (btcnew::transport::udp_channels & channels_a, btcnew::endpoint const & endpoint_a, uint8_t protocol_version_a) :
 channel (channels_a.node),
 endpoint (endpoint_a),
@@ -29,7 +40,7 @@ bool btcnew::transport::channel_udp::operator== (btcnew::transport::channel cons
 	return result;
 }
 
-void btcnew::transport::channel_udp::send_buffer (btcnew::shared_const_buffer const & buffer_a, btcnew::stat::detail detail_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a)
+void btcnew::transport::channel_udp::send_buffer (btcnew::shared_const_buffer const & buffer_a, btcnew::stat::detail detail_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a, bool const)
 {
 	set_last_packet_sent (std::chrono::steady_clock::now ());
 	channels.send (buffer_a, endpoint, callback (detail_a, callback_a));
@@ -78,17 +89,162 @@ socket (node_a.io_ctx, btcnew::endpoint (boost::asio::ip::address_v6::any (), po
 	}
 
 	local_endpoint = btcnew::endpoint (boost::asio::ip::address_v6::loopback (), port);
+	node.stats.define_histogram (btcnew::stat::type::udp, btcnew::stat::detail::packets_per_syscall, btcnew::stat::dir::in, { 1, max_batch + 1 }, max_batch);
+	node.stats.define_histogram (btcnew::stat::type::udp, btcnew::stat::detail::packets_per_syscall, btcnew::stat::dir::out, { 1, max_batch + 1 }, max_batch);
+#ifdef __linux__
+	receive_buffers.reserve (max_batch);
+#endif
 }
 
 void btcnew::transport::udp_channels::send (btcnew::shared_const_buffer const & buffer_a, btcnew::endpoint endpoint_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a)
 {
-	boost::asio::post (strand,
-	[this, buffer_a, endpoint_a, callback_a] () {
-		this->socket.async_send_to (buffer_a, endpoint_a,
-		boost::asio::bind_executor (strand, callback_a));
-	});
+	if (simulated != nullptr)
+	{
+		simulated->send (get_local_endpoint (), endpoint_a, buffer_a, callback_a);
+	}
+	else
+	{
+#ifdef __linux__
+		boost::asio::post (strand,
+		[this, buffer_a, endpoint_a, callback_a] () {
+			this->send_queue.push_back ({ buffer_a, endpoint_a, callback_a });
+			if (!this->sending)
+			{
+				this->sending = true;
+				// Everything queued until the socket is writable goes out with as few sendmmsg calls as possible
+				this->socket.async_wait (boost::asio::ip::udp::socket::wait_write,
+				boost::asio::bind_executor (strand, [this] (boost::system::error_code const & ec) { this->send_batch (ec); }));
+			}
+		});
+#else
+		boost::asio::post (strand,
+		[this, buffer_a, endpoint_a, callback_a] () {
+			this->socket.async_send_to (buffer_a, endpoint_a,
+			boost::asio::bind_executor (strand, callback_a));
+		});
+#endif
+	}
 }
 
+#ifdef __linux__
+void btcnew::transport::udp_channels::send_batch (boost::system::error_code const & ec_a)
+{
+	auto fail_front = [this] (boost::system::error_code const & error_a) {
+		auto entry (std::move (send_queue.front ()));
+		send_queue.pop_front ();
+		if (entry.callback)
+		{
+			entry.callback (error_a, 0);
+		}
+	};
+	auto blocked (false);
+	while (!send_queue.empty () && !blocked)
+	{
+		if (ec_a || stopped)
+		{
+			fail_front (ec_a ? ec_a : boost::asio::error::operation_aborted);
+			continue;
+		}
+		std::array<mmsghdr, max_batch> messages;
+		std::array<iovec, max_batch> iovecs;
+		auto count (std::min<size_t> (send_queue.size (), max_batch));
+		for (size_t i (0); i < count; ++i)
+		{
+			auto & entry (send_queue[i]);
+			iovecs[i].iov_base = const_cast<void *> (entry.buffer.begin ()->data ());
+			iovecs[i].iov_len = entry.buffer.size ();
+			messages[i].msg_hdr = msghdr{};
+			messages[i].msg_hdr.msg_name = entry.endpoint.data ();
+			messages[i].msg_hdr.msg_namelen = entry.endpoint.size ();
+			messages[i].msg_hdr.msg_iov = &iovecs[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+		}
+		auto sent (::sendmmsg (socket.native_handle (), messages.data (), count, MSG_DONTWAIT));
+		auto error (errno);
+		if (sent > 0)
+		{
+			node.stats.update_histogram (btcnew::stat::type::udp, btcnew::stat::detail::packets_per_syscall, btcnew::stat::dir::out, sent);
+			for (auto i (0); i < sent; ++i)
+			{
+				auto entry (std::move (send_queue.front ()));
+				send_queue.pop_front ();
+				if (entry.callback)
+				{
+					entry.callback (boost::system::error_code (), messages[i].msg_len);
+				}
+			}
+		}
+		else if (error == EAGAIN || error == EWOULDBLOCK)
+		{
+			blocked = true;
+		}
+		else if (error != EINTR)
+		{
+			// sendmmsg reports the error of the first datagram it could not send, the ones after it are retried
+			fail_front (boost::system::error_code (error, boost::system::system_category ()));
+		}
+	}
+	if (blocked)
+	{
+		socket.async_wait (boost::asio::ip::udp::socket::wait_write,
+		boost::asio::bind_executor (strand, [this] (boost::system::error_code const & ec) { this->send_batch (ec); }));
+	}
+	else
+	{
+		sending = false;
+	}
+}
+
+void btcnew::transport::udp_channels::receive_batch ()
+{
+	node.network.buffer_container.allocate (receive_buffers, max_batch);
+	if (!receive_buffers.empty ())
+	{
+		std::array<mmsghdr, max_batch> messages;
+		std::array<iovec, max_batch> iovecs;
+		for (size_t i (0), n (receive_buffers.size ()); i < n; ++i)
+		{
+			iovecs[i].iov_base = receive_buffers[i]->buffer;
+			iovecs[i].iov_len = btcnew::network::buffer_size;
+			messages[i].msg_hdr = msghdr{};
+			messages[i].msg_hdr.msg_name = receive_buffers[i]->endpoint.data ();
+			messages[i].msg_hdr.msg_namelen = receive_buffers[i]->endpoint.capacity ();
+			messages[i].msg_hdr.msg_iov = &iovecs[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+		}
+		int received;
+		do
+		{
+			received = ::recvmmsg (socket.native_handle (), messages.data (), receive_buffers.size (), MSG_DONTWAIT, nullptr);
+		} while (received < 0 && errno == EINTR);
+		auto error (errno);
+		if (received > 0)
+		{
+			node.stats.update_histogram (btcnew::stat::type::udp, btcnew::stat::detail::packets_per_syscall, btcnew::stat::dir::in, received);
+		}
+		else if (error != EAGAIN && error != EWOULDBLOCK && node.config.logging.network_logging ())
+		{
+			node.logger.try_log (boost::str (boost::format ("UDP Receive error: %1%") % std::strerror (error)));
+		}
+		for (auto i (0), n (static_cast<int> (receive_buffers.size ())); i < n; ++i)
+		{
+			auto data (receive_buffers[i]);
+			if (i < received)
+			{
+				data->size = messages[i].msg_len;
+				data->endpoint.resize (messages[i].msg_hdr.msg_namelen);
+				node.network.buffer_container.enqueue (data);
+			}
+			else
+			{
+				node.network.buffer_container.release (data);
+			}
+		}
+		receive_buffers.clear ();
+	}
+}
+#endif
+
 std::shared_ptr<btcnew::transport::channel_udp> btcnew::transport::udp_channels::insert (btcnew::endpoint const & endpoint_a, unsigned network_version_a)
 {
 	assert (endpoint_a.address ().is_v6 ());
@@ -105,6 +261,7 @@ std::shared_ptr<btcnew::transport::channel_udp> btcnew::transport::udp_channels:
 		{
 			result = std::make_shared<btcnew::transport::channel_udp> (*this, endpoint_a, network_version_a);
 			channels.get<endpoint_tag> ().insert ({ result });
+			snapshot_stale = true;
 			lock.unlock ();
 			node.network.channel_observer (result);
 		}
@@ -116,6 +273,7 @@ void btcnew::transport::udp_channels::erase (btcnew::endpoint const & endpoint_a
 {
 	btcnew::lock_guard<std::mutex> lock (mutex);
 	channels.get<endpoint_tag> ().erase (endpoint_a);
+	snapshot_stale = true;
 }
 
 size_t btcnew::transport::udp_channels::size () const
@@ -140,23 +298,40 @@ std::unordered_set<std::shared_ptr<btcnew::transport::channel>> btcnew::transpor
 {
 	std::unordered_set<std::shared_ptr<btcnew::transport::channel>> result;
 	result.reserve (count_a);
-	btcnew::lock_guard<std::mutex> lock (mutex);
+	auto peers (snapshot ());
 	// Stop trying to fill result with random samples after this many attempts
 	auto random_cutoff (count_a * 2);
-	auto peers_size (channels.size ());
 	// Usually count_a will be much smaller than peers.size()
 	// Otherwise make sure we have a cutoff on attempting to randomly fill
-	if (!channels.empty ())
+	if (!peers->empty ())
 	{
 		for (auto i (0); i < random_cutoff && result.size () < count_a; ++i)
 		{
-			auto index (btcnew::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (peers_size - 1)));
-			result.insert (channels.get<random_access_tag> ()[index].channel);
+			auto index (btcnew::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (peers->size () - 1)));
+			result.insert ((*peers)[index]);
 		}
 	}
 	return result;
 }
 
+std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>> const> btcnew::transport::udp_channels::snapshot () const
+{
+	auto result (std::atomic_load (&channels_snapshot));
+	if (snapshot_stale.exchange (false) || result == nullptr)
+	{
+		btcnew::lock_guard<std::mutex> lock (mutex);
+		auto rebuilt (std::make_shared<std::vector<std::shared_ptr<btcnew::transport::channel>>> ());
+		rebuilt->reserve (channels.size ());
+		for (auto & wrapper : channels)
+		{
+			rebuilt->push_back (wrapper.channel);
+		}
+		result = rebuilt;
+		std::atomic_store (&channels_snapshot, result);
+	}
+	return result;
+}
+
 void btcnew::transport::udp_channels::random_fill (std::array<btcnew::endpoint, 8> & target_a) const
 {
 	auto peers (random_set (target_a.size ()));
@@ -219,6 +394,7 @@ void btcnew::transport::udp_channels::clean_node_id (btcnew::account const & nod
 {
 	btcnew::lock_guard<std::mutex> lock (mutex);
 	channels.get<node_id_tag> ().erase (node_id_a);
+	snapshot_stale = true;
 }
 
 void btcnew::transport::udp_channels::clean_node_id (btcnew::endpoint const & endpoint_a, btcnew::account const & node_id_a)
@@ -231,6 +407,7 @@ void btcnew::transport::udp_channels::clean_node_id (btcnew::endpoint const & en
 		if (record.endpoint ().address () == endpoint_a.address () && record.endpoint ().port () != endpoint_a.port ())
 		{
 			channels.get<endpoint_tag> ().erase (record.endpoint ());
+			snapshot_stale = true;
 			break;
 		}
 	}
@@ -265,6 +442,32 @@ void btcnew::transport::udp_channels::receive ()
 		node.logger.try_log ("Receiving packet");
 	}
 
+#ifdef __linux__
+	// Wait for the socket to become readable and then read everything available in batches
+	socket.async_wait (boost::asio::ip::udp::socket::wait_read,
+	boost::asio::bind_executor (strand,
+	[this] (boost::system::error_code const & error) {
+		if (!error && !stopped)
+		{
+			this->receive_batch ();
+			this->receive ();
+		}
+		else
+		{
+			if (error)
+			{
+				if (this->node.config.logging.network_logging ())
+				{
+					this->node.logger.try_log (boost::str (boost::format ("UDP Receive error: %1%") % error.message ()));
+				}
+			}
+			if (!stopped)
+			{
+				this->node.alarm.add (std::chrono::steady_clock::now () + std::chrono::seconds (5), [this] () { this->receive (); });
+			}
+		}
+	}));
+#else
 	auto data (node.network.buffer_container.allocate ());
 
 	socket.async_receive_from (boost::asio::buffer (data->buffer, btcnew::network::buffer_size), data->endpoint,
@@ -292,15 +495,20 @@ void btcnew::transport::udp_channels::receive ()
 			}
 		}
 	}));
+#endif
 }
 
 void btcnew::transport::udp_channels::start ()
 {
-	for (size_t i = 0; i < node.config.io_threads; ++i)
+	// Simulated datagrams are queued directly by receive_simulated
+	if (simulated == nullptr)
 	{
-		boost::asio::post (strand, [this] () {
-			receive ();
-		});
+		for (size_t i = 0; i < node.config.io_threads; ++i)
+		{
+			boost::asio::post (strand, [this] () {
+				receive ();
+			});
+		}
 	}
 	ongoing_keepalive ();
 }
@@ -348,11 +556,13 @@ class udp_message_visitor : public btcnew::message_visitor
 public:
 	udp_message_visitor (btcnew::node & node_a, btcnew::endpoint const & endpoint_a) :
 	node (node_a),
-	endpoint (endpoint_a)
+	endpoint (endpoint_a),
+	start (std::chrono::steady_clock::now ())
 	{
 	}
 	void keepalive (btcnew::keepalive const & message_a) override
 	{
+		parsed (message_a);
 		if (!node.network.udp_channels.max_ip_connections (endpoint))
 		{
 			auto cookie (node.network.syn_cookies.assign (endpoint));
@@ -384,14 +594,17 @@ public:
 	}
 	void publish (btcnew::publish const & message_a) override
 	{
+		parsed (message_a);
 		message (message_a);
 	}
 	void confirm_req (btcnew::confirm_req const & message_a) override
 	{
+		parsed (message_a);
 		message (message_a);
 	}
 	void confirm_ack (btcnew::confirm_ack const & message_a) override
 	{
+		parsed (message_a);
 		message (message_a);
 	}
 	void bulk_pull (btcnew::bulk_pull const &) override
@@ -412,6 +625,7 @@ public:
 	}
 	void node_id_handshake (btcnew::node_id_handshake const & message_a) override
 	{
+		parsed (message_a);
 		if (node.config.logging.network_node_id_handshake_logging ())
 		{
 			node.logger.try_log (boost::str (boost::format ("Received node_id_handshake message from %1% with query %2% and response ID %3%") % endpoint % (message_a.query ? message_a.query->to_string () : std::string ("[none]")) % (message_a.response ? message_a.response->first.to_node_id () : std::string ("[none]"))));
@@ -472,14 +686,21 @@ public:
 			node.network.process_message (message_a, find_channel);
 		}
 	}
+	/** Messages are visited as soon as they are deserialized, which ends the parse time */
+	void parsed (btcnew::message const & message_a)
+	{
+		node.network.message_histograms.add_elapsed (btcnew::transport::transport_type::udp, message_a.header.type, btcnew::message_histograms::metric::parse, start);
+	}
 	btcnew::node & node;
 	btcnew::endpoint endpoint;
+	std::chrono::steady_clock::time_point start;
 };
 }
 
 void btcnew::transport::udp_channels::receive_action (btcnew::message_buffer * data_a)
 {
 	auto allowed_sender (true);
+	auto limited (false);
 	if (data_a->endpoint == local_endpoint)
 	{
 		allowed_sender = false;
@@ -492,62 +713,84 @@ void btcnew::transport::udp_channels::receive_action (btcnew::message_buffer * d
 	{
 		allowed_sender = false;
 	}
+	else if (node.network.peer_limiter.enable)
+	{
+		allowed_sender = !node.network.peer_limiter.should_drop (data_a->endpoint, btcnew::account (0), btcnew::transport::transport_type::udp);
+		limited = !allowed_sender;
+	}
 	if (allowed_sender)
 	{
-		udp_message_visitor visitor (node, data_a->endpoint);
-		btcnew::message_parser parser (node.block_uniquer, node.vote_uniquer, visitor, node.work);
-		parser.deserialize_buffer (data_a->buffer, data_a->size);
-		if (parser.status != btcnew::message_parser::parse_status::success)
+		// Only the header is read to find the message class, invalid headers are left to the parser
+		auto error (false);
+		btcnew::bufferstream header_stream (data_a->buffer, data_a->size);
+		btcnew::message_header header (error, header_stream);
+		if (error || !node.network.traffic_shaper.should_drop_inbound (data_a->endpoint, header.type, data_a->size))
 		{
-			node.stats.inc (btcnew::stat::type::error);
+			if (!error)
+			{
+				node.network.message_histograms.add (btcnew::transport::transport_type::udp, header.type, btcnew::message_histograms::metric::size, data_a->size);
+				node.network.message_histograms.add_elapsed (btcnew::transport::transport_type::udp, header.type, btcnew::message_histograms::metric::queue, data_a->received);
+			}
+			udp_message_visitor visitor (node, data_a->endpoint);
+			btcnew::message_parser parser (node.network.publish_filter, node.block_uniquer, node.vote_uniquer, visitor, node.work);
+			parser.deserialize_buffer (data_a->buffer, data_a->size);
+			if (parser.status == btcnew::message_parser::parse_status::duplicate_publish_message)
+			{
+				node.stats.inc (btcnew::stat::type::filter, btcnew::stat::detail::duplicate_publish);
+			}
+			else if (parser.status != btcnew::message_parser::parse_status::success)
+			{
+				node.stats.inc (btcnew::stat::type::error);
 
-			switch (parser.status)
+				switch (parser.status)
+				{
+					case btcnew::message_parser::parse_status::insufficient_work:
+						// We've already increment error count, update detail only
+						node.stats.inc_detail_only (btcnew::stat::type::error, btcnew::stat::detail::insufficient_work);
+						break;
+					case btcnew::message_parser::parse_status::invalid_magic:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_magic);
+						break;
+					case btcnew::message_parser::parse_status::invalid_network:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_network);
+						break;
+					case btcnew::message_parser::parse_status::invalid_header:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_header);
+						break;
+					case btcnew::message_parser::parse_status::invalid_message_type:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_message_type);
+						break;
+					case btcnew::message_parser::parse_status::invalid_keepalive_message:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_keepalive_message);
+						break;
+					case btcnew::message_parser::parse_status::invalid_publish_message:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_publish_message);
+						break;
+					case btcnew::message_parser::parse_status::invalid_confirm_req_message:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_confirm_req_message);
+						break;
+					case btcnew::message_parser::parse_status::invalid_confirm_ack_message:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_confirm_ack_message);
+						break;
+					case btcnew::message_parser::parse_status::invalid_node_id_handshake_message:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_node_id_handshake_message);
+						break;
+					case btcnew::message_parser::parse_status::outdated_version:
+						node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::outdated_version);
+						break;
+					case btcnew::message_parser::parse_status::success:
+					case btcnew::message_parser::parse_status::duplicate_publish_message:
+						/* Already checked, unreachable */
+						break;
+				}
+			}
+			else
 			{
-				case btcnew::message_parser::parse_status::insufficient_work:
-					// We've already increment error count, update detail only
-					node.stats.inc_detail_only (btcnew::stat::type::error, btcnew::stat::detail::insufficient_work);
-					break;
-				case btcnew::message_parser::parse_status::invalid_magic:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_magic);
-					break;
-				case btcnew::message_parser::parse_status::invalid_network:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_network);
-					break;
-				case btcnew::message_parser::parse_status::invalid_header:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_header);
-					break;
-				case btcnew::message_parser::parse_status::invalid_message_type:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_message_type);
-					break;
-				case btcnew::message_parser::parse_status::invalid_keepalive_message:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_keepalive_message);
-					break;
-				case btcnew::message_parser::parse_status::invalid_publish_message:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_publish_message);
-					break;
-				case btcnew::message_parser::parse_status::invalid_confirm_req_message:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_confirm_req_message);
-					break;
-				case btcnew::message_parser::parse_status::invalid_confirm_ack_message:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_confirm_ack_message);
-					break;
-				case btcnew::message_parser::parse_status::invalid_node_id_handshake_message:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::invalid_node_id_handshake_message);
-					break;
-				case btcnew::message_parser::parse_status::outdated_version:
-					node.stats.inc (btcnew::stat::type::udp, btcnew::stat::detail::outdated_version);
-					break;
-				case btcnew::message_parser::parse_status::success:
-					/* Already checked, unreachable */
-					break;
+				node.stats.add (btcnew::stat::type::traffic_udp, btcnew::stat::dir::in, data_a->size);
 			}
 		}
-		else
-		{
-			node.stats.add (btcnew::stat::type::traffic_udp, btcnew::stat::dir::in, data_a->size);
-		}
 	}
-	else
+	else if (!limited)
 	{
 		if (node.config.logging.network_packet_logging ())
 		{
@@ -558,6 +801,20 @@ void btcnew::transport::udp_channels::receive_action (btcnew::message_buffer * d
 	}
 }
 
+void btcnew::transport::udp_channels::receive_simulated (btcnew::endpoint const & endpoint_a, btcnew::shared_const_buffer const & buffer_a)
+{
+	if (!stopped)
+	{
+		auto data (node.network.buffer_container.allocate ());
+		if (data != nullptr)
+		{
+			data->size = boost::asio::buffer_copy (boost::asio::buffer (data->buffer, btcnew::network::buffer_size), buffer_a);
+			data->endpoint = endpoint_a;
+			node.network.buffer_container.enqueue (data);
+		}
+	}
+}
+
 void btcnew::transport::udp_channels::process_packets ()
 {
 	while (!stopped)
@@ -623,6 +880,7 @@ void btcnew::transport::udp_channels::purge (std::chrono::steady_clock::time_poi
 	btcnew::lock_guard<std::mutex> lock (mutex);
 	auto disconnect_cutoff (channels.get<last_packet_received_tag> ().lower_bound (cutoff_a));
 	channels.get<last_packet_received_tag> ().erase (channels.get<last_packet_received_tag> ().begin (), disconnect_cutoff);
+	snapshot_stale = true;
 	// Remove keepalive attempt tracking for attempts older than cutoff
 	auto attempts_cutoff (attempts.get<1> ().lower_bound (cutoff_a));
 	attempts.get<1> ().erase (attempts.get<1> ().begin (), attempts_cutoff);
@@ -655,11 +913,8 @@ void btcnew::transport::udp_channels::ongoing_keepalive ()
 
 void btcnew::transport::udp_channels::list (std::deque<std::shared_ptr<btcnew::transport::channel>> & deque_a)
 {
-	btcnew::lock_guard<std::mutex> lock (mutex);
-	for (auto i (channels.begin ()), j (channels.end ()); i != j; ++i)
-	{
-		deque_a.push_back (i->channel);
-	}
+	auto peers (snapshot ());
+	deque_a.insert (deque_a.end (), peers->begin (), peers->end ());
 }
 
 void btcnew::transport::udp_channels::modify (std::shared_ptr<btcnew::transport::channel_udp> channel_a, std::function<void (std::shared_ptr<btcnew::transport::channel_udp>)> modify_callback_a)
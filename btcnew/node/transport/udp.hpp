@@ -11,7 +11,9 @@
 #include <boost/multi_index/random_access_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <deque>
 #include <mutex>
+#include <vector>
 
 namespace btcnew
 {
@@ -27,7 +29,7 @@ namespace transport
 		channel_udp (btcnew::transport::udp_channels &, btcnew::endpoint const &, uint8_t protocol_version);
 		size_t hash_code () const override;
 		bool operator== (btcnew::transport::channel const &) const override;
-		void send_buffer (btcnew::shared_const_buffer const &, btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) override;
+		void send_buffer (btcnew::shared_const_buffer const &, btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr, bool const = true) override;
 		std::function<void (boost::system::error_code const &, size_t)> callback (btcnew::stat::detail, std::function<void (boost::system::error_code const &, size_t)> const & = nullptr) const override;
 		std::string to_string () const override;
 		bool operator== (btcnew::transport::channel_udp const & other_a) const
@@ -56,6 +58,7 @@ namespace transport
 		btcnew::endpoint endpoint;
 		btcnew::transport::udp_channels & channels;
 	};
+	class simulated_network;
 	class udp_channels final
 	{
 		friend class btcnew::transport::channel_udp;
@@ -68,6 +71,8 @@ namespace transport
 		std::shared_ptr<btcnew::transport::channel_udp> channel (btcnew::endpoint const &) const;
 		void random_fill (std::array<btcnew::endpoint, 8> &) const;
 		std::unordered_set<std::shared_ptr<btcnew::transport::channel>> random_set (size_t) const;
+		/** Channels at the time of the last membership change, shared by readers without taking the mutex */
+		std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>> const> snapshot () const;
 		bool store_all (bool = true);
 		std::shared_ptr<btcnew::transport::channel_udp> find_node_id (btcnew::account const &);
 		void clean_node_id (btcnew::account const &);
@@ -80,6 +85,8 @@ namespace transport
 		void send (btcnew::shared_const_buffer const & buffer_a, btcnew::endpoint endpoint_a, std::function<void (boost::system::error_code const &, size_t)> const & callback_a);
 		btcnew::endpoint get_local_endpoint () const;
 		void receive_action (btcnew::message_buffer *);
+		/** Queue a datagram delivered by btcnew::transport::simulated_network for processing as if it was read from the socket */
+		void receive_simulated (btcnew::endpoint const &, btcnew::shared_const_buffer const &);
 		void process_packets ();
 		std::shared_ptr<btcnew::transport::channel> create (btcnew::endpoint const &);
 		bool max_ip_connections (btcnew::endpoint const &);
@@ -91,9 +98,30 @@ namespace transport
 		void list (std::deque<std::shared_ptr<btcnew::transport::channel>> &);
 		void modify (std::shared_ptr<btcnew::transport::channel_udp>, std::function<void (std::shared_ptr<btcnew::transport::channel_udp>)>);
 		btcnew::node & node;
+		/** When set, datagrams are sent and received through this in-process network instead of the socket */
+		std::shared_ptr<btcnew::transport::simulated_network> simulated;
+		/** Most datagrams read or written by a single recvmmsg/sendmmsg call */
+		static size_t constexpr max_batch{ 64 };
 
 	private:
 		void close_socket ();
+#ifdef __linux__
+		// Drain readable datagrams with recvmmsg, called from the strand
+		void receive_batch ();
+		// Write queued datagrams with sendmmsg, called from the strand
+		void send_batch (boost::system::error_code const &);
+		class send_entry final
+		{
+		public:
+			btcnew::shared_const_buffer buffer;
+			btcnew::endpoint endpoint;
+			std::function<void (boost::system::error_code const &, size_t)> callback;
+		};
+		// Datagrams waiting for the socket to become writable, guarded by strand
+		std::deque<send_entry> send_queue;
+		bool sending{ false };
+		std::vector<btcnew::message_buffer *> receive_buffers;
+#endif
 		class endpoint_tag
 		{
 		};
@@ -144,6 +172,9 @@ namespace transport
 			std::chrono::steady_clock::time_point last_attempt;
 		};
 		mutable std::mutex mutex;
+		/** Copy on write list of channels, rebuilt by the first reader after \p snapshot_stale is set under \p mutex */
+		mutable std::shared_ptr<std::vector<std::shared_ptr<btcnew::transport::channel>> const> channels_snapshot;
+		mutable std::atomic<bool> snapshot_stale{ true };
 		boost::multi_index_container<
 		channel_udp_wrapper,
 		boost::multi_index::indexed_by<
@@ -2,16 +2,30 @@
 #include <btcnew/node/node.hpp>
 #include <btcnew/node/vote_processor.hpp>
 
+size_t constexpr btcnew::vote_processor::batch_size;
+
+namespace
+{
+/** Votes queued per tier before further votes from that tier are dropped */
+std::array<size_t, 4> constexpr tier_max_votes{ 96 * 1024, 16 * 1024, 16 * 1024, 16 * 1024 };
+/** Votes taken from each tier per scheduling round, higher weight representatives get a larger share */
+std::array<size_t, 4> constexpr tier_shares{ 1, 2, 4, 8 };
+}
+
 btcnew::vote_processor::vote_processor (btcnew::node & node_a) :
 node (node_a),
 started (false),
 stopped (false),
-active (false),
-thread ([this] () {
-	btcnew::thread_role::set (btcnew::thread_role::name::vote_processing);
-	process_loop ();
-})
+active (0)
 {
+	auto threads_count (std::max (1u, node.flags.vote_processor_threads));
+	for (auto i (0u); i < threads_count; ++i)
+	{
+		threads.emplace_back ([this] () {
+			btcnew::thread_role::set (btcnew::thread_role::name::vote_processing);
+			process_loop ();
+		});
+	}
 	btcnew::unique_lock<std::mutex> lock (mutex);
 	condition.wait (lock, [& started = started] { return started; });
 }
@@ -30,10 +44,10 @@ void btcnew::vote_processor::process_loop ()
 
 	while (!stopped)
 	{
-		if (!votes.empty ())
+		if (votes_count > 0)
 		{
 			std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> votes_l;
-			votes_l.swap (votes);
+			take_batch (votes_l);
 
 			log_this_iteration = false;
 			if (node.config.logging.network_logging () && votes_l.size () > 50)
@@ -45,28 +59,26 @@ void btcnew::vote_processor::process_loop ()
 				log_this_iteration = true;
 				elapsed.restart ();
 			}
-			active = true;
+			++active;
 			lock.unlock ();
+			// Signatures are checked without any lock held so threads verify their batches concurrently
 			verify_votes (votes_l);
 			{
-				btcnew::unique_lock<std::mutex> active_single_lock (node.active.mutex);
+				// Votes only lock the election shards they touch, so batches from several threads apply concurrently
 				auto transaction (node.store.tx_begin_read ());
 				uint64_t count (1);
 				for (auto & i : votes_l)
 				{
 					vote_blocking (transaction, i.first, i.second, true);
-					// Free active_transactions mutex each 100 processed votes
 					if (count % 100 == 0)
 					{
-						active_single_lock.unlock ();
 						transaction.refresh ();
-						active_single_lock.lock ();
 					}
 					count++;
 				}
 			}
 			lock.lock ();
-			active = false;
+			--active;
 
 			lock.unlock ();
 			condition.notify_all ();
@@ -84,50 +96,66 @@ void btcnew::vote_processor::process_loop ()
 	}
 }
 
-void btcnew::vote_processor::vote (std::shared_ptr<btcnew::vote> vote_a, std::shared_ptr<btcnew::transport::channel> channel_a)
+void btcnew::vote_processor::take_batch (std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> & votes_a)
 {
-	btcnew::unique_lock<std::mutex> lock (mutex);
-	if (!stopped)
+	assert (!mutex.try_lock ());
+	// Weighted round robin over tiers, and round robin over the representatives within a tier, so a flood of votes from one representative or from low weight accounts only delays itself
+	while (votes_count > 0 && votes_a.size () < batch_size)
 	{
-		bool process (false);
-		/* Random early delection levels
-		 Always process votes for test network (process = true)
-		 Stop processing with max 144 * 1024 votes */
-		if (!node.network_params.network.is_test_network ())
+		for (auto tier_l (tiers); tier_l-- > 0 && votes_a.size () < batch_size;)
 		{
-			// Level 0 (< 0.1%)
-			if (votes.size () < 96 * 1024)
-			{
-				process = true;
-			}
-			// Level 1 (0.1-1%)
-			else if (votes.size () < 112 * 1024)
-			{
-				process = (representatives_1.find (vote_a->account) != representatives_1.end ());
-			}
-			// Level 2 (1-5%)
-			else if (votes.size () < 128 * 1024)
-			{
-				process = (representatives_2.find (vote_a->account) != representatives_2.end ());
-			}
-			// Level 3 (> 5%)
-			else if (votes.size () < 144 * 1024)
+			auto & tier_queue_l (tier_queues[tier_l]);
+			for (size_t i (0); i < tier_shares[tier_l] && !tier_queue_l.ready.empty () && votes_a.size () < batch_size; ++i)
 			{
-				process = (representatives_3.find (vote_a->account) != representatives_3.end ());
+				auto representative (tier_queue_l.ready.front ());
+				tier_queue_l.ready.pop_front ();
+				auto existing (queues.find (representative));
+				assert (existing != queues.end ());
+				auto & queue_l (existing->second);
+				votes_a.push_back (std::move (queue_l.votes.front ()));
+				queue_l.votes.pop_front ();
+				--tier_queue_l.votes;
+				--votes_count;
+				if (queue_l.votes.empty ())
+				{
+					queues.erase (existing);
+				}
+				else
+				{
+					tier_queue_l.ready.push_back (representative);
+				}
 			}
 		}
-		else
-		{
-			// Process for test network
-			process = true;
-		}
-		if (process)
-		{
-			votes.push_back (std::make_pair (vote_a, channel_a));
+	}
+}
 
+size_t btcnew::vote_processor::tier (btcnew::account const & representative_a) const
+{
+	size_t result (0);
+	if (representatives_3.find (representative_a) != representatives_3.end ())
+	{
+		result = 3;
+	}
+	else if (representatives_2.find (representative_a) != representatives_2.end ())
+	{
+		result = 2;
+	}
+	else if (representatives_1.find (representative_a) != representatives_1.end ())
+	{
+		result = 1;
+	}
+	return result;
+}
+
+void btcnew::vote_processor::vote (std::shared_ptr<btcnew::vote> vote_a, std::shared_ptr<btcnew::transport::channel> channel_a)
+{
+	btcnew::unique_lock<std::mutex> lock (mutex);
+	if (!stopped)
+	{
+		if (enqueue (vote_a, channel_a))
+		{
 			lock.unlock ();
 			condition.notify_all ();
-			lock.lock ();
 		}
 		else
 		{
@@ -136,6 +164,29 @@ void btcnew::vote_processor::vote (std::shared_ptr<btcnew::vote> vote_a, std::sh
 	}
 }
 
+bool btcnew::vote_processor::enqueue (std::shared_ptr<btcnew::vote> vote_a, std::shared_ptr<btcnew::transport::channel> channel_a)
+{
+	assert (!mutex.try_lock ());
+	/* Each tier has its own limit so votes from high weight representatives are never dropped because of spam from low weight ones
+	 Always process votes for test network */
+	auto existing (queues.find (vote_a->account));
+	auto tier_l (existing != queues.end () ? existing->second.tier : tier (vote_a->account));
+	auto & tier_queue_l (tier_queues[tier_l]);
+	auto result (tier_queue_l.votes < tier_max_votes[tier_l] || node.network_params.network.is_test_network ());
+	if (result)
+	{
+		if (existing == queues.end ())
+		{
+			existing = queues.emplace (vote_a->account, representative_queue{ {}, tier_l }).first;
+			tier_queue_l.ready.push_back (vote_a->account);
+		}
+		existing->second.votes.emplace_back (vote_a, channel_a);
+		++tier_queue_l.votes;
+		++votes_count;
+	}
+	return result;
+}
+
 void btcnew::vote_processor::verify_votes (std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> & votes_a)
 {
 	auto size (votes_a.size ());
@@ -168,21 +219,23 @@ void btcnew::vote_processor::verify_votes (std::deque<std::pair<std::shared_ptr<
 		{
 			result.push_back (vote);
 		}
+		else if (vote.second != nullptr)
+		{
+			node.network.peer_limiter.penalize (vote.second->get_endpoint (), vote.second->get_type (), btcnew::transport::penalty_reason::invalid_signature);
+		}
 		++i;
 	}
 	votes_a.swap (result);
 }
 
-// node.active.mutex lock required
 btcnew::vote_code btcnew::vote_processor::vote_blocking (btcnew::transaction const & transaction_a, std::shared_ptr<btcnew::vote> vote_a, std::shared_ptr<btcnew::transport::channel> channel_a, bool validated)
 {
-	assert (!node.active.mutex.try_lock ());
 	auto result (btcnew::vote_code::invalid);
 	if (validated || !vote_a->validate ())
 	{
 		auto max_vote (node.store.vote_max (transaction_a, vote_a));
 		result = btcnew::vote_code::replay;
-		if (!node.active.vote (vote_a, true))
+		if (!node.active.vote (vote_a))
 		{
 			result = btcnew::vote_code::vote;
 		}
@@ -211,6 +264,10 @@ btcnew::vote_code btcnew::vote_processor::vote_blocking (btcnew::transaction con
 		case btcnew::vote_code::invalid:
 			status = "Invalid";
 			node.stats.inc (btcnew::stat::type::vote, btcnew::stat::detail::vote_invalid);
+			if (channel_a != nullptr)
+			{
+				node.network.peer_limiter.penalize (channel_a->get_endpoint (), channel_a->get_type (), btcnew::transport::penalty_reason::invalid_signature);
+			}
 			break;
 		case btcnew::vote_code::replay:
 			status = "Replay";
@@ -235,21 +292,30 @@ void btcnew::vote_processor::stop ()
 		stopped = true;
 	}
 	condition.notify_all ();
-	if (thread.joinable ())
+	for (auto & thread : threads)
 	{
-		thread.join ();
+		if (thread.joinable ())
+		{
+			thread.join ();
+		}
 	}
 }
 
 void btcnew::vote_processor::flush ()
 {
 	btcnew::unique_lock<std::mutex> lock (mutex);
-	while (active || !votes.empty ())
+	while (active > 0 || votes_count > 0)
 	{
 		condition.wait (lock);
 	}
 }
 
+size_t btcnew::vote_processor::size ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return votes_count;
+}
+
 void btcnew::vote_processor::calculate_weights ()
 {
 	btcnew::unique_lock<std::mutex> lock (mutex);
@@ -285,20 +351,23 @@ namespace btcnew
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (vote_processor & vote_processor, const std::string & name)
 {
 	size_t votes_count = 0;
+	size_t queues_count = 0;
 	size_t representatives_1_count = 0;
 	size_t representatives_2_count = 0;
 	size_t representatives_3_count = 0;
 
 	{
 		btcnew::lock_guard<std::mutex> guard (vote_processor.mutex);
-		votes_count = vote_processor.votes.size ();
+		votes_count = vote_processor.votes_count;
+		queues_count = vote_processor.queues.size ();
 		representatives_1_count = vote_processor.representatives_1.size ();
 		representatives_2_count = vote_processor.representatives_2.size ();
 		representatives_3_count = vote_processor.representatives_3.size ();
 	}
 
 	auto composite = std::make_unique<seq_con_info_composite> (name);
-	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "votes", votes_count, sizeof (decltype (vote_processor.votes)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "votes", votes_count, sizeof (std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "queues", queues_count, sizeof (decltype (vote_processor.queues)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "representatives_1", representatives_1_count, sizeof (decltype (vote_processor.representatives_1)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "representatives_2", representatives_2_count, sizeof (decltype (vote_processor.representatives_2)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "representatives_3", representatives_3_count, sizeof (decltype (vote_processor.representatives_3)::value_type) }));
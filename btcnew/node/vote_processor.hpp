@@ -6,10 +6,13 @@
 
 #include <boost/thread/thread.hpp>
 
+#include <array>
 #include <deque>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace btcnew
 {
@@ -25,18 +28,41 @@ class vote_processor final
 public:
 	explicit vote_processor (btcnew::node &);
 	void vote (std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>);
-	/** Note: node.active.mutex lock is required */
+	/** Note: node.active.mutex must not be held, votes lock the election shards they apply to */
 	btcnew::vote_code vote_blocking (btcnew::transaction const &, std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>, bool = false);
 	void verify_votes (std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> &);
 	void flush ();
 	void calculate_weights ();
+	size_t size ();
 	btcnew::node & node;
 	void stop ();
+	/** Maximum number of votes taken by a processing thread at once */
+	static size_t constexpr batch_size{ 1024 };
 
 private:
+	/** Representatives are grouped in tiers by weight, 0 below 0.1% of online stake up to 3 at 5% or above */
+	static size_t constexpr tiers{ 4 };
+	class representative_queue final
+	{
+	public:
+		std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> votes;
+		size_t tier;
+	};
+	class tier_queue final
+	{
+	public:
+		/** Representatives with queued votes, served round robin */
+		std::deque<btcnew::account> ready;
+		size_t votes{ 0 };
+	};
 	void process_loop ();
-	std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> votes;
-	/** Representatives levels for random early detection */
+	size_t tier (btcnew::account const &) const;
+	bool enqueue (std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>);
+	void take_batch (std::deque<std::pair<std::shared_ptr<btcnew::vote>, std::shared_ptr<btcnew::transport::channel>>> &);
+	std::unordered_map<btcnew::account, representative_queue> queues;
+	std::array<tier_queue, tiers> tier_queues;
+	size_t votes_count{ 0 };
+	/** Representatives levels for queue tiers */
 	std::unordered_set<btcnew::account> representatives_1;
 	std::unordered_set<btcnew::account> representatives_2;
 	std::unordered_set<btcnew::account> representatives_3;
@@ -44,10 +70,12 @@ private:
 	std::mutex mutex;
 	bool started;
 	bool stopped;
-	bool active;
-	boost::thread thread;
+	/** Number of threads processing a batch */
+	unsigned active;
+	std::vector<boost::thread> threads;
 
 	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (vote_processor & vote_processor, const std::string & name);
+	friend class vote_processor_fair_queue_Test;
 };
 
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (vote_processor & vote_processor, const std::string & name);
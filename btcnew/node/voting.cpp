@@ -2,11 +2,16 @@
 #include <btcnew/node/voting.hpp>
 
 #include <chrono>
+#include <limits>
 
 btcnew::vote_generator::vote_generator (btcnew::node & node_a) :
 node (node_a),
+min_delay (std::max (std::chrono::steady_clock::duration (std::chrono::milliseconds (1)), std::chrono::steady_clock::duration (node_a.config.vote_generator_delay) / 20)),
+current_delay (node_a.config.vote_generator_delay),
 thread ([this] () { run (); })
 {
+	node.stats.define_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, { 1, btcnew::network::confirm_ack_hashes_max + 1 }, btcnew::network::confirm_ack_hashes_max);
+	node.stats.define_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_queue_delay, btcnew::stat::dir::out, { 0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, std::numeric_limits<uint64_t>::max () });
 	btcnew::unique_lock<std::mutex> lock (mutex);
 	condition.wait (lock, [& started = started] { return started; });
 }
@@ -14,14 +19,33 @@ thread ([this] () { run (); })
 void btcnew::vote_generator::add (btcnew::block_hash const & hash_a)
 {
 	btcnew::unique_lock<std::mutex> lock (mutex);
-	hashes.push_back (hash_a);
-	if (hashes.size () >= 12)
+	hashes.emplace_back (hash_a, std::chrono::steady_clock::now ());
+	// Wake up to start the delay for the first hash, or to send a full vote
+	if (hashes.size () == 1 || hashes.size () >= btcnew::network::confirm_ack_hashes_max)
 	{
 		lock.unlock ();
 		condition.notify_all ();
 	}
 }
 
+std::vector<std::shared_ptr<btcnew::vote>> btcnew::vote_generator::generate (btcnew::transaction const & transaction_a, std::vector<btcnew::block_hash> const & hashes_a)
+{
+	std::vector<std::shared_ptr<btcnew::vote>> result;
+	size_t const max_hashes (btcnew::network::confirm_ack_hashes_max);
+	for (auto i (hashes_a.begin ()), n (hashes_a.end ()); i != n;)
+	{
+		auto end (i + std::min<size_t> (n - i, max_hashes));
+		std::vector<btcnew::block_hash> hashes_l (i, end);
+		node.wallets.foreach_representative ([this, &result, &hashes_l, &transaction_a] (btcnew::public_key const & pub_a, btcnew::raw_key const & prv_a) {
+			auto vote (this->node.store.vote_generate (transaction_a, pub_a, prv_a, hashes_l));
+			this->node.votes_cache.add (vote);
+			result.push_back (vote);
+		});
+		i = end;
+	}
+	return result;
+}
+
 void btcnew::vote_generator::stop ()
 {
 	btcnew::unique_lock<std::mutex> lock (mutex);
@@ -36,15 +60,68 @@ void btcnew::vote_generator::stop ()
 	}
 }
 
+void btcnew::vote_generator::confirmation_latency (std::chrono::milliseconds const & latency_a)
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	latency = latency.count () == 0 ? std::chrono::steady_clock::duration (latency_a) : (latency * 7 + latency_a) / 8;
+}
+
+std::chrono::steady_clock::duration btcnew::vote_generator::delay ()
+{
+	btcnew::lock_guard<std::mutex> lock (mutex);
+	return current_delay;
+}
+
+std::chrono::steady_clock::duration btcnew::vote_generator::max_delay () const
+{
+	std::chrono::steady_clock::duration result (node.config.vote_generator_delay);
+	if (latency.count () > 0)
+	{
+		result = std::max (min_delay, std::min (result, latency / 4));
+	}
+	return result;
+}
+
+void btcnew::vote_generator::update_delay (size_t batch_size_a, std::chrono::steady_clock::duration const & waited_a)
+{
+	assert (batch_size_a > 0);
+	auto max_delay_l (max_delay ());
+	auto target (max_delay_l);
+	if (batch_size_a < btcnew::network::confirm_ack_hashes_max)
+	{
+		// The oldest hash started the wait, project how many would be bundled within the longest delay at the rate the others arrived
+		auto waited_l (std::max (waited_a, min_delay));
+		auto projected (1 + (batch_size_a - 1) * std::chrono::duration<double> (max_delay_l).count () / std::chrono::duration<double> (waited_l).count ());
+		if (batch_size_a == 1 || projected < node.config.vote_generator_threshold)
+		{
+			// Too few hashes arrive for holding them back to save votes, vote for them with low latency
+			target = min_delay;
+		}
+		else
+		{
+			// Hold hashes about as long as it takes to fill a vote
+			auto remaining (static_cast<std::chrono::steady_clock::rep> (btcnew::network::confirm_ack_hashes_max - 1));
+			target = std::min (max_delay_l, waited_l * remaining / static_cast<std::chrono::steady_clock::rep> (batch_size_a - 1));
+		}
+	}
+	// Under load votes fill up before the delay ends so keeping it long costs no latency
+	current_delay = std::max (min_delay, std::min (max_delay_l, (current_delay * 3 + target) / 4));
+}
+
 void btcnew::vote_generator::send (btcnew::unique_lock<std::mutex> & lock_a)
 {
+	auto now (std::chrono::steady_clock::now ());
+	auto waited (now - hashes.front ().second);
 	std::vector<btcnew::block_hash> hashes_l;
-	hashes_l.reserve (12);
-	while (!hashes.empty () && hashes_l.size () < 12)
+	hashes_l.reserve (btcnew::network::confirm_ack_hashes_max);
+	while (!hashes.empty () && hashes_l.size () < btcnew::network::confirm_ack_hashes_max)
 	{
-		hashes_l.push_back (hashes.front ());
+		hashes_l.push_back (hashes.front ().first);
+		node.stats.update_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_queue_delay, btcnew::stat::dir::out, std::chrono::duration_cast<std::chrono::milliseconds> (now - hashes.front ().second).count ());
 		hashes.pop_front ();
 	}
+	update_delay (hashes_l.size (), waited);
+	node.stats.update_histogram (btcnew::stat::type::vote_generator, btcnew::stat::detail::generator_batch_size, btcnew::stat::dir::out, hashes_l.size ());
 	lock_a.unlock ();
 	{
 		auto transaction (node.store.tx_begin_read ());
@@ -67,54 +144,70 @@ void btcnew::vote_generator::run ()
 	lock.lock ();
 	while (!stopped)
 	{
-		if (hashes.size () >= 12)
+		if (hashes.size () >= btcnew::network::confirm_ack_hashes_max)
 		{
 			send (lock);
 		}
-		else
+		else if (!hashes.empty ())
 		{
-			condition.wait_for (lock, node.config.vote_generator_delay, [this] () { return this->hashes.size () >= 12; });
-			if (hashes.size () >= node.config.vote_generator_threshold && hashes.size () < 12)
+			// Hold back the oldest hash for the current delay to let the vote fill up
+			auto deadline (hashes.front ().second + current_delay);
+			if (std::chrono::steady_clock::now () < deadline)
 			{
-				condition.wait_for (lock, node.config.vote_generator_delay, [this] () { return this->hashes.size () >= 12; });
+				condition.wait_until (lock, deadline, [this] () { return this->stopped || this->hashes.size () >= btcnew::network::confirm_ack_hashes_max; });
 			}
-			if (!hashes.empty ())
+			else
 			{
 				send (lock);
 			}
 		}
+		else
+		{
+			condition.wait (lock);
+		}
+	}
+}
+
+btcnew::votes_cache::votes_cache (size_t max_bytes_a, size_t stripes_a) :
+stripe_max_bytes (max_bytes_a / std::max<size_t> (stripes_a, 1))
+{
+	for (auto i (std::max<size_t> (stripes_a, 1)); i > 0; --i)
+	{
+		stripes.push_back (std::make_unique<stripe> ());
 	}
 }
 
 void btcnew::votes_cache::add (std::shared_ptr<btcnew::vote> const & vote_a)
 {
-	btcnew::lock_guard<std::mutex> lock (cache_mutex);
+	auto share (vote_share (*vote_a));
 	for (auto & block : vote_a->blocks)
 	{
 		auto hash (boost::get<btcnew::block_hash> (block));
-		auto existing (cache.get<1> ().find (hash));
-		if (existing == cache.get<1> ().end ())
+		auto & stripe_l (stripe_for (hash));
+		btcnew::lock_guard<std::mutex> lock (stripe_l.mutex);
+		auto existing (stripe_l.cache.get<1> ().find (hash));
+		if (existing == stripe_l.cache.get<1> ().end ())
 		{
-			// Clean old votes
-			if (cache.size () >= network_params.voting.max_cache)
-			{
-				cache.erase (cache.begin ());
-			}
 			// Insert new votes (new hash)
-			auto inserted (cache.insert (btcnew::cached_votes{ std::chrono::steady_clock::now (), hash, std::vector<std::shared_ptr<btcnew::vote>> (1, vote_a) }));
+			auto bytes_l (entry_bytes (*vote_a));
+			auto inserted (stripe_l.cache.push_back (btcnew::cached_votes{ hash, std::vector<std::shared_ptr<btcnew::vote>> (1, vote_a), bytes_l }));
 			(void)inserted;
 			assert (inserted.second);
+			stripe_l.bytes += bytes_l;
 		}
 		else
 		{
 			// Insert new votes (old hash)
-			cache.get<1> ().modify (existing, [vote_a] (btcnew::cached_votes & cache_a) {
+			stripe_l.cache.get<1> ().modify (existing, [&vote_a, share, &stripe_l] (btcnew::cached_votes & cache_a) {
 				// Replace old vote for same representative & hash
 				bool replaced (false);
 				for (auto i (cache_a.votes.begin ()), n (cache_a.votes.end ()); i != n && !replaced; ++i)
 				{
 					if ((*i)->account == vote_a->account)
 					{
+						auto old_share (vote_share (**i));
+						cache_a.bytes = cache_a.bytes - old_share + share;
+						stripe_l.bytes = stripe_l.bytes - old_share + share;
 						*i = vote_a;
 						replaced = true;
 					}
@@ -123,28 +216,86 @@ void btcnew::votes_cache::add (std::shared_ptr<btcnew::vote> const & vote_a)
 				if (!replaced)
 				{
 					cache_a.votes.push_back (vote_a);
+					cache_a.bytes += share;
+					stripe_l.bytes += share;
 				}
 			});
 		}
+		// Clean old votes
+		while (stripe_l.bytes > stripe_max_bytes && stripe_l.cache.size () > 1)
+		{
+			stripe_l.bytes -= stripe_l.cache.front ().bytes;
+			stripe_l.cache.pop_front ();
+		}
 	}
 }
 
 std::vector<std::shared_ptr<btcnew::vote>> btcnew::votes_cache::find (btcnew::block_hash const & hash_a)
 {
 	std::vector<std::shared_ptr<btcnew::vote>> result;
-	btcnew::lock_guard<std::mutex> lock (cache_mutex);
-	auto existing (cache.get<1> ().find (hash_a));
-	if (existing != cache.get<1> ().end ())
 	{
-		result = existing->votes;
+		auto & stripe_l (stripe_for (hash_a));
+		btcnew::lock_guard<std::mutex> lock (stripe_l.mutex);
+		auto existing (stripe_l.cache.get<1> ().find (hash_a));
+		if (existing != stripe_l.cache.get<1> ().end ())
+		{
+			result = existing->votes;
+		}
 	}
+	++(result.empty () ? misses : hits);
 	return result;
 }
 
 void btcnew::votes_cache::remove (btcnew::block_hash const & hash_a)
 {
-	btcnew::lock_guard<std::mutex> lock (cache_mutex);
-	cache.get<1> ().erase (hash_a);
+	auto & stripe_l (stripe_for (hash_a));
+	btcnew::lock_guard<std::mutex> lock (stripe_l.mutex);
+	auto existing (stripe_l.cache.get<1> ().find (hash_a));
+	if (existing != stripe_l.cache.get<1> ().end ())
+	{
+		stripe_l.bytes -= existing->bytes;
+		stripe_l.cache.get<1> ().erase (existing);
+	}
+}
+
+size_t btcnew::votes_cache::size ()
+{
+	size_t result (0);
+	for (auto & stripe_l : stripes)
+	{
+		btcnew::lock_guard<std::mutex> lock (stripe_l->mutex);
+		result += stripe_l->cache.size ();
+	}
+	return result;
+}
+
+size_t btcnew::votes_cache::bytes ()
+{
+	size_t result (0);
+	for (auto & stripe_l : stripes)
+	{
+		btcnew::lock_guard<std::mutex> lock (stripe_l->mutex);
+		result += stripe_l->bytes;
+	}
+	return result;
+}
+
+size_t btcnew::votes_cache::entry_bytes (btcnew::vote const & vote_a)
+{
+	// Node overhead of both indices is approximated as four pointers
+	return sizeof (btcnew::cached_votes) + 4 * sizeof (void *) + vote_share (vote_a);
+}
+
+btcnew::votes_cache::stripe & btcnew::votes_cache::stripe_for (btcnew::block_hash const & hash_a)
+{
+	return *stripes[hash_a.qwords[1] % stripes.size ()];
+}
+
+size_t btcnew::votes_cache::vote_share (btcnew::vote const & vote_a)
+{
+	// Every hash covered by the vote is charged an equal part of it, so the vote is counted once in total
+	auto vote_bytes (sizeof (btcnew::vote) + vote_a.blocks.size () * sizeof (decltype (vote_a.blocks)::value_type));
+	return sizeof (std::shared_ptr<btcnew::vote>) + vote_bytes / std::max<size_t> (vote_a.blocks.size (), 1);
 }
 
 namespace btcnew
@@ -165,16 +316,11 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (vote_generator & v
 
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (votes_cache & votes_cache, const std::string & name)
 {
-	size_t cache_count = 0;
-
-	{
-		btcnew::lock_guard<std::mutex> guard (votes_cache.cache_mutex);
-		cache_count = votes_cache.cache.size ();
-	}
-	auto sizeof_element = sizeof (decltype (votes_cache.cache)::value_type);
 	auto composite = std::make_unique<seq_con_info_composite> (name);
-	/* This does not currently loop over each element inside the cache to get the sizes of the votes inside cached_votes */
-	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "cache", cache_count, sizeof_element }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "cache", votes_cache.size (), sizeof (btcnew::cached_votes) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "bytes", votes_cache.bytes (), 1 }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "hits", votes_cache.hits, 0 }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "misses", votes_cache.misses, 0 }));
 	return composite;
 }
 }
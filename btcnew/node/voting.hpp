@@ -9,9 +9,11 @@
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/random_access_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/thread.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -19,52 +21,91 @@
 namespace btcnew
 {
 class node;
+class transaction;
 class vote_generator final
 {
 public:
 	vote_generator (btcnew::node &);
 	void add (btcnew::block_hash const &);
+	/** Generate and cache votes for \p hashes_a from every local representative, in batches of the most hashes a vote can hold */
+	std::vector<std::shared_ptr<btcnew::vote>> generate (btcnew::transaction const & transaction_a, std::vector<btcnew::block_hash> const & hashes_a);
+	/** Record how long an election took to reach quorum, hashes are never held back for a large part of it */
+	void confirmation_latency (std::chrono::milliseconds const &);
+	/** Current time the oldest queued hash is held for while a vote fills up */
+	std::chrono::steady_clock::duration delay ();
 	void stop ();
 
 private:
 	void run ();
 	void send (btcnew::unique_lock<std::mutex> &);
+	/** Adapt the delay to the size of the last batch and how long its oldest hash waited */
+	void update_delay (size_t, std::chrono::steady_clock::duration const &);
+	/** Longest delay allowed, the configured delay bounded by a quarter of the observed confirmation latency */
+	std::chrono::steady_clock::duration max_delay () const;
 	btcnew::node & node;
 	std::mutex mutex;
 	btcnew::condition_variable condition;
-	std::deque<btcnew::block_hash> hashes;
+	/** Queued hashes and the time they were added */
+	std::deque<std::pair<btcnew::block_hash, std::chrono::steady_clock::time_point>> hashes;
 	btcnew::network_params network_params;
+	std::chrono::steady_clock::duration const min_delay;
+	std::chrono::steady_clock::duration current_delay;
+	/** Moving average of the time elections take to reach quorum, zero until one is observed */
+	std::chrono::steady_clock::duration latency{ 0 };
 	bool stopped{ false };
 	bool started{ false };
 	boost::thread thread;
 
 	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (vote_generator & vote_generator, const std::string & name);
+	friend class vote_generator_adaptive_delay_Test;
 };
 
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (vote_generator & vote_generator, const std::string & name);
 class cached_votes final
 {
 public:
-	std::chrono::steady_clock::time_point time;
 	btcnew::block_hash hash;
 	std::vector<std::shared_ptr<btcnew::vote>> votes;
+	/** Memory charged for this entry, its own overhead and a share of every vote it references */
+	size_t bytes;
 };
+/**
+ * Votes generated by this node, indexed by every hash they cover so confirm_req can be answered without signing again.
+ * A vote is stored once and referenced from each of its hashes, which are charged an equal share of its size.
+ * Hashes are spread over independently locked stripes, each evicting its oldest entries when over its share of the byte budget.
+ */
 class votes_cache final
 {
 public:
+	votes_cache (size_t max_bytes_a, size_t stripes_a);
 	void add (std::shared_ptr<btcnew::vote> const &);
 	std::vector<std::shared_ptr<btcnew::vote>> find (btcnew::block_hash const &);
 	void remove (btcnew::block_hash const &);
+	size_t size ();
+	/** Estimated memory used by entries and the votes they reference */
+	size_t bytes ();
+	/** Estimated memory used by a cache entry for a hash in \p vote_a, when it is the only vote referenced */
+	static size_t entry_bytes (btcnew::vote const & vote_a);
 
 private:
-	std::mutex cache_mutex;
-	boost::multi_index_container<
-	btcnew::cached_votes,
-	boost::multi_index::indexed_by<
-	boost::multi_index::ordered_non_unique<boost::multi_index::member<btcnew::cached_votes, std::chrono::steady_clock::time_point, &btcnew::cached_votes::time>>,
-	boost::multi_index::hashed_unique<boost::multi_index::member<btcnew::cached_votes, btcnew::block_hash, &btcnew::cached_votes::hash>>>>
-	cache;
-	btcnew::network_params network_params;
+	class stripe final
+	{
+	public:
+		std::mutex mutex;
+		boost::multi_index_container<
+		btcnew::cached_votes,
+		boost::multi_index::indexed_by<
+		boost::multi_index::sequenced<>,
+		boost::multi_index::hashed_unique<boost::multi_index::member<btcnew::cached_votes, btcnew::block_hash, &btcnew::cached_votes::hash>>>>
+		cache;
+		size_t bytes{ 0 };
+	};
+	stripe & stripe_for (btcnew::block_hash const &);
+	static size_t vote_share (btcnew::vote const &);
+	std::vector<std::unique_ptr<stripe>> stripes;
+	size_t const stripe_max_bytes;
+	std::atomic<uint64_t> hits{ 0 };
+	std::atomic<uint64_t> misses{ 0 };
 	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (votes_cache & votes_cache, const std::string & name);
 };
 
@@ -1453,9 +1453,9 @@ void btcnew::work_watcher::watching (btcnew::qualified_root const & root_a, std:
 								{
 									{
 										auto hash (block_a->hash ());
-										btcnew::lock_guard<std::mutex> active_guard (watcher_l->node.active.mutex);
-										auto existing (watcher_l->node.active.roots.find (root_a));
-										if (existing != watcher_l->node.active.roots.end ())
+										btcnew::lock_guard<btcnew::elections_mutex> active_guard (watcher_l->node.active.mutex);
+										auto existing (watcher_l->node.active.find_root (root_a));
+										if (existing != nullptr)
 										{
 											auto election (existing->election);
 											if (election->status.winner->hash () == hash)
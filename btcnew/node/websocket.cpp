@@ -331,6 +331,14 @@ btcnew::websocket::topic to_topic (std::string const & topic_a)
 	{
 		topic = btcnew::websocket::topic::work;
 	}
+	else if (topic_a == "latency")
+	{
+		topic = btcnew::websocket::topic::latency;
+	}
+	else if (topic_a == "message_stats")
+	{
+		topic = btcnew::websocket::topic::message_stats;
+	}
 
 	return topic;
 }
@@ -362,6 +370,14 @@ std::string from_topic (btcnew::websocket::topic topic_a)
 	{
 		topic = "work";
 	}
+	else if (topic_a == btcnew::websocket::topic::latency)
+	{
+		topic = "latency";
+	}
+	else if (topic_a == btcnew::websocket::topic::message_stats)
+	{
+		topic = "message_stats";
+	}
 	return topic;
 }
 }
@@ -677,6 +693,31 @@ btcnew::websocket::message btcnew::websocket::message_builder::difficulty_change
 	return message_l;
 }
 
+btcnew::websocket::message btcnew::websocket::message_builder::latency (btcnew::latency_tracker & latency_tracker_a)
+{
+	btcnew::websocket::message message_l (btcnew::websocket::topic::latency);
+	set_common_fields (message_l);
+
+	// Milliseconds spent reaching each stage since the previous one
+	boost::property_tree::ptree latency_l;
+	latency_tracker_a.serialize_json (latency_l);
+
+	message_l.contents.add_child ("message", latency_l);
+	return message_l;
+}
+
+btcnew::websocket::message btcnew::websocket::message_builder::message_stats (btcnew::message_histograms & message_histograms_a)
+{
+	btcnew::websocket::message message_l (btcnew::websocket::topic::message_stats);
+	set_common_fields (message_l);
+
+	boost::property_tree::ptree message_stats_l;
+	message_histograms_a.serialize_json (message_stats_l);
+
+	message_l.contents.add_child ("message", message_stats_l);
+	return message_l;
+}
+
 btcnew::websocket::message btcnew::websocket::message_builder::work_generation (btcnew::block_hash const & root_a, uint64_t work_a, uint64_t difficulty_a, uint64_t publish_threshold_a, std::chrono::milliseconds const & duration_a, std::string const & peer_a, std::vector<std::string> const & bad_peers_a, bool completed_a, bool cancelled_a)
 {
 	btcnew::websocket::message message_l (btcnew::websocket::topic::work);
@@ -32,6 +32,8 @@ using socket_type = boost::asio::basic_stream_socket<boost::asio::ip::tcp, boost
 namespace btcnew
 {
 class node;
+class latency_tracker;
+class message_histograms;
 enum class election_status_type : uint8_t;
 namespace websocket
 {
@@ -54,6 +56,10 @@ namespace websocket
 		active_difficulty,
 		/** Work generation message */
 		work,
+		/** Block latency percentiles per stage, sent periodically */
+		latency,
+		/** Size and processing time percentiles per message type and transport, sent periodically */
+		message_stats,
 		/** Auxiliary length, not a valid topic, must be the last enum */
 		_length
 	};
@@ -85,6 +91,8 @@ namespace websocket
 		message stopped_election (btcnew::block_hash const & hash_a);
 		message vote_received (std::shared_ptr<btcnew::vote> vote_a);
 		message difficulty_changed (uint64_t publish_threshold_a, uint64_t difficulty_active_a);
+		message latency (btcnew::latency_tracker & latency_tracker_a);
+		message message_stats (btcnew::message_histograms & message_histograms_a);
 		message work_generation (btcnew::block_hash const & root_a, uint64_t const work_a, uint64_t const difficulty_a, uint64_t const publish_threshold_a, std::chrono::milliseconds const & duration_a, std::string const & peer_a, std::vector<std::string> const & bad_peers_a, bool const completed_a = true, bool const cancelled_a = false);
 		message work_cancelled (btcnew::block_hash const & root_a, uint64_t const difficulty_a, uint64_t const publish_threshold_a, std::chrono::milliseconds const & duration_a, std::vector<std::string> const & bad_peers_a);
 		message work_failed (btcnew::block_hash const & root_a, uint64_t const difficulty_a, uint64_t const publish_threshold_a, std::chrono::milliseconds const & duration_a, std::vector<std::string> const & bad_peers_a);
@@ -13,6 +13,7 @@ enum class writer
 {
 	confirmation_height,
 	process_batch,
+	voting,
 	testing // Used in tests to emulate a write lock
 };
 
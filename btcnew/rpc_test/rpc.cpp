@@ -1815,16 +1815,16 @@ TEST (rpc, process_block_with_work_watcher)
 	uint64_t updated_difficulty;
 	while (!updated)
 	{
-		btcnew::unique_lock<std::mutex> lock (node1.active.mutex);
+		std::unique_lock<btcnew::elections_mutex> lock (node1.active.mutex);
 		//fill multipliers_cb and update active difficulty;
 		for (auto i (0); i < node1.active.multipliers_cb.size (); i++)
 		{
 			node1.active.multipliers_cb.push_back (multiplier1 * (1 + i / 100.));
 		}
 		node1.active.update_active_difficulty (lock);
-		auto const existing (node1.active.roots.find (send->qualified_root ()));
+		auto const existing (node1.active.find_root (send->qualified_root ()));
 		//if existing is junk the block has been confirmed already
-		ASSERT_NE (existing, node1.active.roots.end ());
+		ASSERT_NE (existing, nullptr);
 		updated = existing->difficulty != difficulty1;
 		updated_difficulty = existing->difficulty;
 		lock.unlock ();
@@ -7062,7 +7062,7 @@ TEST (rpc, active_difficulty)
 	rpc.start ();
 	boost::property_tree::ptree request;
 	request.put ("action", "active_difficulty");
-	btcnew::unique_lock<std::mutex> lock (node->active.mutex);
+	std::unique_lock<btcnew::elections_mutex> lock (node->active.mutex);
 	node->active.multipliers_cb.push_front (1.5);
 	node->active.multipliers_cb.push_front (4.2);
 	// Also pushes 1.0 to the front of multipliers_cb
@@ -7121,6 +7121,141 @@ TEST (rpc, active_difficulty)
 }
 
 // This is mainly to check for threading issues with TSAN
+TEST (rpc, election_scheduler)
+{
+	btcnew::system system (24000, 1);
+	auto node = system.nodes.front ();
+	scoped_io_thread_name_change scoped_thread_name_io;
+	enable_ipc_transport_tcp (node->config.ipc_config.transport_tcp);
+	btcnew::node_rpc_config node_rpc_config;
+	btcnew::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	btcnew::rpc_config rpc_config (true);
+	btcnew::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	btcnew::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	btcnew::genesis genesis;
+	auto send (std::make_shared<btcnew::state_block> (btcnew::test_genesis_key.pub, genesis.hash (), btcnew::test_genesis_key.pub, btcnew::genesis_amount - btcnew::Gbtcnew_ratio, btcnew::test_genesis_key.pub, btcnew::test_genesis_key.prv, btcnew::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	{
+		btcnew::lock_guard<btcnew::elections_mutex> lock (node->active.mutex);
+		ASSERT_FALSE (node->active.scheduler.push (send, btcnew::genesis_amount, std::chrono::seconds (0)));
+	}
+	boost::property_tree::ptree request;
+	request.put ("action", "election_scheduler");
+	test_response response (request, rpc.config.port, system.io_ctx);
+	system.deadline_set (5s);
+	while (response.status == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (200, response.status);
+	ASSERT_EQ (std::to_string (node->config.active_elections_size), response.json.get<std::string> ("max_bucket_size"));
+	auto & buckets (response.json.get_child ("buckets"));
+	ASSERT_EQ (btcnew::election_scheduler::bucket_count, buckets.size ());
+	auto index (btcnew::election_scheduler::bucket_index (btcnew::genesis_amount));
+	for (auto & bucket : buckets)
+	{
+		ASSERT_EQ (bucket.first == std::to_string (index) ? "1" : "0", bucket.second.get<std::string> (""));
+	}
+}
+
+TEST (rpc, latency)
+{
+	btcnew::system system (24000, 1);
+	auto node = system.nodes.front ();
+	scoped_io_thread_name_change scoped_thread_name_io;
+	enable_ipc_transport_tcp (node->config.ipc_config.transport_tcp);
+	btcnew::node_rpc_config node_rpc_config;
+	btcnew::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	btcnew::rpc_config rpc_config (true);
+	btcnew::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	btcnew::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	node->latency.arrival (1);
+	node->latency.stage (1, btcnew::latency_stage::enqueue);
+	boost::property_tree::ptree request;
+	request.put ("action", "latency");
+	test_response response (request, rpc.config.port, system.io_ctx);
+	system.deadline_set (5s);
+	while (response.status == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (200, response.status);
+	ASSERT_EQ ("1", response.json.get<std::string> ("tracked"));
+	auto & stages (response.json.get_child ("stages"));
+	ASSERT_EQ (btcnew::latency_tracker::stages.size (), stages.size ());
+	ASSERT_EQ ("1", stages.get<std::string> ("enqueue.count"));
+	ASSERT_EQ ("0", stages.get<std::string> ("total.count"));
+}
+
+TEST (rpc, io_shards)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.threading_config.io_shards = 2;
+	auto node = system.add_node (node_config);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	enable_ipc_transport_tcp (node->config.ipc_config.transport_tcp);
+	btcnew::node_rpc_config node_rpc_config;
+	btcnew::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	btcnew::rpc_config rpc_config (true);
+	btcnew::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	btcnew::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "io_shards");
+	test_response response (request, rpc.config.port, system.io_ctx);
+	system.deadline_set (5s);
+	while (response.status == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (200, response.status);
+	auto & shards (response.json.get_child ("shards"));
+	ASSERT_EQ (2, shards.size ());
+	for (auto & shard : shards)
+	{
+		ASSERT_EQ ("-1", shard.second.get<std::string> ("cpu"));
+		ASSERT_NO_THROW (shard.second.get<uint64_t> ("sockets"));
+		ASSERT_NO_THROW (shard.second.get<uint64_t> ("handlers"));
+	}
+}
+
+TEST (rpc, peer_penalties)
+{
+	btcnew::system system;
+	btcnew::node_config node_config (24000, system.logging);
+	node_config.traffic_shaping_config.enable = true;
+	node_config.traffic_shaping_config.penalty_exclude_score = 5;
+	auto node = system.add_node (node_config);
+	btcnew::endpoint endpoint (boost::asio::ip::address_v6::from_string ("::ffff:10.0.0.1"), 10000);
+	node->network.peer_limiter.penalize (endpoint, btcnew::transport::transport_type::tcp, btcnew::transport::penalty_reason::invalid_signature);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	enable_ipc_transport_tcp (node->config.ipc_config.transport_tcp);
+	btcnew::node_rpc_config node_rpc_config;
+	btcnew::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	btcnew::rpc_config rpc_config (true);
+	btcnew::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	btcnew::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "peer_penalties");
+	test_response response (request, rpc.config.port, system.io_ctx);
+	system.deadline_set (5s);
+	while (response.status == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (200, response.status);
+	auto & penalties (response.json.get_child ("penalties"));
+	ASSERT_EQ (1, penalties.size ());
+	auto & penalty (penalties.front ().second);
+	ASSERT_EQ (endpoint.address ().to_string (), penalty.get<std::string> ("address"));
+	ASSERT_EQ ("0", penalty.get<std::string> ("score"));
+	ASSERT_EQ ("1", penalty.get<std::string> ("exclusions"));
+	ASSERT_LT (0, penalty.get<uint64_t> ("excluded_seconds"));
+}
+
 TEST (rpc, simultaneous_calls)
 {
 	// This tests simulatenous calls to the same node in different threads
@@ -3,6 +3,54 @@
 #include <boost/endian/conversion.hpp>
 #include <boost/polymorphic_cast.hpp>
 
+namespace
+{
+/**
+ * Wraps a pooled transaction so that it is handed back to the pool instead of being closed once
+ * the owning btcnew::read_transaction goes out of scope
+ */
+class pooled_read_transaction_impl final : public btcnew::read_transaction_impl
+{
+public:
+	pooled_read_transaction_impl (btcnew::read_transaction_pool & pool_a, std::unique_ptr<btcnew::read_transaction_impl> impl_a) :
+	pool (pool_a),
+	impl (std::move (impl_a))
+	{
+	}
+
+	~pooled_read_transaction_impl ()
+	{
+		if (active)
+		{
+			impl->reset ();
+		}
+		pool.release (std::move (impl));
+	}
+
+	void reset () override
+	{
+		impl->reset ();
+		active = false;
+	}
+
+	void renew () override
+	{
+		impl->renew ();
+		active = true;
+	}
+
+	void * get_handle () const override
+	{
+		return impl->get_handle ();
+	}
+
+private:
+	btcnew::read_transaction_pool & pool;
+	std::unique_ptr<btcnew::read_transaction_impl> impl;
+	bool active{ true };
+};
+}
+
 btcnew::block_sideband::block_sideband (btcnew::block_type type_a, btcnew::account const & account_a, btcnew::block_hash const & successor_a, btcnew::amount const & balance_a, uint64_t height_a, uint64_t timestamp_a, btcnew::epoch epoch_a) :
 type (type_a),
 successor (successor_a),
@@ -410,6 +458,119 @@ void btcnew::read_transaction::refresh () const
 	renew ();
 }
 
+btcnew::read_transaction_pool::read_transaction_pool (std::function<std::unique_ptr<btcnew::read_transaction_impl> ()> create_a, size_t max_pooled_a, size_t max_pooled_per_thread_a, std::chrono::milliseconds max_idle_a) :
+create (create_a),
+max_pooled (max_pooled_a),
+max_pooled_per_thread (max_pooled_per_thread_a),
+max_idle (max_idle_a)
+{
+}
+
+btcnew::read_transaction_pool::~read_transaction_pool ()
+{
+	clear ();
+}
+
+btcnew::read_transaction btcnew::read_transaction_pool::tx_begin_read ()
+{
+	std::unique_ptr<btcnew::read_transaction_impl> impl;
+	std::vector<std::unique_ptr<btcnew::read_transaction_impl>> discard;
+	{
+		btcnew::lock_guard<std::mutex> guard (mutex);
+		auto now (std::chrono::steady_clock::now ());
+		if (now - last_purge >= max_idle)
+		{
+			purge_idle (now, discard);
+		}
+		auto existing (pooled.find (std::this_thread::get_id ()));
+		if (existing != pooled.end () && !existing->second.empty ())
+		{
+			impl = std::move (existing->second.back ().impl);
+			existing->second.pop_back ();
+			--pooled_count;
+		}
+	}
+	// Closing discarded transactions and renewing can both take a lock inside the database, so do it outside of the mutex
+	discard.clear ();
+	if (impl != nullptr)
+	{
+		impl->renew ();
+		++renewed;
+	}
+	else
+	{
+		impl = create ();
+		++created;
+	}
+	return btcnew::read_transaction{ std::make_unique<pooled_read_transaction_impl> (*this, std::move (impl)) };
+}
+
+/** The transaction must already be reset */
+void btcnew::read_transaction_pool::release (std::unique_ptr<btcnew::read_transaction_impl> impl_a)
+{
+	btcnew::unique_lock<std::mutex> lock (mutex);
+	auto & thread_pooled (pooled[std::this_thread::get_id ()]);
+	if (pooled_count < max_pooled && thread_pooled.size () < max_pooled_per_thread)
+	{
+		thread_pooled.push_back ({ std::move (impl_a), std::chrono::steady_clock::now () });
+		++pooled_count;
+	}
+	else
+	{
+		lock.unlock ();
+		++discarded;
+		impl_a.reset ();
+	}
+}
+
+void btcnew::read_transaction_pool::purge_idle (std::chrono::steady_clock::time_point const & now_a, std::vector<std::unique_ptr<btcnew::read_transaction_impl>> & discard_a)
+{
+	last_purge = now_a;
+	for (auto i (pooled.begin ()), n (pooled.end ()); i != n;)
+	{
+		auto & thread_pooled (i->second);
+		// Oldest transactions are at the front
+		auto idle_end (std::find_if (thread_pooled.begin (), thread_pooled.end (), [&now_a, max_idle = max_idle](pooled_transaction const & pooled_transaction_a) {
+			return now_a - pooled_transaction_a.released < max_idle;
+		}));
+		for (auto j (thread_pooled.begin ()); j != idle_end; ++j)
+		{
+			discard_a.push_back (std::move (j->impl));
+		}
+		pooled_count -= std::distance (thread_pooled.begin (), idle_end);
+		discarded += std::distance (thread_pooled.begin (), idle_end);
+		thread_pooled.erase (thread_pooled.begin (), idle_end);
+		// Remove threads which have not read recently (or no longer exist)
+		i = thread_pooled.empty () ? pooled.erase (i) : std::next (i);
+	}
+}
+
+size_t btcnew::read_transaction_pool::size ()
+{
+	btcnew::lock_guard<std::mutex> guard (mutex);
+	return pooled_count;
+}
+
+void btcnew::read_transaction_pool::clear ()
+{
+	decltype (pooled) pooled_l;
+	{
+		btcnew::lock_guard<std::mutex> guard (mutex);
+		pooled.swap (pooled_l);
+		pooled_count = 0;
+	}
+}
+
+namespace btcnew
+{
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (read_transaction_pool & read_transaction_pool, const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "pooled", read_transaction_pool.size (), sizeof (std::unique_ptr<btcnew::read_transaction_impl>) }));
+	return composite;
+}
+}
+
 btcnew::write_transaction::write_transaction (std::unique_ptr<btcnew::write_transaction_impl> write_transaction_impl) :
 impl (std::move (write_transaction_impl))
 {
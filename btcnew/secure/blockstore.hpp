@@ -12,7 +12,11 @@
 #include <boost/endian/conversion.hpp>
 #include <boost/polymorphic_cast.hpp>
 
+#include <chrono>
+#include <functional>
 #include <stack>
+#include <thread>
+#include <unordered_map>
 
 namespace btcnew
 {
@@ -626,6 +630,49 @@ private:
 	std::unique_ptr<btcnew::write_transaction_impl> impl;
 };
 
+/**
+ * Keeps reset read transactions per thread so they can be renewed rather than created from scratch. This saves
+ * a reader slot acquisition and allocation (LMDB) or a snapshot object (RocksDB) for every short lived read.
+ * Pooled transactions which have been idle for longer than max_idle are discarded, as are any exceeding max_pooled.
+ */
+class read_transaction_pool final
+{
+public:
+	read_transaction_pool (std::function<std::unique_ptr<btcnew::read_transaction_impl> ()> create_a, size_t max_pooled_a = 32, size_t max_pooled_per_thread_a = 2, std::chrono::milliseconds max_idle_a = std::chrono::seconds (5));
+	~read_transaction_pool ();
+	btcnew::read_transaction tx_begin_read ();
+	void release (std::unique_ptr<btcnew::read_transaction_impl> impl_a);
+	size_t size ();
+	void clear ();
+
+	/** Number of transactions which had to be created because none were pooled for the calling thread */
+	std::atomic<uint64_t> created{ 0 };
+	/** Number of transactions served by renewing a pooled one */
+	std::atomic<uint64_t> renewed{ 0 };
+	/** Number of pooled transactions destroyed because they were idle for too long or the pool was full */
+	std::atomic<uint64_t> discarded{ 0 };
+
+private:
+	class pooled_transaction final
+	{
+	public:
+		std::unique_ptr<btcnew::read_transaction_impl> impl;
+		std::chrono::steady_clock::time_point released;
+	};
+	void purge_idle (std::chrono::steady_clock::time_point const & now_a, std::vector<std::unique_ptr<btcnew::read_transaction_impl>> & discard_a);
+
+	std::function<std::unique_ptr<btcnew::read_transaction_impl> ()> create;
+	size_t const max_pooled;
+	size_t const max_pooled_per_thread;
+	std::chrono::milliseconds const max_idle;
+	std::mutex mutex;
+	std::unordered_map<std::thread::id, std::vector<pooled_transaction>> pooled;
+	size_t pooled_count{ 0 };
+	std::chrono::steady_clock::time_point last_purge{ std::chrono::steady_clock::now () };
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (read_transaction_pool & read_transaction_pool, const std::string & name);
+
 class rep_weights;
 
 /**
@@ -698,6 +745,12 @@ public:
 	// Return latest vote for an account considering the vote cache
 	virtual std::shared_ptr<btcnew::vote> vote_current (btcnew::transaction const &, btcnew::account const &) = 0;
 	virtual void flush (btcnew::write_transaction const &) = 0;
+	// Reserve sequence numbers for generated votes in blocks of this size, a vote at the top of each block is written before any sequence from it is returned so sequences are not reused after a crash. 0 disables reservations
+	virtual void vote_reservation_set (uint64_t) = 0;
+	// Return true if a reservation is waiting to be written by flush
+	virtual bool vote_flush_required () = 0;
+	// Flush in a write transaction of its own, reservations written are usable once it is committed. This must not be called while holding a write transaction
+	virtual void vote_flush () = 0;
 	virtual btcnew::store_iterator<btcnew::account, std::shared_ptr<btcnew::vote>> vote_begin (btcnew::transaction const &) = 0;
 	virtual btcnew::store_iterator<btcnew::account, std::shared_ptr<btcnew::vote>> vote_end () = 0;
 
@@ -733,9 +786,15 @@ public:
 
 	virtual bool copy_db (boost::filesystem::path const & destination) = 0;
 
+	/** Not applicable to all sub-classes */
+	virtual std::unique_ptr<seq_con_info_component> collect_seq_con_info (const std::string & name) = 0;
+
 	/** Not applicable to all sub-classes */
 	virtual void serialize_mdb_tracker (boost::property_tree::ptree &, std::chrono::milliseconds, std::chrono::milliseconds) = 0;
 
+	/** Transaction open counts, lifetimes and read transaction pool usage */
+	virtual void serialize_txn_totals (boost::property_tree::ptree &) = 0;
+
 	virtual bool init_error () const = 0;
 
 	/** Start read-write transaction */
@@ -278,22 +278,41 @@ public:
 
 	std::shared_ptr<btcnew::vote> vote_generate (btcnew::transaction const & transaction_a, btcnew::account const & account_a, btcnew::raw_key const & key_a, std::shared_ptr<btcnew::block> block_a) override
 	{
-		btcnew::lock_guard<std::mutex> lock (cache_mutex);
-		auto result (vote_current (transaction_a, account_a));
-		uint64_t sequence ((result ? result->sequence : 0) + 1);
-		result = std::make_shared<btcnew::vote> (account_a, key_a, sequence, block_a);
-		vote_cache_l1[account_a] = result;
-		return result;
+		return vote_generate_impl (transaction_a, account_a, key_a, block_a);
 	}
 
 	std::shared_ptr<btcnew::vote> vote_generate (btcnew::transaction const & transaction_a, btcnew::account const & account_a, btcnew::raw_key const & key_a, std::vector<btcnew::block_hash> blocks_a) override
+	{
+		return vote_generate_impl (transaction_a, account_a, key_a, blocks_a);
+	}
+
+	void vote_reservation_set (uint64_t reservation_a) override
 	{
 		btcnew::lock_guard<std::mutex> lock (cache_mutex);
-		auto result (vote_current (transaction_a, account_a));
-		uint64_t sequence ((result ? result->sequence : 0) + 1);
-		result = std::make_shared<btcnew::vote> (account_a, key_a, sequence, blocks_a);
-		vote_cache_l1[account_a] = result;
-		return result;
+		vote_reservation = reservation_a;
+	}
+
+	bool vote_flush_required () override
+	{
+		btcnew::lock_guard<std::mutex> lock (cache_mutex);
+		return !vote_reservations_pending.empty ();
+	}
+
+	void vote_flush () override
+	{
+		std::unordered_map<btcnew::account, uint64_t> flushed;
+		{
+			auto transaction (tx_begin_write ({ tables::vote }));
+			flush (transaction);
+			// Also takes reservations flushed in earlier transactions by other callers of flush, which are committed by now
+			flushed.swap (vote_reservations_flushed);
+		}
+		btcnew::lock_guard<std::mutex> lock (cache_mutex);
+		for (auto & reservation : flushed)
+		{
+			auto & durable (vote_reservations_durable[reservation.first]);
+			durable = std::max (durable, reservation.second);
+		}
 	}
 
 	std::shared_ptr<btcnew::vote> vote_max (btcnew::transaction const & transaction_a, std::shared_ptr<btcnew::vote> vote_a) override
@@ -494,21 +513,27 @@ public:
 
 	void flush (btcnew::write_transaction const & transaction_a) override
 	{
+		std::unordered_map<btcnew::account, std::shared_ptr<btcnew::vote>> reservations;
 		{
 			btcnew::lock_guard<std::mutex> lock (cache_mutex);
 			vote_cache_l1.swap (vote_cache_l2);
 			vote_cache_l1.clear ();
+			reservations.swap (vote_reservations_pending);
 		}
 		for (auto i (vote_cache_l2.begin ()), n (vote_cache_l2.end ()); i != n; ++i)
 		{
-			std::vector<uint8_t> vector;
+			auto reserved (vote_reservations_written.find (i->first));
+			// Never replace a written reservation with a lower sequence
+			if (reserved == vote_reservations_written.end () || reserved->second < i->second->sequence)
 			{
-				btcnew::vectorstream stream (vector);
-				i->second->serialize (stream);
+				vote_put (transaction_a, *i->second);
 			}
-			btcnew::db_val<Val> value (vector.size (), vector.data ());
-			auto status1 (put (transaction_a, tables::vote, i->first, value));
-			release_assert (success (status1));
+		}
+		for (auto & reservation : reservations)
+		{
+			vote_put (transaction_a, *reservation.second);
+			vote_reservations_written[reservation.first] = reservation.second->sequence;
+			vote_reservations_flushed[reservation.first] = reservation.second->sequence;
 		}
 	}
 
@@ -765,6 +790,63 @@ protected:
 	btcnew::network_params network_params;
 	std::unordered_map<btcnew::account, std::shared_ptr<btcnew::vote>> vote_cache_l1;
 	std::unordered_map<btcnew::account, std::shared_ptr<btcnew::vote>> vote_cache_l2;
+	uint64_t vote_reservation{ 0 };
+	/** Highest sequence reserved per local representative, including reservations not written yet */
+	std::unordered_map<btcnew::account, uint64_t> vote_reservations;
+	/** Votes at the top of new reservations, waiting for the next flush */
+	std::unordered_map<btcnew::account, std::shared_ptr<btcnew::vote>> vote_reservations_pending;
+	/** Sequence of the reservation written for each representative, only accessed while holding a write transaction */
+	std::unordered_map<btcnew::account, uint64_t> vote_reservations_written;
+	/** Reservations written by flush whose transaction may not be committed yet, only accessed while holding a write transaction */
+	std::unordered_map<btcnew::account, uint64_t> vote_reservations_flushed;
+	/** Top of the reservation known to be committed for each representative, sequences up to it may be returned */
+	std::unordered_map<btcnew::account, uint64_t> vote_reservations_durable;
+
+	template <typename T>
+	std::shared_ptr<btcnew::vote> vote_generate_impl (btcnew::transaction const & transaction_a, btcnew::account const & account_a, btcnew::raw_key const & key_a, T const & blocks_a)
+	{
+		btcnew::unique_lock<std::mutex> lock (cache_mutex);
+		auto result (vote_current (transaction_a, account_a));
+		uint64_t sequence ((result ? result->sequence : 0) + 1);
+		result = std::make_shared<btcnew::vote> (account_a, key_a, sequence, blocks_a);
+		vote_cache_l1[account_a] = result;
+		if (vote_reservation > 0)
+		{
+			// The stored vote is the top of the last reservation, so after a restart sequences continue above it.
+			// A new block is reserved once half of the current one is used, leaving time for the periodic flush to write it before it runs out
+			auto & reserved (vote_reservations[account_a]);
+			if (sequence + vote_reservation / 2 >= reserved)
+			{
+				reserved = sequence + vote_reservation;
+				vote_reservations_pending[account_a] = std::make_shared<btcnew::vote> (account_a, key_a, reserved, blocks_a);
+			}
+			// The sequence isn't returned before a reservation covering it is committed, otherwise a crash could reuse it after the vote was sent
+			while (vote_reservations_durable[account_a] < sequence)
+			{
+				if (vote_reservations_pending.find (account_a) == vote_reservations_pending.end ())
+				{
+					// Taken by a flush which may not be committed yet, write it again to know when it is
+					vote_reservations_pending[account_a] = std::make_shared<btcnew::vote> (account_a, key_a, vote_reservations[account_a], blocks_a);
+				}
+				lock.unlock ();
+				vote_flush ();
+				lock.lock ();
+			}
+		}
+		return result;
+	}
+
+	void vote_put (btcnew::write_transaction const & transaction_a, btcnew::vote const & vote_a)
+	{
+		std::vector<uint8_t> vector;
+		{
+			btcnew::vectorstream stream (vector);
+			vote_a.serialize (stream);
+		}
+		btcnew::db_val<Val> value (vector.size (), vector.data ());
+		auto status (put (transaction_a, tables::vote, vote_a.account, value));
+		release_assert (success (status));
+	}
 	static int constexpr version{ 15 };
 
 	template <typename T>
@@ -124,13 +124,17 @@ btcnew::node_constants::node_constants (btcnew::network_constants & network_cons
 	peer_interval = search_pending_interval;
 	unchecked_cleaning_interval = std::chrono::minutes (30);
 	process_confirmed_interval = network_constants.is_test_network () ? std::chrono::milliseconds (50) : std::chrono::milliseconds (500);
+	latency_report_interval = network_constants.is_test_network () ? std::chrono::seconds (1) : std::chrono::seconds (10);
 	max_weight_samples = network_constants.is_live_network () ? 4032 : 864;
 	weight_period = 5 * 60; // 5 minutes
 }
 
 btcnew::voting_constants::voting_constants (btcnew::network_constants & network_constants)
 {
-	max_cache = network_constants.is_test_network () ? 2 : 4 * 1024;
+	max_cache_bytes = network_constants.is_test_network () ? 640 : 2 * 1024 * 1024;
+	cache_stripes = network_constants.is_test_network () ? 1 : 16;
+	sequence_reservation = network_constants.is_test_network () ? 64 : 4096;
+	flush_check_interval = network_constants.is_test_network () ? std::chrono::milliseconds (50) : std::chrono::milliseconds (500);
 }
 
 btcnew::portmapping_constants::portmapping_constants (btcnew::network_constants & network_constants)
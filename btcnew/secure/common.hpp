@@ -394,6 +394,8 @@ public:
 	std::chrono::seconds peer_interval;
 	std::chrono::minutes unchecked_cleaning_interval;
 	std::chrono::milliseconds process_confirmed_interval;
+	/** How often block latency and message percentiles are sent to websocket subscribers */
+	std::chrono::seconds latency_report_interval;
 
 	/** The maximum amount of samples for a 2 week period on live or 3 days on beta */
 	uint64_t max_weight_samples;
@@ -405,7 +407,13 @@ class voting_constants
 {
 public:
 	voting_constants (btcnew::network_constants & network_constants);
-	size_t max_cache;
+	/** Memory budget of the votes cache, about two single hash entries on the test network */
+	size_t max_cache_bytes;
+	size_t cache_stripes;
+	/** Vote sequence numbers reserved per representative with each write of its vote */
+	uint64_t sequence_reservation;
+	/** How often pending sequence reservations are checked for and written */
+	std::chrono::milliseconds flush_check_interval;
 };
 
 /** Port-mapping related constants whose value depends on the active network */
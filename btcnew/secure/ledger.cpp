@@ -683,8 +683,9 @@ verification (verification_a)
 }
 } // namespace
 
-btcnew::ledger::ledger (btcnew::block_store & store_a, btcnew::stat & stat_a, bool cache_reps_a, bool cache_cemented_count_a) :
+btcnew::ledger::ledger (btcnew::block_store & store_a, btcnew::stat & stat_a, bool cache_reps_a, bool cache_cemented_count_a, bool cache_confirmation_heights_a) :
 store (store_a),
+confirmation_height_cache (cache_confirmation_heights_a),
 stats (stat_a),
 check_bootstrap_weights (true)
 {
@@ -700,11 +701,15 @@ check_bootstrap_weights (true)
 			}
 		}
 
-		if (cache_cemented_count_a)
+		if (cache_cemented_count_a || cache_confirmation_heights_a)
 		{
 			for (auto i (store.confirmation_height_begin (transaction)), n (store.confirmation_height_end ()); i != n; ++i)
 			{
-				cemented_count += i->second;
+				if (cache_cemented_count_a)
+				{
+					cemented_count += i->second;
+				}
+				confirmation_height_cache.put (i->first, i->second);
 			}
 		}
 
@@ -1038,6 +1043,7 @@ void btcnew::ledger::change_latest (btcnew::write_transaction const & transactio
 		if (old_a.head.is_zero () && new_a.open_block == new_a.head)
 		{
 			assert (!store.confirmation_height_exists (transaction_a, account_a));
+			// Not cached until its confirmation height is committed, lookups fall back to the store
 			store.confirmation_height_put (transaction_a, account_a, 0);
 		}
 		if (!old_a.head.is_zero () && old_a.epoch () != new_a.epoch ())
@@ -1050,6 +1056,7 @@ void btcnew::ledger::change_latest (btcnew::write_transaction const & transactio
 	else
 	{
 		store.confirmation_height_del (transaction_a, account_a);
+		confirmation_height_cache.erase (account_a);
 		store.account_del (transaction_a, account_a);
 	}
 }
@@ -1109,12 +1116,17 @@ std::shared_ptr<btcnew::block> btcnew::ledger::forked_block (btcnew::transaction
 bool btcnew::ledger::block_confirmed (btcnew::transaction const & transaction_a, btcnew::block_hash const & hash_a) const
 {
 	auto confirmed (false);
-	auto block_height (store.block_account_height (transaction_a, hash_a));
-	if (block_height > 0) // 0 indicates that the block doesn't exist
+	btcnew::block_sideband sideband;
+	auto block (store.block_get (transaction_a, hash_a, &sideband));
+	if (block != nullptr)
 	{
+		auto account (block->account ().is_zero () ? sideband.account : block->account ());
 		uint64_t confirmation_height;
-		release_assert (!store.confirmation_height_get (transaction_a, account (transaction_a, hash_a), confirmation_height));
-		confirmed = (confirmation_height >= block_height);
+		if (confirmation_height_cache.get (account, confirmation_height))
+		{
+			release_assert (!store.confirmation_height_get (transaction_a, account, confirmation_height));
+		}
+		confirmed = (confirmation_height >= sideband.height);
 	}
 	return confirmed;
 }
@@ -1131,8 +1143,60 @@ bool btcnew::ledger::block_not_confirmed_or_not_exists (btcnew::block const & bl
 	return result;
 }
 
+btcnew::confirmation_height_cache::confirmation_height_cache (bool enabled_a) :
+enabled (enabled_a)
+{
+}
+
+void btcnew::confirmation_height_cache::put (btcnew::account const & account_a, uint64_t confirmation_height_a)
+{
+	if (enabled)
+	{
+		btcnew::lock_guard<std::mutex> guard (mutex);
+		confirmation_heights[account_a] = confirmation_height_a;
+	}
+}
+
+bool btcnew::confirmation_height_cache::get (btcnew::account const & account_a, uint64_t & confirmation_height_a) const
+{
+	auto result (true);
+	if (enabled)
+	{
+		btcnew::lock_guard<std::mutex> guard (mutex);
+		auto existing (confirmation_heights.find (account_a));
+		if (existing != confirmation_heights.end ())
+		{
+			confirmation_height_a = existing->second;
+			result = false;
+		}
+	}
+	return result;
+}
+
+void btcnew::confirmation_height_cache::erase (btcnew::account const & account_a)
+{
+	if (enabled)
+	{
+		btcnew::lock_guard<std::mutex> guard (mutex);
+		confirmation_heights.erase (account_a);
+	}
+}
+
+size_t btcnew::confirmation_height_cache::size () const
+{
+	btcnew::lock_guard<std::mutex> guard (mutex);
+	return confirmation_heights.size ();
+}
+
 namespace btcnew
 {
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (confirmation_height_cache & confirmation_height_cache, const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "confirmation_heights", confirmation_height_cache.size (), sizeof (std::pair<btcnew::account, uint64_t>) }));
+	return composite;
+}
+
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (ledger & ledger, const std::string & name)
 {
 	auto composite = std::make_unique<seq_con_info_composite> (name);
@@ -1140,6 +1204,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (ledger & ledger, c
 	auto sizeof_element = sizeof (decltype (ledger.bootstrap_weights)::value_type);
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "bootstrap_weights", count, sizeof_element }));
 	composite->add_component (collect_seq_con_info (ledger.rep_weights, "rep_weights"));
+	composite->add_component (collect_seq_con_info (ledger.confirmation_height_cache, "confirmation_height_cache"));
 	return composite;
 }
 }
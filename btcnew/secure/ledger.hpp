@@ -9,11 +9,33 @@ namespace btcnew
 class block_store;
 class stat;
 
+/**
+ * In-memory copy of the confirmation_height table, so checking whether a block is cemented does not need to read it.
+ * Accounts which are not found fall back to reading the store.
+ */
+class confirmation_height_cache final
+{
+public:
+	explicit confirmation_height_cache (bool);
+	void put (btcnew::account const &, uint64_t);
+	/** Returns true if the account was not found */
+	bool get (btcnew::account const &, uint64_t &) const;
+	void erase (btcnew::account const &);
+	size_t size () const;
+	bool const enabled;
+
+private:
+	mutable std::mutex mutex;
+	std::unordered_map<btcnew::account, uint64_t> confirmation_heights;
+};
+
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (confirmation_height_cache &, const std::string &);
+
 using tally_t = std::map<btcnew::uint128_t, std::shared_ptr<btcnew::block>, std::greater<btcnew::uint128_t>>;
 class ledger final
 {
 public:
-	ledger (btcnew::block_store &, btcnew::stat &, bool = true, bool = true);
+	ledger (btcnew::block_store &, btcnew::stat &, bool = true, bool = true, bool = false);
 	btcnew::account account (btcnew::transaction const &, btcnew::block_hash const &) const;
 	btcnew::uint128_t amount (btcnew::transaction const &, btcnew::account const &);
 	btcnew::uint128_t amount (btcnew::transaction const &, btcnew::block_hash const &);
@@ -51,6 +73,7 @@ public:
 	std::atomic<uint64_t> cemented_count{ 0 };
 	std::atomic<uint64_t> block_count_cache{ 0 };
 	btcnew::rep_weights rep_weights;
+	btcnew::confirmation_height_cache confirmation_height_cache;
 	btcnew::stat & stats;
 	std::unordered_map<btcnew::account, btcnew::uint128_t> bootstrap_weights;
 	std::atomic<size_t> bootstrap_weights_size{ 0 };
@@ -224,8 +224,16 @@ TEST (node, fork_storm)
 			}
 			else
 			{
-				btcnew::lock_guard<std::mutex> lock (node_a->active.mutex);
-				if (node_a->active.roots.begin ()->election->last_votes_size () == 1)
+				std::shared_ptr<btcnew::election> election;
+				{
+					btcnew::lock_guard<btcnew::elections_mutex> lock (node_a->active.mutex);
+					auto roots (node_a->active.sorted_roots (1));
+					if (!roots.empty ())
+					{
+						election = roots.front ().election;
+					}
+				}
+				if (election != nullptr && election->last_votes_size () == 1)
 				{
 					++single;
 				}
@@ -465,7 +473,7 @@ TEST (confirmation_height, many_accounts_single_confirmation)
 
 	// As this test can take a while extend the next frontier check
 	{
-		btcnew::lock_guard<std::mutex> guard (node->active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
 		node->active.next_frontier_check = std::chrono::steady_clock::now () + 7200s;
 	}
 
@@ -536,7 +544,7 @@ TEST (confirmation_height, many_accounts_many_confirmations)
 
 	// As this test can take a while extend the next frontier check
 	{
-		btcnew::lock_guard<std::mutex> guard (node->active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
 		node->active.next_frontier_check = std::chrono::steady_clock::now () + 7200s;
 	}
 
@@ -585,7 +593,7 @@ TEST (confirmation_height, long_chains)
 
 	// As this test can take a while extend the next frontier check
 	{
-		btcnew::lock_guard<std::mutex> guard (node->active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
 		node->active.next_frontier_check = std::chrono::steady_clock::now () + 7200s;
 	}
 
@@ -674,7 +682,7 @@ TEST (confirmation_height, prioritize_frontiers_overwrite)
 
 	// As this test can take a while extend the next frontier check
 	{
-		btcnew::lock_guard<std::mutex> guard (node->active.mutex);
+		btcnew::lock_guard<btcnew::elections_mutex> guard (node->active.mutex);
 		node->active.next_frontier_check = std::chrono::steady_clock::now () + 7200s;
 	}
 